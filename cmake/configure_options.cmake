@@ -14,6 +14,7 @@ endif ( NOT ENABLE_COREFILES )
 set ( _LARGEFILE_SOURCE ${ENABLE_LARGE_PCAP} )
 set ( USE_STDLOG ${ENABLE_STDLOG} )
 set ( USE_TSC_CLOCK ${ENABLE_TSC_CLOCK} )
+set ( USE_SLAB_ALLOCATOR ${ENABLE_SLAB_ALLOCATOR} )
 
 if ( ENABLE_LARGE_PCAP )
     set ( _FILE_OFFSET_BITS 64 )
@@ -23,6 +23,7 @@ option ( ENABLE_COREFILES "Prevent Snort from generating core files" ON )
 option ( ENABLE_LARGE_PCAP "Enable support for pcaps larger than 2 GB" OFF )
 option ( ENABLE_STDLOG "Use file descriptor 3 instead of stdout for alerts" OFF )
 option ( ENABLE_TSC_CLOCK "Use timestamp counter register clock (x86 only)" OFF )
+option ( ENABLE_SLAB_ALLOCATOR "Serve small allocations from per-thread slabs" OFF )
 
 # documentation
 option ( MAKE_HTML_DOC "Create the HTML documentation" ON )
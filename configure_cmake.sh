@@ -42,6 +42,7 @@ Optional Features:
     --enable-large-pcap     enable support for pcaps larger than 2 GB
     --enable-stdlog         use file descriptor 3 instead of stdout for alerts
     --enable-tsc-clock      use timestamp counter register clock (x86 only)
+    --enable-slab-allocator serve small allocations from per-thread slabs
     --enable-debug-msgs     enable debug printing options (bugreports and
                             developers only)
     --enable-debug          enable debugging options (bugreports and developers
@@ -238,6 +239,9 @@ while [ $# -ne 0 ]; do
         --enable-tsc-clock)
             append_cache_entry ENABLE_TSC_CLOCK         BOOL true
             ;;
+        --enable-slab-allocator)
+            append_cache_entry ENABLE_SLAB_ALLOCATOR    BOOL true
+            ;;
         --disable-large-pcap)
             append_cache_entry ENABLE_LARGE_PCAP        BOOL false
             ;;
@@ -27,23 +27,37 @@
 
 // Unresolved external symbol declarations and references.
 SNORT_FORCED_INCLUSION_EXTERN(bitop_test);
+SNORT_FORCED_INCLUSION_EXTERN(byte_index_test);
+SNORT_FORCED_INCLUSION_EXTERN(byte_scan_test);
+SNORT_FORCED_INCLUSION_EXTERN(checksum_test);
+SNORT_FORCED_INCLUSION_EXTERN(decode_test);
+SNORT_FORCED_INCLUSION_EXTERN(file_mempool_test);
+SNORT_FORCED_INCLUSION_EXTERN(file_sha256_test);
 SNORT_FORCED_INCLUSION_EXTERN(lua_stack_test);
 SNORT_FORCED_INCLUSION_EXTERN(sfdaq_module_test);
 SNORT_FORCED_INCLUSION_EXTERN(sfip_test);
 SNORT_FORCED_INCLUSION_EXTERN(sfrf_test);
 SNORT_FORCED_INCLUSION_EXTERN(sfrt_test);
 SNORT_FORCED_INCLUSION_EXTERN(sfthd_test);
+SNORT_FORCED_INCLUSION_EXTERN(slab_allocator_test);
 SNORT_FORCED_INCLUSION_EXTERN(stopwatch_test);
 
 bool catch_extern_tests[] =
 {
     SNORT_FORCED_INCLUSION_SYMBOL(bitop_test),
+    SNORT_FORCED_INCLUSION_SYMBOL(byte_index_test),
+    SNORT_FORCED_INCLUSION_SYMBOL(byte_scan_test),
+    SNORT_FORCED_INCLUSION_SYMBOL(checksum_test),
+    SNORT_FORCED_INCLUSION_SYMBOL(decode_test),
+    SNORT_FORCED_INCLUSION_SYMBOL(file_mempool_test),
+    SNORT_FORCED_INCLUSION_SYMBOL(file_sha256_test),
     SNORT_FORCED_INCLUSION_SYMBOL(lua_stack_test),
     SNORT_FORCED_INCLUSION_SYMBOL(sfdaq_module_test),
     SNORT_FORCED_INCLUSION_SYMBOL(sfip_test),
     SNORT_FORCED_INCLUSION_SYMBOL(sfrf_test),
     SNORT_FORCED_INCLUSION_SYMBOL(sfrt_test),
     SNORT_FORCED_INCLUSION_SYMBOL(sfthd_test),
+    SNORT_FORCED_INCLUSION_SYMBOL(slab_allocator_test),
     SNORT_FORCED_INCLUSION_SYMBOL(stopwatch_test),
 };
 
@@ -21,9 +21,17 @@
 #define CODECS_CHECKSUM_H
 
 #include <cstddef>
+#include <cstdint>
 
 #include <protocols/protocol_ids.h>
 
+// SSE2 is part of the x86_64 baseline; AVX2 is selected at runtime
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define CKSUM_SIMD
+#define CKSUM_SIMD_MIN_LEN 128
+#endif
+
 namespace checksum
 {
 struct Pseudoheader6
@@ -54,6 +62,14 @@ inline uint16_t icmp_cksum(const uint16_t* buf, std::size_t len, const Pseudohea
 inline uint16_t icmp_cksum(const uint16_t* buf, std::size_t len);
 inline uint16_t ip_cksum(const uint16_t* buf, std::size_t len);
 
+//  incrementally update a checksum when checksummed data is rewritten in
+//  place (RFC 1624) instead of summing the whole buffer again.  values are
+//  16 bit words as stored in the packet; buffers are word aligned with the
+//  start of the checksummed data and len is even.
+inline uint16_t cksum_update(uint16_t cksum, uint16_t old_word, uint16_t new_word);
+inline uint16_t cksum_update(
+    uint16_t cksum, const uint16_t* old_buf, const uint16_t* new_buf, std::size_t len);
+
 /*
  *  NOTE: Since multiple dynamic libraries use checksums, the choice
  *          is to either include all of the checksum details in a header,
@@ -87,7 +103,7 @@ struct Psuedoheader6Union
     };
 };
 
-inline uint16_t cksum_add(const uint16_t* buf, std::size_t len, uint32_t cksum)
+inline uint16_t cksum_add_scalar(const uint16_t* buf, std::size_t len, uint32_t cksum)
 {
     const uint16_t* sp = buf;
 
@@ -166,6 +182,120 @@ inline uint16_t cksum_add(const uint16_t* buf, std::size_t len, uint32_t cksum)
     return (uint16_t)(~cksum);
 }
 
+// reduce a wide sum to 16 bits with end around carry without changing
+// its one's complement value so it can be added to a 32 bit sum
+inline uint32_t fold_sum(uint64_t sum)
+{
+    sum = (sum >> 32) + (sum & 0xffffffff);
+    sum = (sum >> 16) + (sum & 0x0000ffff);
+    sum = (sum >> 16) + (sum & 0x0000ffff);
+    sum += (sum >> 16);
+    return (uint32_t)(sum & 0x0000ffff);
+}
+
+#ifdef CKSUM_SIMD
+// the vector kernels add 16 bit words into 32 bit lanes, two words per lane
+// per block, and widen into 64 bit lanes before the 32 bit lanes can carry
+#define CKSUM_SIMD_MAX_RUN 16384
+
+// sum of blocks * 16 bytes taken as 16 bit words
+inline uint64_t sum_sse2(const uint8_t* p, std::size_t blocks)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc64 = zero;
+
+    while ( blocks )
+    {
+        std::size_t n = blocks < CKSUM_SIMD_MAX_RUN ? blocks : CKSUM_SIMD_MAX_RUN;
+        __m128i acc32 = zero;
+        blocks -= n;
+
+        while ( n-- )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)p);
+            acc32 = _mm_add_epi32(acc32, _mm_unpacklo_epi16(v, zero));
+            acc32 = _mm_add_epi32(acc32, _mm_unpackhi_epi16(v, zero));
+            p += 16;
+        }
+        acc64 = _mm_add_epi64(acc64, _mm_unpacklo_epi32(acc32, zero));
+        acc64 = _mm_add_epi64(acc64, _mm_unpackhi_epi32(acc32, zero));
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, acc64);
+    return lanes[0] + lanes[1];
+}
+
+// sum of blocks * 32 bytes taken as 16 bit words
+__attribute__((target("avx2")))
+inline uint64_t sum_avx2(const uint8_t* p, std::size_t blocks)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc64 = zero;
+
+    while ( blocks )
+    {
+        std::size_t n = blocks < CKSUM_SIMD_MAX_RUN ? blocks : CKSUM_SIMD_MAX_RUN;
+        __m256i acc32 = zero;
+        blocks -= n;
+
+        while ( n-- )
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i*)p);
+            acc32 = _mm256_add_epi32(acc32, _mm256_unpacklo_epi16(v, zero));
+            acc32 = _mm256_add_epi32(acc32, _mm256_unpackhi_epi16(v, zero));
+            p += 32;
+        }
+        acc64 = _mm256_add_epi64(acc64, _mm256_unpacklo_epi32(acc32, zero));
+        acc64 = _mm256_add_epi64(acc64, _mm256_unpackhi_epi32(acc32, zero));
+    }
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, acc64);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+inline bool have_avx2()
+{
+    static const bool avx2 = []()
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return avx2;
+}
+#endif
+
+// headers and tiny payloads stay on the unrolled scalar loop; larger
+// buffers are summed with the widest kernel the cpu supports and the
+// remainder of less than one vector is finished by the scalar loop
+inline uint16_t cksum_add(const uint16_t* buf, std::size_t len, uint32_t cksum)
+{
+#ifdef CKSUM_SIMD
+    if ( len >= CKSUM_SIMD_MIN_LEN )
+    {
+        const uint8_t* p = (const uint8_t*)buf;
+        std::size_t n;
+
+        if ( have_avx2() )
+        {
+            n = len / 32;
+            cksum += fold_sum(sum_avx2(p, n));
+            n *= 32;
+        }
+        else
+        {
+            n = len / 16;
+            cksum += fold_sum(sum_sse2(p, n));
+            n *= 16;
+        }
+        buf = (const uint16_t*)(p + n);
+        len -= n;
+    }
+#endif
+    return cksum_add_scalar(buf, len, cksum);
+}
+
 inline void add_ipv4_pseudoheader(const Pseudoheader* const ph4,
     uint32_t& cksum)
 {
@@ -339,6 +469,33 @@ inline uint16_t ip_cksum(const uint16_t* buf, std::size_t len)
 
 inline uint16_t cksum_add(const uint16_t* buf, std::size_t len)
 { return detail::cksum_add(buf, len, 0); }
+
+inline uint16_t cksum_update(uint16_t cksum, uint16_t old_word, uint16_t new_word)
+{
+    // HC' = ~(~HC + ~m + m')
+    uint32_t sum = (uint16_t)~cksum;
+    sum += (uint16_t)~old_word;
+    sum += new_word;
+
+    sum  = (sum >> 16) + (sum & 0x0000ffff);
+    sum += (sum >> 16);
+
+    return (uint16_t)(~sum);
+}
+
+inline uint16_t cksum_update(
+    uint16_t cksum, const uint16_t* old_buf, const uint16_t* new_buf, std::size_t len)
+{
+    uint64_t sum = (uint16_t)~cksum;
+
+    for ( std::size_t i = 0; i < len / 2; ++i )
+    {
+        sum += (uint16_t)~old_buf[i];
+        sum += new_buf[i];
+    }
+
+    return (uint16_t)(~detail::fold_sum(sum));
+}
 } // namespace checksum
 
 #endif  /* CODECS_CHECKSUM_H */
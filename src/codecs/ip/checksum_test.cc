@@ -0,0 +1,160 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// checksum_test.cc validates the vector checksum kernels against the
+// scalar loop and times them
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdlib>
+#include <vector>
+
+#include "catch/snort_catch.h"
+
+#include "checksum.h"
+
+SNORT_FORCED_INCLUSION_DEFINITION(checksum_test);
+
+using namespace checksum;
+
+static std::vector<uint8_t> make_data(std::size_t len, unsigned seed)
+{
+    std::vector<uint8_t> v(len);
+    srand(seed);
+
+    for ( auto& b : v )
+        b = rand();
+
+    return v;
+}
+
+TEST_CASE("cksum_add matches scalar", "[checksum]")
+{
+    // odd offsets exercise unaligned loads
+    std::vector<uint8_t> buf = make_data(2048 + 64, 1);
+
+    for ( std::size_t off = 0; off < 4; ++off )
+    {
+        for ( std::size_t len = 0; len <= 2048; ++len )
+        {
+            const uint16_t* p = (const uint16_t*)(buf.data() + off);
+
+            for ( uint32_t init : { 0u, 0x1234u, 0xfffffu } )
+                CHECK(detail::cksum_add(p, len, init) == detail::cksum_add_scalar(p, len, init));
+        }
+    }
+}
+
+TEST_CASE("cksum_add large and saturated", "[checksum]")
+{
+    std::vector<uint8_t> ones(70000, 0xff);
+    std::vector<uint8_t> rnd = make_data(70000, 2);
+
+    for ( std::size_t len : { 128u, 1500u, 9000u, 65535u, 65536u, 70000u } )
+    {
+        CHECK(detail::cksum_add((const uint16_t*)ones.data(), len, 0) ==
+            detail::cksum_add_scalar((const uint16_t*)ones.data(), len, 0));
+
+        CHECK(detail::cksum_add((const uint16_t*)rnd.data(), len, 0) ==
+            detail::cksum_add_scalar((const uint16_t*)rnd.data(), len, 0));
+    }
+}
+
+#ifdef CKSUM_SIMD
+TEST_CASE("vector kernels", "[checksum]")
+{
+    std::vector<uint8_t> buf = make_data(64 * 1024 + 1, 3);
+
+    for ( std::size_t blocks = 0; blocks <= 2048; ++blocks )
+    {
+        const uint16_t* p = (const uint16_t*)(buf.data() + 1);
+        uint16_t scalar = detail::cksum_add_scalar(p, blocks * 32, 0);
+
+        CHECK((uint16_t)~detail::fold_sum(detail::sum_sse2((const uint8_t*)p, blocks * 2)) ==
+            scalar);
+
+        if ( detail::have_avx2() )
+            CHECK((uint16_t)~detail::fold_sum(detail::sum_avx2((const uint8_t*)p, blocks)) ==
+                scalar);
+    }
+}
+#endif
+
+TEST_CASE("cksum_update", "[checksum]")
+{
+    std::vector<uint8_t> buf = make_data(1500, 4);
+    uint16_t* words = (uint16_t*)buf.data();
+    const std::size_t len = buf.size();
+
+    SECTION("single word")
+    {
+        for ( std::size_t i = 0; i < len / 2; i += 7 )
+        {
+            uint16_t sum = cksum_add(words, len);
+            uint16_t old = words[i];
+            words[i] = (uint16_t)rand();
+
+            CHECK(cksum_update(sum, old, words[i]) == cksum_add(words, len));
+        }
+    }
+    SECTION("range")
+    {
+        for ( std::size_t i = 0; i < len / 2; i += 31 )
+        {
+            std::size_t n = (len / 2 - i) < 40 ? (len / 2 - i) : 40;
+            std::vector<uint16_t> old(words + i, words + i + n);
+            uint16_t sum = cksum_add(words, len);
+
+            for ( std::size_t j = 0; j < n; ++j )
+                words[i + j] = (uint16_t)rand();
+
+            CHECK(cksum_update(sum, old.data(), words + i, n * 2) == cksum_add(words, len));
+        }
+    }
+}
+
+TEST_CASE("cksum_add benchmarks", "[checksum][!benchmark]")
+{
+    std::vector<uint8_t> buf = make_data(65536 + 1, 5);
+    const uint16_t* p = (const uint16_t*)buf.data();
+    // volatile so the sums can't be discarded and the loops with them
+    volatile uint32_t sink = 0;
+
+    BENCHMARK("scalar 1460")
+    {
+        for ( int i = 0; i < 10000; ++i )
+            sink += detail::cksum_add_scalar(p, 1460, i);
+    }
+    BENCHMARK("dispatch 1460")
+    {
+        for ( int i = 0; i < 10000; ++i )
+            sink += detail::cksum_add(p, 1460, i);
+    }
+    BENCHMARK("scalar 65535")
+    {
+        for ( int i = 0; i < 1000; ++i )
+            sink += detail::cksum_add_scalar(p, 65535, i);
+    }
+    BENCHMARK("dispatch 65535")
+    {
+        for ( int i = 0; i < 1000; ++i )
+            sink += detail::cksum_add(p, 65535, i);
+    }
+}
+
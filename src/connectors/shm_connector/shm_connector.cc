@@ -0,0 +1,287 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// shm_connector.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "shm_connector.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "log/messages.h"
+#include "main/snort_debug.h"
+#include "main/thread.h"
+#include "profiler/profiler_defs.h"
+#include "utils/util.h"
+
+#include "shm_connector_module.h"
+
+/* Globals ****************************************************************/
+
+THREAD_LOCAL ShmConnectorStats shm_connector_stats;
+THREAD_LOCAL ProfileStats shm_connector_perfstats;
+
+ShmConnectorCommon::ShmConnectorCommon(ShmConnectorConfig::ShmConnectorConfigSet* conf)
+{
+    config_set = (ConnectorConfig::ConfigSet*)conf;
+}
+
+ShmConnectorCommon::~ShmConnectorCommon()
+{
+    for ( auto conf : *config_set )
+        delete conf;
+
+    config_set->clear();
+    delete config_set;
+}
+
+ShmConnector::ShmConnector(ShmConnectorConfig* shm_connector_config, ShmRing* shm_ring)
+{
+    DebugMessage(DEBUG_CONNECTORS,"ShmConnector::ShmConnector()\n");
+    config = shm_connector_config;
+    ring = shm_ring;
+}
+
+ShmConnector::~ShmConnector()
+{
+    DebugMessage(DEBUG_CONNECTORS,"ShmConnector::~ShmConnector()\n");
+    delete ring;
+}
+
+// The message is built in place in the ring.  If the ring is full it is
+// built on the heap and copied in at transmit if there is room by then.
+ConnectorMsgHandle* ShmConnector::alloc_message(const uint32_t length, const uint8_t** data)
+{
+    DebugMessage(DEBUG_CONNECTORS,"ShmConnector::alloc_message()\n");
+    ShmConnectorMsgHandle* handle = new ShmConnectorMsgHandle;
+
+    handle->connector_msg.length = length;
+    handle->connector_msg.data = ring->reserve(length, handle->pos);
+
+    if ( !handle->connector_msg.data )
+    {
+        handle->connector_msg.data = new uint8_t[length];
+        handle->copy = true;
+        shm_connector_stats.copied++;
+    }
+
+    *data = handle->connector_msg.data;
+    return handle;
+}
+
+void ShmConnector::discard_message(ConnectorMsgHandle* msg)
+{
+    DebugMessage(DEBUG_CONNECTORS,"ShmConnector::discard_message()\n");
+    ShmConnectorMsgHandle* handle = (ShmConnectorMsgHandle*)msg;
+
+    if ( handle->copy )
+        delete[] handle->connector_msg.data;
+
+    else if ( config->direction == Connector::CONN_TRANSMIT )
+        ring->cancel(handle->pos);
+
+    else
+        ring->release(handle->pos);
+
+    delete handle;
+}
+
+bool ShmConnector::transmit_message(ConnectorMsgHandle* msg)
+{
+    DebugMessage(DEBUG_CONNECTORS,"ShmConnector::transmit_message()\n");
+    ShmConnectorMsgHandle* handle = (ShmConnectorMsgHandle*)msg;
+    const uint32_t length = handle->connector_msg.length;
+    bool ok = true;
+
+    if ( !handle->copy )
+        ring->commit(handle->pos, length);
+
+    else
+    {
+        uint64_t pos;
+        uint8_t* data = ring->reserve(length, pos);
+
+        if ( data )
+        {
+            memcpy(data, handle->connector_msg.data, length);
+            ring->commit(pos, length);
+        }
+        else
+        {
+            shm_connector_stats.dropped++;
+            ok = false;
+        }
+        delete[] handle->connector_msg.data;
+    }
+
+    if ( ok )
+        shm_connector_stats.sent++;
+
+    delete handle;
+    return ok;
+}
+
+// The message is read in place and its space goes back to the ring when it
+// is discarded.  Messages must be discarded in the order received.
+ConnectorMsgHandle* ShmConnector::receive_message(bool block)
+{
+    uint32_t length;
+    uint64_t end;
+    const uint8_t* data = ring->read(length, end, block, SHM_RECEIVE_TIMEOUT_MS);
+
+    if ( !data )
+        return nullptr;
+
+    ShmConnectorMsgHandle* handle = new ShmConnectorMsgHandle;
+    handle->connector_msg.length = length;
+    handle->connector_msg.data = (uint8_t*)data;
+    handle->pos = end;
+
+    shm_connector_stats.received++;
+    return handle;
+}
+
+//-------------------------------------------------------------------------
+// api stuff
+//-------------------------------------------------------------------------
+
+static Module* mod_ctor()
+{
+    DebugMessage(DEBUG_CONNECTORS,"shm_connector:mod_ctor()\n");
+    return new ShmConnectorModule;
+}
+
+static void mod_dtor(Module* m)
+{
+    delete m;
+    DebugMessage(DEBUG_CONNECTORS,"shm_connector:mod_dtor(Module*)\n");
+}
+
+// Create a per-thread object.  Both ends open the same file and whichever
+// is first creates the ring.
+static Connector* shm_connector_tinit(ConnectorConfig* config)
+{
+    DebugMessage(DEBUG_CONNECTORS,"shm_connector:shm_connector_tinit()\n");
+    ShmConnectorConfig* cfg = (ShmConnectorConfig*)config;
+
+    if ( cfg->direction != Connector::CONN_TRANSMIT and
+        cfg->direction != Connector::CONN_RECEIVE )
+        return nullptr;
+
+    std::string pathname;
+
+    if ( cfg->name.find('/') == std::string::npos )
+        pathname = "/dev/shm/snort_";
+
+    pathname += cfg->name;
+
+    if ( cfg->per_thread )
+    {
+        pathname += "_";
+        pathname += std::to_string(get_instance_id());
+    }
+
+    int fd = open(pathname.c_str(), O_RDWR | O_CREAT, 0600);
+
+    if ( fd < 0 )
+    {
+        ErrorMessage("shm_connector: can't open %s: %s\n", pathname.c_str(), get_error(errno));
+        return nullptr;
+    }
+
+    // the mapping outlives the descriptor
+    ShmRing* ring = ShmRing::attach(fd, cfg->size);
+    close(fd);
+
+    if ( !ring )
+    {
+        ErrorMessage("shm_connector: can't map a %u byte ring from %s\n", cfg->size,
+            pathname.c_str());
+        return nullptr;
+    }
+
+    DebugFormat(DEBUG_CONNECTORS,"shm_connector:shm_connector_tinit(): pathname: %s\n",
+        pathname.c_str());
+
+    return new ShmConnector(cfg, ring);
+}
+
+static void shm_connector_tterm(Connector* connector)
+{
+    DebugMessage(DEBUG_CONNECTORS,"shm_connector:shm_connector_tterm()\n");
+    ShmConnector* shm_connector = (ShmConnector*)connector;
+
+    delete shm_connector;
+}
+
+static ConnectorCommon* shm_connector_ctor(Module* m)
+{
+    DebugMessage(DEBUG_CONNECTORS,"shm_connector:shm_connector_ctor(Module*)\n");
+    ShmConnectorModule* mod = (ShmConnectorModule*)m;
+    ShmConnectorCommon* shm_connector_common = new ShmConnectorCommon(
+        mod->get_and_clear_config());
+
+    return shm_connector_common;
+}
+
+static void shm_connector_dtor(ConnectorCommon* c)
+{
+    DebugMessage(DEBUG_CONNECTORS,"shm_connector:shm_connector_dtor(ConnectorCommon*)\n");
+    ShmConnectorCommon* sc = (ShmConnectorCommon*)c;
+    delete sc;
+}
+
+const ConnectorApi shm_connector_api =
+{
+    {
+        PT_CONNECTOR,
+        sizeof(ConnectorApi),
+        CONNECTOR_API_VERSION,
+        0,
+        API_RESERVED,
+        API_OPTIONS,
+        SHM_CONNECTOR_NAME,
+        SHM_CONNECTOR_HELP,
+        mod_ctor,
+        mod_dtor
+    },
+    0,
+    nullptr,
+    nullptr,
+    shm_connector_tinit,
+    shm_connector_tterm,
+    shm_connector_ctor,
+    shm_connector_dtor
+};
+
+#ifdef BUILDING_SO
+SO_PUBLIC const BaseApi* snort_plugins[] =
+#else
+const BaseApi* shm_connector[] =
+#endif
+{
+    &shm_connector_api.base,
+    nullptr
+};
+
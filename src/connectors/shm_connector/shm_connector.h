@@ -0,0 +1,74 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// shm_connector.h
+
+#ifndef SHM_CONNECTOR_H
+#define SHM_CONNECTOR_H
+
+#include "framework/connector.h"
+
+#include "shm_connector_config.h"
+#include "shm_ring.h"
+
+// longest a blocking receive waits for a message
+#define SHM_RECEIVE_TIMEOUT_MS (1000)
+
+//-------------------------------------------------------------------------
+// class stuff
+//-------------------------------------------------------------------------
+
+// the message data is in the ring unless the ring was full when it was
+// allocated, in which case it is copied in when transmitted
+class ShmConnectorMsgHandle : public ConnectorMsgHandle
+{
+public:
+    ConnectorMsg connector_msg;
+    uint64_t pos = 0;  // of a reservation or the end of a received message
+    bool copy = false;
+};
+
+class ShmConnectorCommon : public ConnectorCommon
+{
+public:
+    ShmConnectorCommon(ShmConnectorConfig::ShmConnectorConfigSet*);
+    ~ShmConnectorCommon();
+};
+
+class ShmConnector : public Connector
+{
+public:
+    ShmConnector(ShmConnectorConfig*, ShmRing*);
+    ~ShmConnector() override;
+
+    ConnectorMsgHandle* alloc_message(const uint32_t, const uint8_t**) override;
+    void discard_message(ConnectorMsgHandle*) override;
+    bool transmit_message(ConnectorMsgHandle*) override;
+    ConnectorMsgHandle* receive_message(bool) override;
+
+    ConnectorMsg* get_connector_msg(ConnectorMsgHandle* handle) override
+    { return( &((ShmConnectorMsgHandle*)handle)->connector_msg ); }
+    Direction get_connector_direction() override
+    { return config->direction; }
+
+private:
+    ShmRing* ring;
+};
+
+#endif
+
@@ -0,0 +1,184 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// shm_connector_module.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "shm_connector_module.h"
+
+#include "log/messages.h"
+#include "main/snort_debug.h"
+
+static const Parameter shm_connector_params[] =
+{
+    { "connector", Parameter::PT_STRING, nullptr, nullptr,
+      "connector name" },
+
+    { "name", Parameter::PT_STRING, nullptr, nullptr,
+      "ring name, a file in /dev/shm unless it is a path" },
+
+    { "direction", Parameter::PT_ENUM, "receive | transmit", nullptr,
+      "usage" },
+
+    { "size", Parameter::PT_INT, "4096:1073741824", "1048576",
+      "ring size in bytes, rounded up to a power of 2" },
+
+    { "per_thread", Parameter::PT_BOOL, nullptr, "true",
+      "append the packet thread instance id to the name so each thread has its own ring" },
+
+    { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
+};
+
+static const PegInfo shm_connector_pegs[] =
+{
+    { CountType::SUM, "sent", "messages written to the ring" },
+    { CountType::SUM, "received", "messages read from the ring" },
+    { CountType::SUM, "copied", "messages allocated outside a full ring and copied in" },
+    { CountType::SUM, "dropped", "messages dropped because the ring was full" },
+    { CountType::END, nullptr, nullptr }
+};
+
+//-------------------------------------------------------------------------
+// shm_connector module
+//-------------------------------------------------------------------------
+
+ShmConnectorModule::ShmConnectorModule() :
+    Module(SHM_CONNECTOR_NAME, SHM_CONNECTOR_HELP, shm_connector_params)
+{
+    DebugMessage(DEBUG_CONNECTORS,"ShmConnectorModule::ShmConnectorModule()\n");
+    config = nullptr;
+    config_set = new ShmConnectorConfig::ShmConnectorConfigSet;
+}
+
+ShmConnectorModule::~ShmConnectorModule()
+{
+    DebugMessage(DEBUG_CONNECTORS,"ShmConnectorModule::~ShmConnectorModule()\n");
+    if ( config )
+        delete config;
+    if ( config_set )
+        delete config_set;
+}
+
+ProfileStats* ShmConnectorModule::get_profile() const
+{ return &shm_connector_perfstats; }
+
+bool ShmConnectorModule::set(const char* fqn, Value& v, SnortConfig*)
+{
+#ifdef DEBUG_MSGS
+    DebugFormat(DEBUG_CONNECTORS,"ShmConnectorModule::set(): %s, %s\n", fqn, v.get_name());
+#else
+    UNUSED(fqn);
+#endif
+
+    if ( v.is("connector") )
+        config->connector_name = v.get_string();
+
+    else if ( v.is("name") )
+        config->name = v.get_string();
+
+    else if ( v.is("direction") )
+        switch ( v.get_long() )
+        {
+        case 0:
+        {
+            config->direction = Connector::CONN_RECEIVE;
+            break;
+        }
+        case 1:
+        {
+            config->direction = Connector::CONN_TRANSMIT;
+            break;
+        }
+        default:
+            return false;
+        }
+
+    else if ( v.is("size") )
+    {
+        uint32_t size = 4096;
+
+        while ( size < v.get_long() )
+            size <<= 1;
+
+        config->size = size;
+    }
+    else if ( v.is("per_thread") )
+        config->per_thread = v.get_bool();
+
+    else
+        return false;
+
+    return true;
+}
+
+// clear my working config and hand-over the compiled list to the caller
+ShmConnectorConfig::ShmConnectorConfigSet* ShmConnectorModule::get_and_clear_config()
+{
+    DebugMessage(DEBUG_CONNECTORS,"ShmConnectorModule::get_and_clear_config()\n");
+    ShmConnectorConfig::ShmConnectorConfigSet* temp_config = config_set;
+    config = nullptr;
+    config_set = nullptr;
+    return temp_config;
+}
+
+bool ShmConnectorModule::begin(const char* fqn, int idx, SnortConfig*)
+{
+#ifdef DEBUG_MSGS
+    DebugFormat(DEBUG_CONNECTORS,"ShmConnectorModule::begin(): %s, %d\n", fqn, idx);
+#else
+    UNUSED(fqn);
+    UNUSED(idx);
+#endif
+    if ( !config )
+    {
+        config = new ShmConnectorConfig;
+    }
+    return true;
+}
+
+bool ShmConnectorModule::end(const char* fqn, int idx, SnortConfig*)
+{
+#ifdef DEBUG_MSGS
+    DebugFormat(DEBUG_CONNECTORS,"ShmConnectorModule::end(): %s, %d\n", fqn, idx);
+#else
+    UNUSED(fqn);
+#endif
+
+    if (idx != 0)
+    {
+        if ( config->name.empty() or config->direction == Connector::CONN_UNDEFINED )
+        {
+            ParseError("shm_connector requires a name and a direction");
+            return false;
+        }
+        config_set->push_back(config);
+        config = nullptr;
+    }
+
+    return true;
+}
+
+const PegInfo* ShmConnectorModule::get_pegs() const
+{ return shm_connector_pegs; }
+
+PegCount* ShmConnectorModule::get_counts() const
+{ return (PegCount*)&shm_connector_stats; }
+
@@ -0,0 +1,312 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// shm_ring.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "shm_ring.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <climits>
+#include <cstring>
+#include <ctime>
+
+// the header and records are shared with other processes so their atomics
+// must not need a lock
+static_assert(ATOMIC_INT_LOCK_FREE == 2 and ATOMIC_LLONG_LOCK_FREE == 2,
+    "shared memory rings need lock free atomics");
+
+static const uint32_t SHM_RING_MAGIC = 0x534e5254;
+static const uint32_t SHM_RING_VERSION = 1;
+
+enum RingState : uint32_t { RING_NEW = 0, RING_INIT, RING_READY };
+
+// the first process to attach initializes the header.  everything else in
+// a new file is zero which is an empty ring.
+struct ShmRingHeader
+{
+    std::atomic<uint32_t> state;
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+
+    // producers and the consumer each get their own cache line
+    alignas(64) std::atomic<uint64_t> head;  // next reservation
+    alignas(64) std::atomic<uint64_t> tail;  // released by the consumer
+
+    alignas(64) std::atomic<uint32_t> waiting;  // consumers blocked in read()
+    std::atomic<uint32_t> wakeups;  // futex word
+};
+
+static const size_t DATA_OFFSET = (sizeof(ShmRingHeader) + 63) & ~(size_t)63;
+
+// each message is preceded by a record header and padded to 8 bytes.  state
+// stays zero until the message is committed.  space is zeroed again as it is
+// released so a record is never confused with what was there before.
+struct ShmRecord
+{
+    uint32_t span;  // bytes to the next record
+    std::atomic<uint32_t> state;
+};
+
+static const uint32_t REC_READY = 0x80000000;
+static const uint32_t REC_SKIP = 0x40000000;
+static const uint32_t REC_LENGTH = 0x3fffffff;
+
+size_t ShmRing::get_file_size(uint32_t size)
+{ return DATA_OFFSET + size; }
+
+ShmRing* ShmRing::attach(int fd, uint32_t size)
+{
+    assert(size >= 64 and !(size & (size - 1)));
+    const size_t file_size = get_file_size(size);
+    struct stat st;
+
+    if ( fstat(fd, &st) )
+        return nullptr;
+
+    // racing to size a new file is harmless since both use the same size
+    if ( !st.st_size )
+    {
+        if ( ftruncate(fd, file_size) )
+            return nullptr;
+    }
+    else if ( (size_t)st.st_size != file_size )
+        return nullptr;
+
+    void* p = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if ( p == MAP_FAILED )
+        return nullptr;
+
+    ShmRingHeader* hdr = (ShmRingHeader*)p;
+    uint32_t state = RING_NEW;
+
+    if ( hdr->state.compare_exchange_strong(state, RING_INIT) )
+    {
+        hdr->magic = SHM_RING_MAGIC;
+        hdr->version = SHM_RING_VERSION;
+        hdr->size = size;
+        state = RING_READY;
+        hdr->state.store(state, std::memory_order_release);
+    }
+    else
+    {
+        // another process is initializing it
+        const struct timespec ms = { 0, 1000000 };
+
+        for ( unsigned i = 0; i < 1000 and state != RING_READY; ++i )
+        {
+            nanosleep(&ms, nullptr);
+            state = hdr->state.load(std::memory_order_acquire);
+        }
+    }
+
+    if ( state != RING_READY or hdr->magic != SHM_RING_MAGIC or
+        hdr->version != SHM_RING_VERSION or hdr->size != size )
+    {
+        munmap(p, file_size);
+        return nullptr;
+    }
+
+    return new ShmRing(hdr, (uint8_t*)p + DATA_OFFSET, size);
+}
+
+ShmRing::ShmRing(ShmRingHeader* h, uint8_t* d, uint32_t s)
+{
+    hdr = h;
+    data = d;
+    size = s;
+    next = hdr->tail.load(std::memory_order_acquire);
+}
+
+ShmRing::~ShmRing()
+{
+    munmap(hdr, get_file_size(size));
+}
+
+uint8_t* ShmRing::reserve(uint32_t length, uint64_t& pos)
+{
+    const uint64_t span = (sizeof(ShmRecord) + (uint64_t)length + 7) & ~(uint64_t)7;
+
+    if ( length > REC_LENGTH or span > size )
+        return nullptr;
+
+    uint64_t head = hdr->head.load(std::memory_order_relaxed);
+    uint32_t pad;
+
+    do
+    {
+        // a message never wraps; the end of the ring is skipped instead
+        const uint32_t offset = head & (size - 1);
+        pad = (offset + span > size) ? size - offset : 0;
+
+        if ( head + pad + span - hdr->tail.load(std::memory_order_acquire) > size )
+            return nullptr;
+    }
+    while ( !hdr->head.compare_exchange_weak(head, head + pad + span,
+        std::memory_order_acq_rel, std::memory_order_relaxed) );
+
+    if ( pad )
+    {
+        ShmRecord* r = get_record(head);
+        r->span = pad;
+        r->state.store(REC_READY | REC_SKIP, std::memory_order_release);
+        head += pad;
+    }
+
+    ShmRecord* rec = get_record(head);
+    rec->span = span;
+    pos = head;
+
+    return (uint8_t*)(rec + 1);
+}
+
+void ShmRing::commit(uint64_t pos, uint32_t length)
+{
+    ShmRecord* rec = get_record(pos);
+    assert(length <= rec->span - sizeof(ShmRecord));
+
+    rec->state.store(REC_READY | length, std::memory_order_release);
+    wake();
+}
+
+void ShmRing::cancel(uint64_t pos)
+{
+    get_record(pos)->state.store(REC_READY | REC_SKIP, std::memory_order_release);
+    wake();
+}
+
+const uint8_t* ShmRing::read(uint32_t& length, uint64_t& end, bool block, unsigned timeout_ms)
+{
+    while ( true )
+    {
+        ShmRecord* rec = get_record(next);
+        const uint32_t state = rec->state.load(std::memory_order_acquire);
+
+        if ( !(state & REC_READY) )
+        {
+            if ( !block )
+                return nullptr;
+
+            wait(timeout_ms);
+            block = false;
+            continue;
+        }
+
+        next += rec->span;
+
+        if ( state & REC_SKIP )
+        {
+            // nothing read is held so this space can go back now
+            if ( !outstanding )
+            {
+                clear(hdr->tail.load(std::memory_order_relaxed), next);
+                hdr->tail.store(next, std::memory_order_release);
+            }
+            continue;
+        }
+
+        length = state & REC_LENGTH;
+        end = next;
+        ++outstanding;
+
+        return (uint8_t*)(rec + 1);
+    }
+}
+
+void ShmRing::release(uint64_t end)
+{
+    assert(outstanding);
+    --outstanding;
+
+    const uint64_t tail = hdr->tail.load(std::memory_order_relaxed);
+    assert(end > tail and end <= next);
+
+    clear(tail, end);
+    hdr->tail.store(end, std::memory_order_release);
+}
+
+void ShmRing::clear(uint64_t from, uint64_t to)
+{
+    while ( from < to )
+    {
+        const uint32_t offset = from & (size - 1);
+        const uint32_t n = std::min(to - from, (uint64_t)(size - offset));
+
+        memset(data + offset, 0, n);
+        from += n;
+    }
+}
+
+// a commit must be visible before checking for waiters and a waiter must be
+// counted before checking for commits or a wakeup could be lost
+void ShmRing::wake()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if ( !hdr->waiting.load(std::memory_order_relaxed) )
+        return;
+
+    hdr->wakeups.fetch_add(1, std::memory_order_release);
+
+#ifdef __linux__
+    // not FUTEX_PRIVATE_FLAG since the waiter is in another process
+    syscall(SYS_futex, &hdr->wakeups, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+void ShmRing::wait(unsigned timeout_ms)
+{
+    hdr->waiting.fetch_add(1, std::memory_order_seq_cst);
+    const uint32_t seen = hdr->wakeups.load(std::memory_order_seq_cst);
+
+    if ( !(get_record(next)->state.load(std::memory_order_seq_cst) & REC_READY) )
+    {
+#ifdef __linux__
+        struct timespec ts = { (time_t)(timeout_ms / 1000), (long)(timeout_ms % 1000) * 1000000 };
+        syscall(SYS_futex, &hdr->wakeups, FUTEX_WAIT, seen, &ts, nullptr, 0);
+#else
+        const struct timespec ms = { 0, 1000000 };
+
+        for ( unsigned i = 0; i < timeout_ms; ++i )
+        {
+            if ( hdr->wakeups.load(std::memory_order_acquire) != seen )
+                break;
+
+            nanosleep(&ms, nullptr);
+        }
+#endif
+    }
+    hdr->waiting.fetch_sub(1, std::memory_order_relaxed);
+}
+
@@ -0,0 +1,89 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// shm_ring.h
+
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+// ShmRing is a message ring in memory shared between processes.  Any number
+// of producers reserve space for a message, fill it in place, and commit
+// it.  A single consumer reads committed messages in place and releases them
+// in the order read.  Nothing goes through the kernel except the wakeup of a
+// blocked consumer.
+
+#include <cstddef>
+#include <cstdint>
+
+struct ShmRingHeader;
+struct ShmRecord;
+
+class ShmRing
+{
+public:
+    // map a ring of size bytes (a power of 2) onto the file open on fd,
+    // creating it if the file is empty.  returns nullptr if the file holds
+    // a ring of some other size or version.
+    static ShmRing* attach(int fd, uint32_t size);
+
+    // bytes of file needed for a ring of size bytes
+    static size_t get_file_size(uint32_t size);
+
+    ~ShmRing();
+
+    // space for a message of length bytes or nullptr if the ring is full.
+    // pos identifies the message for commit() or cancel().
+    uint8_t* reserve(uint32_t length, uint64_t& pos);
+
+    // publish length bytes, at most the length reserved
+    void commit(uint64_t pos, uint32_t length);
+
+    // give back a reservation; the consumer skips it
+    void cancel(uint64_t pos);
+
+    // next committed message or nullptr if there is none.  if block, wait
+    // up to timeout_ms for one.  end is passed to release().
+    const uint8_t* read(uint32_t& length, uint64_t& end, bool block, unsigned timeout_ms);
+
+    // return the space up to end to producers.  messages must be released
+    // in the order read.
+    void release(uint64_t end);
+
+    uint32_t get_size() const
+    { return size; }
+
+private:
+    ShmRing(ShmRingHeader*, uint8_t* data, uint32_t size);
+
+    ShmRecord* get_record(uint64_t pos) const
+    { return (ShmRecord*)(data + (pos & (size - 1))); }
+
+    void clear(uint64_t from, uint64_t to);
+    void wake();
+    void wait(unsigned timeout_ms);
+
+    ShmRingHeader* hdr;
+    uint8_t* data;
+    uint32_t size;
+
+    uint64_t next = 0;  // consumer's read position
+    unsigned outstanding = 0;  // read but not released
+};
+
+#endif
+
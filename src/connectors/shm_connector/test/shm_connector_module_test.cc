@@ -0,0 +1,150 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// shm_connector_module_test.cc
+// unit test main
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "connectors/shm_connector/shm_connector_module.h"
+#include "profiler/profiler.h"
+
+#include "main/snort_debug.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+THREAD_LOCAL ShmConnectorStats shm_connector_stats;
+THREAD_LOCAL ProfileStats shm_connector_perfstats;
+
+void show_stats(PegCount*, const PegInfo*, unsigned, const char*) { }
+void show_stats(PegCount*, const PegInfo*, IndexVec&, const char*) { }
+void show_stats(PegCount*, const PegInfo*, IndexVec&, const char*, FILE*) { }
+
+void ParseError(const char*, ...) { }
+
+#ifdef DEBUG_MSGS
+void Debug::print(const char*, int, uint64_t, const char*, ...) { }
+#endif
+
+char* snort_strdup(const char* s)
+{ return strdup(s); }
+
+TEST_GROUP(shm_connector_module)
+{
+    void setup()
+    {
+        MemoryLeakWarningPlugin::turnOffNewDeleteOverloads();
+    }
+
+    void teardown()
+    {
+        MemoryLeakWarningPlugin::turnOnNewDeleteOverloads();
+    }
+};
+
+TEST(shm_connector_module, test)
+{
+    Value connector_val("shm-tx");
+    Value name_val("ha");
+    Value direction_val("transmit");
+    Value size_val((double)100000);
+    Value per_thread_val(false);
+    Parameter connector_param =
+        {"connector", Parameter::PT_STRING, nullptr, nullptr, "connector"};
+    Parameter name_param =
+        {"name", Parameter::PT_STRING, nullptr, nullptr, "name"};
+    Parameter direction_param =
+        {"direction", Parameter::PT_ENUM, "receive | transmit", nullptr, "direction"};
+    Parameter size_param =
+        {"size", Parameter::PT_INT, "4096:1073741824", "1048576", "size"};
+    Parameter per_thread_param =
+        {"per_thread", Parameter::PT_BOOL, nullptr, "true", "per_thread"};
+
+    ShmConnectorModule module;
+
+    connector_val.set(&connector_param);
+    name_val.set(&name_param);
+    direction_val.set(&direction_param);
+    CHECK( direction_param.validate(direction_val) == true );
+    size_val.set(&size_param);
+    per_thread_val.set(&per_thread_param);
+
+    module.begin("shm_connector", 0, nullptr);
+    module.begin("shm_connector", 1, nullptr);
+    module.set("shm_connector.connector", connector_val, nullptr);
+    module.set("shm_connector.name", name_val, nullptr);
+    module.set("shm_connector.direction", direction_val, nullptr);
+    module.set("shm_connector.size", size_val, nullptr);
+    module.set("shm_connector.per_thread", per_thread_val, nullptr);
+    CHECK(module.end("shm_connector", 1, nullptr) == true);
+    module.end("shm_connector", 0, nullptr);
+
+    ShmConnectorConfig::ShmConnectorConfigSet* config_set = module.get_and_clear_config();
+
+    CHECK(config_set != nullptr);
+
+    CHECK(config_set->size() == 1);
+
+    ShmConnectorConfig config = *(config_set->front());
+    CHECK(config.connector_name == "shm-tx");
+    CHECK(config.name == "ha");
+    CHECK(config.direction == Connector::CONN_TRANSMIT);
+    CHECK(config.size == 131072);
+    CHECK(config.per_thread == false);
+
+    CHECK(module.get_pegs() != nullptr );
+    CHECK(module.get_counts() != nullptr );
+    CHECK(module.get_profile() != nullptr );
+
+    for ( auto conf : *config_set )
+        delete conf;
+
+    config_set->clear();
+    delete config_set;
+}
+
+TEST(shm_connector_module, test_incomplete)
+{
+    Value connector_val("shm-rx");
+    Parameter connector_param =
+        {"connector", Parameter::PT_STRING, nullptr, nullptr, "connector"};
+
+    ShmConnectorModule module;
+
+    connector_val.set(&connector_param);
+
+    // name and direction are required
+    module.begin("shm_connector", 0, nullptr);
+    module.begin("shm_connector", 1, nullptr);
+    module.set("shm_connector.connector", connector_val, nullptr);
+    CHECK(module.end("shm_connector", 1, nullptr) == false);
+    module.end("shm_connector", 0, nullptr);
+
+    ShmConnectorConfig::ShmConnectorConfigSet* config_set = module.get_and_clear_config();
+    CHECK(config_set->size() == 0);
+    delete config_set;
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
+
@@ -0,0 +1,566 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// shm_connector_test.cc
+// unit test main
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "connectors/shm_connector/shm_connector.h"
+#include "connectors/shm_connector/shm_connector_module.h"
+#include "connectors/shm_connector/shm_ring.h"
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "main/snort_debug.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+extern const BaseApi* shm_connector[];
+static const ConnectorApi* shmc_api = nullptr;
+
+static unsigned s_instance = 0;
+
+void show_stats(PegCount*, const PegInfo*, unsigned, const char*) { }
+void show_stats(PegCount*, const PegInfo*, IndexVec&, const char*) { }
+void show_stats(PegCount*, const PegInfo*, IndexVec&, const char*, FILE*) { }
+
+unsigned get_instance_id()
+{ return s_instance; }
+
+const char* get_error(int)
+{ return ""; }
+
+#ifdef DEBUG_MSGS
+void Debug::print(const char*, int, uint64_t, const char*, ...) { }
+#endif
+void ErrorMessage(const char*, ...) { }
+void LogMessage(const char*, ...) { }
+
+ShmConnectorModule::ShmConnectorModule() :
+    Module("SHMC", "SHMC Help", nullptr)
+{ }
+
+ShmConnectorConfig::ShmConnectorConfigSet* ShmConnectorModule::get_and_clear_config()
+{
+    ShmConnectorConfig::ShmConnectorConfigSet* config_set =
+        new ShmConnectorConfig::ShmConnectorConfigSet;
+
+    return config_set;
+}
+
+ShmConnectorModule::~ShmConnectorModule() { }
+
+ProfileStats* ShmConnectorModule::get_profile() const { return nullptr; }
+
+bool ShmConnectorModule::set(const char*, Value&, SnortConfig*) { return true; }
+bool ShmConnectorModule::begin(const char*, int, SnortConfig*) { return true; }
+bool ShmConnectorModule::end(const char*, int, SnortConfig*) { return true; }
+
+const PegInfo* ShmConnectorModule::get_pegs() const { return nullptr; }
+PegCount* ShmConnectorModule::get_counts() const { return nullptr; }
+
+static std::string ring_path()
+{ return "/tmp/shm_connector_test_" + std::to_string(getpid()); }
+
+static int open_ring_file()
+{ return open(ring_path().c_str(), O_RDWR | O_CREAT, 0600); }
+
+// message i holds i in its first 4 bytes followed by i % 256 repeated
+static uint32_t fill(uint8_t* data, uint32_t i, uint32_t length)
+{
+    memcpy(data, &i, sizeof(i));
+    memset(data + sizeof(i), (int)(i & 0xff), length - sizeof(i));
+    return length;
+}
+
+static bool check(const uint8_t* data, uint32_t i, uint32_t length)
+{
+    uint32_t id;
+    memcpy(&id, data, sizeof(id));
+
+    if ( id != i )
+        return false;
+
+    for ( uint32_t k = sizeof(i); k < length; k++ )
+        if ( data[k] != (uint8_t)i )
+            return false;
+
+    return true;
+}
+
+static uint32_t length_of(uint32_t i)
+{ return 4 + (i * 37) % 300; }
+
+//-------------------------------------------------------------------------
+// ring
+//-------------------------------------------------------------------------
+
+TEST_GROUP(shm_ring)
+{
+    ShmRing* ring = nullptr;
+    int fd = -1;
+
+    void setup()
+    {
+        MemoryLeakWarningPlugin::turnOffNewDeleteOverloads();
+        unlink(ring_path().c_str());
+        fd = open_ring_file();
+        CHECK(fd >= 0);
+        ring = ShmRing::attach(fd, 4096);
+        CHECK(ring != nullptr);
+    }
+
+    void teardown()
+    {
+        delete ring;
+        close(fd);
+        unlink(ring_path().c_str());
+        MemoryLeakWarningPlugin::turnOnNewDeleteOverloads();
+    }
+};
+
+TEST(shm_ring, in_order)
+{
+    uint64_t pos[3];
+
+    for ( uint32_t i = 0; i < 3; i++ )
+    {
+        uint8_t* data = ring->reserve(length_of(i), pos[i]);
+        CHECK(data != nullptr);
+        fill(data, i, length_of(i));
+        ring->commit(pos[i], length_of(i));
+    }
+
+    for ( uint32_t i = 0; i < 3; i++ )
+    {
+        uint32_t length;
+        uint64_t end;
+        const uint8_t* data = ring->read(length, end, false, 0);
+        CHECK(data != nullptr);
+        CHECK(length == length_of(i));
+        CHECK(check(data, i, length));
+        ring->release(end);
+    }
+
+    uint32_t length;
+    uint64_t end;
+    CHECK(ring->read(length, end, false, 0) == nullptr);
+}
+
+TEST(shm_ring, wait_for_commit)
+{
+    uint64_t first, second;
+    uint32_t length;
+    uint64_t end;
+    const uint8_t* msg;
+
+    uint8_t* data = ring->reserve(8, first);
+    fill(data, 1, 8);
+    data = ring->reserve(8, second);
+    fill(data, 2, 8);
+
+    // messages are read in the order reserved
+    ring->commit(second, 8);
+    CHECK(ring->read(length, end, false, 0) == nullptr);
+
+    ring->commit(first, 8);
+    msg = ring->read(length, end, false, 0);
+    CHECK(msg and check(msg, 1, length));
+    ring->release(end);
+    msg = ring->read(length, end, false, 0);
+    CHECK(msg and check(msg, 2, length));
+    ring->release(end);
+}
+
+TEST(shm_ring, cancel_and_shrink)
+{
+    uint64_t pos;
+    uint32_t length;
+    uint64_t end;
+
+    ring->reserve(100, pos);
+    ring->cancel(pos);
+
+    uint8_t* data = ring->reserve(100, pos);
+    fill(data, 7, 10);
+    ring->commit(pos, 10);
+
+    const uint8_t* msg = ring->read(length, end, false, 0);
+    CHECK(msg != nullptr);
+    CHECK(length == 10);
+    CHECK(check(msg, 7, length));
+    ring->release(end);
+}
+
+TEST(shm_ring, full)
+{
+    uint64_t pos;
+    unsigned n = 0;
+
+    while ( uint8_t* data = ring->reserve(100, pos) )
+    {
+        fill(data, n++, 100);
+        ring->commit(pos, 100);
+    }
+    CHECK(n > 30);
+    CHECK(ring->reserve(4096, pos) == nullptr);
+
+    uint32_t length;
+    uint64_t end;
+    CHECK(ring->read(length, end, false, 0) != nullptr);
+    ring->release(end);
+    CHECK(ring->reserve(100, pos) != nullptr);
+    ring->cancel(pos);
+}
+
+TEST(shm_ring, wrap)
+{
+    // odd sizes so messages land everywhere and the end is skipped often
+    uint32_t sent = 0, received = 0;
+
+    while ( received < 5000 )
+    {
+        uint64_t pos;
+
+        while ( sent < 5000 )
+        {
+            uint8_t* data = ring->reserve(length_of(sent), pos);
+
+            if ( !data )
+                break;
+
+            fill(data, sent, length_of(sent));
+            ring->commit(pos, length_of(sent));
+            sent++;
+        }
+
+        uint32_t length;
+        uint64_t end;
+
+        for ( unsigned k = 0; k < 3; k++ )
+        {
+            const uint8_t* data = ring->read(length, end, false, 0);
+
+            if ( !data )
+                break;
+
+            CHECK(length == length_of(received));
+            CHECK(check(data, received, length));
+            ring->release(end);
+            received++;
+        }
+    }
+}
+
+TEST(shm_ring, attach_mismatch)
+{
+    int other = open_ring_file();
+    CHECK(ShmRing::attach(other, 8192) == nullptr);
+
+    // the same size attaches to the same ring
+    ShmRing* peer = ShmRing::attach(other, 4096);
+    CHECK(peer != nullptr);
+    close(other);
+
+    uint64_t pos;
+    fill(peer->reserve(8, pos), 3, 8);
+    peer->commit(pos, 8);
+    delete peer;
+
+    uint32_t length;
+    uint64_t end;
+    const uint8_t* msg = ring->read(length, end, false, 0);
+    CHECK(msg and check(msg, 3, length));
+    ring->release(end);
+}
+
+TEST(shm_ring, block_timeout)
+{
+    uint32_t length;
+    uint64_t end;
+    CHECK(ring->read(length, end, true, 10) == nullptr);
+}
+
+TEST(shm_ring, producers)
+{
+    const unsigned producers = 4;
+    const uint32_t count = 20000;
+    std::vector<std::thread> threads;
+
+    for ( unsigned t = 0; t < producers; t++ )
+        threads.emplace_back([this, t]()
+        {
+            for ( uint32_t i = 0; i < count; )
+            {
+                uint64_t pos;
+                uint8_t* data = ring->reserve(16, pos);
+
+                if ( !data )
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                uint32_t id[4] = { t, i, t ^ i, 0 };
+                memcpy(data, id, sizeof(id));
+                ring->commit(pos, sizeof(id));
+                i++;
+            }
+        });
+
+    // each producer's messages arrive in order
+    std::vector<uint32_t> next(producers, 0);
+    bool ok = true;
+
+    for ( uint32_t n = 0; n < producers * count; )
+    {
+        uint32_t length;
+        uint64_t end;
+        const uint8_t* data = ring->read(length, end, true, 10);
+
+        if ( !data )
+            continue;
+
+        uint32_t id[4];
+        memcpy(id, data, sizeof(id));
+        ring->release(end);
+
+        if ( length != sizeof(id) or id[0] >= producers or id[1] != next[id[0]] or
+            id[2] != (id[0] ^ id[1]) )
+            ok = false;
+        else
+            next[id[0]]++;
+        n++;
+    }
+
+    for ( auto& t : threads )
+        t.join();
+
+    CHECK(ok);
+}
+
+TEST(shm_ring, processes)
+{
+    const uint32_t count = 20000;
+    const std::string path = ring_path();
+    pid_t pid = fork();
+    CHECK(pid >= 0);
+
+    if ( !pid )
+    {
+        // the child maps the ring itself
+        int cfd = open(path.c_str(), O_RDWR);
+        ShmRing* tx = ShmRing::attach(cfd, 4096);
+        close(cfd);
+
+        if ( !tx )
+            _exit(1);
+
+        for ( uint32_t i = 0; i < count; )
+        {
+            uint64_t pos;
+            uint8_t* data = tx->reserve(length_of(i), pos);
+
+            if ( !data )
+            {
+                sched_yield();
+                continue;
+            }
+            fill(data, i, length_of(i));
+            tx->commit(pos, length_of(i));
+            i++;
+        }
+        delete tx;
+        _exit(0);
+    }
+
+    bool ok = true;
+    int status;
+    uint32_t i = 0;
+
+    while ( i < count )
+    {
+        uint32_t length;
+        uint64_t end;
+        const uint8_t* data = ring->read(length, end, true, 100);
+
+        if ( !data )
+        {
+            // don't wait forever if the child gave up
+            if ( waitpid(pid, &status, WNOHANG) == pid )
+                break;
+            continue;
+        }
+
+        if ( length != length_of(i) or !check(data, i, length) )
+            ok = false;
+
+        ring->release(end);
+        i++;
+    }
+
+    if ( i == count )
+        CHECK(waitpid(pid, &status, 0) == pid);
+
+    CHECK(i == count);
+    CHECK(WIFEXITED(status) and WEXITSTATUS(status) == 0);
+    CHECK(ok);
+}
+
+//-------------------------------------------------------------------------
+// connector
+//-------------------------------------------------------------------------
+
+TEST_GROUP(shm_connector)
+{
+    Module* mod = nullptr;
+    ConnectorCommon* connector_common = nullptr;
+    ShmConnectorConfig tx_config;
+    ShmConnectorConfig rx_config;
+
+    void setup()
+    {
+        MemoryLeakWarningPlugin::turnOffNewDeleteOverloads();
+        shmc_api = (const ConnectorApi*)shm_connector[0];
+        s_instance = 1;
+
+        tx_config.connector_name = "shm-tx";
+        tx_config.direction = Connector::CONN_TRANSMIT;
+        tx_config.name = ring_path();
+        tx_config.size = 4096;
+
+        rx_config = tx_config;
+        rx_config.connector_name = "shm-rx";
+        rx_config.direction = Connector::CONN_RECEIVE;
+
+        memset(&shm_connector_stats, 0, sizeof(shm_connector_stats));
+    }
+
+    void teardown()
+    {
+        unlink((ring_path() + "_1").c_str());
+        MemoryLeakWarningPlugin::turnOnNewDeleteOverloads();
+    }
+};
+
+TEST(shm_connector, mod_ctor_dtor)
+{
+    CHECK(shmc_api != nullptr);
+    mod = shmc_api->base.mod_ctor();
+    CHECK(mod != nullptr);
+    connector_common = shmc_api->ctor(mod);
+    CHECK(connector_common != nullptr);
+    shmc_api->dtor(connector_common);
+    shmc_api->base.mod_dtor(mod);
+}
+
+TEST(shm_connector, no_direction)
+{
+    tx_config.direction = Connector::CONN_UNDEFINED;
+    CHECK(shmc_api->tinit(&tx_config) == nullptr);
+}
+
+TEST(shm_connector, transmit_receive)
+{
+    Connector* tx = shmc_api->tinit(&tx_config);
+    Connector* rx = shmc_api->tinit(&rx_config);
+    CHECK(tx != nullptr);
+    CHECK(rx != nullptr);
+    CHECK(tx->get_connector_direction() == Connector::CONN_TRANSMIT);
+    CHECK(rx->get_connector_direction() == Connector::CONN_RECEIVE);
+
+    CHECK(rx->receive_message(false) == nullptr);
+
+    // the sender may use less than it allocated
+    const uint8_t* data;
+    ConnectorMsgHandle* handle = tx->alloc_message(200, &data);
+    ConnectorMsg* msg = tx->get_connector_msg(handle);
+    CHECK(msg->data == data);
+    msg->length = fill(msg->data, 42, 50);
+    CHECK(tx->transmit_message(handle));
+
+    // an allocation can be given back
+    handle = tx->alloc_message(200, &data);
+    tx->discard_message(handle);
+
+    handle = rx->receive_message(true);
+    CHECK(handle != nullptr);
+    msg = rx->get_connector_msg(handle);
+    CHECK(msg->length == 50);
+    CHECK(check(msg->data, 42, msg->length));
+    rx->discard_message(handle);
+
+    CHECK(rx->receive_message(false) == nullptr);
+    CHECK(shm_connector_stats.sent == 1);
+    CHECK(shm_connector_stats.received == 1);
+
+    shmc_api->tterm(tx);
+    shmc_api->tterm(rx);
+}
+
+TEST(shm_connector, full)
+{
+    Connector* tx = shmc_api->tinit(&tx_config);
+    Connector* rx = shmc_api->tinit(&rx_config);
+
+    const uint8_t* data;
+    ConnectorMsgHandle* first = tx->alloc_message(3000, &data);
+    ConnectorMsgHandle* second = tx->alloc_message(3000, &data);
+    CHECK(shm_connector_stats.copied == 1);
+
+    // the copy goes in once there is room
+    fill(tx->get_connector_msg(first)->data, 1, 3000);
+    fill(tx->get_connector_msg(second)->data, 2, 3000);
+    CHECK(tx->transmit_message(first));
+
+    ConnectorMsgHandle* handle = rx->receive_message(false);
+    CHECK(check(rx->get_connector_msg(handle)->data, 1, 3000));
+    rx->discard_message(handle);
+
+    CHECK(tx->transmit_message(second));
+    handle = rx->receive_message(false);
+    CHECK(check(rx->get_connector_msg(handle)->data, 2, 3000));
+    rx->discard_message(handle);
+
+    // and is dropped if there isn't
+    first = tx->alloc_message(3000, &data);
+    second = tx->alloc_message(3000, &data);
+    CHECK(tx->transmit_message(first));
+    CHECK(!tx->transmit_message(second));
+    CHECK(shm_connector_stats.dropped == 1);
+
+    shmc_api->tterm(tx);
+    shmc_api->tterm(rx);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
+
@@ -27,6 +27,7 @@
 #include <netdb.h>
 #include <poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "log/messages.h"
@@ -259,23 +260,48 @@ bool TcpConnector::transmit_message(ConnectorMsgHandle* msg)
 
     TcpConnectorMsgHdr tcpc_hdr(tmsg->connector_msg.length);
 
-    if ( send( sock_fd, (const char*)&tcpc_hdr, sizeof(tcpc_hdr), 0 ) != sizeof(tcpc_hdr) )
-    {
-        ErrorMessage("TcpConnector: failed to transmit header\n");
-        delete tmsg;
-        return false;
-    }
+    // header and body go out in one system call
+    struct iovec iov[2];
+    iov[0].iov_base = &tcpc_hdr;
+    iov[0].iov_len = sizeof(tcpc_hdr);
+    iov[1].iov_base = tmsg->connector_msg.data;
+    iov[1].iov_len = tmsg->connector_msg.length;
 
-    if ( send( sock_fd, (const char*)tmsg->connector_msg.data, tmsg->connector_msg.length, 0 ) !=
-        tmsg->connector_msg.length )
+    struct iovec* next = iov;
+    int count = 2;
+    bool ok = true;
+
+    while ( count )
     {
-        delete tmsg;
-        return false;
+        ssize_t n = writev(sock_fd, next, count);
+
+        if ( n < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+
+            ErrorMessage("TcpConnector: failed to transmit message\n");
+            ok = false;
+            break;
+        }
+
+        // skip what was sent and retry any partial write
+        while ( count and (size_t)n >= next->iov_len )
+        {
+            n -= next->iov_len;
+            ++next;
+            --count;
+        }
+        if ( count )
+        {
+            next->iov_base = (uint8_t*)next->iov_base + n;
+            next->iov_len -= n;
+        }
     }
 
     delete tmsg;
 
-    return true;
+    return ok;
 }
 
 ConnectorMsgHandle* TcpConnector::receive_message(bool)
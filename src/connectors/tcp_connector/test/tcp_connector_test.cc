@@ -29,6 +29,7 @@
 #include <netdb.h>
 #include <sys/poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "main/snort_debug.h"
@@ -60,8 +61,10 @@ static int s_rec_error = 0;
 static int s_rec_error_size = -1;
 static bool s_rec_return_zero = false;
 
-static int s_send_ret_header = sizeof(TcpConnectorMsgHdr);
-static int s_send_ret_other = 0;
+static bool s_writev_error = false;
+static size_t s_writev_limit = 0;  // most bytes written per call, 0 for all
+static size_t s_writev_total = 0;
+static unsigned s_writev_calls = 0;
 
 TcpConnectorConfig connector_config;
 
@@ -85,12 +88,22 @@ void ErrorMessage(const char*, ...) { }
 void LogMessage(const char*, ...) { }
 
 int connect (int, __CONST_SOCKADDR_ARG, socklen_t) { return s_connect_return; }
-ssize_t send (int, const void*, size_t n, int)
+ssize_t writev (int, const struct iovec* iov, int iovcnt)
 {
-    if ( n == sizeof(TcpConnectorMsgHdr) )
-        return s_send_ret_header;
-    else
-        return s_send_ret_other;
+    s_writev_calls++;
+
+    if ( s_writev_error )
+        return -1;
+
+    size_t n = 0;
+    for ( int i = 0; i < iovcnt; i++ )
+        n += iov[i].iov_len;
+
+    if ( s_writev_limit && (n > s_writev_limit) )
+        n = s_writev_limit;
+
+    s_writev_total += n;
+    return n;
 }
 
 int poll (struct pollfd* fds, nfds_t nfds, int)
@@ -153,11 +166,11 @@ static void set_normal_status()
     s_bind_return = 0;
     s_listen_return = 0;
     s_accept_return = 2;
-    s_send_ret_header = sizeof(TcpConnectorMsgHdr);
-    s_send_ret_other = 0;
     s_connect_return = 1;
-    s_send_ret_header = sizeof(TcpConnectorMsgHdr);
-    s_send_ret_other = 0;
+    s_writev_error = false;
+    s_writev_limit = 0;
+    s_writev_total = 0;
+    s_writev_calls = 0;
     s_poll_error = false;
     s_poll_undesirable = false;
     s_poll_data_available = false;
@@ -576,12 +589,13 @@ TEST(tcp_connector_tinit_tterm_call, alloc_transmit)
     TcpConnectorMsgHandle* handle = (TcpConnectorMsgHandle*)(tcpc->alloc_message(40,&data));
     CHECK(data != nullptr);
     CHECK(handle->connector_msg.length == 40);
-    s_send_ret_other = 40;
     CHECK(handle->connector_msg.data == data);
     CHECK(tcpc->transmit_message(handle) == true);
+    CHECK(s_writev_calls == 1);
+    CHECK(s_writev_total == sizeof(TcpConnectorMsgHdr) + 40);
 }
 
-TEST(tcp_connector_tinit_tterm_call, alloc_transmit_header_fail)
+TEST(tcp_connector_tinit_tterm_call, alloc_transmit_fail)
 {
     const uint8_t* data = nullptr;
     TcpConnector* tcpc = (TcpConnector*)connector;
@@ -590,13 +604,12 @@ TEST(tcp_connector_tinit_tterm_call, alloc_transmit_header_fail)
     TcpConnectorMsgHandle* handle = (TcpConnectorMsgHandle*)(tcpc->alloc_message(40,&data));
     CHECK(data != nullptr);
     CHECK(handle->connector_msg.length == 40);
-    s_send_ret_header = sizeof(TcpConnectorMsgHdr)-1;
-    s_send_ret_other = 40;
+    s_writev_error = true;
     CHECK(handle->connector_msg.data == data);
     CHECK(tcpc->transmit_message(handle) == false);
 }
 
-TEST(tcp_connector_tinit_tterm_call, alloc_transmit_body_fail)
+TEST(tcp_connector_tinit_tterm_call, alloc_transmit_partial)
 {
     const uint8_t* data = nullptr;
     TcpConnector* tcpc = (TcpConnector*)connector;
@@ -605,9 +618,11 @@ TEST(tcp_connector_tinit_tterm_call, alloc_transmit_body_fail)
     TcpConnectorMsgHandle* handle = (TcpConnectorMsgHandle*)(tcpc->alloc_message(40,&data));
     CHECK(data != nullptr);
     CHECK(handle->connector_msg.length == 40);
-    s_send_ret_other = 30;
+    s_writev_limit = 7;  // splits the header and the body
     CHECK(handle->connector_msg.data == data);
-    CHECK(tcpc->transmit_message(handle) == false);
+    CHECK(tcpc->transmit_message(handle) == true);
+    CHECK(s_writev_total == sizeof(TcpConnectorMsgHdr) + 40);
+    CHECK(s_writev_calls == (sizeof(TcpConnectorMsgHdr) + 40 + 6) / 7);
 }
 
 TEST(tcp_connector_tinit_tterm_call, alloc_transmit_no_sock)
@@ -35,6 +35,7 @@
 #include "main/snort_debug.h"
 #include "main/thread.h"
 #include "managers/inspector_manager.h"
+#include "memory/memory_domain.h"
 #include "packet_io/active.h"
 #include "parser/parser.h"
 #include "profiler/profiler_defs.h"
@@ -288,6 +289,7 @@ bool DetectionEngine::detect(Packet* p, bool offload_ok)
 {
     assert(p);
     Profile profile(detectPerfStats);
+    memory::DomainContext domain(memory::Domain::DETECTION);
 
     if ( !p->ptrs.ip_api.is_valid() )
         return false;
@@ -35,6 +35,7 @@
 #include <cassert>
 
 #include "log/messages.h"
+#include "main/thread_config.h"
 #include "utils/stats.h"
 #include "utils/util.h"
 
@@ -50,6 +51,8 @@ std::thread* FileCapture::file_storer = nullptr;
 std::queue<FileCapture*> FileCapture::files_waiting;
 bool FileCapture::running = true;
 
+static THREAD_LOCAL FileMemStats mem_counted;
+
 FileCaptureState FileCapture::error_capture(FileCaptureState state)
 {
     file_counts.file_reserve_failures++;
@@ -180,7 +183,7 @@ void FileCapture::init_mempool(int64_t max_file_mem, int64_t block_len)
 
     int max_files = max_file_mem_in_bytes / block_size;
 
-    file_mempool = new FileMemPool(max_files, block_size);
+    file_mempool = new FileMemPool(max_files, block_size, ThreadConfig::get_instance_max());
 }
 
 inline FileCaptureBlock* FileCapture::create_file_buffer()
@@ -540,6 +543,21 @@ void FileCapture::store_file_async()
     capture_cv.notify_one();
 }
 
+void FileCapture::update_mem_counts()
+{
+    if (!file_mempool)
+        return;
+
+    FileMemStats stats;
+    file_mempool->get_thread_stats(stats);
+
+    file_counts.buffer_cache_hits += stats.cache_hits - mem_counted.cache_hits;
+    file_counts.buffer_cache_refills += stats.cache_refills - mem_counted.cache_refills;
+    file_counts.buffer_cache_spills += stats.cache_spills - mem_counted.cache_spills;
+    file_counts.buffer_list_retries += stats.retries - mem_counted.retries;
+    mem_counted = stats;
+}
+
 /*Log file capture mempool usage*/
 void FileCapture::print_mem_usage()
 {
@@ -549,6 +567,13 @@ void FileCapture::print_mem_usage()
         LogCount("Buffers in use", file_mempool->allocated());
         LogCount("Buffers in free list", file_mempool->freed());
         LogCount("Buffers in release list", file_mempool->released());
+
+        FileMemStats stats;
+        file_mempool->get_stats(stats);
+        LogCount("Buffer cache hits", stats.cache_hits);
+        LogCount("Buffer cache refills", stats.cache_refills);
+        LogCount("Buffer cache spills", stats.cache_spills);
+        LogCount("Buffer list contention", stats.retries);
     }
 }
 
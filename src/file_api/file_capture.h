@@ -80,6 +80,9 @@ public:
     // Log file capture mempool usage
     static void print_mem_usage();
 
+    // Add this thread's buffer cache activity since the last call to file_counts
+    static void update_mem_counts();
+
     // Exit file capture, release all file capture memory etc,
     // this must be called when snort exits
     static void exit();
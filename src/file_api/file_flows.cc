@@ -31,6 +31,7 @@
 
 #include "main/snort_config.h"
 #include "managers/inspector_manager.h"
+#include "memory/memory_domain.h"
 #include "protocols/packet.h"
 
 #include "file_cache.h"
@@ -179,6 +180,7 @@ FileContext* FileFlows::get_file_context(uint64_t file_id, bool to_create)
 bool FileFlows::file_process(uint64_t file_id, const uint8_t* file_data,
     int data_size, uint64_t offset, FileDirection dir)
 {
+    memory::DomainContext domain(memory::Domain::FILE);
     int64_t file_depth = FileService::get_max_file_depth();
 
     if ((file_depth < 0)or (offset > (uint64_t)file_depth))
@@ -222,6 +224,7 @@ bool FileFlows::file_process(uint64_t file_id, const uint8_t* file_data,
 bool FileFlows::file_process(const uint8_t* file_data, int data_size,
     FilePosition position, bool upload, size_t file_index)
 {
+    memory::DomainContext domain(memory::Domain::FILE);
     FileContext* context;
     FileDirection direction = upload ? FILE_UPLOAD : FILE_DOWNLOAD;
     /* if both disabled, return immediately*/
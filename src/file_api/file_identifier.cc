@@ -71,16 +71,24 @@ void FileIdentifier::init_merge_hash()
 }
 
 FileIdentifier::~FileIdentifier()
+{
+    release_trie();
+}
+
+void FileIdentifier::release_trie()
 {
     /*Release memory used for identifiers*/
     for (auto mem_block:id_memory_blocks)
     {
         snort_free(mem_block);
     }
+    id_memory_blocks.clear();
+    identifier_root = nullptr;
 
     if (identifier_merge_hash != nullptr)
     {
         ghash_delete(identifier_merge_hash);
+        identifier_merge_hash = nullptr;
     }
 }
 
@@ -284,6 +292,9 @@ void FileIdentifier::insert_file_rule(FileMagicRule& rule)
 {
     IdentifierNode* node;
 
+    /*Rules can't be added once the trie is compiled*/
+    assert(states.empty());
+
     if (!identifier_root)
     {
         identifier_root = (IdentifierNode*)calloc_mem(sizeof(*identifier_root));
@@ -323,10 +334,13 @@ uint32_t FileIdentifier::find_file_type_id(const uint8_t* buf, int len, uint64_t
     if ( !buf || len <= 0 )
         return SNORT_FILE_TYPE_CONTINUE;
 
-    if (!(*context))
-        *context = (void*)(identifier_root);
+    /*Only the compiled trie is searched*/
+    assert(!identifier_root);
 
-    IdentifierNode* current = (IdentifierNode*)(*context);
+    if (!(*context) and states.size() > 1)
+        *context = (void*)(&states[1]);
+
+    const IdentifierState* current = (const IdentifierState*)(*context);
 
     uint64_t end = file_offset + len;
 
@@ -341,7 +355,7 @@ uint32_t FileIdentifier::find_file_type_id(const uint8_t* buf, int len, uint64_t
         if ( current->offset >= end )
         {
             /* Save current state */
-            *context = current;
+            *context = (void*)current;
             if (file_type_id)
                 return file_type_id;
             else
@@ -349,7 +363,9 @@ uint32_t FileIdentifier::find_file_type_id(const uint8_t* buf, int len, uint64_t
         }
 
         /*Move to the next level*/
-        current = current->next[buf[current->offset - file_offset ]];
+        uint8_t c = buf[current->offset - file_offset];
+        uint32_t next = branches[current->first_branch + current->index.find(c)];
+        current = next ? &states[next] : nullptr;
     }
 
     /*Either end of magics or passed the current offset*/
@@ -361,6 +377,88 @@ uint32_t FileIdentifier::find_file_type_id(const uint8_t* buf, int len, uint64_t
     return file_type_id;
 }
 
+/*
+ * Convert a build node to a compiled state. Children that have not been
+ * numbered yet are appended to order, so walking order numbers the trie
+ * breadth first and shared nodes keep a single state.
+ */
+void FileIdentifier::compile_node(const IdentifierNode* node, IdentifierState& state,
+    std::unordered_map<const IdentifierNode*, uint32_t>& numbers,
+    std::vector<const IdentifierNode*>& order)
+{
+    auto number = [&](const IdentifierNode* n) -> uint32_t
+    {
+        if (!n)
+            return 0;
+
+        auto it = numbers.find(n);
+        if (it != numbers.end())
+            return it->second;
+
+        order.push_back(n);
+        return numbers[n] = order.size();
+    };
+
+    /* The most common branch becomes the default. It is null unless the
+     * node was inserted for an offset gap, which branches to the same
+     * node on every byte. */
+    std::unordered_map<const IdentifierNode*, unsigned> counts;
+    const IdentifierNode* other = nullptr;
+    unsigned most = 0;
+
+    for (unsigned i = 0; i < MAX_BRANCH; i++)
+    {
+        unsigned n = ++counts[node->next[i]];
+        if (n > most)
+        {
+            most = n;
+            other = node->next[i];
+        }
+    }
+
+    state.type_id = node->type_id;
+    state.offset = node->offset;
+    state.first_branch = branches.size();
+    branches.push_back(number(other));
+
+    for (unsigned i = 0; i < MAX_BRANCH; i++)
+    {
+        if (node->next[i] == other)
+            continue;
+
+        unsigned slot = state.index.add(i);
+        assert(slot == branches.size() - state.first_branch);
+        UNUSED(slot);
+        branches.push_back(number(node->next[i]));
+    }
+}
+
+void FileIdentifier::compile()
+{
+    if (!identifier_root)
+        return;
+
+    std::unordered_map<const IdentifierNode*, uint32_t> numbers;
+    std::vector<const IdentifierNode*> order;
+
+    order.push_back(identifier_root);
+    numbers[identifier_root] = 1;
+    states.emplace_back();
+
+    for (unsigned i = 0; i < order.size(); i++)
+    {
+        IdentifierState state;
+        compile_node(order[i], state, numbers, order);
+        states.push_back(state);
+    }
+
+    states.shrink_to_fit();
+    branches.shrink_to_fit();
+    release_trie();
+
+    memory_used = states.size() * sizeof(IdentifierState) + branches.size() * sizeof(uint32_t);
+}
+
 FileMagicRule* FileIdentifier::get_rule_from_id(uint32_t id)
 {
     if ((id < FILE_ID_MAX) && (file_magic_rules[id].id > 0))
@@ -399,6 +497,7 @@ TEST_CASE ("FileIdRulePDF", "[FileMagic]")
     FileIdentifier rc;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "PDF";
 
@@ -423,6 +522,7 @@ TEST_CASE ("FileIdRuleUnknow", "[FileMagic]")
     FileIdentifier rc;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "DDF";
 
@@ -458,6 +558,7 @@ TEST_CASE ("FileIdRuleEXE", "[FileMagic]")
     rule.id = 3;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "PDFooo";
     void* context = nullptr;
@@ -491,6 +592,7 @@ TEST_CASE ("FileIdRulePDFEXE", "[FileMagic]")
     rule.id = 3;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "PDFEXE";
     void* context = nullptr;
@@ -525,11 +627,135 @@ TEST_CASE ("FileIdRuleFirst", "[FileMagic]")
     rule.id = 3;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "PDF";
     void* context = nullptr;
 
     CHECK(rc.find_file_type_id((const uint8_t*)data, strlen(data), 0, &context) == 1);
 }
+
+TEST_CASE ("FileIdRuleGap", "[FileMagic]")
+{
+    FileMagicData magic;
+
+    magic.content = "PDF";
+    magic.offset = 0;
+
+    FileMagicRule rule;
+
+    rule.type = "pdf";
+    rule.file_magics.push_back(magic);
+    rule.id = 1;
+
+    FileIdentifier rc;
+    rc.insert_file_rule(rule);
+
+    magic.clear();
+    magic.content = "EXE";
+    magic.offset = 5;
+
+    rule.clear();
+    rule.type = "exe";
+    rule.file_magics.push_back(magic);
+    rule.id = 3;
+
+    rc.insert_file_rule(rule);
+    rc.compile();
+
+    void* context = nullptr;
+    const char* data = "PDFooEXE";
+    CHECK((rc.find_file_type_id((const uint8_t*)data, strlen(data), 0, &context) == 3));
+
+    context = nullptr;
+    data = "ABCDEEXE";
+    CHECK((rc.find_file_type_id((const uint8_t*)data, strlen(data), 0, &context) == 3));
+
+    context = nullptr;
+    data = "PDFooABC";
+    CHECK((rc.find_file_type_id((const uint8_t*)data, strlen(data), 0, &context) == 1));
+}
+
+TEST_CASE ("FileIdRuleContinue", "[FileMagic]")
+{
+    FileMagicData magic;
+
+    magic.content = "PDF";
+    magic.offset = 0;
+
+    FileMagicRule rule;
+
+    rule.type = "pdf";
+    rule.file_magics.push_back(magic);
+    rule.id = 1;
+
+    FileIdentifier rc;
+    rc.insert_file_rule(rule);
+    rc.compile();
+
+    void* context = nullptr;
+    const char* data = "PDF";
+
+    CHECK((rc.find_file_type_id((const uint8_t*)data, 2, 0, &context) ==
+        SNORT_FILE_TYPE_CONTINUE));
+    CHECK(context != nullptr);
+    CHECK(rc.find_file_type_id((const uint8_t*)data + 2, 1, 2, &context) == 1);
+}
+
+// Rules resembling the default file magic: a few hundred short magics at
+// offset 0 sharing common prefixes, plus some at a fixed offset
+static void insert_test_rules(FileIdentifier& rc)
+{
+    srand(1);
+
+    for (uint32_t id = 1; id <= 300; id++)
+    {
+        FileMagicData magic;
+        magic.offset = (id % 10) ? 0 : 8 + rand() % 256;
+
+        unsigned len = 2 + rand() % 6;
+        for (unsigned i = 0; i < len; i++)
+            magic.content += (char)(i < 2 ? 'A' + rand() % 4 : rand());
+
+        FileMagicRule rule;
+        rule.id = id;
+        rule.file_magics.push_back(magic);
+        rc.insert_file_rule(rule);
+    }
+}
+
+TEST_CASE ("FileIdCompiledMemory", "[FileMagic][!benchmark]")
+{
+    FileIdentifier rc;
+    insert_test_rules(rc);
+
+    uint32_t trie_memory = rc.memory_usage();
+    rc.compile();
+    uint32_t compiled_memory = rc.memory_usage();
+
+    WARN("file magic trie " << trie_memory << " bytes, compiled " << compiled_memory << " bytes");
+    CHECK(compiled_memory * 10 < trie_memory);
+
+    std::vector<uint8_t> data(1460 * 64);
+    for (auto& b : data)
+        b = 'A' + rand() % 4;
+
+    unsigned found = 0;
+
+    BENCHMARK("identify 64 file starts")
+    {
+        for (int n = 0; n < 100; n++)
+        {
+            for (unsigned off = 0; off < data.size(); off += 1460)
+            {
+                void* context = nullptr;
+                if (rc.find_file_type_id(&data[off], 1460, 0, &context) !=
+                    SNORT_FILE_TYPE_UNKNOWN)
+                    found++;
+            }
+        }
+    }
+    CHECK(found > 0);
+}
 #endif
 
@@ -25,11 +25,18 @@
 // File type identification is based on file magic. To improve the detection
 // performance, a trie is created to scan file data once. Currently, only the
 // most specific file type is returned.
+//
+// Rules are merged into a trie of IdentifierNodes that has a full branch
+// array per node. Once all rules are in, compile() converts it into a flat
+// array of IdentifierStates which only hold the branches that differ from
+// the node's default and the build trie is released.
 
 #include <list>
+#include <unordered_map>
 #include <vector>
 
 #include "hash/ghash.h"
+#include "utils/byte_index.h"
 
 #include "file_lib.h"
 
@@ -81,6 +88,18 @@ struct IdentifierNode
     struct IdentifierNode* next[MAX_BRANCH]; /* pointer to an array of 256 identifiers pointers*/
 };
 
+// Branches of a compiled state are kept in FileIdentifier::branches starting at
+// first_branch. The first entry is the default for bytes not in the index;
+// it is set where an offset gap allows any byte. Entries are state numbers,
+// with 0 meaning no branch.
+struct IdentifierState
+{
+    ByteIndex index;
+    uint32_t type_id;
+    uint32_t offset;
+    uint32_t first_branch;
+};
+
 typedef std::list<void* >  IDMemoryBlocks;
 
 class FileIdentifier
@@ -89,11 +108,16 @@ public:
     ~FileIdentifier();
     uint32_t memory_usage() { return memory_used; }
     void insert_file_rule(FileMagicRule& rule);
+    void compile();
     uint32_t find_file_type_id(const uint8_t* buf, int len, uint64_t offset, void** context);
     FileMagicRule* get_rule_from_id(uint32_t);
 
 private:
     void init_merge_hash();
+    void release_trie();
+    void compile_node(const IdentifierNode*, IdentifierState&,
+        std::unordered_map<const IdentifierNode*, uint32_t>&,
+        std::vector<const IdentifierNode*>&);
     void* calloc_mem(size_t size);
     void set_node_state_shared(IdentifierNode* start);
     IdentifierNode* clone_node(IdentifierNode* start);
@@ -107,6 +131,8 @@ private:
     GHash* identifier_merge_hash = nullptr;
     FileMagicRule file_magic_rules[FILE_ID_MAX + 1];
     IDMemoryBlocks id_memory_blocks;
+    std::vector<IdentifierState> states;  // states[0] is unused so 0 means none
+    std::vector<uint32_t> branches;
 };
 
 #endif
@@ -29,8 +29,6 @@
 
 #include "file_lib.h"
 
-#include <openssl/sha.h>
-
 #include <iostream>
 #include <iomanip>
 
@@ -250,7 +248,6 @@ FileCaptureState FileInfo::reserve_file(FileCapture*& dest)
 FileContext::FileContext ()
 {
     file_type_context = nullptr;
-    file_signature_context = nullptr;
     file_capture = nullptr;
     file_segments = nullptr;
     inspector = (FileInspect*)InspectorManager::acquire(FILE_ID_NAME, true);
@@ -259,8 +256,6 @@ FileContext::FileContext ()
 
 FileContext::~FileContext ()
 {
-    if (file_signature_context)
-        snort_free(file_signature_context);
     if (file_capture)
         stop_file_capture();
     if (file_segments)
@@ -365,7 +360,7 @@ void FileContext::finish_signature_lookup(Flow* flow, bool final_lookup, FilePol
         }
         else
         {
-            snort_free(sha256);
+            delete[] sha256;
             sha256 = nullptr;
         }
     }
@@ -377,7 +372,7 @@ void FileContext::set_signature_state(bool gen_sig)
     {
         if ( sha256 )
         {
-            snort_free(sha256);
+            delete[] sha256;
             sha256 = nullptr;
         }
 
@@ -543,54 +538,44 @@ void FileContext::process_file_signature_sha256(const uint8_t* file_data, int si
     switch (position)
     {
     case SNORT_FILE_START:
-        if (!file_signature_context)
-            file_signature_context = snort_calloc(sizeof(SHA256_CTX));
-        SHA256_Init((SHA256_CTX*)file_signature_context);
-        SHA256_Update((SHA256_CTX*)file_signature_context, file_data, data_size);
+        file_signature_context.init();
+        file_signature_started = true;
+        file_signature_context.update(file_data, data_size);
         if (file_state.sig_state == FILE_SIG_FLUSH)
         {
-            static uint8_t file_signature_context_backup[sizeof(SHA256_CTX)];
-            sha256 = (uint8_t*)snort_alloc(SHA256_HASH_SIZE);
-            memcpy(file_signature_context_backup, file_signature_context, sizeof(SHA256_CTX));
-
-            SHA256_Final(sha256, (SHA256_CTX*)file_signature_context);
-            memcpy(file_signature_context, file_signature_context_backup, sizeof(SHA256_CTX));
+            sha256 = new uint8_t[SHA256_HASH_SIZE];
+            file_signature_context.final(sha256);
         }
         break;
 
     case SNORT_FILE_MIDDLE:
-        if (!file_signature_context)
+        if (!file_signature_started)
             return;
-        SHA256_Update((SHA256_CTX*)file_signature_context, file_data, data_size);
+        file_signature_context.update(file_data, data_size);
         if (file_state.sig_state == FILE_SIG_FLUSH)
         {
-            static uint8_t file_signature_context_backup[sizeof(SHA256_CTX)];
             if ( !sha256 )
-                sha256 = (uint8_t*)snort_alloc(SHA256_HASH_SIZE);
-            memcpy(file_signature_context_backup, file_signature_context, sizeof(SHA256_CTX));
-
-            SHA256_Final(sha256, (SHA256_CTX*)file_signature_context);
-            memcpy(file_signature_context, file_signature_context_backup, sizeof(SHA256_CTX));
+                sha256 = new uint8_t[SHA256_HASH_SIZE];
+            file_signature_context.final(sha256);
         }
 
         break;
 
     case SNORT_FILE_END:
-        if (!file_signature_context)
+        if (!file_signature_started)
             return;
-        SHA256_Update((SHA256_CTX*)file_signature_context, file_data, data_size);
+        file_signature_context.update(file_data, data_size);
         sha256 = new uint8_t[SHA256_HASH_SIZE];
-        SHA256_Final(sha256, (SHA256_CTX*)file_signature_context);
+        file_signature_context.final(sha256);
         file_state.sig_state = FILE_SIG_DONE;
         break;
 
     case SNORT_FILE_FULL:
-        if (!file_signature_context)
-            file_signature_context = snort_calloc(sizeof (SHA256_CTX));
-        SHA256_Init((SHA256_CTX*)file_signature_context);
-        SHA256_Update((SHA256_CTX*)file_signature_context, file_data, data_size);
+        file_signature_context.init();
+        file_signature_started = true;
+        file_signature_context.update(file_data, data_size);
         sha256 = new uint8_t[SHA256_HASH_SIZE];
-        SHA256_Final(sha256, (SHA256_CTX*)file_signature_context);
+        file_signature_context.final(sha256);
         file_state.sig_state = FILE_SIG_DONE;
         break;
 
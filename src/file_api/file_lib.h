@@ -28,6 +28,7 @@
 #include <string>
 
 #include "file_api/file_api.h"
+#include "file_api/file_sha256.h"
 #include "utils/util.h"
 
 #define SNORT_FILE_TYPE_UNKNOWN          UINT16_MAX
@@ -131,7 +132,8 @@ public:
 private:
     uint64_t processed_bytes = 0;
     void* file_type_context;
-    void* file_signature_context;
+    FileSha256 file_signature_context;
+    bool file_signature_started = false;
     FileSegments* file_segments;
     FileInspect* inspector;
     FileConfig*  config;
@@ -32,6 +32,7 @@
 #include "file_mempool.h"
 
 #include "log/messages.h"
+#include "main/thread.h"
 #include "utils/util.h"
 
 /*This magic is used for double free detection*/
@@ -39,29 +40,24 @@
 #define FREE_MAGIC    0x2525252525252525
 typedef uint64_t MagicType;
 
+// Caches take and return half their size at a time so a thread that
+// alternates between allocating and freeing doesn't go back and forth to
+// the shared lists.
+#define FILE_MEM_BATCH (FILE_MEM_CACHE_SIZE / 2)
+
+static inline void bump(std::atomic<uint64_t>& count)
+{
+    // only the owning thread writes, so no locked add is needed
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
 #ifdef DEBUG_MSGS
 void FileMemPool::verify()
 {
-    uint64_t free_size;
-    uint64_t release_size;
-
-    free_size = cbuffer_used(free_list);
-    release_size = cbuffer_used(released_list);
-
-    if (free_size > cbuffer_size(free_list))
-    {
-        DebugMessage(DEBUG_FILE, "file_mempool: failed to verify free list!\n");
-    }
-
-    if (release_size > cbuffer_size(released_list))
-    {
-        DebugMessage(DEBUG_FILE, "file_mempool: failed to verify release list!\n");
-    }
-
     /* The free mempool and size of release mempool should be smaller than
      * or equal to the size of mempool
      */
-    if (free_size + release_size > total)
+    if (freed() + released() > total)
     {
         DebugMessage(DEBUG_FILE, "file_mempool: failed to verify mempool size!\n");
     }
@@ -69,77 +65,146 @@ void FileMemPool::verify()
 
 #endif
 
-void FileMemPool::free_pools()
-{
-    if (datapool != nullptr)
-    {
-        snort_free(datapool);
-        datapool = nullptr;
-    }
-
-    cbuffer_free(free_list);
-    cbuffer_free(released_list);
-}
-
 /*
  * Purpose: initialize a FileMemPool object and allocate memory for it
  * Args:
  *   num_objects - number of items in this pool
  *   obj_size    - size of the items
+ *   caches      - number of packet threads with a private cache
  */
 
-FileMemPool::FileMemPool(uint64_t num_objects, size_t o_size)
+FileMemPool::FileMemPool(uint64_t num_objects, size_t o_size, unsigned n_caches)
 {
-    unsigned int i;
-
-    if ((num_objects < 1) || (o_size < 1))
+    if ((num_objects < 1) || (o_size < sizeof(MagicType)) || (num_objects >= UINT32_MAX))
         return;
 
     obj_size = o_size;
 
     // this is the basis pool that represents all the *data pointers in the list
     datapool = (void**)snort_calloc(num_objects, obj_size);
+    links = new std::atomic<uint32_t>[num_objects];
 
-    /* sets up the memory list */
-    free_list = cbuffer_init(num_objects);
-    if (!free_list)
+    // everything starts out on the free list in order
+    for (uint64_t i = 0; i < num_objects; i++)
     {
-        DebugMessage(DEBUG_FILE, "file_mempool: Failed to init free list\n");
-        free_pools();
-        return;
+        *(MagicType*)object(i) = FREE_MAGIC;
+        links[i].store((i + 1 < num_objects) ? i + 2 : 0, std::memory_order_relaxed);
     }
+    total = num_objects;
+    free_count.store(num_objects);
+    free_head.store(1);
 
-    released_list = cbuffer_init(num_objects);
-    if (!released_list)
+    // objects sitting in other threads' caches can't be allocated so caches
+    // are only used when they can hold a small part of the pool
+    if ( n_caches and num_objects >= (uint64_t)n_caches * FILE_MEM_CACHE_SIZE * 4 )
     {
-        DebugMessage(DEBUG_FILE, "file_mempool: Failed to init release list\n");
-        free_pools();
-        return;
+        caches = new Cache[n_caches]();
+        num_caches = n_caches;
     }
+}
 
-    total = 0;
-    for (i=0; i<num_objects; i++)
+/*
+ * Destroy a set of FileMemPool objects
+ *
+ */
+FileMemPool::~FileMemPool()
+{
+    if (datapool != nullptr)
+        snort_free(datapool);
+
+    delete[] links;
+    delete[] caches;
+}
+
+FileMemPool::Cache* FileMemPool::get_cache()
+{
+    if ( !num_caches or !is_packet_thread() )
+        return nullptr;
+
+    unsigned id = get_instance_id();
+    return (id < num_caches) ? caches + id : nullptr;
+}
+
+void FileMemPool::count_retry()
+{
+    retries.fetch_add(1, std::memory_order_relaxed);
+
+    if ( Cache* c = get_cache() )
+        bump(c->retries);
+}
+
+// Push the chain first .. last, which must already be linked together
+void FileMemPool::push(std::atomic<uint64_t>& head, uint32_t first, uint32_t last)
+{
+    uint64_t old = head.load(std::memory_order_relaxed);
+    links[last].store((uint32_t)old, std::memory_order_relaxed);
+
+    while ( !head.compare_exchange_weak(old, (((old >> 32) + 1) << 32) | (first + 1),
+        std::memory_order_release, std::memory_order_relaxed) )
     {
-        void* data = ((char*)datapool) + (i * obj_size);
+        links[last].store((uint32_t)old, std::memory_order_relaxed);
+        count_retry();
+    }
+}
+
+// Pop up to max objects.  The links walked may be changing underneath if
+// another thread gets in first, but then the head has changed too and the
+// exchange fails, so a successful exchange means the chain taken was intact.
+unsigned FileMemPool::pop(std::atomic<uint64_t>& head, uint32_t* out, unsigned max)
+{
+    uint64_t old = head.load(std::memory_order_acquire);
 
-        if (cbuffer_write(free_list,  data))
+    while ( true )
+    {
+        uint32_t next = (uint32_t)old;
+        unsigned n = 0;
+
+        while ( next and n < max )
         {
-            DebugMessage(DEBUG_FILE, "file_mempool: Failed to add to free list\n");
-            free_pools();
-            return;
+            out[n++] = next - 1;
+            next = links[next - 1].load(std::memory_order_relaxed);
         }
-        *(MagicType*)data = FREE_MAGIC;
-        total++;
+
+        if ( !n )
+            return 0;
+
+        uint64_t top = (((old >> 32) + 1) << 32) | next;
+
+        if ( head.compare_exchange_weak(old, top, std::memory_order_acquire,
+            std::memory_order_acquire) )
+            return n;
+
+        count_retry();
     }
 }
 
-/*
- * Destroy a set of FileMemPool objects
- *
- */
-FileMemPool::~FileMemPool()
+// Free objects are used before released ones, as before
+unsigned FileMemPool::refill(uint32_t* out, unsigned max)
+{
+    unsigned n = pop(free_head, out, max);
+
+    if ( n )
+        free_count.fetch_sub(n, std::memory_order_relaxed);
+
+    else if ( (n = pop(released_head, out, max)) )
+        released_count.fetch_sub(n, std::memory_order_relaxed);
+
+    return n;
+}
+
+// Return the newest half of a full cache to the free list as one chain
+void FileMemPool::spill(Cache* c)
 {
-    free_pools();
+    uint32_t* items = c->items + FILE_MEM_CACHE_SIZE - FILE_MEM_BATCH;
+
+    for ( unsigned i = 0; i + 1 < FILE_MEM_BATCH; ++i )
+        links[items[i]].store(items[i + 1] + 1, std::memory_order_relaxed);
+
+    free_count.fetch_add(FILE_MEM_BATCH, std::memory_order_relaxed);
+    push(free_head, items[0], items[FILE_MEM_BATCH - 1]);
+
+    c->count.store(FILE_MEM_CACHE_SIZE - FILE_MEM_BATCH, std::memory_order_relaxed);
+    bump(c->spills);
 }
 
 /*
@@ -153,42 +218,71 @@ FileMemPool::~FileMemPool()
 
 void* FileMemPool::m_alloc()
 {
-    void* b = nullptr;
+    if (datapool == nullptr)
+        return nullptr;
 
-    std::lock_guard<std::mutex> lock(pool_mutex);
+    Cache* c = get_cache();
+    uint32_t index;
 
-    if (cbuffer_read(free_list, &b))
+    if ( c )
     {
-        if (cbuffer_read(released_list, &b))
+        uint32_t n = c->count.load(std::memory_order_relaxed);
+
+        if ( n )
+            bump(c->hits);
+
+        else
         {
-            return nullptr;
+            n = refill(c->items, FILE_MEM_BATCH);
+
+            if ( !n )
+                return nullptr;
+
+            bump(c->refills);
         }
+        index = c->items[--n];
+        c->count.store(n, std::memory_order_relaxed);
     }
+    else if ( !refill(&index, 1) )
+        return nullptr;
+
+    void* b = object(index);
 
     if (*(MagicType*)b != FREE_MAGIC)
     {
         DebugMessage(DEBUG_FILE, "file_mempool_alloc(): Allocation errors!\n");
     }
 
+    // so freeing it before it is written is not taken for a double free
+    *(MagicType*)b = 0;
+
     DEBUG_WRAP(verify(); );
 
     return b;
 }
 
+bool FileMemPool::get_index(void* obj, uint32_t& index)
+{
+    if ( (obj == nullptr) or (datapool == nullptr) or (obj < (void*)datapool) )
+        return false;
+
+    uint64_t offset = (char*)obj - (char*)datapool;
+
+    if ( (offset % obj_size) or (offset / obj_size >= total) )
+        return false;
+
+    index = offset / obj_size;
+    return true;
+}
+
 /*
- * Free a new object from the buffer
- * We use circular buffer to synchronize one reader and one writer
+ * Mark an object free before it goes on a list
  */
-int FileMemPool::remove(CircularBuffer* cb, void* obj)
+int FileMemPool::remove(void* obj, uint32_t& index)
 {
-    if (obj == nullptr)
+    if ( !get_index(obj, index) )
         return FILE_MEM_FAIL;
 
-    if (cbuffer_write(cb, obj))
-    {
-        return FILE_MEM_FAIL;
-    }
-
     if (*(MagicType*)obj == FREE_MAGIC)
     {
         DebugMessage(DEBUG_FILE, "file_mempool_remove(): Double free!\n");
@@ -202,13 +296,29 @@ int FileMemPool::remove(CircularBuffer* cb, void* obj)
 
 int FileMemPool::m_free(void* obj)
 {
-    std::lock_guard<std::mutex> lock(pool_mutex);
+    uint32_t index;
+
+    if ( remove(obj, index) )
+        return FILE_MEM_FAIL;
 
-    int ret = remove(free_list, obj);
+    if ( Cache* c = get_cache() )
+    {
+        if ( c->count.load(std::memory_order_relaxed) == FILE_MEM_CACHE_SIZE )
+            spill(c);
+
+        uint32_t n = c->count.load(std::memory_order_relaxed);
+        c->items[n] = index;
+        c->count.store(n + 1, std::memory_order_relaxed);
+    }
+    else
+    {
+        free_count.fetch_add(1, std::memory_order_relaxed);
+        push(free_head, index, index);
+    }
 
     DEBUG_WRAP(verify(); );
 
-    return ret;
+    return FILE_MEM_SUCCESS;
 }
 
 /*
@@ -220,32 +330,69 @@ int FileMemPool::m_free(void* obj)
 
 int FileMemPool::m_release(void* obj)
 {
-    std::lock_guard<std::mutex> lock(pool_mutex);
+    uint32_t index;
 
     /*A writer that might from different thread*/
-    int ret = remove(released_list, obj);
+    if ( remove(obj, index) )
+        return FILE_MEM_FAIL;
+
+    released_count.fetch_add(1, std::memory_order_relaxed);
+    push(released_head, index, index);
 
     DEBUG_WRAP(verify(); );
 
-    return ret;
+    return FILE_MEM_SUCCESS;
 }
 
 /* Returns number of elements allocated in current buffer*/
 uint64_t FileMemPool::allocated()
 {
+    // the counts are read one at a time while others may be moving objects
+    // between lists so the sum can briefly run over
     uint64_t total_freed = released() + freed();
-    return (total - total_freed);
+    return (total_freed < total) ? (total - total_freed) : 0;
 }
 
 /* Returns number of elements freed in current buffer*/
 uint64_t FileMemPool::freed()
 {
-    return (cbuffer_used(free_list));
+    uint64_t n = free_count.load(std::memory_order_relaxed);
+
+    for ( unsigned i = 0; i < num_caches; ++i )
+        n += caches[i].count.load(std::memory_order_relaxed);
+
+    return n;
 }
 
 /* Returns number of elements released in current buffer*/
 uint64_t FileMemPool::released()
 {
-    return (cbuffer_used(released_list));
+    return released_count.load(std::memory_order_relaxed);
+}
+
+void FileMemPool::get_stats(FileMemStats& stats)
+{
+    stats = { };
+
+    for ( unsigned i = 0; i < num_caches; ++i )
+    {
+        stats.cache_hits += caches[i].hits.load(std::memory_order_relaxed);
+        stats.cache_refills += caches[i].refills.load(std::memory_order_relaxed);
+        stats.cache_spills += caches[i].spills.load(std::memory_order_relaxed);
+    }
+    stats.retries = retries.load(std::memory_order_relaxed);
+}
+
+void FileMemPool::get_thread_stats(FileMemStats& stats)
+{
+    stats = { };
+
+    if ( Cache* c = get_cache() )
+    {
+        stats.cache_hits = c->hits.load(std::memory_order_relaxed);
+        stats.cache_refills = c->refills.load(std::memory_order_relaxed);
+        stats.cache_spills = c->spills.load(std::memory_order_relaxed);
+        stats.retries = c->retries.load(std::memory_order_relaxed);
+    }
 }
 
@@ -23,25 +23,36 @@
 #define FILE_MEMPOOL_H
 
 //  This mempool implementation has very efficient alloc/free operations.
-//  In addition, it provides thread-safe alloc/free for one allocation/free
-//  thread and one release thread.
+//  Objects are handed out from a small cache private to each packet thread
+//  which is refilled from and spilled to a shared free list in batches.  The
+//  shared lists are lock free stacks so any number of packet threads can
+//  allocate and free, and any thread (eg the file writer) can release.
 //  One more bonus: Double free detection is also added into this library
-//  This is a thread safe version of memory pool for one writer and one reader thread
 
-#include <mutex>
+#include <atomic>
 
 #include "main/snort_debug.h"
 
-#include "circular_buffer.h"
-
 #define FILE_MEM_SUCCESS    0  // FIXIT-L use bool
 #define FILE_MEM_FAIL      (-1)
 
+#define FILE_MEM_CACHE_SIZE 32  // objects held by each thread cache
+
+struct FileMemStats
+{
+    uint64_t cache_hits;     // allocations served by a thread cache
+    uint64_t cache_refills;  // batches taken from the shared lists
+    uint64_t cache_spills;   // batches returned to the shared free list
+    uint64_t retries;        // compare and swap failures on the shared lists
+};
+
 class FileMemPool
 {
 public:
 
-    FileMemPool(uint64_t num_objects, size_t obj_size);
+    // caches is the number of packet threads that get a private cache, by
+    // instance id; other threads use the shared lists directly
+    FileMemPool(uint64_t num_objects, size_t obj_size, unsigned caches = 0);
     ~FileMemPool();
 
     // Allocate a new object from the FileMemPool
@@ -49,41 +60,77 @@ public:
     // Returns: a pointer to the FileMemPool object on success, nullptr on failure
     void* m_alloc();
 
-    // This must be called by the same thread calling file_mempool_alloc()
+    // This should be called by the same thread calling m_alloc()
     // Return: FILE_MEM_SUCCESS or FILE_MEM_FAIL
     int m_free(void* obj);
 
-    // This can be called by a different thread calling file_mempool_alloc()
+    // This can be called by a different thread calling m_alloc()
     // Return: FILE_MEM_SUCCESS or FILE_MEM_FAIL
     int m_release(void* obj);
 
     //Returns number of elements allocated
     uint64_t allocated();
 
-    // Returns number of elements freed in current buffer
+    // Returns number of elements freed, including those held by thread caches
     uint64_t freed();
 
-    // Returns number of elements released in current buffer
+    // Returns number of elements released and not yet reused
     uint64_t released();
 
     // Returns total number of elements in current buffer
     uint64_t total_objects() { return total; }
 
-private:
+    void get_stats(FileMemStats&);
+
+    // Same, for the calling thread's cache only; zeros if it has none
+    void get_thread_stats(FileMemStats&);
 
-    void free_pools();
-    int remove(CircularBuffer* cb, void* obj);
+private:
+    struct Cache
+    {
+        std::atomic<uint32_t> count;
+        std::atomic<uint64_t> hits;
+        std::atomic<uint64_t> refills;
+        std::atomic<uint64_t> spills;
+        std::atomic<uint64_t> retries;
+        uint32_t items[FILE_MEM_CACHE_SIZE];
+        uint8_t pad[64];  // keep neighboring caches off each other's lines
+    };
+
+    Cache* get_cache();
+    void count_retry();
+    bool get_index(void* obj, uint32_t& index);
+    int remove(void* obj, uint32_t& index);
 #ifdef DEBUG_MSGS
     void verify();
 #endif
 
-    void** datapool; /* memory buffer */
-    uint64_t total;
-    CircularBuffer* free_list;
-    CircularBuffer* released_list;
-    size_t obj_size;
-    std::mutex pool_mutex;
+    void push(std::atomic<uint64_t>& head, uint32_t first, uint32_t last);
+    unsigned pop(std::atomic<uint64_t>& head, uint32_t* out, unsigned max);
+
+    void spill(Cache*);
+    unsigned refill(uint32_t* out, unsigned max);
+
+    void* object(uint32_t index)
+    { return (char*)datapool + (uint64_t)index * obj_size; }
+
+    void** datapool = nullptr; /* memory buffer */
+    uint64_t total = 0;
+    size_t obj_size = 0;
+
+    // links[i] is 1 + the index below object i on whichever list holds it,
+    // 0 at the bottom.  the heads carry a change count in the upper 32 bits
+    // so a head that was popped and pushed back can't be mistaken for the
+    // one that was read (ABA).
+    std::atomic<uint32_t>* links = nullptr;
+    std::atomic<uint64_t> free_head { 0 };
+    std::atomic<uint64_t> released_head { 0 };
+    std::atomic<uint64_t> free_count { 0 };
+    std::atomic<uint64_t> released_count { 0 };
+    std::atomic<uint64_t> retries { 0 };
+
+    Cache* caches = nullptr;
+    unsigned num_caches = 0;
 };
 
 #endif
-
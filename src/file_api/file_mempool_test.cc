@@ -0,0 +1,264 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// file_mempool_test.cc drives the capture pool from several packet threads
+// and a release thread at once and checks that no object is handed out
+// twice or lost
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "catch/snort_catch.h"
+#include "main/thread.h"
+
+#include "file_mempool.h"
+
+SNORT_FORCED_INCLUSION_DEFINITION(file_mempool_test);
+
+#define OBJ_SIZE 64
+
+TEST_CASE("mempool alloc free release", "[file_mempool]")
+{
+    FileMemPool pool(4, OBJ_SIZE);
+    void* obj[4];
+
+    for ( auto& p : obj )
+        CHECK((p = pool.m_alloc()) != nullptr);
+
+    CHECK(pool.m_alloc() == nullptr);
+    CHECK(pool.allocated() == 4);
+
+    CHECK(pool.m_free(obj[0]) == FILE_MEM_SUCCESS);
+    CHECK(pool.m_release(obj[1]) == FILE_MEM_SUCCESS);
+    CHECK(pool.freed() == 1);
+    CHECK(pool.released() == 1);
+
+    // double free and foreign pointers are refused
+    CHECK(pool.m_free(obj[0]) == FILE_MEM_FAIL);
+    CHECK(pool.m_release(obj[1]) == FILE_MEM_FAIL);
+    CHECK(pool.m_free((char*)obj[2] + 1) == FILE_MEM_FAIL);
+    CHECK(pool.m_free(nullptr) == FILE_MEM_FAIL);
+
+    // free objects go out before released ones
+    CHECK(pool.m_alloc() == obj[0]);
+    CHECK(pool.m_alloc() == obj[1]);
+    CHECK(pool.allocated() == 4);
+}
+
+TEST_CASE("mempool thread cache", "[file_mempool]")
+{
+    const unsigned num = 8 * FILE_MEM_CACHE_SIZE;
+    FileMemPool pool(num, OBJ_SIZE, 2);
+    std::vector<void*> objs;
+
+    set_thread_type(STHREAD_TYPE_PACKET);
+    set_instance_id(1);
+
+    for ( unsigned i = 0; i < num; ++i )
+        objs.push_back(pool.m_alloc());
+
+    CHECK(pool.m_alloc() == nullptr);
+
+    for ( auto p : objs )
+        CHECK(pool.m_free(p) == FILE_MEM_SUCCESS);
+
+    CHECK(pool.freed() == num);
+    CHECK(pool.allocated() == 0);
+
+    // most of the second round comes straight from the cache
+    for ( unsigned i = 0; i < num; ++i )
+        CHECK(pool.m_alloc() != nullptr);
+
+    FileMemStats stats;
+    pool.get_stats(stats);
+    CHECK(stats.cache_hits > num);
+    CHECK(stats.cache_spills > 0);
+
+    set_instance_id(0);
+    set_thread_type(STHREAD_TYPE_MAIN);
+}
+
+static void stress(unsigned threads, unsigned caches)
+{
+    const unsigned num = threads * FILE_MEM_CACHE_SIZE * 8;
+    const unsigned rounds = 20000;
+
+    FileMemPool pool(num, OBJ_SIZE, caches);
+    std::vector<std::atomic<uint8_t>> owner(num);
+    std::atomic<unsigned> errors { 0 };
+    std::atomic<unsigned> running { threads };
+
+    // the writer thread frees what it is given with release
+    std::mutex lock;
+    std::queue<void*> handed_off;
+
+    // each object carries its own index past the free magic
+    auto index = [](void* p) -> unsigned
+    { return *(uint32_t*)((uint8_t*)p + 16); };
+
+    {
+        // learn each object's index once, with caches bypassed
+        std::vector<void*> objs;
+        void* p;
+
+        while ( (p = pool.m_alloc()) )
+            objs.push_back(p);
+
+        CHECK(objs.size() == num);
+
+        for ( unsigned i = 0; i < objs.size(); ++i )
+        {
+            *(uint32_t*)((uint8_t*)objs[i] + 16) = i;
+            pool.m_free(objs[i]);
+        }
+    }
+
+    auto packet = [&](unsigned id)
+    {
+        set_thread_type(STHREAD_TYPE_PACKET);
+        set_instance_id(id);
+
+        std::vector<void*> held;
+        uint32_t seed = id + 1;
+
+        for ( unsigned r = 0; r < rounds; ++r )
+        {
+            seed = seed * 1103515245 + 12345;
+
+            if ( held.size() < 48 and (seed >> 16) % 3 )
+            {
+                void* p = pool.m_alloc();
+
+                if ( !p )
+                    continue;
+
+                uint8_t expect = 0;
+
+                if ( !owner[index(p)].compare_exchange_strong(expect, id + 1) )
+                    ++errors;
+
+                held.push_back(p);
+            }
+            else if ( !held.empty() )
+            {
+                void* p = held.back();
+                held.pop_back();
+
+                if ( owner[index(p)].exchange(0) != id + 1 )
+                    ++errors;
+
+                if ( (seed >> 16) % 4 )
+                {
+                    if ( pool.m_free(p) != FILE_MEM_SUCCESS )
+                        ++errors;
+                }
+                else
+                {
+                    std::lock_guard<std::mutex> lk(lock);
+                    handed_off.push(p);
+                }
+            }
+        }
+        for ( auto p : held )
+        {
+            owner[index(p)] = 0;
+            pool.m_free(p);
+        }
+        --running;
+    };
+
+    auto writer = [&]()
+    {
+        while ( true )
+        {
+            void* p = nullptr;
+            {
+                std::lock_guard<std::mutex> lk(lock);
+
+                if ( !handed_off.empty() )
+                {
+                    p = handed_off.front();
+                    handed_off.pop();
+                }
+                else if ( !running )
+                    break;
+            }
+            if ( p and pool.m_release(p) != FILE_MEM_SUCCESS )
+                ++errors;
+        }
+    };
+
+    std::vector<std::thread> workers;
+
+    for ( unsigned i = 0; i < threads; ++i )
+        workers.emplace_back(packet, i);
+
+    std::thread w(writer);
+
+    for ( auto& t : workers )
+        t.join();
+
+    w.join();
+
+    CHECK(errors == 0);
+    CHECK(pool.allocated() == 0);
+    CHECK(pool.freed() + pool.released() == num);
+
+    FileMemStats stats;
+    pool.get_stats(stats);
+    CHECK((stats.cache_hits > 0) == (caches > 0));
+
+    // everything can still be allocated exactly once, including what was
+    // left in each thread's cache
+    std::vector<bool> seen(num);
+    void* p;
+    unsigned n = 0;
+
+    set_thread_type(STHREAD_TYPE_PACKET);
+
+    for ( unsigned id = 0; id < threads; ++id )
+    {
+        set_instance_id(id);
+
+        while ( (p = pool.m_alloc()) )
+        {
+            CHECK(!seen[index(p)]);
+            seen[index(p)] = true;
+            ++n;
+        }
+    }
+    CHECK(n == num);
+
+    set_instance_id(0);
+    set_thread_type(STHREAD_TYPE_MAIN);
+}
+
+TEST_CASE("mempool stress", "[file_mempool]")
+{
+    // with and without thread caches
+    stress(4, 4);
+    stress(4, 0);
+}
+
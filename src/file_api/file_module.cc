@@ -31,6 +31,7 @@
 
 #include "main/snort_config.h"
 
+#include "file_capture.h"
 #include "file_stats.h"
 
 static const Parameter file_magic_params[] =
@@ -185,6 +186,10 @@ static const PegInfo file_pegs[] =
     { CountType::SUM, "total_files", "number of files processed" },
     { CountType::SUM, "total_file_data", "number of file data bytes processed" },
     { CountType::SUM, "cache_failures", "number of file cache add failures" },
+    { CountType::SUM, "buffer_cache_hits", "number of capture buffers taken from a thread cache" },
+    { CountType::SUM, "buffer_cache_refills", "number of batches of capture buffers taken from the shared lists" },
+    { CountType::SUM, "buffer_cache_spills", "number of batches of capture buffers returned to the shared list" },
+    { CountType::SUM, "buffer_list_retries", "number of retries due to contention on the shared buffer lists" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -204,6 +209,7 @@ PegCount* FileIdModule::get_counts() const
 
 void FileIdModule::sum_stats(bool accumulate_now_stats)
 {
+    FileCapture::update_mem_counts();
     file_stats_sum();
     Module::sum_stats(accumulate_now_stats);
 }
@@ -406,6 +412,7 @@ void FileIdModule::load_config(FileConfig*& dst)
 
     if (fc)
     {
+        fc->compile_file_rules();
         fc->get_file_policy().load();
         fc = nullptr;
     }
@@ -0,0 +1,246 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// file_sha256.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "file_sha256.h"
+
+#include <openssl/sha.h>
+
+#include <cstring>
+
+#include "hash/hashes.h"
+
+// SHA extensions are selected at runtime
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#include <immintrin.h>
+#define SHA256_SHANI
+#endif
+
+static const uint32_t sha256_init[8] =
+{
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+// Without the SHA extensions blocks are handed to OpenSSL's block function,
+// which picks its own best implementation for the cpu.  Only the chaining
+// values are carried between calls.
+static void compress_openssl(uint32_t* state, const uint8_t* data, size_t blocks)
+{
+    SHA256_CTX c;
+    memcpy(c.h, state, sizeof(c.h));
+
+    while ( blocks-- )
+    {
+        SHA256_Transform(&c, data);
+        data += 64;
+    }
+    memcpy(state, c.h, sizeof(c.h));
+}
+
+#ifdef SHA256_SHANI
+static bool have_shani()
+{
+    static const bool shani = []()
+    {
+        unsigned a, b, c, d;
+
+        __builtin_cpu_init();
+
+        if ( !__builtin_cpu_supports("sse4.1") or !__get_cpuid_count(7, 0, &a, &b, &c, &d) )
+            return false;
+
+        return (b & (1u << 29)) != 0;
+    }();
+    return shani;
+}
+
+alignas(16) static const uint32_t sha256_k[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// Each group of 4 rounds extends the message schedule by 4 words:
+// W[t-16] + s0(W[t-15]) from msg1, W[t-7] from the two previous groups and
+// s1(W[t-2]) from msg2.  w0 holds the group 4 back and is replaced.
+__attribute__((target("sha,sse4.1")))
+static inline void sha256_schedule(__m128i& w0, __m128i w1, __m128i w2, __m128i w3)
+{
+    const __m128i w7 = _mm_alignr_epi8(w3, w2, 4);
+    w0 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w0, w1), w7), w3);
+}
+
+__attribute__((target("sha,sse4.1")))
+static inline void sha256_rounds(__m128i& abef, __m128i& cdgh, __m128i w, const uint32_t* k)
+{
+    const __m128i wk = _mm_add_epi32(w, _mm_load_si128((const __m128i*)k));
+    cdgh = _mm_sha256rnds2_epu32(cdgh, abef, wk);
+    abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(wk, 0x0e));
+}
+
+// The state is kept in the ABEF / CDGH arrangement the round instruction
+// wants for the whole run of blocks.
+__attribute__((target("sha,sse4.1")))
+static void compress_shani(uint32_t* state, const uint8_t* data, size_t blocks)
+{
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state), 0xb1);
+    __m128i cdgh = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(state + 4)), 0x1b);
+    __m128i abef = _mm_alignr_epi8(tmp, cdgh, 8);
+    cdgh = _mm_blend_epi16(cdgh, tmp, 0xf0);
+
+    while ( blocks-- )
+    {
+        const __m128i abef_save = abef;
+        const __m128i cdgh_save = cdgh;
+
+        __m128i w0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), bswap);
+        __m128i w1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), bswap);
+        __m128i w2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), bswap);
+        __m128i w3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), bswap);
+
+        sha256_rounds(abef, cdgh, w0, sha256_k);
+        sha256_rounds(abef, cdgh, w1, sha256_k + 4);
+        sha256_rounds(abef, cdgh, w2, sha256_k + 8);
+        sha256_rounds(abef, cdgh, w3, sha256_k + 12);
+
+        for ( unsigned i = 16; i < 64; i += 16 )
+        {
+            sha256_schedule(w0, w1, w2, w3);
+            sha256_rounds(abef, cdgh, w0, sha256_k + i);
+            sha256_schedule(w1, w2, w3, w0);
+            sha256_rounds(abef, cdgh, w1, sha256_k + i + 4);
+            sha256_schedule(w2, w3, w0, w1);
+            sha256_rounds(abef, cdgh, w2, sha256_k + i + 8);
+            sha256_schedule(w3, w0, w1, w2);
+            sha256_rounds(abef, cdgh, w3, sha256_k + i + 12);
+        }
+        abef = _mm_add_epi32(abef, abef_save);
+        cdgh = _mm_add_epi32(cdgh, cdgh_save);
+        data += 64;
+    }
+
+    tmp = _mm_shuffle_epi32(abef, 0x1b);
+    cdgh = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128((__m128i*)state, _mm_blend_epi16(tmp, cdgh, 0xf0));
+    _mm_storeu_si128((__m128i*)(state + 4), _mm_alignr_epi8(cdgh, tmp, 8));
+}
+#endif
+
+static inline void compress(uint32_t* state, const uint8_t* data, size_t blocks)
+{
+#ifdef SHA256_SHANI
+    if ( have_shani() )
+    {
+        compress_shani(state, data, blocks);
+        return;
+    }
+#endif
+    compress_openssl(state, data, blocks);
+}
+
+bool FileSha256::accelerated()
+{
+#ifdef SHA256_SHANI
+    return have_shani();
+#else
+    return false;
+#endif
+}
+
+void FileSha256::init()
+{
+    memcpy(state, sha256_init, sizeof(state));
+    total = 0;
+}
+
+void FileSha256::update(const uint8_t* data, size_t len)
+{
+    unsigned used = total & 63;
+    total += len;
+
+    if ( used )
+    {
+        unsigned n = 64 - used;
+
+        if ( len < n )
+        {
+            memcpy(block + used, data, len);
+            return;
+        }
+        memcpy(block + used, data, n);
+        compress(state, block, 1);
+        data += n;
+        len -= n;
+    }
+
+    if ( len >= 64 )
+    {
+        compress(state, data, len / 64);
+        data += len & ~(size_t)63;
+        len &= 63;
+    }
+
+    if ( len )
+        memcpy(block, data, len);
+}
+
+void FileSha256::final(uint8_t* digest) const
+{
+    uint32_t h[8];
+    uint8_t tail[128];
+    unsigned used = total & 63;
+
+    memcpy(h, state, sizeof(h));
+    memcpy(tail, block, used);
+    tail[used++] = 0x80;
+
+    unsigned len = (used <= 56) ? 64 : 128;
+    memset(tail + used, 0, len - used);
+
+    const uint64_t bits = total << 3;
+
+    for ( unsigned i = 0; i < 8; ++i )
+        tail[len - 1 - i] = (uint8_t)(bits >> (8 * i));
+
+    compress(h, tail, len / 64);
+
+    for ( unsigned i = 0; i < 8; ++i )
+    {
+        digest[4 * i] = (uint8_t)(h[i] >> 24);
+        digest[4 * i + 1] = (uint8_t)(h[i] >> 16);
+        digest[4 * i + 2] = (uint8_t)(h[i] >> 8);
+        digest[4 * i + 3] = (uint8_t)h[i];
+    }
+    static_assert(sizeof(h) == SHA256_HASH_SIZE, "digest size");
+}
+
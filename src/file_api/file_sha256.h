@@ -0,0 +1,55 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// file_sha256.h
+
+#ifndef FILE_SHA256_H
+#define FILE_SHA256_H
+
+// FileSha256 is the streaming file signature hash.  it is held directly in
+// the file context so nothing is allocated per file, and final() works on a
+// copy of the running state so a digest can be taken at any point (for an
+// early signature lookup) without disturbing the hash of the rest of the
+// file.  whole blocks go straight from the file data to the compression
+// function, which uses the x86 SHA extensions when the cpu has them.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "main/snort_types.h"
+
+class SO_PUBLIC FileSha256
+{
+public:
+    void init();
+    void update(const uint8_t* data, size_t len);
+
+    // digest must be SHA256_HASH_SIZE bytes
+    void final(uint8_t* digest) const;
+
+    // true if the SHA extensions are in use
+    static bool accelerated();
+
+private:
+    uint32_t state[8];
+    uint64_t total;
+    uint8_t block[64];
+};
+
+#endif
+
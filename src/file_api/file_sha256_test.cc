@@ -0,0 +1,157 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// file_sha256_test.cc checks the streaming file hash against OpenSSL for
+// arbitrary segmentation and times it against the legacy per file context
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <openssl/sha.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "catch/snort_catch.h"
+#include "hash/hashes.h"
+
+#include "file_sha256.h"
+
+SNORT_FORCED_INCLUSION_DEFINITION(file_sha256_test);
+
+static std::vector<uint8_t> make_data(unsigned len)
+{
+    std::vector<uint8_t> v(len);
+
+    for ( auto& b : v )
+        b = rand();
+
+    return v;
+}
+
+static bool same(const FileSha256& fs, const uint8_t* data, size_t len)
+{
+    uint8_t a[SHA256_HASH_SIZE], b[SHA256_HASH_SIZE];
+    fs.final(a);
+    SHA256(data, len, b);
+    return !memcmp(a, b, sizeof(a));
+}
+
+TEST_CASE("sha256 known answers", "[file_sha256]")
+{
+    const uint8_t abc[SHA256_HASH_SIZE] =
+    {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+    };
+    const uint8_t empty[SHA256_HASH_SIZE] =
+    {
+        0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+        0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55
+    };
+    uint8_t digest[SHA256_HASH_SIZE];
+    FileSha256 fs;
+
+    fs.init();
+    fs.final(digest);
+    CHECK(!memcmp(digest, empty, sizeof(digest)));
+
+    fs.update((const uint8_t*)"abc", 3);
+    fs.final(digest);
+    CHECK(!memcmp(digest, abc, sizeof(digest)));
+}
+
+TEST_CASE("sha256 lengths", "[file_sha256]")
+{
+    srand(1);
+    std::vector<uint8_t> data = make_data(300);
+
+    // every padding case, including the length spilling into a second block
+    for ( unsigned len = 0; len <= data.size(); ++len )
+    {
+        FileSha256 fs;
+        fs.init();
+        fs.update(data.data(), len);
+        CHECK(same(fs, data.data(), len));
+    }
+}
+
+TEST_CASE("sha256 segments", "[file_sha256]")
+{
+    srand(2);
+    std::vector<uint8_t> data = make_data(100000);
+
+    for ( unsigned max : { 1, 7, 64, 65, 1460, 16384 } )
+    {
+        FileSha256 fs;
+        fs.init();
+        unsigned done = 0;
+
+        // taking a digest part way must not change the rest of the hash
+        while ( done < data.size() )
+        {
+            unsigned n = rand() % max + 1;
+
+            if ( n > data.size() - done )
+                n = data.size() - done;
+
+            fs.update(data.data() + done, n);
+            done += n;
+
+            if ( !(rand() % 16) )
+                CHECK(same(fs, data.data(), done));
+        }
+        CHECK(same(fs, data.data(), data.size()));
+    }
+}
+
+TEST_CASE("sha256 benchmarks", "[file_sha256][!benchmark]")
+{
+    srand(3);
+    std::vector<uint8_t> data = make_data(1 << 20);
+    uint8_t digest[SHA256_HASH_SIZE];
+    // digests are stored through a volatile so the hashing is kept
+    volatile unsigned sink = 0;
+
+    // a 1 MB download in 1460 byte segments with a digest at the end
+    BENCHMARK("legacy 1M")
+    {
+        SHA256_CTX* c = (SHA256_CTX*)calloc(1, sizeof(SHA256_CTX));
+        SHA256_Init(c);
+
+        for ( unsigned i = 0; i < data.size(); i += 1460 )
+            SHA256_Update(c, data.data() + i, std::min(1460u, (unsigned)data.size() - i));
+
+        SHA256_Final(digest, c);
+        free(c);
+        sink += digest[0];
+    }
+    BENCHMARK("file_sha256 1M")
+    {
+        FileSha256 fs;
+        fs.init();
+
+        for ( unsigned i = 0; i < data.size(); i += 1460 )
+            fs.update(data.data() + i, std::min(1460u, (unsigned)data.size() - i));
+
+        fs.final(digest);
+        sink += digest[0];
+    }
+}
+
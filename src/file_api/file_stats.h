@@ -37,6 +37,10 @@ struct FileCounts
     PegCount files_total;
     PegCount file_data_total;
     PegCount cache_add_fails;
+    PegCount buffer_cache_hits;
+    PegCount buffer_cache_refills;
+    PegCount buffer_cache_spills;
+    PegCount buffer_list_retries;
     PegCount files_buffered_total;
     PegCount files_released_total;
     PegCount files_freed_total;
@@ -223,11 +223,18 @@ int Flow::set_flow_data(FlowData* fd)
         flow_data->prev = fd;
 
     flow_data = fd;
+
+    if ( fd->get_id() < FLOW_DATA_SLOTS )
+        flow_data_slot[fd->get_id()] = fd;
+
     return 0;
 }
 
 FlowData* Flow::get_flow_data(unsigned id) const
 {
+    if ( id < FLOW_DATA_SLOTS )
+        return flow_data_slot[id];
+
     FlowData* fd = flow_data;
 
     while (fd)
@@ -242,6 +249,9 @@ FlowData* Flow::get_flow_data(unsigned id) const
 
 void Flow::free_flow_data(FlowData* fd)
 {
+    if ( fd->get_id() < FLOW_DATA_SLOTS )
+        flow_data_slot[fd->get_id()] = nullptr;
+
     if ( fd == flow_data )
     {
         flow_data = fd->next;
@@ -279,6 +289,7 @@ void Flow::free_flow_data()
         delete tmp;
     }
     flow_data = nullptr;
+    memset(flow_data_slot, 0, sizeof(flow_data_slot));
 }
 
 void Flow::call_handlers(Packet* p, bool eof)
@@ -97,6 +97,10 @@ struct Packet;
 
 typedef void (* StreamAppDataFree)(void*);
 
+// flow data ids are assigned densely at startup so the first few are kept
+// in slots and found by index; the rest are only found on the list
+#define FLOW_DATA_SLOTS 8
+
 class SO_PUBLIC FlowData
 {
 public:
@@ -316,6 +320,7 @@ public:  // FIXIT-M privatize if possible
 
     // everything from here down is zeroed
     FlowData* flow_data;
+    FlowData* flow_data_slot[FLOW_DATA_SLOTS];
     Inspector* clouseau;  // service identifier
     Inspector* gadget;    // service handler
     Inspector* data;
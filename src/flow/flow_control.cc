@@ -27,6 +27,7 @@
 #include "main/snort_debug.h"
 #include "managers/inspector_manager.h"
 #include "memory/memory_cap.h"
+#include "memory/memory_domain.h"
 #include "packet_io/active.h"
 #include "protocols/icmp4.h"
 #include "protocols/tcp.h"
@@ -239,9 +240,10 @@ void FlowControl::preemptive_cleanup()
             (unsigned) last_pkt_type);
 
     // FIXIT-H is there a possibility of this looping forever?
+    // pooled memory is shed before any flows are
     while ( memory::MemoryCap::over_threshold() )
     {
-        if ( !prune_one(PruneReason::PREEMPTIVE, true) )
+        if ( !memory::prune_domains() and !prune_one(PruneReason::PREEMPTIVE, true) )
             break;
     }
 }
@@ -23,6 +23,9 @@
 
 #include "ha.h"
 
+#include <sys/time.h>
+
+#include <algorithm>
 #include <array>
 
 #include "framework/counts.h"
@@ -34,8 +37,11 @@
 
 #include "flow.h"
 #include "flow_key.h"
+#include "ha_module.h"
 
 static const uint8_t HA_MESSAGE_VERSION = 3;
+// batched messages are walked by their lengths and may elide the key
+static const uint8_t HA_BATCH_VERSION = 4;
 
 // define message size and content constants.
 static const uint8_t KEY_SIZE_IP6 = sizeof(FlowKey);
@@ -47,12 +53,13 @@ static const suseconds_t USEC_PER_SEC = 1000000;
 enum
 {
     KEY_TYPE_IP6 = 1,
-    KEY_TYPE_IP4 = 2
+    KEY_TYPE_IP4 = 2,
+    KEY_TYPE_SAME = 3   // same key as the previous message in the batch
 };
 
 typedef std::array<FlowHAClient*, MAX_CLIENTS> ClientMap;
 
-THREAD_LOCAL SimpleStats ha_stats;
+THREAD_LOCAL HAStats ha_stats;
 THREAD_LOCAL ProfileStats ha_perf_stats;
 
 static THREAD_LOCAL HighAvailability* ha;
@@ -62,6 +69,18 @@ THREAD_LOCAL bool HighAvailabilityManager::shutting_down = false;
 struct timeval FlowHAState::min_session_lifetime;
 struct timeval FlowHAState::min_sync_interval;
 uint8_t s_handle_counter = 1; // stream client (index == 0) always exists
+static uint16_t s_batch_size = 0;
+static struct timeval s_batch_interval = { 0, 0 };
+
+// The side channel message being filled by this thread.  Each HA message in
+// it is header, key, and total_length bytes of content.
+struct HABatch
+{
+    SCMessage* msg = nullptr;
+    uint32_t used = 0;
+    struct timeval deadline;
+    FlowKey key;  // of the last message added
+};
 
 // The [0] entry contains the stream client (always present)
 // Entries [1] to [MAX_CLIENTS-1] contain the optional clients
@@ -209,13 +228,19 @@ bool FlowHAClient::place(HAMessage* msg, uint8_t* data, uint8_t length)
 // Does not use the message cursor coming in.
 // Leave the message cursor just after the key. Return
 // the key length.
-static uint8_t write_flow_key(Flow* flow, HAMessage* msg)
+static uint8_t write_flow_key(Flow* flow, HAMessage* msg, bool same_key)
 {
     HAMessageHeader* hdr = (HAMessageHeader*)msg->content();
     msg->cursor = (uint8_t*)hdr + sizeof(HAMessageHeader);
     const FlowKey* key = flow->key;
     assert(key);
 
+    if ( same_key )
+    {
+        hdr->key_type = KEY_TYPE_SAME;
+        return 0;
+    }
+
     if ( is_ip6_key(flow->key) )
     {
         hdr->key_type = KEY_TYPE_IP6;
@@ -238,13 +263,17 @@ static uint8_t write_flow_key(Flow* flow, HAMessage* msg)
 
 // Regardless of the message cursor, extract the key and
 // return the key length.  Position the cursor just after the key.
+// An elided key leaves the key from the previous message.
 static uint8_t read_flow_key(FlowKey* key, HAMessage* msg)
 {
     assert(key);
     HAMessageHeader* hdr = (HAMessageHeader*)msg->content();
     msg->cursor = (uint8_t*)hdr + sizeof(HAMessageHeader);
 
-    if ( hdr->key_type == KEY_TYPE_IP6 )
+    if ( hdr->key_type == KEY_TYPE_SAME )
+        return 0;
+
+    else if ( hdr->key_type == KEY_TYPE_IP6 )
     {
         memcpy(key, msg->cursor, KEY_SIZE_IP6);
         msg->cursor += KEY_SIZE_IP6;
@@ -284,6 +313,22 @@ static uint16_t calculate_msg_header_length(Flow* flow)
     return sizeof(HAMessageHeader) + key_size(flow);
 }
 
+// Size of the key that follows a header, or -1 if the type is unknown
+static int key_size(uint8_t key_type)
+{
+    switch ( key_type )
+    {
+    case KEY_TYPE_IP6:
+        return KEY_SIZE_IP6;
+    case KEY_TYPE_IP4:
+        return KEY_SIZE_IP4;
+    case KEY_TYPE_SAME:
+        return 0;
+    default:
+        return -1;
+    }
+}
+
 // Calculate the UPDATE message content length based on the
 // set of active clients.  The Session client is always present.
 static uint16_t calculate_update_msg_content_length(Flow* flow)
@@ -310,13 +355,14 @@ static uint16_t calculate_update_msg_content_length(Flow* flow)
 
 // Write the HA header and key sections.  Position the cursor
 // at the beginning of the content section.
-static void write_msg_header(Flow* flow, HAEvent event, uint16_t content_length, HAMessage* msg)
+static void write_msg_header(Flow* flow, HAEvent event, uint16_t content_length, HAMessage* msg,
+    bool same_key)
 {
     HAMessageHeader* hdr = (HAMessageHeader*)msg->content();
     hdr->event = (uint8_t)event;
-    hdr->version = HA_MESSAGE_VERSION;
+    hdr->version = s_batch_size ? HA_BATCH_VERSION : HA_MESSAGE_VERSION;
     hdr->total_length = content_length;
-    write_flow_key(flow, msg);  // set cursor to just beyond key
+    write_flow_key(flow, msg, same_key);  // set cursor to just beyond key
 }
 
 static void write_update_msg_client( FlowHAClient* client, Flow* flow, HAMessage* msg)
@@ -340,16 +386,14 @@ static void write_update_msg_content(Flow* flow, HAMessage* msg)
     }
 }
 
-static void consume_receive_delete_message(HAMessage* msg)
+static void consume_receive_delete_message(FlowKey& key, HAMessage* msg)
 {
-    FlowKey key;
     (void)read_flow_key(&key, msg);
     Stream::delete_flow(&key);
 }
 
-static void consume_receive_update_message(HAMessage* msg)
+static void consume_receive_update_message(FlowKey& key, HAMessage* msg)
 {
-    FlowKey key;
     (void)read_flow_key(&key, msg);
     // flow will be nullptr if/when the session does not exist in the caches
     Flow* flow = Stream::get_flow(&key);
@@ -397,23 +441,20 @@ static void consume_receive_update_message(HAMessage* msg)
     }
 }
 
-static void consume_receive_message(HAMessage* msg)
+static void consume_receive_message(FlowKey& key, HAMessage* msg)
 {
     HAMessageHeader* hdr = (HAMessageHeader*)msg->content();
 
-    if ( hdr->version != HA_MESSAGE_VERSION)
-        return;
-
     switch ( hdr->event )
     {
         case HA_DELETE_EVENT:
         {
-            consume_receive_delete_message(msg);
+            consume_receive_delete_message(key, msg);
             break;
         }
         case HA_UPDATE_EVENT:
         {
-            consume_receive_update_message(msg);
+            consume_receive_update_message(key, msg);
             break;
         }
         default:
@@ -421,6 +462,52 @@ static void consume_receive_message(HAMessage* msg)
     }
 }
 
+// An unbatched message fills the side channel message.  Batched messages
+// follow one another, each sized by its header.
+static void consume_receive_batch(uint8_t* data, uint32_t length)
+{
+    FlowKey key;
+    bool have_key = false;
+
+    while ( length >= sizeof(HAMessageHeader) )
+    {
+        HAMessageHeader* hdr = (HAMessageHeader*)data;
+        uint32_t msg_length;
+
+        if ( hdr->version == HA_MESSAGE_VERSION )
+            msg_length = length;
+
+        else if ( hdr->version == HA_BATCH_VERSION )
+        {
+            int key_length = key_size(hdr->key_type);
+
+            if ( (key_length < 0) || (!key_length && !have_key) )
+            {
+                ErrorMessage("Consuming HA batch - invalid key\n");
+                break;
+            }
+
+            msg_length = sizeof(HAMessageHeader) + key_length + hdr->total_length;
+
+            if ( msg_length > length )
+            {
+                ErrorMessage("Consuming HA batch - message too short\n");
+                break;
+            }
+        }
+        else
+            break;
+
+        HAMessage msg(data, (uint16_t)msg_length);
+        consume_receive_message(key, &msg);
+        have_key = true;
+        ha_stats.messages_received++;
+
+        data += msg_length;
+        length -= msg_length;
+    }
+}
+
 HighAvailability::HighAvailability(PortBitSet* ports, bool)
 {
     using namespace std::placeholders;
@@ -453,6 +540,8 @@ HighAvailability::HighAvailability(PortBitSet* ports, bool)
     for ( int i=0; i<MAX_CLIENTS; i++ )
         (*s_client_map)[i] = nullptr;
 
+    batch = new HABatch;
+
     // Only looking for side channel processing - FIXIT-H
 }
 
@@ -462,9 +551,11 @@ HighAvailability::~HighAvailability()
 
     if ( sc )
     {
+        flush();
         sc->unregister_receive_handler();
     }
 
+    delete batch;
     delete s_client_map;
 }
 
@@ -478,12 +569,75 @@ void HighAvailability::receive_handler(SCMessage* sc_msg)
     // SC received messages must have reference back to SideChannel object
     assert(sc_msg->sc);
 
-    HAMessage ha_msg(sc_msg);
-    consume_receive_message(&ha_msg);
+    ha_stats.batches_received++;
+    consume_receive_batch(sc_msg->content, sc_msg->content_length);
 
     sc_msg->sc->discard_message(sc_msg);
 }
 
+// Lay out the header and key of a new message in the current batch,
+// flushing first if it won't fit, and return the message positioned at
+// its content.  Successive messages for the same flow share one key.
+HAMessage HighAvailability::start_message(Flow* flow, HAEvent event, uint16_t content_length)
+{
+    bool same_key = batch->msg && !memcmp(&batch->key, flow->key, sizeof(batch->key));
+    uint32_t length = sizeof(HAMessageHeader) + content_length;
+
+    if ( !same_key )
+        length += key_size(flow);
+
+    if ( batch->msg && (batch->used + length > batch->msg->content_length) )
+    {
+        flush();
+
+        if ( same_key )
+        {
+            same_key = false;
+            length += key_size(flow);
+        }
+    }
+    if ( same_key )
+        ha_stats.keys_elided++;
+
+    if ( !batch->msg )
+    {
+        batch->msg = sc->alloc_transmit_message(std::max(length, (uint32_t)s_batch_size));
+        assert(batch->msg);
+        batch->used = 0;
+
+        packet_gettimeofday(&batch->deadline);
+        timeradd(&batch->deadline, &s_batch_interval, &batch->deadline);
+    }
+
+    HAMessage ha_msg(batch->msg->content + batch->used, (uint16_t)length);
+    batch->used += length;
+    batch->key = *flow->key;
+
+    write_msg_header(flow, event, content_length, &ha_msg, same_key);
+    return ha_msg;
+}
+
+void HighAvailability::end_message()
+{
+    if ( !s_batch_size || (batch->used == batch->msg->content_length) )
+        flush();
+}
+
+// Send what has been batched, trimming the message to what was used
+void HighAvailability::flush()
+{
+    if ( !batch->msg )
+        return;
+
+    batch->msg->content_length = batch->used;
+    ha_stats.batches_sent++;
+    ha_stats.bytes_sent += batch->used;
+
+    sc->transmit_message(batch->msg);
+    batch->msg = nullptr;
+    batch->used = 0;
+}
+
 void HighAvailability::process_update(Flow* flow, const DAQ_PktHdr_t* pkthdr)
 {
     DebugMessage(DEBUG_HA,"HighAvailability::process_update()\n");
@@ -502,16 +656,12 @@ void HighAvailability::process_update(Flow* flow, const DAQ_PktHdr_t* pkthdr)
             flow->ha_state->check_any(FlowHAState::NEW) ) )
         return;
 
-    const uint16_t header_len = calculate_msg_header_length(flow);
     const uint16_t content_len = calculate_update_msg_content_length(flow);
 
-    SCMessage* sc_msg = sc->alloc_transmit_message((uint32_t)(header_len+content_len));
-    assert(sc_msg);
-    HAMessage ha_msg(sc_msg);
-
-    write_msg_header(flow, HA_UPDATE_EVENT, content_len, &ha_msg);
+    HAMessage ha_msg = start_message(flow, HA_UPDATE_EVENT, content_len);
     write_update_msg_content(flow, &ha_msg);
-    sc->transmit_message(sc_msg);
+    ha_stats.update_messages++;
+    end_message();
 
     flow->ha_state->clear(FlowHAState::NEW | FlowHAState::MODIFIED |
         FlowHAState::MAJOR | FlowHAState::CRITICAL);
@@ -534,22 +684,36 @@ void HighAvailability::process_deletion(Flow* flow)
     if ( !sc )
         return;
 
-    const uint32_t msg_len = calculate_msg_header_length(flow);
-    SCMessage* sc_msg = sc->alloc_transmit_message(msg_len);
-    HAMessage ha_msg(sc_msg);
-
     // No content, only header+key
-    write_msg_header(flow, HA_DELETE_EVENT, 0, &ha_msg);
-
-    sc->transmit_message(sc_msg);
+    start_message(flow, HA_DELETE_EVENT, 0);
+    ha_stats.delete_messages++;
+    end_message();
 
     flow->ha_state->add(FlowHAState::DELETED);
 }
 
+// This runs after every packet so it also sends a batch once its interval
+// has passed
 void HighAvailability::process_receive()
+{
+    if ( sc == nullptr )
+        return;
+
+    if ( batch->msg )
+    {
+        struct timeval now;
+        packet_gettimeofday(&now);
+
+        if ( !timercmp(&now, &batch->deadline, <) )
+            flush();
+    }
+    sc->process(DISPATCH_ALL_RECEIVE);
+}
+
+void HighAvailability::process_idle()
 {
     if ( sc != nullptr )
-        sc->process(DISPATCH_ALL_RECEIVE);
+        flush();
 }
 
 // Called by the configuration parsing activity in the main thread.
@@ -568,12 +732,19 @@ bool HighAvailabilityManager::instantiate(PortBitSet* mod_ports, bool mod_use_da
     return true;
 }
 
+void HighAvailabilityManager::config_batch(uint16_t batch_size, struct timeval* interval)
+{
+    s_batch_size = batch_size;
+    s_batch_interval = *interval;
+}
+
 // Called prior to the starts of configuration in the main thread.
 void HighAvailabilityManager::pre_config_init()
 {
     DebugFormat(DEBUG_HA,"HighAvailabilityManager::pre_config_init(): key size: %zu\n",
         sizeof(FlowKey));
     ports = nullptr;
+    s_batch_size = 0;
 }
 
 // Called within the packet thread prior to packet processing
@@ -622,6 +793,12 @@ void HighAvailabilityManager::process_receive()
         ha->process_receive();
 }
 
+void HighAvailabilityManager::process_idle()
+{
+    if ( ha != nullptr )
+        ha->process_idle();
+}
+
 // Called in the packet threads to determine whether or not HA is active
 bool HighAvailabilityManager::active()
 {
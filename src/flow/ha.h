@@ -101,21 +101,27 @@ struct __attribute__((__packed__)) HAClientHeader
     uint8_t length;
 };
 
-// Describe the message being produced or consumed.
+// Describe the message being produced or consumed.  A side channel message
+// may carry several HA messages when batching is enabled, so an HAMessage
+// covers just its own part of the content.
 class HAMessage
 {
 public:
     HAMessage(SCMessage* msg)
-    { sc_msg = msg; }
+    { buffer = msg->content; length = msg->content_length; }
+
+    HAMessage(uint8_t* buf, uint16_t len)
+    { buffer = buf; length = len; }
 
     uint8_t* content()
-    { return sc_msg->content; }
+    { return buffer; }
     uint16_t content_length()
-    { return sc_msg->content_length; }
+    { return length; }
     uint8_t* cursor;
 
 private:
-    SCMessage* sc_msg;
+    uint8_t* buffer;
+    uint16_t length;
 };
 
 // A FlowHAClient subclass for each producer/consumer of flow HA data
@@ -138,6 +144,8 @@ protected:
 
 };
 
+struct HABatch;
+
 // HighAvailability is instantiated for each packet-thread.
 // FIXIT-M make the SideChannel the THREAD_LOCAL element and collapse
 //  into HighAvailabilityManager
@@ -150,10 +158,16 @@ public:
     void process_update(Flow*, const DAQ_PktHdr_t*);
     void process_deletion(Flow*);
     void process_receive();
+    void process_idle();
 
 private:
     void receive_handler(SCMessage*);
+    HAMessage start_message(Flow*, HAEvent, uint16_t content_length);
+    void end_message();
+    void flush();
+
     SideChannel* sc = nullptr;
+    HABatch* batch = nullptr;
 };
 
 // Top level management of HighAvailability components.
@@ -165,6 +179,10 @@ public:
 
     // Invoked by the module configuration parsing to create HA instance
     static bool instantiate(PortBitSet*,bool,struct timeval*,struct timeval*);
+
+    // Pack messages into side channel messages of up to batch_size bytes,
+    // sent when full or after interval.  Zero sends each message alone.
+    static void config_batch(uint16_t batch_size, struct timeval* interval);
     static void thread_init();
     static void thread_term_beginning(); // thread is about to be terminated
     static void thread_term();
@@ -180,6 +198,9 @@ public:
 
     // Look for and dispatch receive messages.
     static void process_receive();
+
+    // Send any batched messages now that traffic has paused.
+    static void process_idle();
     static void set_modified(Flow*);
     static bool in_standby(Flow*);
 
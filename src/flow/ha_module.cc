@@ -52,9 +52,27 @@ static const Parameter ha_params[] =
     { "min_sync", Parameter::PT_REAL, "0.0:100.0", "1.0",
       "minimum interval between HA updates" },
 
+    { "batch_size", Parameter::PT_INT, "0:60000", "0",
+      "pack updates into side channel messages of up to this many bytes (0 to send each alone)" },
+
+    { "batch_interval", Parameter::PT_REAL, "0.0:10.0", "0.01",
+      "maximum time a batched update waits to be sent" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
+static const PegInfo ha_pegs[] =
+{
+    { CountType::SUM, "update_messages", "flow updates sent" },
+    { CountType::SUM, "delete_messages", "flow deletions sent" },
+    { CountType::SUM, "keys_elided", "messages sent without a repeated flow key" },
+    { CountType::SUM, "batches_sent", "side channel messages sent" },
+    { CountType::SUM, "bytes_sent", "HA bytes sent" },
+    { CountType::SUM, "messages_received", "HA messages received" },
+    { CountType::SUM, "batches_received", "side channel messages received" },
+    { CountType::END, nullptr, nullptr }
+};
+
 static void convert_real_seconds_to_timeval(double seconds, struct timeval* tv)
 {
     double whole = trunc(seconds);
@@ -72,6 +90,8 @@ HighAvailabilityModule::HighAvailabilityModule() :
     config.ports = nullptr;
     convert_real_seconds_to_timeval(1.0, &config.min_session_lifetime);
     convert_real_seconds_to_timeval(0.1, &config.min_sync_interval);
+    config.batch_size = 0;
+    convert_real_seconds_to_timeval(0.01, &config.batch_interval);
 }
 
 HighAvailabilityModule::~HighAvailabilityModule()
@@ -83,6 +103,9 @@ HighAvailabilityModule::~HighAvailabilityModule()
 ProfileStats* HighAvailabilityModule::get_profile() const
 { return &ha_perf_stats; }
 
+const PegInfo* HighAvailabilityModule::get_pegs() const
+{ return ha_pegs; }
+
 bool HighAvailabilityModule::set(const char* fqn, Value& v, SnortConfig*)
 {
 #ifdef DEBUG_MSGS
@@ -111,6 +134,13 @@ bool HighAvailabilityModule::set(const char* fqn, Value& v, SnortConfig*)
     {
         convert_real_seconds_to_timeval(v.get_real(), &config.min_sync_interval);
     }
+    else if ( v.is("batch_size") )
+        config.batch_size = v.get_long();
+
+    else if ( v.is("batch_interval") )
+    {
+        convert_real_seconds_to_timeval(v.get_real(), &config.batch_interval);
+    }
     else
         return false;
 
@@ -145,6 +175,7 @@ bool HighAvailabilityModule::end(const char* fqn, int idx, SnortConfig*)
         ParseWarning(WARN_CONF, "Illegal HighAvailability configuration");
         return false;
     }
+    HighAvailabilityManager::config_batch(config.batch_size, &config.batch_interval);
 
     return true;
 }
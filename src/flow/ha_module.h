@@ -36,9 +36,22 @@ struct HighAvailabilityConfig
     PortBitSet* ports = nullptr;
     struct timeval min_session_lifetime;
     struct timeval min_sync_interval;
+    uint16_t batch_size;
+    struct timeval batch_interval;
 };
 
-extern THREAD_LOCAL SimpleStats ha_stats;
+struct HAStats
+{
+    PegCount update_messages;
+    PegCount delete_messages;
+    PegCount keys_elided;
+    PegCount batches_sent;
+    PegCount bytes_sent;
+    PegCount messages_received;
+    PegCount batches_received;
+};
+
+extern THREAD_LOCAL HAStats ha_stats;
 extern THREAD_LOCAL ProfileStats ha_perf_stats;
 
 class HighAvailabilityModule : public Module
@@ -54,8 +67,7 @@ public:
     PegCount* get_counts() const override
     { return (PegCount*)&ha_stats; }
 
-    const PegInfo* get_pegs() const override
-    { return simple_pegs; }
+    const PegInfo* get_pegs() const override;
 
     ProfileStats* get_profile() const override;
 
@@ -35,7 +35,7 @@
 
 void LogMessage(const char*,...) { }
 
-THREAD_LOCAL SimpleStats ha_stats;
+THREAD_LOCAL HAStats ha_stats;
 THREAD_LOCAL ProfileStats ha_perf_stats;
 
 void show_stats(PegCount*, const PegInfo*, unsigned, const char*) { }
@@ -74,6 +74,8 @@ bool HighAvailabilityManager::instantiate(PortBitSet* mod_ports, bool mod_use_da
     return true;
 }
 
+void HighAvailabilityManager::config_batch(uint16_t, struct timeval*) { }
+
 TEST_GROUP(high_availability_module_test)
 {
     void setup()
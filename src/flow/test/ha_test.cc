@@ -66,6 +66,34 @@ TEST_KEY,
     0, 1, 2, 3, 4, 5, 6, 7, 8, 9
 };
 
+// an update and a delete for the same flow, batched
+static const uint8_t s_batch_message[] =
+{
+    0x02,
+    0x04,
+    12,
+    0x00,
+    0x01,
+TEST_KEY,
+    0x00,
+    10,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+    0x01,
+    0x04,
+    0x00,
+    0x00,
+    0x03
+};
+
+// a batch can't start with an elided key
+static const uint8_t s_batch_no_key_message[] =
+{
+    0x01,
+    0x04,
+    0x00,
+    0x00,
+    0x03
+};
 
 static struct timeval s_packet_time = { 0, 0 };
 static uint8_t s_message[MSG_SIZE];
@@ -73,6 +101,7 @@ static SideChannel s_side_channel;
 static SCMessage s_sc_message;
 static SCMessage s_rec_sc_message;
 static bool s_stream_consume_called = false;
+static unsigned s_stream_consume_count = 0;
 static bool s_other_consume_called = false;
 static bool s_get_session_called = false;
 static bool s_delete_session_called = false;
@@ -94,9 +123,11 @@ class StreamHAClient : public FlowHAClient
 public:
     StreamHAClient() : FlowHAClient(10, true) { }
     ~StreamHAClient() { }
-    bool consume(Flow*&, FlowKey*, HAMessage*)
+    bool consume(Flow*&, FlowKey*, HAMessage* msg)
     {
         s_stream_consume_called = true;
+        s_stream_consume_count++;
+        msg->cursor += 10;
         return true;
     }
     bool produce(Flow*, HAMessage* msg)
@@ -387,6 +418,74 @@ TEST(high_availability_test, transmit_update_stream_only)
     CHECK(s_transmit_message_called == true);
 }
 
+TEST(high_availability_test, receive_batch)
+{
+    s_stream_consume_called = false;
+    s_delete_session_called = false;
+    s_message_content = (uint8_t*)s_batch_message;
+    s_message_length = sizeof(s_batch_message);
+    HighAvailabilityManager::process_receive();
+    CHECK(s_stream_consume_called == true);
+    CHECK(s_delete_session_called == true);
+    CHECK(memcmp((const void*)&s_flowkey, (const void*)&s_test_key, sizeof(s_test_key)) == 0);
+}
+
+TEST(high_availability_test, receive_batch_no_key)
+{
+    s_delete_session_called = false;
+    s_message_content = (uint8_t*)s_batch_no_key_message;
+    s_message_length = sizeof(s_batch_no_key_message);
+    HighAvailabilityManager::process_receive();
+    CHECK(s_delete_session_called == false);
+}
+
+TEST(high_availability_test, transmit_update_batched)
+{
+    s_stream_update_required = true;
+    s_other_update_required = false;
+    s_flow.ha_state->clear_pending(ALL_CLIENTS);
+
+    // sent alone for reference
+    s_transmit_message_called = false;
+    HighAvailabilityManager::process_update(&s_flow, &s_pkthdr);
+    CHECK(s_transmit_message_called == true);
+    const uint8_t single_length = s_message_length;
+    CHECK(s_message[1] == 0x03);
+
+    struct timeval interval = { 1, 0 };
+    HighAvailabilityManager::config_batch(MSG_SIZE, &interval);
+    s_packet_time.tv_sec = 100;
+    s_message_content = nullptr;
+    s_transmit_message_called = false;
+
+    HighAvailabilityManager::process_update(&s_flow, &s_pkthdr);
+    HighAvailabilityManager::process_update(&s_flow, &s_pkthdr);
+    HighAvailabilityManager::process_receive();
+    CHECK(s_transmit_message_called == false);
+
+    // once the interval passes both go in one message with one key, and
+    // are received from it in turn
+    s_packet_time.tv_sec = 101;
+    s_stream_consume_count = 0;
+    HighAvailabilityManager::process_receive();
+    CHECK(s_transmit_message_called == true);
+    CHECK(s_message[1] == 0x04);
+    CHECK(s_message[single_length + 1] == 0x04);
+    CHECK(s_message[single_length + 4] == 0x03);
+    CHECK(s_message_length > single_length);
+    CHECK(s_message_length < 2 * single_length);
+    CHECK(s_stream_consume_count == 2);
+
+    // idle sends whatever is waiting
+    s_message_content = nullptr;
+    s_transmit_message_called = false;
+    HighAvailabilityManager::process_update(&s_flow, &s_pkthdr);
+    CHECK(s_transmit_message_called == false);
+    HighAvailabilityManager::process_idle();
+    CHECK(s_transmit_message_called == true);
+    CHECK(s_message_length == single_length);
+}
+
 TEST(high_availability_test, transmit_update_both_update)
 {
     s_transmit_message_called = false;
@@ -703,6 +703,7 @@ void Snort::thread_idle()
     Stream::timeout_flows(time(nullptr));
     perf_monitor_idle_process();
     aux_counts.idle++;
+    HighAvailabilityManager::process_idle();
     HighAvailabilityManager::process_receive();
 }
 
@@ -211,6 +211,44 @@ void PHVector::add_control(PHInstance* p)
     }
 }
 
+// the instances of a vector that apply to each packet type are compiled
+// into separate vectors when the policy is configured so the per packet
+// loop runs exactly the inspectors it needs without checking proto_bits.
+// packet types are single bits so each gets a slot by bit position.
+
+#define PKT_TYPE_SLOTS 8  // none plus each PktType bit
+
+static inline unsigned type_slot(PktType t)
+{ return __builtin_ffs(to_utype(t)); }
+
+struct PHDispatch
+{
+    PHVector by_type[PKT_TYPE_SLOTS];
+
+    void compile(const PHVector&);
+
+    const PHVector& get(PktType t) const
+    {
+        assert(type_slot(t) < PKT_TYPE_SLOTS);
+        return by_type[type_slot(t)];
+    }
+};
+
+void PHDispatch::compile(const PHVector& v)
+{
+    for ( unsigned t = 0; t < PKT_TYPE_SLOTS; ++t )
+    {
+        unsigned bit = t ? 1 << (t - 1) : 0;
+        by_type[t].alloc(v.num);
+
+        for ( unsigned i = 0; i < v.num; ++i )
+        {
+            if ( bit & v.vec[i]->pp_class.api.proto_bits )
+                by_type[t].add(v.vec[i]);
+        }
+    }
+}
+
 struct FrameworkPolicy
 {
     PHInstanceList ilist;
@@ -223,15 +261,26 @@ struct FrameworkPolicy
     PHVector control;
     PHVector probe;
 
+    PHDispatch packet_dispatch;
+    PHDispatch network_dispatch;
+    PHDispatch session_dispatch;
+    PHDispatch control_dispatch;
+    PHDispatch probe_dispatch;
+
+    // service inspectors indexed by snort protocol id
+    vector<Inspector*> gadgets;
+
     Inspector* binder;
     Inspector* wizard;
 
     bool default_binder;
 
-    void vectorize();
+    void vectorize(SnortConfig*);
 };
 
-void FrameworkPolicy::vectorize()
+static PHInstance* get_instance(FrameworkPolicy*, const char* keyword, bool dflt_only = false);
+
+void FrameworkPolicy::vectorize(SnortConfig* sc)
 {
     passive.alloc(ilist.size());
     packet.alloc(ilist.size());
@@ -286,6 +335,24 @@ void FrameworkPolicy::vectorize()
             break;
         }
     }
+
+    packet_dispatch.compile(packet);
+    network_dispatch.compile(network);
+    session_dispatch.compile(session);
+    control_dispatch.compile(control);
+    probe_dispatch.compile(probe);
+
+    // protocols added after this are looked up by name
+    unsigned max = sc->proto_ref->get_count();
+    gadgets.assign(max, nullptr);
+
+    for ( unsigned id = 1; id < max; ++id )
+    {
+        PHInstance* p = get_instance(this, sc->proto_ref->get_name(id));
+
+        if ( p )
+            gadgets[id] = p->handler;
+    }
 }
 
 //-------------------------------------------------------------------------
@@ -406,7 +473,7 @@ static bool get_instance(
 }
 
 static PHInstance* get_instance(
-        FrameworkPolicy* fp, const char* keyword, bool dflt_only = false)
+        FrameworkPolicy* fp, const char* keyword, bool dflt_only)
 {
     std::vector<PHInstance*>::iterator it;
     return get_instance(fp, keyword, dflt_only, it)? *it : nullptr;
@@ -509,7 +576,21 @@ Inspector* InspectorManager::get_binder()
     return pi->framework_policy->binder;
 }
 
-// FIXIT-P cache get_inspector() returns or provide indexed lookup
+Inspector* InspectorManager::get_service_inspector(int16_t id)
+{
+    InspectionPolicy* pi = get_inspection_policy();
+
+    if ( !pi || !pi->framework_policy )
+        return nullptr;
+
+    const FrameworkPolicy* fp = pi->framework_policy;
+
+    if ( id > 0 && (unsigned)id < fp->gadgets.size() )
+        return fp->gadgets[id];
+
+    return get_inspector(SnortConfig::get_conf()->proto_ref->get_name(id));
+}
+
 Inspector* InspectorManager::get_inspector(const char* key, bool dflt_only)
 {
     InspectionPolicy* pi;
@@ -817,7 +898,7 @@ static bool configure(SnortConfig* sc, FrameworkPolicy* fp, bool cloned)
     }
 
     sort(fp->ilist.begin(), fp->ilist.end(), PHInstance::comp);
-    fp->vectorize();
+    fp->vectorize(sc);
 
     // FIXIT-M checking for wizard here would avoid fatals for
     // can't bind wizard but this exposes other issues that must
@@ -886,24 +967,19 @@ void InspectorManager::print_config(SnortConfig* sc)
 // packet handling
 //-------------------------------------------------------------------------
 
-static inline void execute(
-    Packet* p, PHInstance** prep, unsigned num)
+// service inspectors are only run via the flow gadget so none of the
+// dispatched vectors need the session pointer check
+static inline void execute(Packet* p, const PHDispatch& pd)
 {
-    for ( unsigned i = 0; i < num; ++i, ++prep )
+    const PHVector& pv = pd.get(p->type());
+    PHInstance** prep = pv.vec;
+
+    for ( unsigned i = 0; i < pv.num; ++i, ++prep )
     {
         if ( p->packet_flags & PKT_PASS_RULE )
             break;
 
-        PHClass& ppc = (*prep)->pp_class;
-
-        // FIXIT-P these checks can eventually be optimized
-        // but they are required to ensure that session and app
-        // handlers aren't called w/o a session pointer
-        if ( !p->flow && (ppc.api.type == IT_SERVICE) )
-            break;
-
-        if ( (unsigned)p->type() & ppc.api.proto_bits )
-            (*prep)->handler->eval(p);
+        (*prep)->handler->eval(p);
     }
 }
 
@@ -946,7 +1022,7 @@ void InspectorManager::execute_control(Packet* p)
 {
     SnortConfig* sc = SnortConfig::get_conf();
     FrameworkPolicy* fp = get_default_inspection_policy(sc)->framework_policy;
-    ::execute(p, fp->control.vec, fp->control.num);
+    ::execute(p, fp->control_dispatch);
 }
 
 // FIXIT-M leverage knowledge of flow creation so that reputation (possibly a
@@ -963,7 +1039,7 @@ void InspectorManager::execute(Packet* p)
         // be elevated from inspector to framework component (it is just
         // a flow control wrapper) and use eval() instead of process()
         // for stream_*.
-        ::execute(p, fp->session.vec, fp->session.num);
+        ::execute(p, fp->session_dispatch);
         fp = get_inspection_policy()->framework_policy;
     }
     // must check between each ::execute()
@@ -971,14 +1047,14 @@ void InspectorManager::execute(Packet* p)
        return;
 
     if ( !p->is_cooked() )
-        ::execute(p, fp->packet.vec, fp->packet.num);
+        ::execute(p, fp->packet_dispatch);
 
     if ( p->disable_inspect )
        return;
 
     if ( !p->flow )
     {
-        ::execute(p, fp->network.vec, fp->network.num);
+        ::execute(p, fp->network_dispatch);
 
         if ( p->disable_inspect )
            return;
@@ -991,7 +1067,7 @@ void InspectorManager::execute(Packet* p)
             p->flow->session->process(p);
 
         if ( !p->flow->service )
-            ::execute(p, fp->network.vec, fp->network.num);
+            ::execute(p, fp->network_dispatch);
 
         if ( p->disable_inspect )
            return;
@@ -1007,7 +1083,7 @@ void InspectorManager::execute(Packet* p)
 void InspectorManager::probe(Packet* p)
 {
     FrameworkPolicy* fp = get_inspection_policy()->framework_policy;
-    ::execute(p, fp->probe.vec, fp->probe.num);
+    ::execute(p, fp->probe_dispatch);
 }
 
 void InspectorManager::clear(Packet* p)
@@ -61,6 +61,9 @@ public:
     static InspectorType get_type(const char* key);
     SO_PUBLIC static Inspector* get_inspector(const char* key, bool dflt_only = false);
 
+    // service inspector for the given snort protocol id
+    SO_PUBLIC static Inspector* get_service_inspector(int16_t id);
+
     SO_PUBLIC static Inspector* get_binder();
 
     SO_PUBLIC static Inspector* acquire(const char* key, bool dflt_only = false);
@@ -23,6 +23,7 @@
 #endif
 
 #include <cassert>
+#include <mutex>
 
 #include "memory_cap.h"
 
@@ -35,6 +36,7 @@
 #include "memory_config.h"
 #include "memory_module.h"
 #include "prune_handler.h"
+#include "slab_allocator.h"
 
 #ifdef UNIT_TEST
 #include "catch/snort_catch.h"
@@ -66,16 +68,16 @@ struct Tracker
         // {allocated = 0, deallocated = 48, allocations = 0, deallocations = 1}
         //assert(allocated >= deallocated);
 
-        if ( allocated < deallocated )
-            return 0;
-
-        return allocated - deallocated;
+        return bytes_in_use(allocated, deallocated);
     }
 
     constexpr Tracker() = default;
 };
 
 static THREAD_LOCAL Tracker s_tracker;
+static THREAD_LOCAL Tracker s_domains[NUM_DOMAINS];
+
+static DomainStats s_domain_stats[NUM_DOMAINS];
 
 // -----------------------------------------------------------------------------
 // helpers
@@ -133,30 +135,61 @@ size_t MemoryCap::preemptive_threshold = 0;
 // public interface
 // -----------------------------------------------------------------------------
 
-bool MemoryCap::free_space(size_t n)
+bool MemoryCap::free_space(size_t n, Domain d)
 {
     if ( !is_packet_thread() )
         return true;
 
+    const auto& config = *SnortConfig::get_conf()->memory;
+    const size_t domain_cap = config.domain_caps[(unsigned)d];
+
+    if ( domain_cap )
+    {
+        auto handler = [d]() { prune_domain_handler(d); };
+
+        if ( !memory::free_space(n, domain_cap, s_domains[(unsigned)d], handler) and !config.soft )
+            return false;
+    }
+
     if ( !thread_cap )
         return true;
 
-    const auto& config = *SnortConfig::get_conf()->memory;
-    return memory::free_space(n, thread_cap, s_tracker, prune_handler) || config.soft;
+    auto handler = [d]() { prune_handler(d); };
+    return memory::free_space(n, thread_cap, s_tracker, handler) || config.soft;
 }
 
-void MemoryCap::update_allocations(size_t n)
+void MemoryCap::update_allocations(size_t n, Domain d)
 {
     s_tracker.allocate(n);
+    s_domains[(unsigned)d].allocate(n);
     mp_active_context.update_allocs(n);
 }
 
-void MemoryCap::update_deallocations(size_t n)
+void MemoryCap::update_deallocations(size_t n, Domain d)
 {
     s_tracker.deallocate(n);
+    s_domains[(unsigned)d].deallocate(n);
     mp_active_context.update_deallocs(n);
 }
 
+void MemoryCap::update_slab_allocations(size_t n, Domain d)
+{
+    s_tracker.allocate(n);
+    s_domains[(unsigned)d].allocate(n);
+}
+
+void MemoryCap::update_slab_deallocations(size_t n, Domain d)
+{
+    s_tracker.deallocate(n);
+    s_domains[(unsigned)d].deallocate(n);
+}
+
+void MemoryCap::update_object_allocations(size_t n)
+{ mp_active_context.update_allocs(n); }
+
+void MemoryCap::update_object_deallocations(size_t n)
+{ mp_active_context.update_deallocs(n); }
+
 bool MemoryCap::over_threshold()
 {
     if ( !preemptive_threshold )
@@ -165,6 +198,33 @@ bool MemoryCap::over_threshold()
     return s_tracker.used() >= preemptive_threshold;
 }
 
+void MemoryCap::consolidate()
+{
+    if ( !is_packet_thread() )
+        return;
+
+    static std::mutex stats_mutex;
+    std::lock_guard<std::mutex> lock(stats_mutex);
+
+    for ( unsigned i = 0; i < NUM_DOMAINS; ++i )
+    {
+        DomainStats& ds = s_domain_stats[i];
+        const Tracker& trk = s_domains[i];
+
+        ds.allocations += trk.allocations;
+        ds.deallocations += trk.deallocations;
+        ds.allocated += trk.allocated;
+        ds.deallocated += trk.deallocated;
+        ds.prunes += get_prunes((Domain)i);
+    }
+}
+
+const DomainStats& MemoryCap::get_domain_stats(Domain d)
+{ return s_domain_stats[(unsigned)d]; }
+
+size_t MemoryCap::get_domain_cap(Domain d)
+{ return SnortConfig::get_conf()->memory->domain_caps[(unsigned)d]; }
+
 // FIXIT-L this should not be called while the packet threads are running.
 // once reload is implemented for the memory manager, the configuration
 // model will need to be updated
@@ -219,6 +279,12 @@ void MemoryCap::print()
         LogMessage("    global cap: %zu\n", config.cap);
         LogMessage("    global preemptive threshold percent: %zu\n", config.threshold);
         LogMessage("    cap type: %s\n", config.soft? "soft" : "hard");
+
+        for ( unsigned i = 0; i < NUM_DOMAINS; ++i )
+        {
+            if ( config.domain_caps[i] )
+                LogMessage("    %s cap: %zu\n", get_domain_name((Domain)i), config.domain_caps[i]);
+        }
     }
 
     if ( s_tracker.allocations )
@@ -226,6 +292,9 @@ void MemoryCap::print()
         LogMessage("    main thread usage: %zu\n", s_tracker.used());
         LogMessage("    allocations: %" PRIu64 "\n", s_tracker.allocations);
         LogMessage("    deallocations: %" PRIu64 "\n", s_tracker.deallocations);
+#ifdef USE_SLAB_ALLOCATOR
+        LogMessage("    slabs: %zu\n", SlabAllocator::get_slabs());
+#endif
         LogMessage("    thread cap: %zu\n", thread_cap);
         LogMessage("    preemptive threshold: %zu\n", preemptive_threshold);
     }
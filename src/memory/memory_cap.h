@@ -22,19 +22,53 @@
 #define MEMORY_CAP_H
 
 #include <cstddef>
+#include <cstdint>
+
+#include "memory_domain.h"
 
 namespace memory
 {
 
+// memory freed on a thread other than the one it was charged to can leave
+// deallocated ahead of allocated, so this bottoms out at zero
+inline uint64_t bytes_in_use(uint64_t allocated, uint64_t deallocated)
+{ return allocated < deallocated ? 0 : allocated - deallocated; }
+
+struct DomainStats
+{
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t allocated = 0;
+    uint64_t deallocated = 0;
+    uint64_t prunes = 0;
+
+    uint64_t in_use() const
+    { return bytes_in_use(allocated, deallocated); }
+};
+
 class MemoryCap
 {
 public:
-    static bool free_space(size_t);
-    static void update_allocations(size_t);
-    static void update_deallocations(size_t);
+    static bool free_space(size_t, Domain);
+    static void update_allocations(size_t, Domain);
+    static void update_deallocations(size_t, Domain);
+
+    // the slab allocator charges the cap as slabs are taken and returned
+    // and the profiler as objects are handed out and returned
+    static void update_slab_allocations(size_t, Domain);
+    static void update_slab_deallocations(size_t, Domain);
+    static void update_object_allocations(size_t);
+    static void update_object_deallocations(size_t);
 
     static bool over_threshold();
 
+    // call from each thread before it exits
+    static void consolidate();
+
+    // packet thread totals from consolidate()
+    static const DomainStats& get_domain_stats(Domain);
+    static size_t get_domain_cap(Domain);
+
     // call from main thread
     static void calculate(unsigned num_threads);
 
@@ -23,11 +23,14 @@
 
 #include <cstddef>
 
+#include "memory/memory_domain.h"
+
 struct MemoryConfig
 {
     size_t cap = 0;
     bool soft = false;
     size_t threshold = 0;
+    size_t domain_caps[memory::NUM_DOMAINS] = { };
 
     constexpr MemoryConfig() = default;
 };
@@ -0,0 +1,174 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// memory_domain.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "memory_domain.h"
+
+#include <cassert>
+
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
+namespace memory
+{
+
+static const char* domain_names[NUM_DOMAINS] =
+{ "flow", "reassembly", "http", "file", "appid", "detection" };
+
+// a handful per domain is plenty; these are fixed size so they can be
+// walked while allocations are failing
+static constexpr unsigned MAX_PRUNERS = 8;
+
+static Pruner pruners[NUM_DOMAINS][MAX_PRUNERS];
+static unsigned num_pruners[NUM_DOMAINS];
+
+static THREAD_LOCAL uint64_t prunes[NUM_DOMAINS];
+
+THREAD_LOCAL Domain DomainContext::current = Domain::FLOW;
+
+const char* get_domain_name(Domain d)
+{
+    assert(d < Domain::MAX);
+    return domain_names[(unsigned)d];
+}
+
+void add_pruner(Domain d, Pruner p)
+{
+    assert(d < Domain::MAX);
+    const unsigned i = (unsigned)d;
+
+    for ( unsigned j = 0; j < num_pruners[i]; ++j )
+    {
+        if ( pruners[i][j] == p )
+            return;
+    }
+    assert(num_pruners[i] < MAX_PRUNERS);
+
+    if ( num_pruners[i] < MAX_PRUNERS )
+        pruners[i][num_pruners[i]++] = p;
+}
+
+bool prune_domain(Domain d)
+{
+    const unsigned i = (unsigned)d;
+
+    for ( unsigned j = 0; j < num_pruners[i]; ++j )
+    {
+        if ( pruners[i][j]() )
+        {
+            ++prunes[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool prune_domains()
+{
+    for ( unsigned i = 0; i < NUM_DOMAINS; ++i )
+    {
+        if ( prune_domain((Domain)i) )
+            return true;
+    }
+    return false;
+}
+
+uint64_t get_prunes(Domain d)
+{ return prunes[(unsigned)d]; }
+
+} // namespace memory
+
+#ifdef UNIT_TEST
+
+namespace t_memory_domain
+{
+
+static unsigned calls = 0;
+static unsigned cached = 0;
+
+static bool shed_one()
+{
+    ++calls;
+
+    if ( !cached )
+        return false;
+
+    --cached;
+    return true;
+}
+
+static bool shed_none()
+{
+    ++calls;
+    return false;
+}
+
+} // namespace t_memory_domain
+
+TEST_CASE( "memory domain context", "[memory]" )
+{
+    using namespace memory;
+
+    CHECK( DomainContext::get() == Domain::FLOW );
+    {
+        DomainContext http(Domain::HTTP);
+        CHECK( DomainContext::get() == Domain::HTTP );
+        {
+            DomainContext file(Domain::FILE);
+            CHECK( DomainContext::get() == Domain::FILE );
+        }
+        CHECK( DomainContext::get() == Domain::HTTP );
+    }
+    CHECK( DomainContext::get() == Domain::FLOW );
+    CHECK( get_domain_name(Domain::DETECTION) == std::string("detection") );
+}
+
+TEST_CASE( "memory domain pruners", "[memory]" )
+{
+    using namespace memory;
+    using namespace t_memory_domain;
+
+    // detection is left alone by the rest of snort
+    add_pruner(Domain::DETECTION, shed_none);
+    add_pruner(Domain::DETECTION, shed_one);
+    add_pruner(Domain::DETECTION, shed_one);
+
+    calls = 0;
+    cached = 2;
+    uint64_t base = get_prunes(Domain::DETECTION);
+
+    CHECK( prune_domain(Domain::DETECTION) );
+    CHECK( calls == 2 );
+    CHECK( prune_domain(Domain::DETECTION) );
+
+    // each pruner is called once per pass
+    calls = 0;
+    CHECK_FALSE( prune_domain(Domain::DETECTION) );
+    CHECK( calls == 2 );
+
+    CHECK( get_prunes(Domain::DETECTION) == base + 2 );
+}
+
+#endif
+
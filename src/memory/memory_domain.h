@@ -0,0 +1,85 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// memory_domain.h
+
+#ifndef MEMORY_DOMAIN_H
+#define MEMORY_DOMAIN_H
+
+// allocations are charged to the domain of the innermost DomainContext in
+// scope so that each subsystem can have its own cap and give up cached
+// state before whole flows are pruned.  allocations outside any context
+// are charged to flow.
+
+#include <cstdint>
+
+#include "main/thread.h"
+
+namespace memory
+{
+
+enum class Domain : uint8_t
+{
+    FLOW,
+    REASSEMBLY,
+    HTTP,
+    FILE,
+    APPID,
+    DETECTION,
+    MAX
+};
+
+constexpr unsigned NUM_DOMAINS = (unsigned)Domain::MAX;
+
+const char* get_domain_name(Domain);
+
+class DomainContext
+{
+public:
+    DomainContext(Domain d) : saved(current)
+    { current = d; }
+
+    ~DomainContext()
+    { current = saved; }
+
+    static Domain get()
+    { return current; }
+
+private:
+    const Domain saved;
+    static THREAD_LOCAL Domain current;
+};
+
+// a pruner releases cached or otherwise optional state held by the calling
+// packet thread and returns true if it released anything.  register from
+// the main thread before packet threads start.
+typedef bool (*Pruner)();
+
+void add_pruner(Domain, Pruner);
+
+// run the pruners of one or all domains until one releases something
+bool prune_domain(Domain);
+bool prune_domains();
+
+// prunes that released something on this thread
+uint64_t get_prunes(Domain);
+
+} // namespace memory
+
+#endif
+
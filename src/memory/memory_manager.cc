@@ -29,6 +29,8 @@
 
 #include "memory_allocator.h"
 #include "memory_cap.h"
+#include "memory_domain.h"
+#include "slab_allocator.h"
 
 #ifdef UNIT_TEST
 #include "catch/snort_catch.h"
@@ -45,13 +47,17 @@ namespace memory
 //       it to memory allocations so that the returned memory is also aligned.
 struct alignas(max_align_t) Metadata
 {
+    // number of requested bytes
+    size_t payload_size;
+
 #if defined(REG_TEST) || defined(UNIT_TEST)
-    static constexpr size_t SANITY_CHECK_VALUE = 0xabcdef;
-    size_t sanity;
+    static constexpr uint32_t SANITY_CHECK_VALUE = 0xabcdef;
+    uint32_t sanity;
 #endif
 
-    // number of requested bytes
-    size_t payload_size;
+    // charged for the allocation; kept after the narrower members so it
+    // lands in the tail padding rather than growing the header
+    Domain domain;
 
     // total number of bytes allocated, including Metadata header
     size_t total_size() const;
@@ -62,34 +68,38 @@ struct alignas(max_align_t) Metadata
     { return sanity == SANITY_CHECK_VALUE; }
 #endif
 
-    Metadata(size_t = 0);
+    Metadata(size_t = 0, Domain = Domain::FLOW);
 
     static size_t calculate_total_size(size_t);
 
     template<typename Allocator>
-    static Metadata* create(size_t);
+    static Metadata* create(size_t, Domain = Domain::FLOW);
 
     static Metadata* extract(void*);
 };
 
+// with or without the sanity check, the header costs a single alignment unit
+static_assert(sizeof(Metadata) == alignof(max_align_t), "Metadata outgrew its alignment");
+
 inline size_t Metadata::total_size() const
 { return calculate_total_size(payload_size); }
 
 inline void* Metadata::payload_offset()
 { return this + 1; }
 
-inline Metadata::Metadata(size_t n) :
+inline Metadata::Metadata(size_t n, Domain d) :
+    payload_size(n),
 #if defined(REG_TEST) || defined(UNIT_TEST)
     sanity(SANITY_CHECK_VALUE),
 #endif
-    payload_size(n)
+    domain(d)
 { }
 
 inline size_t Metadata::calculate_total_size(size_t n)
 { return sizeof(Metadata) + n; }
 
 template<typename Allocator>
-Metadata* Metadata::create(size_t n)
+Metadata* Metadata::create(size_t n, Domain d)
 {
     auto meta =
         static_cast<Metadata*>(Allocator::allocate(calculate_total_size(n)));
@@ -98,7 +108,7 @@ Metadata* Metadata::create(size_t n)
         return nullptr;
 
     // Trigger metadata ctor
-    *meta = Metadata(n);
+    *meta = Metadata(n, d);
 
 #if defined(REG_TEST) || defined(UNIT_TEST)
     assert(meta->valid());
@@ -158,14 +168,16 @@ void* Interface<Allocator, Cap>::allocate(size_t n)
     ReentryContext reentry_context(in_allocation_call);
     assert(!reentry_context.is_reentry());
 
-    if ( !Cap::free_space(Metadata::calculate_total_size(n)) )
+    const Domain domain = DomainContext::get();
+
+    if ( !Cap::free_space(Metadata::calculate_total_size(n), domain) )
         return nullptr;
 
-    auto meta = Metadata::create<Allocator>(n);
+    auto meta = Metadata::create<Allocator>(n, domain);
     if ( !meta )
         return nullptr;
 
-    Cap::update_allocations(meta->total_size());
+    Cap::update_allocations(meta->total_size(), domain);
     return meta->payload_offset();
 }
 
@@ -178,13 +190,61 @@ void Interface<Allocator, Cap>::deallocate(void* p)
     auto meta = Metadata::extract(p);
     assert(meta);
 
-    Cap::update_deallocations(meta->total_size());
+    Cap::update_deallocations(meta->total_size(), meta->domain);
     Allocator::deallocate(meta);
 }
 
 template<typename Allocator, typename Cap>
 THREAD_LOCAL bool Interface<Allocator, Cap>::in_allocation_call = false;
 
+// small objects come from slabs without a header; larger ones and those of
+// threads that can't get a slab cache fall back to the Interface above
+
+template<typename Slabs = SlabAllocator, typename Cap = MemoryCap,
+    typename Fallback = Interface<MemoryAllocator, Cap>>
+struct SlabInterface
+{
+    static void* allocate(size_t);
+    static void deallocate(void*);
+
+    static THREAD_LOCAL bool in_allocation_call;
+};
+
+template<typename Slabs, typename Cap, typename Fallback>
+void* SlabInterface<Slabs, Cap, Fallback>::allocate(size_t n)
+{
+    if ( n > Slabs::MAX_OBJECT or !Slabs::usable() )
+        return Fallback::allocate(n);
+
+    ReentryContext reentry_context(in_allocation_call);
+    assert(!reentry_context.is_reentry());
+
+    auto p = Slabs::allocate(n);
+
+    if ( p )
+        Cap::update_object_allocations(Slabs::object_size(n));
+
+    return p;
+}
+
+template<typename Slabs, typename Cap, typename Fallback>
+void SlabInterface<Slabs, Cap, Fallback>::deallocate(void* p)
+{
+    if ( Slabs::owns(p) )
+        Cap::update_object_deallocations(Slabs::deallocate(p));
+    else
+        Fallback::deallocate(p);
+}
+
+template<typename Slabs, typename Cap, typename Fallback>
+THREAD_LOCAL bool SlabInterface<Slabs, Cap, Fallback>::in_allocation_call = false;
+
+#ifdef USE_SLAB_ALLOCATOR
+using DefaultInterface = SlabInterface<>;
+#else
+using DefaultInterface = Interface<>;
+#endif
+
 } //namespace memory
 
 // -----------------------------------------------------------------------------
@@ -195,7 +255,7 @@ THREAD_LOCAL bool Interface<Allocator, Cap>::in_allocation_call = false;
 
 void* operator new(size_t n)
 {
-    auto p = memory::Interface<>::allocate(n);
+    auto p = memory::DefaultInterface::allocate(n);
     if ( !p )
         throw std::bad_alloc();
 
@@ -203,10 +263,10 @@ void* operator new(size_t n)
 }
 
 void* operator new(size_t n, const std::nothrow_t&) noexcept
-{ return memory::Interface<>::allocate(n); }
+{ return memory::DefaultInterface::allocate(n); }
 
 void operator delete(void* p) noexcept
-{ memory::Interface<>::deallocate(p); }
+{ memory::DefaultInterface::deallocate(p); }
 
 void operator delete(void* p, const std::nothrow_t&) noexcept
 { ::operator delete(p); }
@@ -223,6 +283,12 @@ void operator delete[](void* p) noexcept
 void operator delete[](void* p, const std::nothrow_t&) noexcept
 { ::operator delete[](p); }
 
+void operator delete(void* p, size_t) noexcept
+{ ::operator delete(p); }
+
+void operator delete[](void* p, size_t) noexcept
+{ ::operator delete[](p); }
+
 // -----------------------------------------------------------------------------
 // unit tests
 // -----------------------------------------------------------------------------
@@ -264,25 +330,33 @@ void* AllocatorSpy::deallocate_arg = nullptr;
 
 struct CapSpy
 {
-    static bool free_space(size_t n)
+    static bool free_space(size_t n, memory::Domain)
     {
         free_space_called = true;
         free_space_arg = n;
         return free_space_result;
     }
 
-    static void update_allocations(size_t n)
+    static void update_allocations(size_t n, memory::Domain d)
     {
         update_allocations_called = true;
         update_allocations_arg = n;
+        update_domain_arg = d;
     }
 
-    static void update_deallocations(size_t n)
+    static void update_deallocations(size_t n, memory::Domain d)
     {
         update_deallocations_called = true;
         update_deallocations_arg = n;
+        update_domain_arg = d;
     }
 
+    static void update_object_allocations(size_t n)
+    { update_object_allocations_arg = n; }
+
+    static void update_object_deallocations(size_t n)
+    { update_object_deallocations_arg = n; }
+
     static void reset()
     {
         free_space_called = false;
@@ -294,6 +368,11 @@ struct CapSpy
 
         update_deallocations_called = false;
         update_deallocations_arg = 0;
+
+        update_object_allocations_arg = 0;
+        update_object_deallocations_arg = 0;
+
+        update_domain_arg = memory::Domain::MAX;
     }
 
     static bool free_space_called;
@@ -305,6 +384,11 @@ struct CapSpy
 
     static bool update_deallocations_called;
     static size_t update_deallocations_arg;
+
+    static size_t update_object_allocations_arg;
+    static size_t update_object_deallocations_arg;
+
+    static memory::Domain update_domain_arg;
 };
 
 bool CapSpy::free_space_called = false;
@@ -317,6 +401,66 @@ size_t CapSpy::update_allocations_arg = 0;
 bool CapSpy::update_deallocations_called = false;
 size_t CapSpy::update_deallocations_arg = 0;
 
+size_t CapSpy::update_object_allocations_arg = 0;
+size_t CapSpy::update_object_deallocations_arg = 0;
+
+memory::Domain CapSpy::update_domain_arg = memory::Domain::MAX;
+
+struct SlabSpy
+{
+    static constexpr size_t MAX_OBJECT = 64;
+
+    static bool usable()
+    { return usable_result; }
+
+    static bool owns(const void* p)
+    { return p == pool; }
+
+    static void* allocate(size_t)
+    { return pool; }
+
+    static size_t deallocate(void* p)
+    { deallocate_arg = p; return 64; }
+
+    static size_t object_size(size_t)
+    { return 48; }
+
+    static void reset()
+    {
+        usable_result = true;
+        deallocate_arg = nullptr;
+    }
+
+    static bool usable_result;
+    static char pool[64];
+    static void* deallocate_arg;
+};
+
+bool SlabSpy::usable_result = true;
+char SlabSpy::pool[64];
+void* SlabSpy::deallocate_arg = nullptr;
+
+struct FallbackSpy
+{
+    static void* allocate(size_t n)
+    { allocate_arg = n; return nullptr; }
+
+    static void deallocate(void* p)
+    { deallocate_arg = p; }
+
+    static void reset()
+    {
+        allocate_arg = 0;
+        deallocate_arg = nullptr;
+    }
+
+    static size_t allocate_arg;
+    static void* deallocate_arg;
+};
+
+size_t FallbackSpy::allocate_arg = 0;
+void* FallbackSpy::deallocate_arg = nullptr;
+
 } // namespace t_memory
 
 TEST_CASE( "memory metadata", "[memory]" )
@@ -413,6 +557,19 @@ TEST_CASE( "memory manager interface", "[memory]" )
 
             CHECK( CapSpy::update_allocations_called );
             CHECK( CapSpy::update_allocations_arg == memory::Metadata::calculate_total_size(n) );
+            CHECK( CapSpy::update_domain_arg == memory::Domain::FLOW );
+        }
+
+        SECTION( "domain" )
+        {
+            CapSpy::free_space_result = true;
+            AllocatorSpy::pool = pool;
+
+            memory::DomainContext context(memory::Domain::HTTP);
+            Interface::allocate(n);
+
+            CHECK( CapSpy::update_domain_arg == memory::Domain::HTTP );
+            CHECK( reinterpret_cast<memory::Metadata*>(pool)->domain == memory::Domain::HTTP );
         }
     }
 
@@ -440,6 +597,62 @@ TEST_CASE( "memory manager interface", "[memory]" )
             CHECK( CapSpy::update_deallocations_called );
             CHECK( CapSpy::update_deallocations_arg == memory::Metadata::calculate_total_size(n) );
         }
+
+        SECTION( "domain" )
+        {
+            // charged to the domain it was allocated in
+            auto meta_pool = reinterpret_cast<memory::Metadata*>(pool);
+            meta_pool[0] = memory::Metadata(n, memory::Domain::APPID);
+
+            Interface::deallocate(meta_pool[0].payload_offset());
+
+            CHECK( CapSpy::update_domain_arg == memory::Domain::APPID );
+        }
+    }
+}
+
+TEST_CASE( "memory manager slab interface", "[memory]" )
+{
+    using namespace t_memory;
+
+    SlabSpy::reset();
+    CapSpy::reset();
+    FallbackSpy::reset();
+
+    using Interface = memory::SlabInterface<SlabSpy, CapSpy, FallbackSpy>;
+
+    SECTION( "small object" )
+    {
+        CHECK( Interface::allocate(40) == SlabSpy::pool );
+        CHECK( CapSpy::update_object_allocations_arg == 48 );
+        CHECK( FallbackSpy::allocate_arg == 0 );
+
+        Interface::deallocate(SlabSpy::pool);
+        CHECK( SlabSpy::deallocate_arg == SlabSpy::pool );
+        CHECK( CapSpy::update_object_deallocations_arg == 64 );
+        CHECK( FallbackSpy::deallocate_arg == nullptr );
+    }
+
+    SECTION( "large object" )
+    {
+        CHECK( Interface::allocate(65) == nullptr );
+        CHECK( FallbackSpy::allocate_arg == 65 );
+        CHECK( CapSpy::update_object_allocations_arg == 0 );
+    }
+
+    SECTION( "no slab cache" )
+    {
+        SlabSpy::usable_result = false;
+        CHECK( Interface::allocate(8) == nullptr );
+        CHECK( FallbackSpy::allocate_arg == 8 );
+    }
+
+    SECTION( "foreign pointer" )
+    {
+        char c;
+        Interface::deallocate(&c);
+        CHECK( FallbackSpy::deallocate_arg == &c );
+        CHECK( SlabSpy::deallocate_arg == nullptr );
     }
 }
 
@@ -24,6 +24,9 @@
 
 #include "memory_module.h"
 
+#include <cstring>
+
+#include "log/messages.h"
 #include "main/snort_config.h"
 
 #include "memory_config.h"
@@ -36,6 +39,17 @@
 #define s_help \
     "memory management configuration"
 
+static const Parameter domain_params[] =
+{
+    { "domain", Parameter::PT_ENUM, "flow | reassembly | http | file | appid | detection",
+        nullptr, "memory consumer to cap" },
+
+    { "cap", Parameter::PT_INT, "0:", "0",
+        "set the per-packet-thread cap on this domain (bytes, 0 to disable)" },
+
+    { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
+};
+
 static const Parameter s_params[] =
 {
     { "cap", Parameter::PT_INT, "0:", "0",
@@ -48,6 +62,9 @@ static const Parameter s_params[] =
         "set the per-packet-thread threshold for preemptive cleanup actions "
         "(percent, 0 to disable)" },
 
+    { "domains", Parameter::PT_LIST, domain_params, nullptr,
+        "caps on individual consumers within the per-packet-thread cap" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -61,9 +78,15 @@ MemoryModule::MemoryModule() :
     Module(s_name, s_help, s_params)
 { }
 
-bool MemoryModule::set(const char*, Value& v, SnortConfig* sc)
+bool MemoryModule::set(const char* fqn, Value& v, SnortConfig* sc)
 {
-    if ( v.is("cap") )
+    if ( !strcmp(fqn, "memory.domains.domain") )
+        domain = (memory::Domain)v.get_long();
+
+    else if ( !strcmp(fqn, "memory.domains.cap") )
+        domain_cap = v.get_long();
+
+    else if ( v.is("cap") )
         sc->memory->cap = v.get_long();
 
     else if ( v.is("soft") )
@@ -78,9 +101,30 @@ bool MemoryModule::set(const char*, Value& v, SnortConfig* sc)
     return true;
 }
 
-bool MemoryModule::end(const char*, int, SnortConfig*)
+bool MemoryModule::begin(const char* fqn, int idx, SnortConfig*)
+{
+    if ( idx and !strcmp(fqn, "memory.domains") )
+    {
+        domain = memory::Domain::MAX;
+        domain_cap = 0;
+    }
+    return true;
+}
+
+bool MemoryModule::end(const char* fqn, int idx, SnortConfig* sc)
 {
-    configured = true;
+    if ( idx and !strcmp(fqn, "memory.domains") )
+    {
+        if ( domain == memory::Domain::MAX )
+        {
+            ParseError("memory.domains[%d] requires a domain", idx);
+            return false;
+        }
+        sc->memory->domain_caps[(unsigned)domain] = domain_cap;
+    }
+    else if ( !strcmp(fqn, "memory") )
+        configured = true;
+
     return true;
 }
 
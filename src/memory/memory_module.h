@@ -22,6 +22,7 @@
 #define MEMORY_MODULE_H
 
 #include "framework/module.h"
+#include "memory/memory_domain.h"
 
 class MemoryModule : public Module
 {
@@ -29,6 +30,7 @@ public:
     MemoryModule();
 
     bool set(const char*, Value&, SnortConfig*) override;
+    bool begin(const char*, int, SnortConfig*) override;
     bool end(const char*, int, SnortConfig*) override;
 
     Usage get_usage() const override
@@ -38,6 +40,9 @@ public:
 
 private:
     static bool configured;
+
+    memory::Domain domain = memory::Domain::MAX;
+    size_t domain_cap = 0;
 };
 
 #endif
@@ -29,9 +29,16 @@
 namespace memory
 {
 
-void prune_handler()
+void prune_handler(Domain d)
 {
-    Stream::prune_flows();
+    if ( !prune_domain(d) and !prune_domains() )
+        Stream::prune_flows();
+}
+
+void prune_domain_handler(Domain d)
+{
+    if ( !prune_domain(d) )
+        Stream::prune_flows();
 }
 
 } // namespace memory
@@ -21,10 +21,18 @@
 #ifndef PRUNE_HANDLER_H
 #define PRUNE_HANDLER_H
 
+#include "memory_domain.h"
+
 namespace memory
 {
 
-void prune_handler();
+// shed cached state, starting with the domain that needs the space, and
+// prune a flow only when there is none left
+void prune_handler(Domain);
+
+// the same for a domain over its own cap, which only its pruners or
+// pruning a flow can help
+void prune_domain_handler(Domain);
 
 }
 
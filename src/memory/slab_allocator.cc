@@ -0,0 +1,565 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// slab_allocator.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "slab_allocator.h"
+
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include <cassert>
+#include <mutex>
+#include <new>
+
+#include "memory_cap.h"
+#include "memory_domain.h"
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+namespace memory
+{
+
+// address space reserved for slabs; pages are only committed as slabs are
+// carved from it
+static constexpr size_t REGION_SIZE =
+    (size_t)(sizeof(void*) > 4 ? 1ull << 36 : 1ull << 28);
+
+// at most this many threads have caches at once; others use the heap
+static constexpr unsigned MAX_CACHES = 256;
+
+// free slabs kept resident for reuse; pages of the rest are returned
+static constexpr unsigned RETAINED_SLABS = 64;
+
+// each domain has its own slabs of each class
+static constexpr unsigned NUM_LISTS = NUM_DOMAINS * SlabAllocator::NUM_CLASSES;
+
+// -----------------------------------------------------------------------------
+// slabs
+// -----------------------------------------------------------------------------
+
+struct FreeObject
+{
+    FreeObject* next;
+};
+
+// everything but remote is only touched by the thread that owns the cache
+struct alignas(64) Slab
+{
+    Slab* next;
+    Slab* prev;
+    SlabCache* cache;
+    FreeObject* free;                  // returned by the owner
+    std::atomic<FreeObject*> remote;   // returned by other threads
+    char* bump;                        // start of space never handed out
+    uint32_t size;
+    uint32_t used;                     // objects not on free
+    uint8_t cls;
+    Domain domain;
+    bool full;
+
+    Slab(SlabCache*, unsigned, Domain);
+
+    unsigned list() const
+    { return (unsigned)domain * SlabAllocator::NUM_CLASSES + cls; }
+
+    void* pop();
+    void push(void*);
+    void push_remote(void*);
+    bool drain();
+};
+
+Slab::Slab(SlabCache* c, unsigned k, Domain d) :
+    next(nullptr), prev(nullptr), cache(c), free(nullptr), remote(nullptr),
+    bump((char*)(this + 1)), size(SlabAllocator::class_size(k)), used(0),
+    cls(k), domain(d), full(false)
+{ }
+
+inline void* Slab::pop()
+{
+    if ( FreeObject* p = free )
+    {
+        free = p->next;
+        ++used;
+        return p;
+    }
+    if ( bump + size <= (char*)this + SlabAllocator::SLAB_SIZE )
+    {
+        void* p = bump;
+        bump += size;
+        ++used;
+        return p;
+    }
+    return nullptr;
+}
+
+inline void Slab::push(void* v)
+{
+    FreeObject* p = (FreeObject*)v;
+    p->next = free;
+    free = p;
+    --used;
+}
+
+inline void Slab::push_remote(void* v)
+{
+    FreeObject* p = (FreeObject*)v;
+    p->next = remote.load(std::memory_order_relaxed);
+
+    while ( !remote.compare_exchange_weak(
+        p->next, p, std::memory_order_release, std::memory_order_relaxed) );
+}
+
+// take back objects returned by other threads
+bool Slab::drain()
+{
+    FreeObject* p = remote.exchange(nullptr, std::memory_order_acquire);
+
+    if ( !p )
+        return false;
+
+    FreeObject* tail = p;
+    unsigned n = 1;
+
+    while ( tail->next )
+    {
+        tail = tail->next;
+        ++n;
+    }
+    tail->next = free;
+    free = p;
+    used -= n;
+    return true;
+}
+
+static inline Slab* get_slab(void* p)
+{ return (Slab*)((uintptr_t)p & ~(uintptr_t)(SlabAllocator::SLAB_SIZE - 1)); }
+
+static inline void link(Slab*& head, Slab* s)
+{
+    s->prev = nullptr;
+    s->next = head;
+
+    if ( head )
+        head->prev = s;
+
+    head = s;
+}
+
+// behind the head so the slab being allocated from doesn't change and
+// emptied slabs can be released
+static inline void link_behind(Slab*& head, Slab* s)
+{
+    if ( !head )
+    {
+        link(head, s);
+        return;
+    }
+
+    s->prev = head;
+    s->next = head->next;
+
+    if ( head->next )
+        head->next->prev = s;
+
+    head->next = s;
+}
+
+static inline void unlink(Slab*& head, Slab* s)
+{
+    if ( s->prev )
+        s->prev->next = s->next;
+    else
+        head = s->next;
+
+    if ( s->next )
+        s->next->prev = s->prev;
+}
+
+// -----------------------------------------------------------------------------
+// caches
+// -----------------------------------------------------------------------------
+
+// a cache outlives its thread and is handed to the next thread that needs
+// one so that objects still out and the frees of other threads always have
+// somewhere to go
+struct SlabCache
+{
+    Slab* partial[NUM_LISTS];  // head is allocated from
+    Slab* full[NUM_LISTS];
+    std::atomic<bool> remote[NUM_LISTS];
+    size_t slabs[NUM_DOMAINS];
+    bool attached;
+};
+
+// these are all constant initialized so they work before and after the
+// dynamic initialization of other statics
+static std::mutex s_lock;
+static SlabCache s_caches[MAX_CACHES];
+static unsigned s_num_caches = 0;
+
+static char* s_next = nullptr;
+static char* s_limit = nullptr;
+static bool s_reserve_failed = false;
+static pthread_key_t s_key;
+
+static Slab* s_free_slabs = nullptr;
+static unsigned s_num_free_slabs = 0;
+
+constexpr size_t SlabAllocator::SLAB_SIZE;
+constexpr size_t SlabAllocator::MAX_OBJECT;
+constexpr unsigned SlabAllocator::NUM_CLASSES;
+
+std::atomic<uintptr_t> SlabAllocator::region_base { 0 };
+std::atomic<size_t> SlabAllocator::region_size { 0 };
+
+THREAD_LOCAL SlabCache* SlabAllocator::t_cache = nullptr;
+THREAD_LOCAL bool SlabAllocator::t_unusable = false;
+
+// call with s_lock held
+bool SlabAllocator::reserve()
+{
+    if ( s_limit )
+        return true;
+
+    if ( s_reserve_failed )
+        return false;
+
+    s_reserve_failed = true;
+
+    const size_t len = REGION_SIZE + SLAB_SIZE;
+    void* p = mmap(nullptr, len, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if ( p == MAP_FAILED )
+        return false;
+
+    if ( pthread_key_create(&s_key, detach) )
+    {
+        munmap(p, len);
+        return false;
+    }
+
+    const uintptr_t mask = SLAB_SIZE - 1;
+    s_next = (char*)(((uintptr_t)p + mask) & ~mask);
+    s_limit = s_next + REGION_SIZE;
+    s_reserve_failed = false;
+
+    region_base.store((uintptr_t)s_next, std::memory_order_relaxed);
+    region_size.store(REGION_SIZE, std::memory_order_release);
+    return true;
+}
+
+static void* take_slab()
+{
+    std::lock_guard<std::mutex> lock(s_lock);
+
+    if ( Slab* s = s_free_slabs )
+    {
+        s_free_slabs = s->next;
+        --s_num_free_slabs;
+        return s;
+    }
+
+    if ( s_next == s_limit )
+        return nullptr;
+
+    if ( mprotect(s_next, SlabAllocator::SLAB_SIZE, PROT_READ | PROT_WRITE) )
+        return nullptr;
+
+    void* p = s_next;
+    s_next += SlabAllocator::SLAB_SIZE;
+    return p;
+}
+
+static void give_slab(Slab* s)
+{
+    bool retain;
+    {
+        std::lock_guard<std::mutex> lock(s_lock);
+        retain = s_num_free_slabs < RETAINED_SLABS;
+    }
+
+    if ( !retain )
+        madvise(s, SlabAllocator::SLAB_SIZE, MADV_DONTNEED);
+
+    std::lock_guard<std::mutex> lock(s_lock);
+    s->next = s_free_slabs;
+    s_free_slabs = s;
+    ++s_num_free_slabs;
+}
+
+static void release(SlabCache& cache, Slab* s)
+{
+    if ( s->full )
+        unlink(cache.full[s->list()], s);
+    else
+        unlink(cache.partial[s->list()], s);
+
+    --cache.slabs[(unsigned)s->domain];
+    MemoryCap::update_slab_deallocations(SlabAllocator::SLAB_SIZE, s->domain);
+    give_slab(s);
+}
+
+static void* find(SlabCache& cache, unsigned k)
+{
+    while ( Slab* s = cache.partial[k] )
+    {
+        if ( void* p = s->pop() )
+            return p;
+
+        if ( s->drain() )
+            continue;
+
+        unlink(cache.partial[k], s);
+        s->full = true;
+        link(cache.full[k], s);
+    }
+    return nullptr;
+}
+
+// move full slabs that other threads have returned objects to back to the
+// partial list
+static void reclaim(SlabCache& cache, unsigned k)
+{
+    if ( !cache.remote[k].exchange(false, std::memory_order_acquire) )
+        return;
+
+    Slab* s = cache.full[k];
+
+    while ( s )
+    {
+        Slab* next = s->next;
+
+        if ( s->drain() )
+        {
+            if ( !s->used )
+                release(cache, s);
+
+            else
+            {
+                unlink(cache.full[k], s);
+                s->full = false;
+                link_behind(cache.partial[k], s);
+            }
+        }
+        s = next;
+    }
+}
+
+// take back everything other threads have returned and give up every empty
+// slab, including those at the head of a partial list, so a cache without
+// a thread doesn't sit on slabs that others could use
+static void trim(SlabCache& cache)
+{
+    for ( unsigned k = 0; k < NUM_LISTS; ++k )
+    {
+        // frees that land after this are flagged again for reclaim
+        cache.remote[k].store(false, std::memory_order_release);
+
+        Slab* s = cache.full[k];
+
+        while ( s )
+        {
+            Slab* next = s->next;
+
+            if ( s->drain() )
+            {
+                unlink(cache.full[k], s);
+                s->full = false;
+                link(cache.partial[k], s);
+            }
+            s = next;
+        }
+
+        s = cache.partial[k];
+
+        while ( s )
+        {
+            Slab* next = s->next;
+            s->drain();
+
+            if ( !s->used )
+                release(cache, s);
+
+            s = next;
+        }
+    }
+}
+
+static void* refill(SlabCache& cache, unsigned c, Domain d)
+{
+    const unsigned k = (unsigned)d * SlabAllocator::NUM_CLASSES + c;
+    reclaim(cache, k);
+
+    if ( void* p = find(cache, k) )
+        return p;
+
+    if ( !MemoryCap::free_space(SlabAllocator::SLAB_SIZE, d) )
+    {
+        // pruning may have returned objects without returning a slab
+        reclaim(cache, k);
+        return find(cache, k);
+    }
+
+    void* mem = take_slab();
+
+    if ( !mem )
+        return nullptr;
+
+    Slab* s = new(mem) Slab(&cache, c, d);
+    link(cache.partial[k], s);
+    ++cache.slabs[(unsigned)d];
+    MemoryCap::update_slab_allocations(SlabAllocator::SLAB_SIZE, d);
+
+    return s->pop();
+}
+
+// -----------------------------------------------------------------------------
+// public interface
+// -----------------------------------------------------------------------------
+
+void* SlabAllocator::allocate(size_t n)
+{
+    assert(t_cache and n <= MAX_OBJECT);
+    const unsigned c = size_class(n);
+    const Domain d = DomainContext::get();
+
+    if ( Slab* s = t_cache->partial[(unsigned)d * NUM_CLASSES + c] )
+    {
+        if ( void* p = s->pop() )
+            return p;
+    }
+    return refill(*t_cache, c, d);
+}
+
+size_t SlabAllocator::deallocate(void* p)
+{
+    assert(owns(p));
+
+    Slab* s = get_slab(p);
+    SlabCache* cache = s->cache;
+    const unsigned k = s->list();
+    const size_t size = s->size;
+
+    if ( cache != t_cache )
+    {
+        // the slab may be reused as soon as this is pushed
+        s->push_remote(p);
+        cache->remote[k].store(true, std::memory_order_release);
+        return size;
+    }
+
+    s->push(p);
+
+    if ( s->full )
+    {
+        unlink(cache->full[k], s);
+        s->full = false;
+        link_behind(cache->partial[k], s);
+    }
+    else if ( !s->used and s != cache->partial[k] )
+        release(*cache, s);
+
+    return size;
+}
+
+size_t SlabAllocator::get_slabs()
+{
+    size_t n = 0;
+
+    if ( t_cache )
+    {
+        for ( auto slabs : t_cache->slabs )
+            n += slabs;
+    }
+    return n;
+}
+
+bool SlabAllocator::attach()
+{
+    if ( t_unusable )
+        return false;
+
+    SlabCache* cache = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(s_lock);
+
+        if ( reserve() )
+        {
+            for ( unsigned i = 0; i < s_num_caches and !cache; ++i )
+            {
+                if ( !s_caches[i].attached )
+                    cache = s_caches + i;
+            }
+            if ( !cache and s_num_caches < MAX_CACHES )
+                cache = s_caches + s_num_caches++;
+
+            if ( cache )
+                cache->attached = true;
+        }
+    }
+
+    if ( !cache )
+    {
+        t_unusable = true;
+        return false;
+    }
+
+    t_cache = cache;
+    pthread_setspecific(s_key, cache);
+
+    // take over the charge for slabs left by a previous thread and drop
+    // those emptied by other threads since
+    for ( unsigned i = 0; i < NUM_DOMAINS; ++i )
+        MemoryCap::update_slab_allocations(cache->slabs[i] * SLAB_SIZE, (Domain)i);
+
+    trim(*cache);
+    return true;
+}
+
+// called at thread exit; the cache keeps its slabs with live objects for
+// the next thread
+void SlabAllocator::detach(void* p)
+{
+    SlabCache* cache = (SlabCache*)p;
+    trim(*cache);
+
+    for ( unsigned i = 0; i < NUM_DOMAINS; ++i )
+        MemoryCap::update_slab_deallocations(cache->slabs[i] * SLAB_SIZE, (Domain)i);
+
+    // destructors that run after this one must not attach another cache
+    // because nothing would detach it
+    t_cache = nullptr;
+    t_unusable = true;
+
+    std::lock_guard<std::mutex> lock(s_lock);
+    cache->attached = false;
+}
+
+} // namespace memory
+
@@ -0,0 +1,106 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// slab_allocator.h
+
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+// SlabAllocator serves small objects from per-thread caches of slabs.
+// objects carry no header; the slab is found by masking the object
+// address and holds the size class and owning cache.  the memory cap is
+// charged when a thread takes or returns a whole slab rather than on each
+// object.  see dev_notes.txt.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "main/thread.h"
+
+namespace memory
+{
+
+struct SlabCache;
+
+class SlabAllocator
+{
+public:
+    static constexpr size_t SLAB_SIZE = 64 * 1024;
+    static constexpr size_t MAX_OBJECT = 2048;
+    static constexpr unsigned NUM_CLASSES = 24;
+
+    // true if this thread has a cache, attaching one if needed
+    static bool usable()
+    { return t_cache or attach(); }
+
+    static bool owns(const void* p)
+    {
+        // size is published after base
+        size_t size = region_size.load(std::memory_order_acquire);
+        uintptr_t base = region_base.load(std::memory_order_relaxed);
+        return (uintptr_t)p - base < size;
+    }
+
+    // nullptr if the cap can't cover another slab
+    static void* allocate(size_t);
+
+    // returns the size of the object's class
+    static size_t deallocate(void*);
+
+    static unsigned size_class(size_t n)
+    {
+        if ( n <= 128 )
+            return n ? (n - 1) >> 4 : 0;
+
+        // 4 classes for each power of 2 above 128
+        unsigned b = 63 - __builtin_clzll(n - 1);
+        return 8 + (b - 7) * 4 + (((n - 1) >> (b - 2)) & 3);
+    }
+
+    static size_t class_size(unsigned c)
+    {
+        if ( c < 8 )
+            return (c + 1) << 4;
+
+        c -= 8;
+        return (size_t)(5 + (c & 3)) << (c / 4 + 5);
+    }
+
+    static size_t object_size(size_t n)
+    { return class_size(size_class(n)); }
+
+    // slabs held by this thread's cache
+    static size_t get_slabs();
+
+private:
+    static bool reserve();
+    static bool attach();
+    static void detach(void*);
+
+    static std::atomic<uintptr_t> region_base;
+    static std::atomic<size_t> region_size;
+
+    static THREAD_LOCAL SlabCache* t_cache;
+    static THREAD_LOCAL bool t_unusable;
+};
+
+} // namespace memory
+
+#endif
+
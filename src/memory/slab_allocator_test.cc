@@ -0,0 +1,184 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// slab_allocator_test.cc checks size classes, slab reuse and release, and
+// objects returned by other threads
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <thread>
+#include <vector>
+
+#include "catch/snort_catch.h"
+
+#include "memory_domain.h"
+#include "slab_allocator.h"
+
+SNORT_FORCED_INCLUSION_DEFINITION(slab_allocator_test);
+
+using namespace memory;
+
+// objects of the largest class per slab
+static constexpr unsigned PER_SLAB = SlabAllocator::SLAB_SIZE / SlabAllocator::MAX_OBJECT - 1;
+
+TEST_CASE("slab size classes", "[memory]")
+{
+    CHECK(SlabAllocator::size_class(0) == 0);
+    CHECK(SlabAllocator::size_class(SlabAllocator::MAX_OBJECT) == SlabAllocator::NUM_CLASSES - 1);
+    CHECK(SlabAllocator::class_size(SlabAllocator::NUM_CLASSES - 1) == SlabAllocator::MAX_OBJECT);
+
+    for ( size_t n = 1; n <= SlabAllocator::MAX_OBJECT; ++n )
+    {
+        unsigned c = SlabAllocator::size_class(n);
+        size_t size = SlabAllocator::class_size(c);
+
+        // smallest class that fits, aligned for any type
+        CHECK(size >= n);
+        CHECK((c == 0 or SlabAllocator::class_size(c - 1) < n));
+        CHECK(size % 16 == 0);
+
+        // no more than 25% waste above 128 bytes
+        CHECK((n <= 128 or size - n < n / 4));
+    }
+}
+
+TEST_CASE("slab reuse", "[memory]")
+{
+    REQUIRE(SlabAllocator::usable());
+
+    void* p = SlabAllocator::allocate(100);
+    size_t size = SlabAllocator::deallocate(p);
+    void* q = SlabAllocator::allocate(100);
+
+    CHECK(size == 112);
+    CHECK(q == p);
+    CHECK(SlabAllocator::owns(p));
+    CHECK((uintptr_t)p % 16 == 0);
+
+    SlabAllocator::deallocate(q);
+
+    char c;
+    CHECK(!SlabAllocator::owns(&c));
+    CHECK(!SlabAllocator::owns(nullptr));
+}
+
+TEST_CASE("slab growth and release", "[memory]")
+{
+    REQUIRE(SlabAllocator::usable());
+
+    std::vector<void*> v;
+    v.reserve(3 * PER_SLAB);
+
+    size_t slabs = SlabAllocator::get_slabs();
+
+    for ( unsigned i = 0; i < 3 * PER_SLAB; ++i )
+        v.push_back(SlabAllocator::allocate(SlabAllocator::MAX_OBJECT));
+
+    CHECK(SlabAllocator::get_slabs() >= slabs + 2);
+
+    // all but the slab being allocated from go back
+    for ( auto p : v )
+        SlabAllocator::deallocate(p);
+
+    CHECK(SlabAllocator::get_slabs() <= slabs + 1);
+}
+
+TEST_CASE("slab remote free", "[memory]")
+{
+    REQUIRE(SlabAllocator::usable());
+
+    std::vector<void*> v;
+    v.reserve(3 * PER_SLAB);
+
+    for ( unsigned i = 0; i < 3 * PER_SLAB; ++i )
+        v.push_back(SlabAllocator::allocate(SlabAllocator::MAX_OBJECT));
+
+    size_t slabs = SlabAllocator::get_slabs();
+
+    std::thread t([&v]()
+    {
+        for ( auto p : v )
+            SlabAllocator::deallocate(p);
+    });
+    t.join();
+
+    // the owner gets them back instead of taking more slabs
+    for ( unsigned i = 0; i < 3 * PER_SLAB; ++i )
+        v[i] = SlabAllocator::allocate(SlabAllocator::MAX_OBJECT);
+
+    CHECK(SlabAllocator::get_slabs() <= slabs);
+
+    for ( auto p : v )
+        SlabAllocator::deallocate(p);
+}
+
+TEST_CASE("slab cache handoff", "[memory]")
+{
+    REQUIRE(SlabAllocator::usable());
+
+    std::vector<void*> v;
+    v.reserve(3 * PER_SLAB);
+
+    std::thread a([&v]()
+    {
+        REQUIRE(SlabAllocator::usable());
+
+        for ( unsigned i = 0; i < 3 * PER_SLAB; ++i )
+            v.push_back(SlabAllocator::allocate(SlabAllocator::MAX_OBJECT));
+    });
+    a.join();
+
+    // returned to a cache that has no thread
+    for ( auto p : v )
+        SlabAllocator::deallocate(p);
+
+    size_t slabs = 0;
+
+    std::thread b([&slabs]()
+    {
+        REQUIRE(SlabAllocator::usable());
+        slabs = SlabAllocator::get_slabs();
+    });
+    b.join();
+
+    // the emptied slabs were given back rather than handed over
+    CHECK(slabs < 3);
+}
+
+TEST_CASE("slab domains", "[memory]")
+{
+    REQUIRE(SlabAllocator::usable());
+
+    void* p = SlabAllocator::allocate(100);
+    void* q;
+    {
+        DomainContext dc(Domain::HTTP);
+        q = SlabAllocator::allocate(100);
+    }
+    void* r = SlabAllocator::allocate(100);
+
+    // domains never share a slab
+    CHECK(((uintptr_t)p ^ (uintptr_t)q) >= SlabAllocator::SLAB_SIZE);
+    CHECK(((uintptr_t)p ^ (uintptr_t)r) < SlabAllocator::SLAB_SIZE);
+
+    SlabAllocator::deallocate(p);
+    SlabAllocator::deallocate(q);
+    SlabAllocator::deallocate(r);
+}
+
@@ -24,9 +24,6 @@
 
 #include "decode_qp.h"
 
-#include <cctype>
-#include <cstdlib>
-
 #include "utils/util_unfold.h"
 
 #include "decode_buffer.h"
@@ -97,77 +94,101 @@ QPDecode::~QPDecode()
         delete buffer;
 }
 
+/* Character classes for decoding. Printable characters, blanks and line
+ * breaks are copied as is and anything else except '=' is dropped. Hex
+ * digits map to their value and everything else to 0xff. These match the
+ * C locale ctype functions. */
+struct QPTables
+{
+    bool copy[256];
+    uint8_t hex[256];
+
+    QPTables()
+    {
+        for (int c = 0; c < 256; c++)
+        {
+            copy[c] = (c >= 0x20 and c < 0x7f) or c == '\t' or c == '\r' or c == '\n';
+
+            if (c >= '0' and c <= '9')
+                hex[c] = c - '0';
+            else if (c >= 'a' and c <= 'f')
+                hex[c] = c - 'a' + 10;
+            else if (c >= 'A' and c <= 'F')
+                hex[c] = c - 'A' + 10;
+            else
+                hex[c] = 0xff;
+        }
+        copy[(int)'='] = false;
+    }
+};
+
+static const QPTables qp_tables;
+
 int sf_qpdecode(const char* src, uint32_t slen, char* dst, uint32_t dlen, uint32_t* bytes_read,
     uint32_t* bytes_copied)
 {
     if (!src || !slen || !dst || !dlen || !bytes_read || !bytes_copied )
         return -1;
 
-    *bytes_read = 0;
-    *bytes_copied = 0;
+    const uint8_t* in = (const uint8_t*)src;
+    uint32_t read = 0;
+    uint32_t copied = 0;
 
-    while ( (*bytes_read < slen) && (*bytes_copied < dlen))
+    while ( (read < slen) && (copied < dlen))
     {
-        char ch = src[*bytes_read];
-        *bytes_read += 1;
+        uint8_t ch = in[read++];
 
-        if ( ch == '=' )
+        if ( ch != '=' )
         {
-            if ( (*bytes_read < slen))
-            {
-                if (src[*bytes_read] == '\n')
-                {
-                    *bytes_read += 1;
-                    continue;
-                }
-                else if ( *bytes_read < (slen - 1) )
-                {
-                    char ch1 = src[*bytes_read];
-                    char ch2 = src[*bytes_read + 1];
-                    if ( ch1 == '\r' && ch2 == '\n')
-                    {
-                        *bytes_read += 2;
-                        continue;
-                    }
-                    if (isxdigit((int)ch1) && isxdigit((int)ch2))
-                    {
-                        char hexBuf[3];
-                        char* eptr;
-                        hexBuf[0] = ch1;
-                        hexBuf[1] = ch2;
-                        hexBuf[2] = '\0';
-                        dst[*bytes_copied]= (char)strtoul(hexBuf, &eptr, 16);
-                        if ((*eptr != '\0'))
-                        {
-                            return -1;
-                        }
-                        *bytes_read += 2;
-                        *bytes_copied +=1;
-                        continue;
-                    }
-                    dst[*bytes_copied] = ch;
-                    *bytes_copied +=1;
-                    continue;
-                }
-                else
-                {
-                    *bytes_read -= 1;
-                    return 0;
-                }
-            }
-            else
-            {
-                *bytes_read -= 1;
-                return 0;
-            }
+            if ( qp_tables.copy[ch] )
+                dst[copied++] = ch;
+            continue;
         }
-        else if ( isprint(ch) || isblank(ch) || ch == '\r' || ch == '\n' )
+
+        /* Wait for the rest of an escape that is split across buffers */
+        if ( read >= slen )
         {
-            dst[*bytes_copied] = ch;
-            *bytes_copied +=1;
+            read--;
+            break;
         }
+
+        /* Soft line break */
+        if ( in[read] == '\n' )
+        {
+            read++;
+            continue;
+        }
+
+        if ( read >= slen - 1 )
+        {
+            read--;
+            break;
+        }
+
+        uint8_t ch1 = in[read];
+        uint8_t ch2 = in[read + 1];
+
+        if ( ch1 == '\r' && ch2 == '\n')
+        {
+            read += 2;
+            continue;
+        }
+
+        uint8_t hi = qp_tables.hex[ch1];
+        uint8_t lo = qp_tables.hex[ch2];
+
+        if ( (hi | lo) < 16 )
+        {
+            dst[copied++] = (char)((hi << 4) | lo);
+            read += 2;
+            continue;
+        }
+
+        dst[copied++] = ch;
     }
 
+    *bytes_read = read;
+    *bytes_copied = copied;
     return 0;
 }
 
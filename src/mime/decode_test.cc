@@ -0,0 +1,233 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// decode_test.cc checks the base64 and quoted-printable decoders against
+// encoded attachments and times them on attachment sized data
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "catch/snort_catch.h"
+#include "helpers/base64_encoder.h"
+
+#include "decode_b64.h"
+#include "decode_qp.h"
+
+SNORT_FORCED_INCLUSION_DEFINITION(decode_test);
+
+static std::vector<uint8_t> make_data(unsigned len)
+{
+    std::vector<uint8_t> v(len);
+
+    for ( auto& b : v )
+        b = rand();
+
+    return v;
+}
+
+// base64 the way it appears in a mail body: lines of 76 followed by CRLF
+static std::string encode(const std::vector<uint8_t>& data, bool lines = true)
+{
+    std::vector<char> buf(2 * data.size() + 8);
+    Base64Encoder b64;
+
+    unsigned n = b64.encode(data.data(), data.size(), buf.data());
+    n += b64.finish(buf.data() + n);
+
+    std::string s(buf.data(), n);
+
+    if ( !lines )
+        return s;
+
+    std::string text;
+
+    for ( unsigned i = 0; i < s.size(); i += 76 )
+        text += s.substr(i, 76) + "\r\n";
+
+    return text;
+}
+
+static uint32_t b64(const std::string& s, uint8_t* out, uint32_t size, int& ret)
+{
+    uint32_t n = 0;
+    ret = sf_base64decode((uint8_t*)s.data(), s.size(), out, size, &n);
+    return n;
+}
+
+TEST_CASE("base64 round trip", "[decode]")
+{
+    srand(1);
+
+    for ( unsigned len = 0; len < 300; ++len )
+    {
+        std::vector<uint8_t> data = make_data(len);
+        std::vector<uint8_t> out(len + 32);
+        int ret;
+
+        for ( bool lines : { false, true } )
+        {
+            CHECK(b64(encode(data, lines), out.data(), out.size(), ret) == len);
+            CHECK(ret == 0);
+            CHECK(!memcmp(out.data(), data.data(), len));
+        }
+    }
+}
+
+TEST_CASE("base64 output limit", "[decode]")
+{
+    srand(2);
+    std::vector<uint8_t> data = make_data(1000);
+    std::string text = encode(data);
+
+    // nothing may be written past the limit
+    for ( unsigned size = 1; size < 200; ++size )
+    {
+        std::vector<uint8_t> out(size + 32, 0xa5);
+        int ret;
+
+        CHECK(b64(text, out.data(), size, ret) == size);
+        CHECK(!memcmp(out.data(), data.data(), size));
+
+        for ( unsigned i = size; i < out.size(); ++i )
+            CHECK(out[i] == 0xa5);
+    }
+}
+
+TEST_CASE("base64 padding and junk", "[decode]")
+{
+    uint8_t out[256];
+    int ret;
+
+    CHECK(b64("=AAA", out, sizeof(out), ret) == 0);
+    CHECK(ret == -1);
+
+    CHECK(b64("dGVzdDAxCg==", out, sizeof(out), ret) == 7);
+    CHECK(!memcmp(out, "test01\n", 7));
+
+    // decoding stops at padding
+    CHECK(b64("dGVzdDAxCg==dGVzdDAxCg==", out, sizeof(out), ret) == 7);
+
+    // junk in the middle of a long run is skipped
+    std::string text = "VGhlIHF1aWNrIGJyb3duIHNlZ21lbnQg*anVtcGVkIG92ZXIgdGhlIGxhenkgZG9ncy4K";
+    const char* plain = "The quick brown segment jumped over the lazy dogs.\n";
+
+    CHECK(b64(text, out, sizeof(out), ret) == strlen(plain));
+    CHECK(!memcmp(out, plain, strlen(plain)));
+}
+
+TEST_CASE("base64 depth", "[decode]")
+{
+    srand(3);
+    std::vector<uint8_t> data = make_data(3000);
+    std::string text = encode(data);
+
+    B64Decode dd(400, 100);
+    unsigned total = 0;
+    DecodeResult ret;
+
+    const uint8_t* p = (const uint8_t*)text.data();
+    const uint8_t* end = p + text.size();
+
+    do
+    {
+        const uint8_t* q = (end - p > 128) ? p + 128 : end;
+        ret = dd.decode_data(p, q);
+
+        if ( ret == DECODE_SUCCESS )
+        {
+            const uint8_t* buf;
+            uint32_t size;
+
+            if ( dd.get_decoded_data(&buf, &size) )
+            {
+                CHECK(!memcmp(buf, data.data() + total, size));
+                total += size;
+            }
+            CHECK(dd.get_detection_depth() <= 100);
+        }
+        p = q;
+    }
+    while ( ret == DECODE_SUCCESS and p < end );
+
+    // 400 characters of encoded text make 300 bytes
+    CHECK(ret == DECODE_EXCEEDED);
+    CHECK(total == 300);
+}
+
+TEST_CASE("quoted-printable", "[decode]")
+{
+    char out[64];
+    uint32_t read, copied;
+
+    const char* text = "a=3Db=\r\nc=\nd=e2=82=AC=zz\x01!";
+    CHECK(sf_qpdecode(text, strlen(text), out, sizeof(out), &read, &copied) == 0);
+    CHECK(read == strlen(text));
+    CHECK(copied == 12);
+    CHECK(!memcmp(out, "a=bcd\xe2\x82\xac=zz!", 12));
+
+    // an escape split across buffers is left for the next one
+    text = "abc=4";
+    CHECK(sf_qpdecode(text, strlen(text), out, sizeof(out), &read, &copied) == 0);
+    CHECK(read == 3);
+    CHECK(copied == 3);
+}
+
+TEST_CASE("decode benchmarks", "[decode][!benchmark]")
+{
+    srand(4);
+    std::vector<uint8_t> data = make_data(65536);
+    std::string text = encode(data);
+    std::vector<uint8_t> out(data.size());
+    int ret;
+
+    // mostly text with some escaped bytes and soft breaks
+    std::string qp;
+
+    for ( unsigned i = 0; qp.size() < 65536; ++i )
+    {
+        qp += (i % 16) ? (char)('a' + i % 26) : '=';
+
+        if ( !(i % 16) )
+            qp += "C3";
+
+        if ( !(i % 70) )
+            qp += "=\r\n";
+    }
+    uint32_t read, copied;
+    volatile unsigned sink = 0;
+
+    BENCHMARK("base64 64K")
+    {
+        for ( int i = 0; i < 100; ++i )
+            sink += b64(text, out.data(), out.size(), ret);
+    }
+    BENCHMARK("quoted-printable 64K")
+    {
+        for ( int i = 0; i < 100; ++i )
+        {
+            sf_qpdecode(qp.data(), qp.size(), (char*)out.data(), out.size(), &read, &copied);
+            sink += copied;
+        }
+    }
+}
+
@@ -85,6 +85,7 @@ class AppIdSession;
 #define APPID_SESSION_OOO_LOGGED            (1ULL << 41)
 #define APPID_SESSION_TPI_OOO_LOGGED        (1ULL << 42)
 #define APPID_SESSION_EXPECTED_EVALUATE     (1ULL << 43)
+#define APPID_SESSION_FAST_PATH             (1ULL << 44)
 #define APPID_SESSION_IGNORE_ID_FLAGS \
     (APPID_SESSION_IGNORE_FLOW | \
     APPID_SESSION_NOT_A_SERVICE | \
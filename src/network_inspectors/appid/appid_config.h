@@ -28,6 +28,7 @@
 #include "framework/decode_data.h"
 #include "protocols/ipv6.h"
 #include "sfip/sf_ip.h"
+#include "time/clock_defs.h"
 #include "utils/sflsq.h"
 
 #define APP_ID_MAX_DIRS         16
@@ -88,6 +89,7 @@ public:
     uint32_t memcap = 0;
     bool debug = false;
     bool dump_ports = false;
+    hr_duration lua_detector_budget = 0_ticks;
     AppIdSessionLogFilter session_log_filter;
 
     bool safe_search_enabled = true;
@@ -45,13 +45,27 @@
 #include "log/messages.h"
 #include "protocols/packet.h"
 #include "protocols/tcp.h"
+#include "utils/stats.h"
+
+THREAD_LOCAL SearchTool* AppIdDiscovery::tcp_patterns = nullptr;
+THREAD_LOCAL SearchTool* AppIdDiscovery::udp_patterns = nullptr;
+
+// the first of service and client discovery to look at a packet scans it and
+// the other one gets the cached hits
+struct PatternScan
+{
+    AppIdPatternMatches matches;
+    PegCount packet = 0;
+    const uint8_t* data = nullptr;
+    uint16_t dsize = 0;
+    IpProtocol proto = IpProtocol::PROTO_NOT_SET;
+};
+
+static THREAD_LOCAL PatternScan* last_scan = nullptr;
 
 AppIdDiscovery::AppIdDiscovery(AppIdInspector& ins)
     : inspector(ins)
-{
-    tcp_patterns = new SearchTool("ac_full", true);
-    udp_patterns = new SearchTool("ac_full", true);
-}
+{ }
 
 AppIdDiscovery::~AppIdDiscovery()
 {
@@ -60,9 +74,6 @@ AppIdDiscovery::~AppIdDiscovery()
 
     pattern_data.clear();
 
-    delete tcp_patterns;
-    delete udp_patterns;
-
     for ( auto kv : tcp_detectors )
         delete kv.second;
 
@@ -72,22 +83,64 @@ AppIdDiscovery::~AppIdDiscovery()
 
 void AppIdDiscovery::initialize_plugins(AppIdInspector* ins)
 {
+    tcp_patterns = new SearchTool("ac_full", true);
+    udp_patterns = new SearchTool("ac_full", true);
+    last_scan = new PatternScan;
+
     ServiceDiscovery::get_instance(ins);
     ClientDiscovery::get_instance(ins);
 }
 
 void AppIdDiscovery::finalize_plugins()
 {
-    ServiceDiscovery::get_instance().finalize_service_patterns();
-    ClientDiscovery::get_instance().finalize_client_plugins();
+    tcp_patterns->prep();
+    udp_patterns->prep();
 }
 
 void AppIdDiscovery::release_plugins()
 {
     delete &ServiceDiscovery::get_instance();
     delete &ClientDiscovery::get_instance();
+
+    delete tcp_patterns;
+    delete udp_patterns;
+    delete last_scan;
+
+    tcp_patterns = udp_patterns = nullptr;
+    last_scan = nullptr;
+}
+
+static int pattern_match(void* id, void*, int match_end_pos, void* data, void*)
+{
+    AppIdPatternMatches* matches = (AppIdPatternMatches*)data;
+    const AppIdPatternMatchNode* pd = (AppIdPatternMatchNode*)id;
+
+    if ( pd->valid_match(match_end_pos) )
+        matches->push_back(pd);
+
+    return 0;
 }
 
+const AppIdPatternMatches& AppIdDiscovery::match_patterns(const Packet* p, IpProtocol proto)
+{
+    PatternScan& scan = *last_scan;
+    PegCount packet = get_packet_number();
+
+    if ( scan.packet != packet or scan.data != p->data or scan.dsize != p->dsize or
+        scan.proto != proto )
+    {
+        SearchTool* patterns = (proto == IpProtocol::TCP) ? tcp_patterns : udp_patterns;
+
+        scan.matches.clear();
+        patterns->find_all((const char*)p->data, p->dsize, &pattern_match, false, &scan.matches);
+
+        scan.packet = packet;
+        scan.data = p->data;
+        scan.dsize = p->dsize;
+        scan.proto = proto;
+    }
+    return scan.matches;
+}
 
 void AppIdDiscovery::register_detector(const std::string& name, AppIdDetector* cd,  IpProtocol proto)
 {
@@ -553,7 +606,8 @@ static uint64_t is_session_monitored(const Packet* p, int dir, AppIdInspector& i
     return flow_flags;
 }
 
-static void lookup_appid_by_host_port(AppIdSession& asd, Packet* p, IpProtocol protocol,
+// returns true if the service was decided and there is nothing left to discover
+static bool lookup_appid_by_host_port(AppIdSession& asd, Packet* p, IpProtocol protocol,
     int direction)
 {
     HostPortVal* hv = nullptr;
@@ -591,6 +645,79 @@ static void lookup_appid_by_host_port(AppIdSession& asd, Packet* p, IpProtocol p
                 thirdparty_appid_module->session_delete(asd.tpsession, 1);
 
             asd.tpsession = nullptr;
+            return true;
+        }
+    }
+    return false;
+}
+
+// pick the ids this packet settled on and tell the rest of snort, including
+// on the fast path where discovery itself is skipped
+static void publish_application_ids(AppIdSession& asd, Packet* p, int direction,
+    bool isTpAppidDiscoveryDone)
+{
+    AppId service_id = asd.pick_service_app_id();
+    AppId payload_id = asd.pick_payload_app_id();
+
+    if (service_id > APP_ID_NONE)
+    {
+        if (asd.get_session_flags(APPID_SESSION_DECRYPTED))
+        {
+            if (asd.misc_app_id == APP_ID_NONE)
+                asd.update_encrypted_app_id(service_id);
+        }
+// FIXIT-M Need to determine what api to use for this _dpd function
+#if 1
+        UNUSED(isTpAppidDiscoveryDone);
+#else
+        else if (isTpAppidDiscoveryDone && isSslServiceAppId(service_id) &&
+            _dpd.isSSLPolicyEnabled(nullptr))
+            asd.set_session_flags(APPID_SESSION_CONTINUE);
+#endif
+    }
+
+    asd.set_application_ids(service_id, asd.pick_client_app_id(), payload_id,
+        asd.pick_misc_app_id());
+
+    /* Set the field that the Firewall queries to see if we have a search engine. */
+    if (asd.search_support_type == UNKNOWN_SEARCH_ENGINE && payload_id > APP_ID_NONE)
+    {
+        uint flags = AppInfoManager::get_instance().get_app_info_flags(payload_id,
+            APPINFO_FLAG_SEARCH_ENGINE | APPINFO_FLAG_SUPPORTED_SEARCH);
+        asd.search_support_type =
+            (flags & APPINFO_FLAG_SEARCH_ENGINE) ?
+            ((flags & APPINFO_FLAG_SUPPORTED_SEARCH) ? SUPPORTED_SEARCH_ENGINE :
+            UNSUPPORTED_SEARCH_ENGINE )
+            : NOT_A_SEARCH_ENGINE;
+        if (asd.session_logging_enabled)
+        {
+            const char* typeString;
+            switch ( asd.search_support_type )
+            {
+            case NOT_A_SEARCH_ENGINE: typeString = "NOT_A_SEARCH_ENGINE"; break;
+            case SUPPORTED_SEARCH_ENGINE: typeString = "SUPPORTED_SEARCH_ENGINE"; break;
+            case UNSUPPORTED_SEARCH_ENGINE: typeString = "UNSUPPORTED_SEARCH_ENGINE"; break;
+            default: typeString = "unknown"; break;
+            }
+
+            LogMessage("AppIdDbg %s appId: %u (safe)search_support_type=%s\n",
+                asd.session_logging_id, payload_id, typeString);
+        }
+    }
+
+    if ( service_id !=  APP_ID_NONE )
+    {
+        if ( payload_id != APP_ID_NONE && payload_id != asd.past_indicator)
+        {
+            asd.past_indicator = payload_id;
+            check_session_for_AF_indicator(p, direction, (AppId)payload_id);
+        }
+
+        if (asd.payload.get_id() == APP_ID_NONE && asd.past_forecast != service_id &&
+            asd.past_forecast != APP_ID_UNKNOWN)
+        {
+            asd.past_forecast = check_session_for_AF_forecast(asd, p, direction,
+                (AppId)service_id);
         }
     }
 }
@@ -688,6 +815,15 @@ void AppIdDiscovery::do_application_discovery(Packet* p, AppIdInspector& inspect
         return;
     }
 
+    // the first packet settled the service so there is nothing left to discover, but
+    // the ids are still published for each packet as before
+    if (asd->get_session_flags(APPID_SESSION_FAST_PATH))
+    {
+        AppIdPegCounts::inc_disco_peg(AppIdPegCounts::DiscoveryPegs::FAST_PATH_PACKETS);
+        publish_application_ids(*asd, p, direction, isTpAppidDiscoveryDone);
+        return;
+    }
+
     if (p->packet_flags & PKT_STREAM_ORDER_BAD)
         asd->set_session_flags(APPID_SESSION_OOO);
     else if ( p->is_tcp() && p->ptrs.tcph )
@@ -717,8 +853,10 @@ void AppIdDiscovery::do_application_discovery(Packet* p, AppIdInspector& inspect
     }
 
     /*HostPort based AppId.  */
+    bool host_port_decided = false;
+
     if ( !(asd->scan_flags & SCAN_HOST_PORT_FLAG) )
-        lookup_appid_by_host_port(*asd, p, protocol, direction);
+        host_port_decided = lookup_appid_by_host_port(*asd, p, protocol, direction);
 
     asd->check_app_detection_restart();
 
@@ -761,6 +899,7 @@ void AppIdDiscovery::do_application_discovery(Packet* p, AppIdInspector& inspect
      *  - We haven't hit the max packets allowed for detector sequence matches.
      *  - Packet has data (we'll ignore 0-sized packets in sequencing). */
     if ( (asd->service.get_port_service_id() <= APP_ID_NONE)
+        && !(asd->scan_flags & SCAN_LENGTH_FLAG)
         && (asd->length_sequence.sequence_cnt < LENGTH_SEQUENCE_CNT_MAX)
         && (p->dsize > 0))
     {
@@ -774,7 +913,10 @@ void AppIdDiscovery::do_application_discovery(Packet* p, AppIdInspector& inspect
         {
             asd->service.set_port_service_id(id);
             asd->set_session_flags(APPID_SESSION_PORT_SERVICE_DONE);
+            AppIdPegCounts::inc_disco_peg(AppIdPegCounts::DiscoveryPegs::LENGTH_FLOWS);
         }
+        else if (id == APP_ID_UNKNOWN)
+            asd->scan_flags |= SCAN_LENGTH_FLAG;
     }
 
     /* exceptions for rexec and any other service detector that needs to see SYN and SYN/ACK */
@@ -817,69 +959,13 @@ void AppIdDiscovery::do_application_discovery(Packet* p, AppIdInspector& inspect
         }
     }
 
-    AppId service_id = asd->pick_service_app_id();
-    AppId payload_id = asd->pick_payload_app_id();
+    publish_application_ids(*asd, p, direction, isTpAppidDiscoveryDone);
 
-    if (service_id > APP_ID_NONE)
+    // a restart for decryption starts discovery over so it can't take the fast path
+    if (host_port_decided && !asd->get_session_flags(APPID_SESSION_DECRYPTED))
     {
-        if (asd->get_session_flags(APPID_SESSION_DECRYPTED))
-        {
-            if (asd->misc_app_id == APP_ID_NONE)
-                asd->update_encrypted_app_id(service_id);
-        }
-// FIXIT-M Need to determine what api to use for this _dpd function
-#if 1
-        UNUSED(isTpAppidDiscoveryDone);
-#else
-        else if (isTpAppidDiscoveryDone && isSslServiceAppId(service_id) &&
-            _dpd.isSSLPolicyEnabled(nullptr))
-            asd->set_session_flags(APPID_SESSION_CONTINUE);
-#endif
-    }
-
-    asd->set_application_ids(service_id, asd->pick_client_app_id(), payload_id,
-        asd->pick_misc_app_id());
-
-    /* Set the field that the Firewall queries to see if we have a search engine. */
-    if (asd->search_support_type == UNKNOWN_SEARCH_ENGINE && payload_id > APP_ID_NONE)
-    {
-        uint flags = AppInfoManager::get_instance().get_app_info_flags(payload_id,
-            APPINFO_FLAG_SEARCH_ENGINE | APPINFO_FLAG_SUPPORTED_SEARCH);
-        asd->search_support_type =
-            (flags & APPINFO_FLAG_SEARCH_ENGINE) ?
-            ((flags & APPINFO_FLAG_SUPPORTED_SEARCH) ? SUPPORTED_SEARCH_ENGINE :
-            UNSUPPORTED_SEARCH_ENGINE )
-            : NOT_A_SEARCH_ENGINE;
-        if (asd->session_logging_enabled)
-        {
-            const char* typeString;
-            switch ( asd->search_support_type )
-            {
-            case NOT_A_SEARCH_ENGINE: typeString = "NOT_A_SEARCH_ENGINE"; break;
-            case SUPPORTED_SEARCH_ENGINE: typeString = "SUPPORTED_SEARCH_ENGINE"; break;
-            case UNSUPPORTED_SEARCH_ENGINE: typeString = "UNSUPPORTED_SEARCH_ENGINE"; break;
-            default: typeString = "unknown"; break;
-            }
-
-            LogMessage("AppIdDbg %s appId: %u (safe)search_support_type=%s\n",
-                asd->session_logging_id, payload_id, typeString);
-        }
-    }
-
-    if ( service_id !=  APP_ID_NONE )
-    {
-        if ( payload_id != APP_ID_NONE && payload_id != asd->past_indicator)
-        {
-            asd->past_indicator = payload_id;
-            check_session_for_AF_indicator(p, direction, (AppId)payload_id);
-        }
-
-        if (asd->payload.get_id() == APP_ID_NONE && asd->past_forecast != service_id &&
-            asd->past_forecast != APP_ID_UNKNOWN)
-        {
-            asd->past_forecast = check_session_for_AF_forecast(*asd, p, direction,
-                (AppId)service_id);
-        }
+        asd->set_session_flags(APPID_SESSION_FAST_PATH);
+        AppIdPegCounts::inc_disco_peg(AppIdPegCounts::DiscoveryPegs::HOST_PORT_FLOWS);
     }
 }
 
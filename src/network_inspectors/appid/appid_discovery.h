@@ -48,6 +48,7 @@ struct Packet;
 #define SCAN_HTTP_VENDOR_FLAG       (1<<6)
 #define SCAN_HTTP_XWORKINGWITH_FLAG (1<<7)
 #define SCAN_HTTP_CONTENT_TYPE_FLAG (1<<8)
+#define SCAN_LENGTH_FLAG            (1<<9)
 
 class AppIdPatternMatchNode
 {
@@ -56,7 +57,7 @@ public:
         : service(detector), pattern_start_pos(start), size(len)
     {}
 
-    bool valid_match(int end_position)
+    bool valid_match(int end_position) const
     {
         if ( pattern_start_pos >= 0 && pattern_start_pos != (end_position - (int)size) )
             return false;
@@ -69,6 +70,11 @@ public:
     unsigned size;
 };
 
+// service and client detectors register their payload patterns in one
+// search tool per protocol so each packet is scanned once for both.  these
+// are the valid hits of the last scan; callers pick out their own detectors.
+typedef std::vector<const AppIdPatternMatchNode*> AppIdPatternMatches;
+
 struct ServiceMatch
 {
     struct ServiceMatch* next;
@@ -104,6 +110,7 @@ public:
     virtual int add_service_port(AppIdDetector*, const ServiceDetectorPort&);
 
     static void do_application_discovery(Packet* p, AppIdInspector&);
+    static const AppIdPatternMatches& match_patterns(const Packet*, IpProtocol);
 
     AppIdDetectors* get_tcp_detectors()
     {
@@ -122,11 +129,13 @@ protected:
     AppIdInspector& inspector;
     AppIdDetectors tcp_detectors;
     AppIdDetectors udp_detectors;
-    SearchTool* tcp_patterns = nullptr;
     int tcp_pattern_count = 0;
-    SearchTool* udp_patterns = nullptr;
     int udp_pattern_count = 0;
     std::vector<AppIdPatternMatchNode*> pattern_data;
+
+private:
+    static THREAD_LOCAL SearchTool* tcp_patterns;
+    static THREAD_LOCAL SearchTool* udp_patterns;
 };
 #endif
 
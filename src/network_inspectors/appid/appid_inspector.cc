@@ -46,6 +46,7 @@
 #include "log/packet_tracer.h"
 #include "managers/inspector_manager.h"
 #include "managers/module_manager.h"
+#include "memory/memory_domain.h"
 #include "protocols/packet.h"
 #include "profiler/profiler.h"
 
@@ -169,6 +170,7 @@ void AppIdInspector::tterm()
 void AppIdInspector::eval(Packet* p)
 {
     Profile profile(appidPerfStats);
+    memory::DomainContext domain(memory::Domain::APPID);
 
     AppIdPegCounts::inc_disco_peg(AppIdPegCounts::DiscoveryPegs::PACKETS);
     if (p->flow)
@@ -198,6 +200,7 @@ static void mod_dtor(Module* m)
 static void appid_inspector_pinit()
 {
     AppIdSession::init();
+    memory::add_pruner(memory::Domain::APPID, AppIdSession::prune_pool);
 }
 
 static void appid_inspector_pterm()
@@ -208,11 +211,13 @@ static void appid_inspector_pterm()
 static void appid_inspector_tinit()
 {
     AppIdPegCounts::init_pegs();
+    AppIdSession::init_pool();
 }
 
 static void appid_inspector_tterm()
 {
     AppIdPegCounts::cleanup_pegs();
+    AppIdSession::release_pool();
 }
 
 static Inspector* appid_inspector_ctor(Module* m)
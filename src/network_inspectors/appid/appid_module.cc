@@ -25,10 +25,12 @@
 
 #include "appid_module.h"
 
+#include <chrono>
 #include <climits>
 
 #include "app_info_table.h"
 #include "appid_peg_counts.h"
+#include "lua_detector_api.h"
 #include "log/messages.h"
 #include "profiler/profiler.h"
 #include "utils/util.h"
@@ -79,6 +81,8 @@ static const Parameter s_params[] =
       "enable appid debug logging" },
     { "dump_ports", Parameter::PT_BOOL, nullptr, "false",
       "enable dump of appid port information" },
+    { "lua_detector_budget", Parameter::PT_INT, "0:", "0",
+      "disable Lua detectors that take longer than this many usecs on 8 of 64 packets (0 is unlimited)" },
 #ifdef REMOVED_WHILE_NOT_IN_USE
     { "thirdparty_appid_dir", Parameter::PT_STRING, nullptr, nullptr,
       "directory to load thirdparty appid detectors from" },
@@ -110,9 +114,22 @@ AppIdModule::~AppIdModule()
     AppIdPegCounts::cleanup_peg_info();
 }
 
-ProfileStats* AppIdModule::get_profile() const
+ProfileStats* AppIdModule::get_profile(
+    unsigned index, const char*& name, const char*& parent) const
 {
-    return &appidPerfStats;
+    switch ( index )
+    {
+    case 0:
+        name = MOD_NAME;
+        parent = nullptr;
+        return &appidPerfStats;
+
+    case 1:
+        name = "appid_lua";
+        parent = MOD_NAME;
+        return &luaDetectorsPerfStats;
+    }
+    return nullptr;
 }
 
 const AppIdModuleConfig* AppIdModule::get_data()
@@ -149,6 +166,14 @@ bool AppIdModule::set(const char*, Value& v, SnortConfig*)
         config->debug = v.get_bool();
     else if ( v.is("dump_ports") )
         config->dump_ports = v.get_bool();
+    else if ( v.is("lua_detector_budget") )
+    {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+
+        long t = clock_ticks(v.get_long());
+        config->lua_detector_budget = duration_cast<hr_duration>(microseconds(t));
+    }
     else if ( v.is("session_log_filter") )
         config->session_log_filter.log_all_sessions = false;  // FIXIT-L need to implement support
                                                               // for all log options
@@ -45,7 +45,7 @@ public:
 
     const PegInfo* get_pegs() const override;
     PegCount* get_counts() const override;
-    ProfileStats* get_profile() const override;
+    ProfileStats* get_profile(unsigned, const char*&, const char*&) const override;
 
     const AppIdModuleConfig* get_data();
 
@@ -40,6 +40,9 @@ std::vector<PegInfo> AppIdPegCounts::appid_pegs =
     { CountType::SUM, "ignored_packets", "count of packets ignored" },
     { CountType::SUM, "total_sessions", "count of sessions created" },
     { CountType::SUM, "appid_unknown", "count of sessions where appid could not be determined" },
+    { CountType::SUM, "host_port_flows", "count of sessions identified by host and port" },
+    { CountType::SUM, "length_flows", "count of sessions identified by packet lengths" },
+    { CountType::SUM, "fast_path_packets", "count of packets that skipped discovery" },
 };
 
 THREAD_LOCAL std::vector<PegCount>* AppIdPegCounts::appid_peg_counts;
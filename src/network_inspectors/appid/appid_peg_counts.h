@@ -50,6 +50,9 @@ public:
         IGNORED_PACKETS,
         TOTAL_SESSIONS,
         APPID_UNKNOWN,
+        HOST_PORT_FLOWS,
+        LENGTH_FLOWS,
+        FAST_PATH_PACKETS,
         NUM_APPID_GLOBAL_PEGS
     };
 
@@ -34,6 +34,7 @@
 #include "appid_inspector.h"
 #include "appid_stats.h"
 #include "appid_utils/ip_funcs.h"
+#include "appid_utils/object_pool.h"
 #include "service_plugins/service_ssl.h"
 #include "thirdparty_appid_utils.h"
 #include "log/messages.h"
@@ -48,6 +49,44 @@
 unsigned AppIdSession::inspector_id = 0;
 THREAD_LOCAL uint32_t AppIdSession::appid_flow_data_id = 0;
 
+// sessions come and go with every monitored flow so released ones are kept
+// for reuse, up to a bound, instead of going back to the heap each time
+#define APPID_SESSION_POOL_MAX   1024
+#define APPID_SESSION_POOL_PRUNE 32
+
+static THREAD_LOCAL ObjectPool<AppIdSession> session_pool;
+
+void* AppIdSession::operator new(size_t n)
+{
+    if ( n != sizeof(AppIdSession) )
+        return ::operator new(n);
+
+    return session_pool.get();
+}
+
+void AppIdSession::operator delete(void* p, size_t n)
+{
+    if ( n != sizeof(AppIdSession) )
+        ::operator delete(p);
+    else
+        session_pool.put(p);
+}
+
+void AppIdSession::init_pool()
+{
+    session_pool.max_free = APPID_SESSION_POOL_MAX;
+}
+
+bool AppIdSession::prune_pool()
+{
+    return session_pool.shed(APPID_SESSION_POOL_PRUNE) > 0;
+}
+
+void AppIdSession::release_pool()
+{
+    session_pool.release();
+}
+
 const uint8_t* service_strstr(const uint8_t* haystack, unsigned haystack_len,
     const uint8_t* needle, unsigned needle_len)
 {
@@ -180,8 +219,6 @@ AppIdSession::~AppIdSession()
 
     delete_session_data();
     free_flow_data();
-    service_candidates.clear();
-    client_candidates.clear();
     snort_free(firewall_early_data);
 }
 
@@ -609,41 +646,46 @@ void AppIdSession::delete_session_data()
     }
 
     delete hsession;
+    hsession = nullptr;
     free_tls_session_data();
     delete dsession;
+    dsession = nullptr;
 }
 
 
+AppIdFlowData* AppIdSession::find_flow_data(unsigned id)
+{
+    for ( auto& fd : flow_data )
+        if ( fd.fd_id == id )
+            return &fd;
+
+    return nullptr;
+}
+
 int AppIdSession::add_flow_data(void* data, unsigned id, AppIdFreeFCN fcn)
 {
-    AppIdFlowDataIter it = flow_data.find(id);
-    if ( it != flow_data.end() )
+    if ( find_flow_data(id) )
         return -1;
 
-    AppIdFlowData* fd = new AppIdFlowData(data, id, fcn);
-    flow_data[id] = fd;
+    flow_data.push_back({ data, id, fcn });
     return 0;
 }
 
 void* AppIdSession::get_flow_data(unsigned id)
 {
-    AppIdFlowDataIter it = flow_data.find(id);
-    if ( it != flow_data.end() )
-        return it->second->fd_data;
-    else
-        return nullptr;
+    AppIdFlowData* fd = find_flow_data(id);
+    return fd ? fd->fd_data : nullptr;
 }
 
+// the caller takes ownership of the data
 void* AppIdSession::remove_flow_data(unsigned id)
 {
     void* data = nullptr;
 
-    AppIdFlowDataIter it = flow_data.find(id);
-    if ( it != flow_data.end() )
+    if ( AppIdFlowData* fd = find_flow_data(id) )
     {
-        data = it->second->fd_data;
-        delete it->second;
-        flow_data.erase(it);
+        data = fd->fd_data;
+        flow_data.erase(fd);
     }
 
     return data;
@@ -651,28 +693,27 @@ void* AppIdSession::remove_flow_data(unsigned id)
 
 void AppIdSession::free_flow_data()
 {
-    for ( AppIdFlowDataIter it = flow_data.cbegin(); it != flow_data.cend(); ++it )
-        delete it->second;
+    for ( auto& fd : flow_data )
+        fd.free_data();
 
     flow_data.clear();
 }
 
 void AppIdSession::free_flow_data_by_id(unsigned id)
 {
-    AppIdFlowDataIter it = flow_data.find(id);
-    if ( it != flow_data.end() )
+    if ( AppIdFlowData* fd = find_flow_data(id) )
     {
-        delete it->second;
-        flow_data.erase(it);
+        fd->free_data();
+        flow_data.erase(fd);
     }
 }
 
 void AppIdSession::free_flow_data_by_mask(unsigned mask)
 {
-    for ( AppIdFlowDataIter it = flow_data.cbegin(); it != flow_data.cend(); )
-        if ( !mask || ( it->second->fd_id & mask ) )
+    for ( auto it = flow_data.begin(); it != flow_data.end(); )
+        if ( !mask || ( it->fd_id & mask ) )
         {
-            delete it->second;
+            it->free_data();
             it = flow_data.erase(it);
         }
         else
@@ -22,7 +22,6 @@
 #ifndef APPID_SESSION_H
 #define APPID_SESSION_H
 
-#include <map>
 #include <string>
 
 #include "app_info_table.h"
@@ -31,6 +30,7 @@
 #include "application_ids.h"
 #include "length_app_cache.h"
 #include "service_state.h"
+#include "appid_utils/small_vector.h"
 #include "detector_plugins/http_url_patterns.h"
 
 struct AppIdServiceSubtype;
@@ -97,24 +97,24 @@ enum APPID_SESSION_DIRECTION
     APP_ID_APPID_SESSION_DIRECTION_MAX // Maximum value of a direction (must be last in the list)
 };
 
-class AppIdFlowData
+// flow data is kept by value in the session; fd_free is called by the
+// session when the data is freed, not when it is removed
+struct AppIdFlowData
 {
-public:
-    AppIdFlowData(void* data, unsigned id, AppIdFreeFCN fcn) :
-        fd_data(data), fd_id(id), fd_free(fcn)
-    { }
+    void* fd_data;
+    unsigned fd_id;
+    AppIdFreeFCN fd_free;
 
-    ~AppIdFlowData()
+    void free_data()
     {
         if ( fd_data && fd_free )
             fd_free(fd_data);
     }
-
-    void* fd_data;
-    unsigned fd_id;
-    AppIdFreeFCN fd_free;
 };
-typedef std::map<unsigned, AppIdFlowData*>::const_iterator AppIdFlowDataIter;
+
+// sessions rarely have more than a few of each so they are kept in place
+#define APPID_SESSION_FLOW_DATA 4
+#define APPID_SESSION_CANDIDATES 4
 
 struct CommonAppIdData
 {
@@ -147,6 +147,14 @@ public:
     AppIdSession(IpProtocol, const SfIp*, uint16_t port, AppIdInspector&);
     ~AppIdSession() override;
 
+    // sessions are recycled through a per thread pool
+    static void* operator new(size_t);
+    static void operator delete(void*, size_t);
+
+    static void init_pool();
+    static bool prune_pool();
+    static void release_pool();
+
     static AppIdSession* allocate_session(const Packet*, IpProtocol, int, AppIdInspector&);
     static AppIdSession* create_future_session(const Packet*, const SfIp*, uint16_t, const SfIp*,
         uint16_t, IpProtocol, int16_t, int, AppIdInspector&);
@@ -159,7 +167,7 @@ public:
     uint32_t session_id = 0;
     Flow* flow = nullptr;
     AppIdConfig* config;
-    std::map<unsigned, AppIdFlowData*> flow_data;
+    SmallVector<AppIdFlowData, APPID_SESSION_FLOW_DATA> flow_data;
     AppInfoManager* app_info_mgr = nullptr;
     CommonAppIdData common;
     uint16_t session_packet_count = 0;
@@ -174,7 +182,7 @@ public:
     SESSION_SERVICE_SEARCH_STATE service_search_state = SESSION_SERVICE_SEARCH_STATE::START;
     ServiceDetector* service_detector = nullptr;
     AppIdServiceSubtype* subtype = nullptr;
-    std::vector<ServiceDetector*> service_candidates;
+    SmallVector<ServiceDetector*, APPID_SESSION_CANDIDATES> service_candidates;
     ServiceAppDescriptor service;
     ClientAppDescriptor client;
     PayloadAppDescriptor payload;
@@ -183,7 +191,7 @@ public:
     APPID_DISCOVERY_STATE client_disco_state = APPID_DISCO_STATE_NONE;
     AppId client_inferred_service_id = APP_ID_NONE;
     ClientDetector* client_detector = nullptr;
-    std::map<std::string, ClientDetector*> client_candidates;
+    SmallVector<ClientDetector*, APPID_SESSION_CANDIDATES> client_candidates;
     bool tried_reverse_service = false;
 
     AppId referred_payload_app_id = APP_ID_NONE;
@@ -294,6 +302,7 @@ private:
     AppIdHttpSession* hsession = nullptr;
     AppIdDnsSession* dsession = nullptr;
 
+    AppIdFlowData* find_flow_data(unsigned id);
     void reinit_session_data();
     void delete_session_data();
     bool is_ssl_decryption_enabled();
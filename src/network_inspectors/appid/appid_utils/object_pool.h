@@ -0,0 +1,99 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// object_pool.h
+
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+// ObjectPool is a per thread free list for objects that come and go with
+// every flow, such as sessions.  get() returns uninitialized memory for one
+// T, for use from a class operator new, and put() keeps up to max_free
+// released blocks for reuse.  declare pools THREAD_LOCAL.  they start out
+// with max_free of zero, ie disabled, so the owner sets it in tinit and
+// calls release() in tterm.  blocks may be put by a thread other than the
+// one that got them.  shed() gives blocks back to the heap when the memory
+// cap needs space.
+
+#include <new>
+
+template<typename T>
+struct ObjectPool
+{
+    struct Link
+    {
+        Link* next;
+    };
+
+    Link* free_list;
+    unsigned free_count;
+    unsigned max_free;
+
+    void* get()
+    {
+        if ( !free_list )
+            return ::operator new(sizeof(T));
+
+        Link* p = free_list;
+        free_list = p->next;
+        free_count--;
+        return p;
+    }
+
+    void put(void* t)
+    {
+        if ( !t )
+            return;
+
+        if ( free_count >= max_free )
+        {
+            ::operator delete(t);
+            return;
+        }
+
+        Link* p = static_cast<Link*>(t);
+        p->next = free_list;
+        free_list = p;
+        free_count++;
+    }
+
+    // returns the number of blocks freed
+    unsigned shed(unsigned n)
+    {
+        unsigned freed = 0;
+
+        while ( free_list and freed < n )
+        {
+            Link* p = free_list;
+            free_list = p->next;
+            ::operator delete(p);
+            freed++;
+        }
+        free_count -= freed;
+        return freed;
+    }
+
+    void release()
+    {
+        shed(free_count);
+        max_free = 0;
+    }
+};
+
+#endif
+
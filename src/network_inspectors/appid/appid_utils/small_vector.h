@@ -0,0 +1,124 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// small_vector.h
+
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+// SmallVector keeps up to N elements in place and only goes to the heap
+// when it grows past that, so the few detectors and data items attached
+// to a typical session cost no allocations.  elements are moved with
+// memcpy and must be trivially copyable.  iterators are plain pointers and
+// are invalidated by any insertion.  order is preserved.
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+template<typename T, unsigned N>
+class SmallVector
+{
+    static_assert(std::is_trivially_copyable<T>::value, "elements are moved with memcpy");
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() = default;
+    SmallVector(const SmallVector&) = delete;
+    SmallVector& operator=(const SmallVector&) = delete;
+
+    ~SmallVector()
+    {
+        if ( data != local() )
+            ::operator delete(data);
+    }
+
+    T* begin() { return data; }
+    T* end() { return data + count; }
+
+    const T* begin() const { return data; }
+    const T* end() const { return data + count; }
+
+    T& operator[](unsigned i)
+    { assert(i < count); return data[i]; }
+
+    unsigned size() const { return count; }
+    bool empty() const { return !count; }
+
+    // heap space, if any, is kept until the vector is destroyed
+    void clear() { count = 0; }
+
+    void push_back(const T& t)
+    {
+        if ( count == capacity )
+            grow();
+
+        data[count++] = t;
+    }
+
+    template<typename It>
+    void append(It first, It last)
+    {
+        for ( ; first != last; ++first )
+            push_back(*first);
+    }
+
+    template<typename It>
+    void assign(It first, It last)
+    {
+        count = 0;
+        append(first, last);
+    }
+
+    // returns the element that followed the erased one
+    T* erase(T* it)
+    {
+        assert(it >= begin() and it < end());
+        memmove((void*)it, (void*)(it + 1), (end() - it - 1) * sizeof(T));
+        --count;
+        return it;
+    }
+
+private:
+    T* local()
+    { return reinterpret_cast<T*>(store); }
+
+    void grow()
+    {
+        T* p = static_cast<T*>(::operator new(2 * capacity * sizeof(T)));
+        memcpy((void*)p, (void*)data, count * sizeof(T));
+
+        if ( data != local() )
+            ::operator delete(data);
+
+        data = p;
+        capacity *= 2;
+    }
+
+    T* data = local();
+    unsigned count = 0;
+    unsigned capacity = N;
+    alignas(T) uint8_t store[N * sizeof(T)];
+};
+
+#endif
+
@@ -25,6 +25,7 @@
 
 #include "client_discovery.h"
 
+#include <algorithm>
 #include <map>
 
 #include "app_info_table.h"
@@ -109,60 +110,32 @@ void ClientDiscovery::initialize()
         kv.second->initialize();
 }
 
-void ClientDiscovery::finalize_client_plugins()
+static void add_client_match(ClientAppMatch** matches, const AppIdPatternMatchNode* pd)
 {
-    if ( tcp_patterns )
-        tcp_patterns->prep();
-
-    if ( udp_patterns )
-        udp_patterns->prep();
-}
+    ClientAppMatch* cam;
 
-/*
- * Callback function for string search
- *
- * @param   id      id in array of search strings from pop_config.cmds
- * @param   index   index in array of search strings from pop_config.cmds
- * @param   data    buffer passed in to search function
- *
- * @return response
- * @retval 1        commands caller to stop searching
- */
-static int pattern_match(void* id, void* /*unused_tree*/, int match_end_pos, void* data,
-    void* /*unused_neg*/)
-{
-    ClientAppMatch** matches = (ClientAppMatch**)data;
-    AppIdPatternMatchNode* pd = (AppIdPatternMatchNode*)id;
+    for (cam = *matches; cam; cam = cam->next)
+        if (cam->detector == pd->service)
+            break;
 
-    if ( pd->valid_match(match_end_pos) )
+    if (cam)
+        cam->count++;
+    else
     {
-        ClientAppMatch* cam;
-
-        for (cam = *matches; cam; cam = cam->next)
-            if (cam->detector == pd->service)
-                break;
-
-        if (cam)
-            cam->count++;
-        else
+        if (match_free_list)
         {
-            if (match_free_list)
-            {
-                cam = match_free_list;
-                match_free_list = cam->next;
-                memset(cam, 0, sizeof(*cam));
-            }
-            else
-                cam = (ClientAppMatch*)snort_calloc(sizeof(ClientAppMatch));
-
-            cam->count = 1;
-            cam->detector =  static_cast<const ClientDetector*>(pd->service);
-            cam->next = *matches;
-            *matches = cam;
+            cam = match_free_list;
+            match_free_list = cam->next;
+            memset(cam, 0, sizeof(*cam));
         }
-    }
+        else
+            cam = (ClientAppMatch*)snort_calloc(sizeof(ClientAppMatch));
 
-    return 0;
+        cam->count = 1;
+        cam->detector =  static_cast<const ClientDetector*>(pd->service);
+        cam->next = *matches;
+        *matches = cam;
+    }
 }
 
 static const ClientDetector* get_next_detector(ClientAppMatch** match_list)
@@ -227,15 +200,10 @@ static void free_matched_list(ClientAppMatch** match_list)
 ClientAppMatch* ClientDiscovery::find_detector_candidates(const Packet* pkt, IpProtocol protocol)
 {
     ClientAppMatch* match_list = nullptr;
-    SearchTool* patterns;
-
-    if (protocol == IpProtocol::TCP)
-        patterns = ClientDiscovery::get_instance().tcp_patterns;
-    else
-        patterns = ClientDiscovery::get_instance().udp_patterns;
 
-    if ( patterns )
-        patterns->find_all((const char*)pkt->data, pkt->dsize, &pattern_match, false, (void*)&match_list);
+    for ( auto pd : match_patterns(pkt, protocol) )
+        if ( pd->service->is_client() )
+            add_client_match(&match_list, pd);
 
     return match_list;
 }
@@ -254,8 +222,9 @@ void ClientDiscovery::create_detector_candidates_list(AppIdSession& asd, Packet*
         if (!cd)
             break;
 
-        if ( asd.client_candidates.find(cd->get_name()) == asd.client_candidates.end() )
-            asd.client_candidates[cd->get_name()] = cd;
+        if ( std::find(asd.client_candidates.begin(), asd.client_candidates.end(), cd) ==
+            asd.client_candidates.end() )
+            asd.client_candidates.push_back(cd);
     }
 
     free_matched_list(&match_list);
@@ -293,15 +262,15 @@ int ClientDiscovery::exec_client_detectors(AppIdSession& asd, Packet* p, int dir
         for ( auto kv = asd.client_candidates.begin(); kv != asd.client_candidates.end(); )
         {
             AppIdDiscoveryArgs disco_args(p->data, p->dsize, direction, asd, p);
-            int result = kv->second->validate(disco_args);
+            int result = (*kv)->validate(disco_args);
             if (asd.session_logging_enabled)
                 LogMessage("AppIdDbg %s %s client detector returned %d\n",
-                    asd.session_logging_id, kv->second->get_name().c_str(), result);
+                    asd.session_logging_id, (*kv)->get_name().c_str(), result);
 
             if (result == APPID_SUCCESS)
             {
                 ret = APPID_SUCCESS;
-                asd.client_detector = kv->second;
+                asd.client_detector = *kv;
                 asd.client_candidates.clear();
                 break;
             }
@@ -45,7 +45,6 @@ public:
     ~ClientDiscovery() override;
     static ClientDiscovery& get_instance(AppIdInspector* ins = nullptr);
 
-    void finalize_client_plugins();
     bool do_client_discovery(AppIdSession&, Packet*, int direction);
 
 private:
@@ -25,7 +25,8 @@
 
 #include "host_port_app_cache.h"
 
-#include <map>
+#include <cstring>
+#include <unordered_map>
 
 #include "log/messages.h"
 #include "utils/cpp_macros.h"
@@ -41,23 +42,9 @@ struct HostPortKey
         padding = 0;
     }
 
-    bool operator<(HostPortKey right) const
+    bool operator==(const HostPortKey& right) const
     {
-        if ( ip.less_than(right.ip) )
-            return true;
-        else if ( right.ip.less_than(ip) )
-            return false;
-        else
-        {
-            if ( port < right.port)
-                return true;
-            else if ( right.port < port )
-                return false;
-            else if ( proto < right.proto)
-                return true;
-            else
-                return false;
-        }
+        return !memcmp(this, &right, sizeof(*this));
     }
 
     SfIp ip;
@@ -67,18 +54,31 @@ struct HostPortKey
 };
 PADDING_GUARD_END
 
-static THREAD_LOCAL std::map<HostPortKey, HostPortVal>* host_port_cache = nullptr;
+// looked up once for every new flow so hash it rather than walk a tree
+struct HashHostPortKey
+{
+    size_t operator()(const HostPortKey& hk) const
+    {
+        uint64_t ip[2];
+        memcpy(ip, hk.ip.get_ip6_ptr(), sizeof(ip));
+        return std::hash<uint64_t>() (ip[0]) ^ std::hash<uint64_t>() (ip[1]) ^
+               std::hash<uint32_t>() ((hk.port << 8) | (uint8_t)hk.proto);
+    }
+};
+
+typedef std::unordered_map<HostPortKey, HostPortVal, HashHostPortKey> HostPortMap;
+
+static THREAD_LOCAL HostPortMap* host_port_cache = nullptr;
 
 void HostPortCache::initialize()
 {
-    host_port_cache = new std::map<HostPortKey, HostPortVal>;
+    host_port_cache = new HostPortMap;
 }
 
 void HostPortCache::terminate()
 {
     if (host_port_cache)
     {
-        host_port_cache->empty();
         delete host_port_cache;
         host_port_cache = nullptr;
     }
@@ -86,14 +86,17 @@ void HostPortCache::terminate()
 
 HostPortVal* HostPortCache::find(const SfIp* ip, uint16_t port, IpProtocol protocol)
 {
+    // most configurations have no host/port detectors at all
+    if ( host_port_cache->empty() )
+        return nullptr;
+
     HostPortKey hk;
 
     hk.ip.set(*ip);
     hk.port = port;
     hk.proto = protocol;
 
-    std::map<HostPortKey, HostPortVal>::iterator it;
-    it = host_port_cache->find(hk);
+    HostPortMap::iterator it = host_port_cache->find(hk);
     if (it != host_port_cache->end())
         return &it->second;
     else
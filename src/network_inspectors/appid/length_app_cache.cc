@@ -56,17 +56,41 @@ AppId find_length_app_cache(const LengthKey* key)
 {
     AppId* val = (AppId*)xhash_find(lengthCache, (void*)key);
     if (val == nullptr)
-        return APP_ID_NONE;    /* no match */
+        return APP_ID_UNKNOWN; /* no sequence starts with this one */
     else
-        return *val;           /* match found */
+        return *val;           /* match found or APP_ID_NONE for a prefix */
 }
 
 bool add_length_app_cache(const LengthKey* key, AppId val)
 {
-    if (xhash_add(lengthCache, (void*)key, (void*)&val))
+    AppId* old = (AppId*)xhash_find(lengthCache, (void*)key);
+
+    // a shorter sequence may have already added this one as its prefix
+    if ( old )
+    {
+        if ( *old != APP_ID_NONE )
+            return false;
+
+        *old = val;
+    }
+    else if (xhash_add(lengthCache, (void*)key, (void*)&val))
     {
         return false;
     }
+
+    // the prefixes let a flow stop tracking lengths as soon as it diverges
+    // from every sequence instead of after LENGTH_SEQUENCE_CNT_MAX packets
+    LengthKey prefix;
+    prefix.proto = key->proto;
+
+    for ( uint8_t i = 1; i < key->sequence_cnt; ++i )
+    {
+        prefix.sequence_cnt = i;
+        prefix.sequence[i - 1] = key->sequence[i - 1];
+
+        AppId none = APP_ID_NONE;
+        xhash_add(lengthCache, (void*)&prefix, (void*)&none);
+    }
     return true;
 }
 
@@ -49,6 +49,10 @@ struct LengthKey
 
 void init_length_app_cache();
 void free_length_app_cache();
+
+// returns the id of a complete sequence, APP_ID_NONE if the key is only the
+// start of one or APP_ID_UNKNOWN if no sequence starts this way, in which
+// case later packets can't match either
 AppId find_length_app_cache(const LengthKey*);
 bool add_length_app_cache(const LengthKey*, AppId);
 
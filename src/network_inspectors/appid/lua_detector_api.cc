@@ -25,6 +25,7 @@
 
 #include "lua_detector_api.h"
 
+#include <chrono>
 #include <lua.hpp>
 #include <pcre.h>
 
@@ -32,6 +33,7 @@
 #include "app_info_table.h"
 #include "appid_inspector.h"
 #include "host_port_app_cache.h"
+#include "lua_detector_ffi.h"
 #include "lua_detector_flow_api.h"
 #include "lua_detector_module.h"
 #include "lua_detector_util.h"
@@ -62,9 +64,31 @@ enum LuaLogLevels
     LUA_LOG_DEBUG = 5,
 };
 
-ProfileStats luaDetectorsPerfStats;
-ProfileStats luaCiscoPerfStats;
-ProfileStats luaCustomPerfStats;
+THREAD_LOCAL ProfileStats luaDetectorsPerfStats;
+
+// view of the packet being validated for detectors using the ffi
+static THREAD_LOCAL AppIdFfiPacket ffi_packet;
+static THREAD_LOCAL bool ffi_packet_valid = false;
+
+SO_PUBLIC const AppIdFfiPacket* appid_ffi_get_packet()
+{
+    return ffi_packet_valid ? &ffi_packet : nullptr;
+}
+
+static void set_ffi_packet(const LuaDetectorParameters& ldp)
+{
+    ffi_packet.data = ldp.data;
+    ffi_packet.size = ldp.size;
+    ffi_packet.dir = ldp.dir;
+    ffi_packet.proto = (unsigned)ldp.asd->protocol;
+    ffi_packet.sp = ldp.pkt->ptrs.sp;
+    ffi_packet.dp = ldp.pkt->ptrs.dp;
+    ffi_packet.session_packets = ldp.asd->session_packet_count;
+    ffi_packet.service_id = ldp.asd->service.get_id();
+    ffi_packet.client_id = ldp.asd->client.get_id();
+    ffi_packet.payload_id = ldp.asd->payload.get_id();
+    ffi_packet_valid = true;
+}
 
 static THREAD_LOCAL XHash* CHP_glossary = nullptr;      // keep track of http multipatterns here
 
@@ -2330,9 +2354,40 @@ LuaStateDescriptor::~LuaStateDescriptor()
     lua_close(my_lua_state);
 }
 
+static void check_lua_budget(LuaStateDescriptor& lsd, hr_duration elapsed, hr_duration budget)
+{
+    if ( budget == 0_ticks )
+        return;
+
+    // only overruns within the current window of calls count, so occasional
+    // slow calls spread over a long run never add up to a disable
+    if ( lsd.perf_stats.time.checks - lsd.window_start >= LUA_DETECTOR_OVERRUN_WINDOW )
+    {
+        lsd.window_start = lsd.perf_stats.time.checks;
+        lsd.overruns = 0;
+    }
+
+    if ( elapsed <= budget or ++lsd.overruns < LUA_DETECTOR_MAX_OVERRUNS )
+        return;
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    lsd.disabled = true;
+    WarningMessage("appid: lua detector %s disabled after taking %ld usec\n",
+        lsd.package_info.name.c_str(),
+        clock_usecs(duration_cast<microseconds>(elapsed).count()));
+}
+
 int LuaStateDescriptor::lua_validate(AppIdDiscoveryArgs& args)
 {
-    Profile lua_detector_context(luaCustomPerfStats);
+    // a disabled detector fails every flow the same way a runtime error does
+    if ( disabled )
+        return APPID_ENULL;
+
+    Profile lua_detector_context(luaDetectorsPerfStats);
+    hr_duration start = perf_stats.time.elapsed;
+    int rc;
 
     ldp.data = args.data;
     ldp.size = args.size;
@@ -2349,11 +2404,22 @@ int LuaStateDescriptor::lua_validate(AppIdDiscoveryArgs& args)
         return APPID_ENULL;
     }
 
-    lua_getglobal(my_lua_state, validateFn);
-    DebugFormat(DEBUG_APPID, "lua detector %s validating: Lua Memory usage %d\n",
-        package_info.name.c_str(), lua_gc(my_lua_state, LUA_GCCOUNT, 0));
+    {
+        Profile detector_context(perf_stats);
+        set_ffi_packet(ldp);
+
+        lua_getglobal(my_lua_state, validateFn);
+        DebugFormat(DEBUG_APPID, "lua detector %s validating: Lua Memory usage %d\n",
+            package_info.name.c_str(), lua_gc(my_lua_state, LUA_GCCOUNT, 0));
+
+        rc = lua_pcall(my_lua_state, 0, 1, 0);
+        ffi_packet_valid = false;
+    }
+
+    check_lua_budget(*this, perf_stats.time.elapsed - start,
+        args.asd.config->mod_config->lua_detector_budget);
 
-    if ( lua_pcall(my_lua_state, 0, 1, 0) )
+    if ( rc )
     {
         // Runtime Lua errors are suppressed in production code since detectors are written for
         // efficiency and with defensive minimum checks. Errors are dealt as exceptions
@@ -2375,7 +2441,7 @@ int LuaStateDescriptor::lua_validate(AppIdDiscoveryArgs& args)
         return APPID_ENULL;
     }
 
-    int rc = lua_tonumber(my_lua_state, -1);
+    rc = lua_tonumber(my_lua_state, -1);
     lua_pop(my_lua_state, 1);
     DebugFormat(DEBUG_APPID, "lua detector %s: status: %d\n", package_info.name.c_str(), rc);
     ldp.pkt = nullptr;
@@ -28,6 +28,7 @@
 #include <string>
 
 #include "client_plugins/client_detector.h"
+#include "profiler/profiler_defs.h"
 #include "service_plugins/service_detector.h"
 
 struct Packet;
@@ -37,6 +38,14 @@ class AppIdSession;
 #define DETECTOR "Detector"
 #define DETECTORFLOW "DetectorFlow"
 
+// a detector that runs over appid.lua_detector_budget this many times within
+// a window of calls is disabled and stays so until the thread's detectors
+// are loaded again
+#define LUA_DETECTOR_MAX_OVERRUNS 8
+#define LUA_DETECTOR_OVERRUN_WINDOW 64
+
+extern THREAD_LOCAL ProfileStats luaDetectorsPerfStats;
+
 struct DetectorPackageInfo
 {
     std::string initFunctionName;
@@ -78,6 +87,12 @@ public:
     DetectorPackageInfo package_info;
     unsigned int service_id = APP_ID_UNKNOWN;
 
+    // this detector's share of luaDetectorsPerfStats
+    ProfileStats perf_stats;
+    uint64_t window_start = 0;
+    unsigned overruns = 0;
+    bool disabled = false;
+
     int lua_validate(AppIdDiscoveryArgs&);
 };
 
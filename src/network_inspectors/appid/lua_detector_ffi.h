@@ -0,0 +1,57 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// lua_detector_ffi.h
+
+#ifndef LUA_DETECTOR_FFI_H
+#define LUA_DETECTOR_FFI_H
+
+// Lua detectors can use these through the LuaJIT ffi instead of the stack
+// api in lua_detector_api.cc.  appid_ffi_get_packet() returns a view of the
+// packet being validated, with data pointing into the packet itself, or
+// null outside of validate.  The declarations are written once as a macro
+// so create_lua_state() can hand the same text to ffi.cdef.
+
+#include <cstdint>
+
+#define APPID_FFI_DECLS \
+    struct AppIdFfiPacket \
+    { \
+        const uint8_t* data; \
+        unsigned size; \
+        int dir; \
+        unsigned proto; \
+        unsigned sp; \
+        unsigned dp; \
+        uint64_t session_packets; \
+        int32_t service_id; \
+        int32_t client_id; \
+        int32_t payload_id; \
+    }; \
+    const struct AppIdFfiPacket* appid_ffi_get_packet();
+
+extern "C"
+{
+    APPID_FFI_DECLS
+}
+
+#define APPID_FFI_STR(x) #x
+#define APPID_FFI_CDEF(x) APPID_FFI_STR(x)
+
+#endif
+
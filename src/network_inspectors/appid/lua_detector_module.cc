@@ -29,10 +29,12 @@
 #include <libgen.h>
 
 #include <cassert>
+#include <chrono>
 
 #include "appid_config.h"
 #include "lua_detector_util.h"
 #include "lua_detector_api.h"
+#include "lua_detector_ffi.h"
 #include "lua_detector_flow_api.h"
 #include "detector_plugins/detector_http.h"
 #include "main/snort_debug.h"
@@ -100,6 +102,14 @@ static lua_State* create_lua_state(const AppIdModuleConfig* mod_config)
     register_detector_flow_api(L);
     lua_pop(L, 1);
 
+    // declare the ffi accessors so detectors can call ffi.C.appid_ffi_get_packet()
+    if ( luaL_dostring(L, "ffi = require('ffi') ffi.cdef[[ "
+        APPID_FFI_CDEF(APPID_FFI_DECLS) " ]]") )
+    {
+        ErrorMessage("appid: can't declare lua detector ffi: %s\n", lua_tostring(L, -1));
+        lua_pop(L, 1);
+    }
+
     /*The garbage-collector pause controls how long the collector waits before
       starting a new cycle. Larger values make the collector less aggressive.
       Values smaller than 100 mean the collector will not wait to start a new
@@ -154,6 +164,17 @@ LuaDetectorManager::~LuaDetectorManager()
         LuaStateDescriptor* lsd = detector->validate_lua_state(false);
         auto L = lsd->my_lua_state;
 
+        if ( config.mod_config->debug and lsd->perf_stats.time.checks )
+        {
+            using std::chrono::duration_cast;
+            using std::chrono::microseconds;
+
+            LogMessage("lua detector %s: %" PRIu64 " checks, %ld usecs%s\n",
+                lsd->package_info.name.c_str(), lsd->perf_stats.time.checks,
+                clock_usecs(duration_cast<microseconds>(lsd->perf_stats.time.elapsed).count()),
+                lsd->disabled ? ", disabled" : "");
+        }
+
         lua_getglobal(L, lsd->package_info.cleanFunctionName.c_str());
         if ( lua_isfunction(L, -1) )
         {
@@ -161,14 +161,6 @@ void ServiceDiscovery::initialize()
         kv.second->initialize();
 }
 
-void ServiceDiscovery::finalize_service_patterns()
-{
-    if (tcp_patterns)
-        tcp_patterns->prep();
-    if (udp_patterns)
-        udp_patterns->prep();
-}
-
 int ServiceDiscovery::add_service_port(AppIdDetector* detector, const ServiceDetectorPort& pp)
 {
     ServiceDetector* service = static_cast<ServiceDetector*>(detector);
@@ -209,33 +201,25 @@ static int AppIdPatternPrecedence(const void* a, const void* b)
         return (sm2->size - sm1->size);
 }
 
-static int pattern_match(void* id, void*, int match_end_pos, void* data, void*)
+static void add_service_match(ServiceMatch** matches, const AppIdPatternMatchNode* pd)
 {
-    ServiceMatch** matches = (ServiceMatch**)data;
-    AppIdPatternMatchNode* pd = (AppIdPatternMatchNode*)id;
-
-    if ( pd->valid_match(match_end_pos) )
-    {
-        ServiceMatch* sm;
+    ServiceMatch* sm;
 
-        for (sm = *matches; sm; sm = sm->next)
-            if (sm->service == (ServiceDetector*)pd->service)
-                break;
+    for (sm = *matches; sm; sm = sm->next)
+        if (sm->service == (ServiceDetector*)pd->service)
+            break;
 
-        if (sm)
-            sm->count++;
-        else
-        {
-            sm = (ServiceMatch*)snort_calloc(sizeof(ServiceMatch));
-            sm->count++;
-            sm->service = static_cast<ServiceDetector*>(pd->service);
-            sm->size = pd->size;
-            sm->next = *matches;
-            *matches = sm;
-        }
+    if (sm)
+        sm->count++;
+    else
+    {
+        sm = (ServiceMatch*)snort_calloc(sizeof(ServiceMatch));
+        sm->count++;
+        sm->service = static_cast<ServiceDetector*>(pd->service);
+        sm->size = pd->size;
+        sm->next = *matches;
+        *matches = sm;
     }
-
-    return 0;
 }
 
 /**Perform pattern match of a packet and construct a list of services sorted in order of
@@ -248,35 +232,27 @@ static int pattern_match(void* id, void*, int match_end_pos, void* data, void*)
 */
 void ServiceDiscovery::match_by_pattern(AppIdSession& asd, const Packet* pkt, IpProtocol proto)
 {
-    SearchTool* patterns = nullptr;
+    ServiceMatch* match_list = nullptr;
 
-    if (proto == IpProtocol::TCP)
-        patterns = tcp_patterns;
-    else
-        patterns = udp_patterns;
+    for ( auto pd : match_patterns(pkt, proto) )
+        if ( !pd->service->is_client() )
+            add_service_match(&match_list, pd);
 
-    if (patterns)
-    {
-        ServiceMatch* match_list = nullptr;
-        patterns->find_all((const char*)pkt->data, pkt->dsize, &pattern_match, false,
-            (void*)&match_list);
+    std::vector<ServiceMatch*> smOrderedList;
+    for (ServiceMatch* sm = match_list; sm; sm = sm->next)
+        smOrderedList.push_back(sm);
 
-        std::vector<ServiceMatch*> smOrderedList;
-        for (ServiceMatch* sm = match_list; sm; sm = sm->next)
-            smOrderedList.push_back(sm);
-
-        if (!smOrderedList.empty() )
+    if (!smOrderedList.empty() )
+    {
+        std::sort(smOrderedList.begin(), smOrderedList.end(), AppIdPatternPrecedence);
+        for ( auto& sm : smOrderedList )
         {
-            std::sort(smOrderedList.begin(), smOrderedList.end(), AppIdPatternPrecedence);
-            for ( auto& sm : smOrderedList )
+            if ( std::find(asd.service_candidates.begin(), asd.service_candidates.end(),
+                sm->service) == asd.service_candidates.end() )
             {
-                if ( std::find(asd.service_candidates.begin(), asd.service_candidates.end(),
-                    sm->service) == asd.service_candidates.end() )
-                {
-                    asd.service_candidates.push_back(sm->service);
-                }
-                snort_free(sm);
+                asd.service_candidates.push_back(sm->service);
             }
+            snort_free(sm);
         }
     }
 }
@@ -315,19 +291,22 @@ void ServiceDiscovery::get_port_based_services(IpProtocol protocol, uint16_t por
         unsigned mapped_port = sslPortRemap(port);
         if (mapped_port)
         {
-            if ( sd.tcp_services.find(mapped_port) != sd.tcp_services.end() )
-                asd.service_candidates = sd.tcp_services[mapped_port];
+            auto it = sd.tcp_services.find(mapped_port);
+            if ( it != sd.tcp_services.end() )
+                asd.service_candidates.assign(it->second.begin(), it->second.end());
         }
     }
     else if ( protocol == IpProtocol::TCP )
     {
-        if ( sd.tcp_services.find(port) != sd.tcp_services.end() )
-            asd.service_candidates = sd.tcp_services[port];
+        auto it = sd.tcp_services.find(port);
+        if ( it != sd.tcp_services.end() )
+            asd.service_candidates.assign(it->second.begin(), it->second.end());
     }
     else
     {
-        if ( sd.udp_services.find(port) != sd.udp_services.end() )
-            asd.service_candidates = sd.udp_services[port];
+        auto it = sd.udp_services.find(port);
+        if ( it != sd.udp_services.end() )
+            asd.service_candidates.assign(it->second.begin(), it->second.end());
     }
 }
 
@@ -373,7 +352,7 @@ void ServiceDiscovery::get_next_service(const Packet* p, const int dir,
                     asd.service_candidates.push_back(rsds->get_service());
                 else if ( !udp_reversed_services[p->ptrs.sp].empty() )
                 {
-                    asd.service_candidates.insert(asd.service_candidates.end(),
+                    asd.service_candidates.append(
                         udp_reversed_services[p->ptrs.sp].begin(),
                         udp_reversed_services[p->ptrs.sp].end());
                 }
@@ -490,7 +469,7 @@ int ServiceDiscovery::identify_service(AppIdSession& asd, Packet* p, int dir)
                 break;    /* done */
             }
             else if (result != APPID_INPROCESS)    /* fail */
-                asd.service_candidates.erase(it);
+                it = asd.service_candidates.erase(it);
             else
                 ++it;
         }
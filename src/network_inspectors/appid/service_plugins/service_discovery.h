@@ -63,7 +63,6 @@ class ServiceDiscovery : public AppIdDiscovery
 public:
     static ServiceDiscovery& get_instance(AppIdInspector* ins = nullptr);
 
-    void finalize_service_patterns();
     int add_service_port(AppIdDetector*, const ServiceDetectorPort&) override;
 
     AppIdDetectorsIterator get_detector_iterator(IpProtocol);
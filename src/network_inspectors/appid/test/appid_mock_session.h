@@ -67,6 +67,16 @@ public:
     }
 };
 
+void* AppIdSession::operator new(size_t n)
+{
+    return ::operator new(n);
+}
+
+void AppIdSession::operator delete(void* p, size_t)
+{
+    ::operator delete(p);
+}
+
 AppIdSession::AppIdSession(IpProtocol, const SfIp*, uint16_t, AppIdInspector& inspector)
     : FlowData(inspector_id, &inspector), inspector(inspector)
 {
@@ -0,0 +1,188 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// appid_session_pool_test.cc checks the in place containers and the per
+// thread pool that sessions are built from and times session allocation
+// with and without the pool
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "network_inspectors/appid/appid_session.h"
+#include "network_inspectors/appid/appid_utils/object_pool.h"
+#include "network_inspectors/appid/appid_utils/small_vector.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+static THREAD_LOCAL ObjectPool<AppIdSession> pool;
+
+static bool in_place(const void* p, const void* obj, size_t size)
+{ return (const uint8_t*)p >= (const uint8_t*)obj and (const uint8_t*)p < (const uint8_t*)obj + size; }
+
+TEST_GROUP(appid_session_pool)
+{
+    void setup() override
+    {
+        MemoryLeakWarningPlugin::turnOffNewDeleteOverloads();
+    }
+
+    void teardown() override
+    {
+        pool.release();
+        MemoryLeakWarningPlugin::turnOnNewDeleteOverloads();
+    }
+};
+
+TEST(appid_session_pool, small_vector_in_place)
+{
+    SmallVector<AppIdFlowData, APPID_SESSION_FLOW_DATA> v;
+
+    for ( unsigned i = 0; i < APPID_SESSION_FLOW_DATA; i++ )
+        v.push_back({ nullptr, i, nullptr });
+
+    CHECK(v.size() == APPID_SESSION_FLOW_DATA);
+    CHECK(in_place(v.begin(), &v, sizeof(v)));
+
+    v.push_back({ nullptr, 99, nullptr });
+    CHECK(!in_place(v.begin(), &v, sizeof(v)));
+    CHECK(v[APPID_SESSION_FLOW_DATA].fd_id == 99);
+}
+
+TEST(appid_session_pool, small_vector_erase)
+{
+    SmallVector<unsigned, 2> v;
+    std::vector<unsigned> src = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+    v.assign(src.begin(), src.end());
+    CHECK(v.size() == 10);
+
+    for ( auto it = v.begin(); it != v.end(); )
+    {
+        if ( *it % 2 )
+            ++it;
+        else
+            it = v.erase(it);
+    }
+
+    // order is kept
+    CHECK(v.size() == 5);
+    for ( unsigned i = 0; i < v.size(); i++ )
+        CHECK(v[i] == 2 * i + 1);
+
+    v.clear();
+    CHECK(v.empty());
+
+    v.append(src.begin(), src.begin() + 3);
+    CHECK(v.size() == 3);
+    CHECK(v[2] == 2);
+}
+
+TEST(appid_session_pool, pool_reuse)
+{
+    void* a = pool.get();
+    void* b = pool.get();
+    void* c = pool.get();
+
+    // disabled until max_free is set
+    pool.put(a);
+    CHECK(pool.free_count == 0);
+
+    pool.max_free = 2;
+    a = pool.get();
+    pool.put(a);
+    pool.put(b);
+    pool.put(c);
+    CHECK(pool.free_count == 2);
+
+    CHECK(pool.get() == b);
+    CHECK(pool.get() == a);
+    CHECK(pool.free_count == 0);
+
+    pool.put(a);
+    pool.put(b);
+}
+
+TEST(appid_session_pool, pool_shed)
+{
+    std::vector<void*> v;
+    pool.max_free = 8;
+
+    for ( unsigned i = 0; i < 8; i++ )
+        v.push_back(pool.get());
+
+    for ( auto p : v )
+        pool.put(p);
+
+    CHECK(pool.shed(3) == 3);
+    CHECK(pool.free_count == 5);
+    CHECK(pool.shed(10) == 5);
+    CHECK(pool.shed(10) == 0);
+}
+
+// flows come and go with some number open at once
+static double sessions_per_sec(void* (*get)(), void (*put)(void*))
+{
+    const unsigned open = 1000;
+    const unsigned rounds = 200;
+    std::vector<void*> v(open);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for ( unsigned r = 0; r < rounds; r++ )
+    {
+        for ( auto& p : v )
+            p = get();
+
+        for ( auto p : v )
+            put(p);
+    }
+
+    std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+    return open * rounds / t.count();
+}
+
+// timing only, so not run by default; use -ri to include it
+IGNORE_TEST(appid_session_pool, benchmark)
+{
+    pool.max_free = 1024;
+
+    double heap = sessions_per_sec(
+        [] { return ::operator new(sizeof(AppIdSession)); },
+        [](void* p) { ::operator delete(p); });
+
+    double pooled = sessions_per_sec(
+        [] { return pool.get(); },
+        [](void* p) { pool.put(p); });
+
+    printf("appid session: %zu bytes, %.0f heap / %.0f pooled allocations/sec\n",
+        sizeof(AppIdSession), heap, pooled);
+
+    CHECK(pool.free_count == 1000);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
+
@@ -396,9 +396,7 @@ static Inspector* get_gadget(Flow* flow)
     if ( !flow->ssn_state.application_protocol )
         return nullptr;
 
-    const char* s = SnortConfig::get_conf()->proto_ref->get_name(flow->ssn_state.application_protocol);
-
-    return InspectorManager::get_inspector(s);
+    return InspectorManager::get_service_inspector(flow->ssn_state.application_protocol);
 }
 
 //-------------------------------------------------------------------------
@@ -0,0 +1,251 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// bin_formatter.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bin_formatter.h"
+
+#include <cstring>
+
+#ifdef UNIT_TEST
+#include <cstdio>
+
+#include "catch/snort_catch.h"
+#endif
+
+using namespace std;
+
+// strings are truncated so their length fits in the record
+#define MAX_STR_LEN UINT16_MAX
+
+// room reserved for each string when sizing the first record
+#define STR_RESERVE 64
+
+void BinFormatter::finalize_fields()
+{
+    size_t size = sizeof(uint32_t) + sizeof(uint64_t);
+
+    for( unsigned i = 0; i < section_names.size(); i++ )
+    {
+        for( unsigned j = 0; j < field_names[i].size(); j++ )
+        {
+            switch( types[i][j] )
+            {
+                case FT_PEG_COUNT:
+                    schema += (char)BFT_PEG_COUNT;
+                    size += sizeof(PegCount);
+                    break;
+
+                case FT_STRING:
+                    schema += (char)BFT_STRING;
+                    size += sizeof(uint16_t) + STR_RESERVE;
+                    break;
+
+                case FT_IDX_PEG_COUNT:
+                    schema += (char)BFT_IDX_PEG_COUNT;
+                    size += sizeof(uint32_t) + values[i][j].ipc->size() * sizeof(PegCount);
+                    break;
+            }
+            schema += " " + section_names[i] + " " + field_names[i][j] + "\n";
+        }
+    }
+    record.resize(size);
+    section_names.clear();
+    field_names.clear();
+}
+
+void BinFormatter::init_output(FILE* fh)
+{
+    uint32_t magic = PERF_BIN_MAGIC;
+    uint32_t size = schema.size();
+
+    fwrite(&magic, sizeof(magic), 1, fh);
+    fwrite(&size, sizeof(size), 1, fh);
+    fwrite(schema.data(), schema.size(), 1, fh);
+    fflush(fh);
+}
+
+void BinFormatter::put(const void* data, size_t len)
+{
+    // only grows when a peg vector or string is larger than ever before
+    if ( record_size + len > record.size() )
+        record.resize(2 * (record_size + len));
+
+    memcpy(&record[record_size], data, len);
+    record_size += len;
+}
+
+void BinFormatter::write(FILE* fh, time_t timestamp)
+{
+    uint64_t ts = timestamp;
+
+    record_size = sizeof(uint32_t);
+    put(&ts, sizeof(ts));
+
+    for( unsigned i = 0; i < values.size(); i++ )
+    {
+        for( unsigned j = 0; j < values[i].size(); j++ )
+        {
+            switch( types[i][j] )
+            {
+                case FT_PEG_COUNT:
+                    put(values[i][j].pc, sizeof(PegCount));
+                    break;
+
+                case FT_STRING:
+                {
+                    const char* s = values[i][j].s ? values[i][j].s : "";
+                    size_t len = strlen(s);
+                    uint16_t n = len < MAX_STR_LEN ? len : MAX_STR_LEN;
+
+                    put(&n, sizeof(n));
+                    put(s, n);
+                    break;
+                }
+
+                case FT_IDX_PEG_COUNT:
+                {
+                    vector<PegCount>* vals = values[i][j].ipc;
+                    uint32_t n = vals->size();
+
+                    put(&n, sizeof(n));
+
+                    if ( n )
+                        put(vals->data(), n * sizeof(PegCount));
+                    break;
+                }
+            }
+        }
+    }
+
+    uint32_t size = record_size - sizeof(uint32_t);
+    memcpy(&record[0], &size, sizeof(size));
+    fwrite(&record[0], record_size, 1, fh);
+
+    // flushing is what makes frequent writes expensive so do it at most
+    // once per second; closing or rotating the file flushes the rest
+    if ( timestamp != last_flush )
+    {
+        fflush(fh);
+        last_flush = timestamp;
+    }
+}
+
+#ifdef UNIT_TEST
+
+TEST_CASE("bin output", "[BinFormatter]")
+{
+    PegCount one = 0, two = 1, three = 2;
+    char five[32] = "hellothere";
+    std::vector<PegCount> kvp;
+
+    const char* schema =
+        "p name one\n"
+        "p name two\n"
+        "p other three\n"
+        "s other five\n"
+        "v other kvp\n";
+
+    FILE* fh = tmpfile();
+    BinFormatter f("bin_formatter");
+
+    f.register_section("name");
+    f.register_field("one", &one);
+    f.register_field("two", &two);
+    f.register_section("other");
+    f.register_field("three", &three);
+    f.register_field("five", five);
+    f.register_field("kvp", &kvp);
+    f.finalize_fields();
+    f.init_output(fh);
+
+    kvp.push_back(50);
+    kvp.push_back(0);
+    kvp.push_back(70);
+
+    f.write(fh, (time_t)1234567890);
+
+    two = 0;
+    three = 0;
+    five[0] = '\0';
+    kvp.clear();
+    f.write(fh, (time_t)2345678901);
+    fflush(fh);
+
+    uint32_t u32;
+    uint64_t u64;
+    uint16_t u16;
+    char buf[64];
+
+    rewind(fh);
+
+    CHECK(fread(&u32, sizeof(u32), 1, fh) == 1);
+    CHECK(u32 == PERF_BIN_MAGIC);
+    CHECK(fread(&u32, sizeof(u32), 1, fh) == 1);
+    CHECK(u32 == strlen(schema));
+    CHECK(fread(buf, u32, 1, fh) == 1);
+    CHECK(!memcmp(buf, schema, u32));
+
+    // timestamp, 3 pegs, string length and text, vector size and 3 pegs
+    CHECK(fread(&u32, sizeof(u32), 1, fh) == 1);
+    CHECK(u32 == 8 + 3 * 8 + 2 + 10 + 4 + 3 * 8);
+    CHECK(fread(&u64, sizeof(u64), 1, fh) == 1);
+    CHECK(u64 == 1234567890);
+
+    for ( PegCount pc : { 0, 1, 2 } )
+    {
+        CHECK(fread(&u64, sizeof(u64), 1, fh) == 1);
+        CHECK(u64 == pc);
+    }
+    CHECK(fread(&u16, sizeof(u16), 1, fh) == 1);
+    CHECK(u16 == 10);
+    CHECK(fread(buf, u16, 1, fh) == 1);
+    CHECK(!memcmp(buf, "hellothere", 10));
+    CHECK(fread(&u32, sizeof(u32), 1, fh) == 1);
+    CHECK(u32 == 3);
+
+    for ( PegCount pc : { 50, 0, 70 } )
+    {
+        CHECK(fread(&u64, sizeof(u64), 1, fh) == 1);
+        CHECK(u64 == pc);
+    }
+
+    CHECK(fread(&u32, sizeof(u32), 1, fh) == 1);
+    CHECK(u32 == 8 + 3 * 8 + 2 + 4);
+    CHECK(fread(&u64, sizeof(u64), 1, fh) == 1);
+    CHECK(u64 == 2345678901);
+
+    for ( unsigned i = 0; i < 3; i++ )
+    {
+        CHECK(fread(&u64, sizeof(u64), 1, fh) == 1);
+        CHECK(u64 == 0);
+    }
+    CHECK(fread(&u16, sizeof(u16), 1, fh) == 1);
+    CHECK(u16 == 0);
+    CHECK(fread(&u32, sizeof(u32), 1, fh) == 1);
+    CHECK(u32 == 0);
+
+    CHECK(fread(&u32, sizeof(u32), 1, fh) == 0);
+    fclose(fh);
+}
+
+#endif
@@ -0,0 +1,68 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// bin_formatter.h
+
+#ifndef BIN_FORMATTER_H
+#define BIN_FORMATTER_H
+
+// BinFormatter writes fixed schema binary records.  Each record is built in
+// a buffer that is reused from one write to the next, with pegs and peg
+// vectors copied verbatim in host byte order, so a write costs one fwrite
+// no matter how many fields there are.  See the developer notes for the
+// file layout and tools/perfbin to convert it to csv or json.
+
+#include <ctime>
+
+#include "perf_formatter.h"
+
+#define PERF_BIN_MAGIC 0x50524642  // "PRFB"
+
+enum BinFieldType : char
+{
+    BFT_PEG_COUNT = 'p',
+    BFT_STRING = 's',
+    BFT_IDX_PEG_COUNT = 'v'
+};
+
+class BinFormatter : public PerfFormatter
+{
+public:
+    BinFormatter(const std::string& tracker_name) : PerfFormatter(tracker_name) {}
+
+    const char* get_extension() override
+    { return ".bin"; }
+
+    bool allow_append() override
+    { return false; }
+
+    void finalize_fields() override;
+    void init_output(FILE*) override;
+    void write(FILE*, time_t) override;
+
+private:
+    std::string schema;
+    std::vector<uint8_t> record;
+    size_t record_size = 0;
+    time_t last_flush = 0;
+
+    void put(const void*, size_t);
+};
+
+#endif
+
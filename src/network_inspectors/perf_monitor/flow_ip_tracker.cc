@@ -24,24 +24,118 @@
 
 #include "flow_ip_tracker.h"
 
+#include <string>
+
+#include "hash/hashfcn.h"
 #include "log/messages.h"
 #include "protocols/packet.h"
 
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
 #define TRACKER_NAME PERF_NAME "_flow_ip"
 
+// a pair lives within this many slots of its hash
+#define FLOW_IP_PROBES 8
+
+// snapshot slots written per packet
+#define FLOW_IP_DRAIN 64
+
+// slots in a new table; it doubles from here as pairs arrive
+#define FLOW_IP_INITIAL 1024
+
 struct FlowStateKey
 {
     SfIp ipA;
     SfIp ipB;
 };
 
+struct FlowStateRecord
+{
+    FlowStateKey key;
+    bool used;
+    FlowStateValue value;
+};
+
 THREAD_LOCAL FlowIPTracker* perf_flow_ip;
 
+static unsigned hash_key(const FlowStateKey& key)
+{
+    static_assert(sizeof(key) == 9 * sizeof(uint32_t), "hash covers the whole key");
+    uint32_t w[sizeof(key) / sizeof(uint32_t)];
+    memcpy(w, &key, sizeof(w));
+
+    uint32_t a = w[0], b = w[1], c = w[2];
+    mix(a, b, c);
+
+    a += w[3]; b += w[4]; c += w[5];
+    mix(a, b, c);
+
+    a += w[6]; b += w[7]; c += w[8];
+    finalize(a, b, c);
+
+    return c;
+}
+
+// slots are never emptied one at a time so the first free slot ends the
+// search.  returns the slot holding key or the first free one in its
+// window, else nullptr with victim set to the pair there with the fewest
+// packets.
+FlowStateRecord* FlowIPTracker::probe(const FlowStateKey& key, FlowStateRecord*& victim)
+{
+    unsigned idx = hash_key(key);
+    victim = nullptr;
+
+    for (unsigned i = 0; i < FLOW_IP_PROBES; i++)
+    {
+        FlowStateRecord* rec = table + ((idx + i) & table_mask);
+
+        if (!rec->used || !memcmp(&rec->key, &key, sizeof(key)))
+            return rec;
+
+        if (!victim || rec->value.total_packets < victim->value.total_packets)
+            victim = rec;
+    }
+    return nullptr;
+}
+
+// rehash into a table twice the size.  the bigger table has room for
+// everything unless a window overflows, in which case the busier pair wins.
+void FlowIPTracker::grow()
+{
+    FlowStateRecord* old = table;
+    unsigned size = table_mask + 1;
+
+    table = new FlowStateRecord[2 * size]();
+    table_mask = 2 * size - 1;
+
+    for (unsigned i = 0; i < size; i++)
+    {
+        if (!old[i].used)
+            continue;
+
+        FlowStateRecord* victim;
+        FlowStateRecord* rec = probe(old[i].key, victim);
+
+        if (rec)
+            *rec = old[i];
+
+        else if (victim->value.total_packets < old[i].value.total_packets)
+            *victim = old[i];
+    }
+    delete[] old;
+}
+
+// the table is allocated on first use and doubles up to the memcap before
+// anything is replaced.  after that a new pair takes the slot of the pair
+// with the fewest packets and inherits its count (Space-Saving), so a pair
+// that keeps sending ranks above the stream of one-off pairs passing
+// through and isn't pushed out by them.
 FlowStateValue* FlowIPTracker::find_stats(const SfIp* src_addr, const SfIp* dst_addr,
     int* swapped)
 {
     FlowStateKey key;
-    FlowStateValue* value;
 
     if (src_addr->less_than(*dst_addr))
     {
@@ -56,23 +150,34 @@ FlowStateValue* FlowIPTracker::find_stats(const SfIp* src_addr, const SfIp* dst_
         *swapped = 1;
     }
 
-    value = (FlowStateValue*)xhash_find(ip_map, &key);
-    if (!value)
+    if (!table)
+        table = new FlowStateRecord[table_mask + 1]();
+
+    FlowStateRecord* victim;
+    FlowStateRecord* rec = probe(key, victim);
+
+    while (!rec && table_mask < max_mask)
     {
-        XHashNode* node = xhash_get_node(ip_map, &key);
+        grow();
+        rec = probe(key, victim);
+    }
 
-        if (!node)
+    if (rec)
+    {
+        if (!rec->used)
         {
-            DEBUG_WRAP(DebugMessage(DEBUG_STREAM,
-                "Key/Value pair didn't exist in the flow stats table and we couldn't add it!\n");
-                );
-            return nullptr;
+            rec->used = true;
+            rec->key = key;
         }
-        memset(node->data, 0, sizeof(FlowStateValue));
-        value = (FlowStateValue*)node->data;
+        return &rec->value;
     }
 
-    return value;
+    uint64_t count = victim->value.total_packets;
+
+    victim->key = key;
+    memset(&victim->value, 0, sizeof(victim->value));
+    victim->value.total_packets = count;
+    return &victim->value;
 }
 
 FlowIPTracker::FlowIPTracker(PerfConfig* perf) :
@@ -113,26 +218,35 @@ FlowIPTracker::FlowIPTracker(PerfConfig* perf) :
         &stats.state_changes[SFS_STATE_UDP_CREATED]);
     formatter->finalize_fields();
 
-    ip_map = xhash_new(1021, sizeof(FlowStateKey), sizeof(FlowStateValue),
-        perfmon_config->flowip_memcap, 1, nullptr, nullptr, 1);
+    // the memcap covers the live table and a snapshot still being written
+    unsigned slots = config->flowip_memcap / (2 * sizeof(FlowStateRecord));
+    unsigned size = FLOW_IP_PROBES;
+
+    while (size * 2 <= slots)
+        size *= 2;
 
-    if (!ip_map)
-        FatalError("Unable to allocate memory for FlowIP stats\n");
+    max_mask = size - 1;
+    reset();
 }
 
 FlowIPTracker::~FlowIPTracker()
 {
-    if (ip_map)
-        xhash_delete(ip_map);
+    drain(snap_size);
+    delete[] table;
 }
 
 void FlowIPTracker::reset()
 {
-    xhash_make_empty(ip_map);
+    delete[] table;
+    table = nullptr;
+    table_mask = ((FLOW_IP_INITIAL < max_mask + 1) ? FLOW_IP_INITIAL : max_mask + 1) - 1;
 }
 
 void FlowIPTracker::update(Packet* p)
 {
+    last_time = p->pkth->ts.tv_sec;
+    drain(FLOW_IP_DRAIN);
+
     if (p->has_ip() && !p->is_rebuilt())
     {
         FlowType type = SFS_TYPE_OTHER;
@@ -168,22 +282,67 @@ void FlowIPTracker::update(Packet* p)
     }
 }
 
-void FlowIPTracker::process(bool)
+void FlowIPTracker::write_records(FlowStateRecord* recs, unsigned start, unsigned end)
 {
-    for (auto node = xhash_findfirst(ip_map); node; node = xhash_findnext(ip_map))
+    for (unsigned i = start; i < end; i++)
     {
-        FlowStateKey* key = (FlowStateKey*)node->key;
-        FlowStateValue* cur_stats = (FlowStateValue*)node->data;
+        if (!recs[i].used)
+            continue;
 
-        key->ipA.ntop(ip_a, sizeof(ip_a));
-        key->ipB.ntop(ip_b, sizeof(ip_b));
-        memcpy(&stats, cur_stats, sizeof(stats));
+        recs[i].key.ipA.ntop(ip_a, sizeof(ip_a));
+        recs[i].key.ipB.ntop(ip_b, sizeof(ip_b));
+        memcpy(&stats, &recs[i].value, sizeof(stats));
 
         write();
     }
+}
+
+// write the next part of the snapshot stamped with the time it was taken
+// and free it once it has all gone out
+void FlowIPTracker::drain(unsigned slots)
+{
+    if (!snapshot)
+        return;
+
+    unsigned end = (slots < snap_size - snap_pos) ? snap_pos + slots : snap_size;
+
+    update_time(snap_time);
+    write_records(snapshot, snap_pos, end);
+    update_time(last_time);
 
-    if ( !(config->perf_flags & PERF_SUMMARY) )
-        reset();
+    snap_pos = end;
+
+    if (snap_pos == snap_size)
+    {
+        delete[] snapshot;
+        snapshot = nullptr;
+    }
+}
+
+// rather than walk the table here, hand it off as the snapshot and start a
+// new interval with an empty one.  update() does the formatting a little
+// at a time so one packet doesn't pay for the whole table.
+void FlowIPTracker::process(bool summary)
+{
+    drain(snap_size);
+
+    if (summary || (config->perf_flags & PERF_SUMMARY))
+    {
+        if (table)
+            write_records(table, 0, table_mask + 1);
+        return;
+    }
+
+    if (!table)
+        return;
+
+    snapshot = table;
+    snap_size = table_mask + 1;
+    table = nullptr;
+    reset();
+
+    snap_time = last_time;
+    snap_pos = 0;
 }
 
 int FlowIPTracker::update_state(const SfIp* src_addr, const SfIp* dst_addr, FlowState state)
@@ -199,3 +358,90 @@ int FlowIPTracker::update_state(const SfIp* src_addr, const SfIp* dst_addr, Flow
     return 0;
 }
 
+
+#ifdef UNIT_TEST
+class MockFlowIPTracker : public FlowIPTracker
+{
+public:
+    MockFlowIPTracker(PerfConfig* config) : FlowIPTracker(config) { }
+
+    FlowStateValue* find(const char* src, const char* dst, int& swapped)
+    {
+        SfIp a, b;
+        a.set(src);
+        b.set(dst);
+        return find_stats(&a, &b, &swapped);
+    }
+};
+
+TEST_CASE("pair order", "[FlowIPTracker]")
+{
+    PerfConfig config;
+    config.format = PERF_MOCK;
+    config.flowip_memcap = 8200;
+
+    MockFlowIPTracker tracker(&config);
+    int swapped;
+
+    FlowStateValue* v = tracker.find("10.1.1.1", "10.1.1.2", swapped);
+    CHECK(swapped == 0);
+    CHECK(tracker.find("10.1.1.2", "10.1.1.1", swapped) == v);
+    CHECK(swapped == 1);
+    CHECK(tracker.find("10.1.1.1", "10.1.1.3", swapped) != v);
+}
+
+TEST_CASE("heavy hitters stay", "[FlowIPTracker]")
+{
+    PerfConfig config;
+    config.format = PERF_MOCK;
+    config.perf_flags = 0;
+    config.flowip_memcap = 8200;
+
+    MockFlowIPTracker tracker(&config);
+    int swapped;
+
+    FlowStateValue* v = tracker.find("10.1.1.1", "10.1.1.2", swapped);
+    v->total_packets = 1000;
+
+    // far more pairs than the table holds
+    for ( unsigned i = 0; i < 1000; i++ )
+    {
+        std::string ip = "10.2." + std::to_string(i / 256) + "." + std::to_string(i % 256);
+        tracker.find("10.1.1.1", ip.c_str(), swapped)->total_packets = 1;
+    }
+    v = tracker.find("10.1.1.1", "10.1.1.2", swapped);
+    CHECK(v->total_packets == 1000);
+
+    // a new pair takes over the count of the one it replaces
+    CHECK(tracker.find("10.3.0.1", "10.3.0.2", swapped)->total_packets >= 1);
+
+    // the next interval starts empty
+    tracker.process(false);
+    v = tracker.find("10.1.1.1", "10.1.1.2", swapped);
+    CHECK(v->total_packets == 0);
+}
+
+TEST_CASE("table grows to the memcap", "[FlowIPTracker]")
+{
+    PerfConfig config;
+    config.format = PERF_MOCK;
+    config.flowip_memcap = 8 * FLOW_IP_INITIAL * 2 * sizeof(FlowStateRecord);
+
+    MockFlowIPTracker tracker(&config);
+    int swapped;
+
+    // more pairs than the initial table holds but well within the cap
+    for ( unsigned i = 0; i < 2 * FLOW_IP_INITIAL; i++ )
+    {
+        std::string ip = "10.2." + std::to_string(i / 256) + "." + std::to_string(i % 256);
+        tracker.find("10.1.1.1", ip.c_str(), swapped)->total_packets = i + 1;
+    }
+
+    // nothing was replaced on the way
+    for ( unsigned i = 0; i < 2 * FLOW_IP_INITIAL; i++ )
+    {
+        std::string ip = "10.2." + std::to_string(i / 256) + "." + std::to_string(i % 256);
+        CHECK(tracker.find("10.1.1.1", ip.c_str(), swapped)->total_packets == i + 1);
+    }
+}
+#endif
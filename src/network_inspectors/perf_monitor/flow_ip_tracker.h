@@ -22,7 +22,6 @@
 #define FLOW_IP_TRACKER_H
 
 #include "perf_tracker.h"
-#include "hash/xhash.h"
 
 enum FlowState
 {
@@ -56,6 +55,9 @@ struct FlowStateValue
     uint32_t state_changes[SFS_STATE_MAX];
 };
 
+struct FlowStateKey;
+struct FlowStateRecord;
+
 class FlowIPTracker : public PerfTracker
 {
 public:
@@ -68,14 +70,29 @@ public:
 
     int update_state(const SfIp* src_addr, const SfIp* dst_addr, FlowState);
 
+protected:
+    FlowStateValue* find_stats(const SfIp* src_addr, const SfIp* dst_addr, int* swapped);
+
 private:
     FlowStateValue stats;
-    XHash* ip_map;
     char ip_a[41], ip_b[41];
 
-    FlowStateValue* find_stats(const SfIp* src_addr, const SfIp* dst_addr, int* swapped);
-    void write_stats();
-    void display_stats();
+    // the live table is updated per packet and grows on demand up to
+    // max_mask + 1 slots; process() hands it off as the snapshot which is
+    // then written a few records per packet and freed
+    FlowStateRecord* table = nullptr;
+    FlowStateRecord* snapshot = nullptr;
+    unsigned table_mask = 0;
+    unsigned max_mask = 0;
+    unsigned snap_size = 0;
+    unsigned snap_pos = 0;
+    time_t snap_time = 0;
+    time_t last_time = 0;
+
+    FlowStateRecord* probe(const FlowStateKey&, FlowStateRecord*& victim);
+    void grow();
+    void write_records(FlowStateRecord*, unsigned start, unsigned end);
+    void drain(unsigned slots);
 };
 
 extern THREAD_LOCAL FlowIPTracker* perf_flow_ip;
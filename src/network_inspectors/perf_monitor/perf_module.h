@@ -44,6 +44,7 @@ enum PerfFormat
     PERF_CSV,
     PERF_TEXT,
     PERF_JSON,
+    PERF_BIN,
     PERF_FBS,
     PERF_MOCK
 };
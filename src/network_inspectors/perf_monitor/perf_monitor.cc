@@ -124,6 +124,9 @@ void PerfMonitor::show(SnortConfig*)
         case PERF_JSON:
             LogMessage("    Output Format:  json\n");
             break;
+        case PERF_BIN:
+            LogMessage("    Output Format:  bin\n");
+            break;
 #ifdef HAVE_FLATBUFFERS
         case PERF_FBS:
             LogMessage("    Output Format:  flatbuffers\n");
@@ -37,6 +37,7 @@
 #include "fbs_formatter.h"
 #endif
 
+#include "bin_formatter.h"
 #include "csv_formatter.h"
 #include "json_formatter.h"
 #include "text_formatter.h"
@@ -68,6 +69,7 @@ PerfTracker::PerfTracker(PerfConfig* config, bool file, const char* tracker_name
         case PERF_CSV: formatter = new CSVFormatter(tracker_name); break;
         case PERF_TEXT: formatter = new TextFormatter(tracker_name); break;
         case PERF_JSON: formatter = new JSONFormatter(tracker_name); break;
+        case PERF_BIN: formatter = new BinFormatter(tracker_name); break;
 #ifdef HAVE_FLATBUFFERS
         case PERF_FBS: formatter = new FbsFormatter(tracker_name); break;
 #endif
@@ -20,6 +20,8 @@
 #ifndef REPUTATION_CONFIG_H
 #define REPUTATION_CONFIG_H
 
+#include <memory>
+
 #include "framework/counts.h"
 #include "main/snort_debug.h"
 #include "main/thread.h"
@@ -29,6 +31,8 @@
 
 // Configuration for reputation network inspector
 
+class ReputationImage;
+
 enum NestedIP
 {
     INNER,
@@ -72,9 +76,11 @@ struct ReputationConfig
     uint8_t* reputation_segment = nullptr;
     char* blacklist_path = nullptr;
     char* whitelist_path = nullptr;
+    char* image_path = nullptr;
     bool memCapReached = false;
     table_flat_t* iplist = nullptr;
     ListInfo* listInfo = nullptr;
+    std::shared_ptr<ReputationImage> image;
 
     ~ReputationConfig();
 };
@@ -0,0 +1,198 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "reputation_image.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "log/messages.h"
+#include "utils/util.h"
+
+using namespace std;
+
+#define IMAGE_BYTE_ORDER 0x01020304
+
+// images are keyed by file identity so a feed rewritten in place is
+// mapped again while an unchanged one is shared across reloads
+static string image_key(const char* path, const struct stat& st)
+{
+    return string(path) + ":" + to_string(st.st_dev) + ":" + to_string(st.st_ino) + ":" +
+        to_string(st.st_size) + ":" + to_string(st.st_mtime);
+}
+
+static mutex image_mutex;
+static map<string, weak_ptr<ReputationImage>> images;
+
+ReputationImage::~ReputationImage()
+{
+    munmap(map, map_size);
+}
+
+bool ReputationImage::validate(const char* path) const
+{
+    const ReputationImageHeader* h = header();
+
+    if ( map_size < sizeof(*h) || memcmp(h->magic, REPUTATION_IMAGE_MAGIC, sizeof(h->magic)) )
+    {
+        ErrorMessage("reputation: %s is not a reputation image\n", path);
+        return false;
+    }
+
+    if ( h->version != REPUTATION_IMAGE_VERSION || h->byte_order != IMAGE_BYTE_ORDER )
+    {
+        ErrorMessage("reputation: %s was compiled for a different version or platform\n", path);
+        return false;
+    }
+
+    if ( h->header_size < sizeof(*h) || (size_t)h->header_size + h->image_size != map_size ||
+        h->image_size < sizeof(table_flat_t) )
+    {
+        ErrorMessage("reputation: %s is truncated\n", path);
+        return false;
+    }
+
+    // the lookup walks offsets from the table so the roots must be in range;
+    // the rest of the image is trusted as written by ReputationImage::save()
+    const table_flat_t* t = get_table();
+
+    if ( !t->rt || !t->rt6 || !t->data || !t->list_info ||
+        t->rt >= h->image_size || t->rt6 >= h->image_size ||
+        t->data >= h->image_size || t->list_info >= h->image_size )
+    {
+        ErrorMessage("reputation: %s has an invalid table\n", path);
+        return false;
+    }
+
+    return true;
+}
+
+shared_ptr<ReputationImage> ReputationImage::load(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+
+    if ( fd < 0 )
+    {
+        ErrorMessage("reputation: can't open image %s: %s\n", path, get_error(errno));
+        return nullptr;
+    }
+
+    struct stat st;
+
+    if ( fstat(fd, &st) || st.st_size <= 0 )
+    {
+        ErrorMessage("reputation: can't stat image %s: %s\n", path, get_error(errno));
+        close(fd);
+        return nullptr;
+    }
+
+    string key = image_key(path, st);
+    lock_guard<mutex> lock(image_mutex);
+
+    auto it = images.find(key);
+    shared_ptr<ReputationImage> img;
+
+    if ( it != images.end() && (img = it->second.lock()) )
+    {
+        close(fd);
+        return img;
+    }
+
+    void* m = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if ( m == MAP_FAILED )
+    {
+        ErrorMessage("reputation: can't map image %s: %s\n", path, get_error(errno));
+        return nullptr;
+    }
+
+    img.reset(new ReputationImage((uint8_t*)m, st.st_size));
+
+    if ( !img->validate(path) )
+        return nullptr;
+
+    for ( auto it = images.begin(); it != images.end(); )
+    {
+        if ( it->second.expired() )
+            it = images.erase(it);
+        else
+            ++it;
+    }
+
+    images[key] = img;
+    return img;
+}
+
+bool ReputationImage::save(const char* path, const ReputationConfig* config)
+{
+    if ( !config->iplist || !config->reputation_segment )
+        return false;
+
+    // lookups use the table as the segment base
+    assert((uint8_t*)config->iplist == config->reputation_segment);
+
+    ReputationImageHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, REPUTATION_IMAGE_MAGIC, sizeof(h.magic));
+
+    h.version = REPUTATION_IMAGE_VERSION;
+    h.byte_order = IMAGE_BYTE_ORDER;
+    h.header_size = sizeof(h);
+    h.image_size = segment_usedmem();
+    h.num_entries = sfrt_flat_num_entries(config->iplist);
+    h.usage = sfrt_flat_usage(config->iplist);
+    h.white_action = config->whiteAction;
+
+    // write to a temporary and rename so running instances never map a
+    // partially written image
+    string tmp = string(path) + ".tmp";
+    FILE* fp = fopen(tmp.c_str(), "wb");
+
+    if ( !fp )
+    {
+        ErrorMessage("reputation: can't create image %s: %s\n", tmp.c_str(), get_error(errno));
+        return false;
+    }
+
+    bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+        fwrite(config->reputation_segment, h.image_size, 1, fp) == 1;
+
+    ok = !fclose(fp) && ok;
+
+    if ( !ok || rename(tmp.c_str(), path) )
+    {
+        ErrorMessage("reputation: can't write image %s: %s\n", path, get_error(errno));
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
@@ -0,0 +1,87 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifndef REPUTATION_IMAGE_H
+#define REPUTATION_IMAGE_H
+
+// A reputation image is the segment memory of a fully built sfrt_flat
+// table written to disk as is.  Everything in the segment is addressed by
+// offset from the table so the image can be mapped read-only anywhere and
+// used for lookups without parsing the original IP lists.  Mappings are
+// shared by all reload generations that reference the same file.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "reputation_config.h"
+
+#define REPUTATION_IMAGE_MAGIC "SNORTREP"
+#define REPUTATION_IMAGE_VERSION 1
+
+struct ReputationImageHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t header_size;
+    uint32_t image_size;   // bytes of segment memory following the header
+    uint32_t num_entries;
+    uint32_t usage;
+    uint8_t white_action;
+    uint8_t reserved[31];
+};
+
+class ReputationImage
+{
+public:
+    ~ReputationImage();
+
+    // map the image at path, reusing an existing mapping of the same file
+    static std::shared_ptr<ReputationImage> load(const char* path);
+
+    // write the table built in the current segment to path
+    static bool save(const char* path, const ReputationConfig*);
+
+    table_flat_t* get_table() const
+    { return (table_flat_t*)(map + header()->header_size); }
+
+    WhiteAction get_white_action() const
+    { return (WhiteAction)header()->white_action; }
+
+    uint32_t get_num_entries() const
+    { return header()->num_entries; }
+
+    uint32_t get_usage() const
+    { return header()->usage; }
+
+private:
+    ReputationImage(uint8_t* m, size_t n) : map(m), map_size(n) { }
+
+    const ReputationImageHeader* header() const
+    { return (const ReputationImageHeader*)map; }
+
+    bool validate(const char* path) const;
+
+private:
+    uint8_t* map;
+    size_t map_size;
+};
+
+#endif
+
@@ -25,13 +25,20 @@
 
 #include "reputation_inspect.h"
 
+#include <atomic>
+#include <string>
+
 #include "detection/detect.h"
 #include "detection/detection_engine.h"
 #include "events/event_queue.h"
 #include "log/messages.h"
+#include "main/analyzer_command.h"
+#include "managers/inspector_manager.h"
 #include "packet_io/active.h"
 #include "profiler/profiler.h"
+#include "utils/util.h"
 
+#include "reputation_image.h"
 #include "reputation_module.h"
 
 THREAD_LOCAL ProfileStats reputationPerfStats;
@@ -66,7 +73,7 @@ const char* WhiteActionOption[] =
 /*
  * Function prototype(s)
  */
-static void snort_reputation(ReputationConfig* GlobalConf, Packet* p);
+static void snort_reputation(ReputationConfig* GlobalConf, table_flat_t* iplist, Packet* p);
 
 unsigned ReputationFlowData::inspector_id = 0;
 
@@ -119,6 +126,8 @@ static void PrintIPlistStats(ReputationConfig* config)
     LogMessage("    Reputation total memory usage: " STDu64 " bytes\n",
         reputationstats.memory_allocated);
     config->numEntries = sfrt_flat_num_entries(config->iplist);
+    if (config->image_path)
+        LogMessage("    Reputation list image: %s\n", config->image_path);
     LogMessage("    Reputation total entries loaded: %u, invalid: %lu, re-defined: %lu\n",
         config->numEntries,total_invalids,total_duplicates);
 }
@@ -152,7 +161,8 @@ static void PrintReputationConf(ReputationConfig* config)
     LogMessage("\n");
 }
 
-static inline IPrepInfo* ReputationLookup(ReputationConfig* config, const SfIp* ip)
+static inline IPrepInfo* ReputationLookup(ReputationConfig* config, table_flat_t* iplist,
+    const SfIp* ip)
 {
     IPrepInfo* result;
 
@@ -166,21 +176,21 @@ static inline IPrepInfo* ReputationLookup(ReputationConfig* config, const SfIp*
         }
     }
 
-    result = (IPrepInfo*)sfrt_flat_dir8x_lookup(ip, config->iplist);
+    result = (IPrepInfo*)sfrt_flat_dir8x_lookup(ip, iplist);
 
     return (result);
 }
 
-static inline IPdecision GetReputation(ReputationConfig* config, IPrepInfo* repInfo,
-    uint32_t* listid)
+static inline IPdecision GetReputation(ReputationConfig* config, table_flat_t* iplist,
+    IPrepInfo* repInfo, uint32_t* listid)
 {
     IPdecision decision = DECISION_NULL;
     uint8_t* base;
     ListInfo* listInfo;
 
     /*Walk through the IPrepInfo lists*/
-    base = (uint8_t*)config->iplist;
-    listInfo =  (ListInfo*)(&base[config->iplist->list_info]);
+    base = (uint8_t*)iplist;
+    listInfo =  (ListInfo*)(&base[iplist->list_info]);
 
     while (repInfo)
     {
@@ -213,18 +223,18 @@ static inline IPdecision GetReputation(ReputationConfig* config, IPrepInfo* repI
     return decision;
 }
 
-static bool ReputationDecisionPerLayer(ReputationConfig* config, Packet* p,
-        const ip::IpApi& ip_api, IPdecision* decision_final)
+static bool ReputationDecisionPerLayer(ReputationConfig* config, table_flat_t* iplist,
+        Packet* p, const ip::IpApi& ip_api, IPdecision* decision_final)
 {
     const SfIp* ip;
     IPdecision decision;
     IPrepInfo* result;
 
     ip = ip_api.get_src();
-    result = ReputationLookup(config, ip);
+    result = ReputationLookup(config, iplist, ip);
     if (result)
     {
-        decision = GetReputation(config, result, &p->iplist_id);
+        decision = GetReputation(config, iplist, result, &p->iplist_id);
 
         *decision_final = decision;
         if ( config->priority == decision)
@@ -232,10 +242,10 @@ static bool ReputationDecisionPerLayer(ReputationConfig* config, Packet* p,
     }
 
     ip = ip_api.get_dst();
-    result = ReputationLookup(config, ip);
+    result = ReputationLookup(config, iplist, ip);
     if (result)
     {
-        decision = GetReputation(config, result, &p->iplist_id);
+        decision = GetReputation(config, iplist, result, &p->iplist_id);
 
         *decision_final = decision;
         if ( config->priority == decision)
@@ -245,7 +255,7 @@ static bool ReputationDecisionPerLayer(ReputationConfig* config, Packet* p,
     return false;
 }
 
-static IPdecision ReputationDecision(ReputationConfig* config, Packet* p)
+static IPdecision ReputationDecision(ReputationConfig* config, table_flat_t* iplist, Packet* p)
 {
     IPdecision decision_final = DECISION_NULL;
 
@@ -260,7 +270,7 @@ static IPdecision ReputationDecision(ReputationConfig* config, Packet* p)
     {
         outer_layer = true;
 
-        if(ReputationDecisionPerLayer(config, p, p->ptrs.ip_api, &decision_final))
+        if(ReputationDecisionPerLayer(config, iplist, p, p->ptrs.ip_api, &decision_final))
             return decision_final;
 
         if(outer_layer_only)
@@ -277,20 +287,20 @@ static IPdecision ReputationDecision(ReputationConfig* config, Packet* p)
     /*Check INNER IP, when configured or only one layer*/
     if (!outer_layer || (config->nestedIP == INNER) || (config->nestedIP == ALL))
     {
-        ReputationDecisionPerLayer(config, p, p->ptrs.ip_api, &decision_final);
+        ReputationDecisionPerLayer(config, iplist, p, p->ptrs.ip_api, &decision_final);
     }
 
     return (decision_final);
 }
 
-static void snort_reputation(ReputationConfig* config, Packet* p)
+static void snort_reputation(ReputationConfig* config, table_flat_t* iplist, Packet* p)
 {
     IPdecision decision;
 
-    if (!config->iplist)
+    if (!iplist)
         return;
 
-    decision = ReputationDecision(config, p);
+    decision = ReputationDecision(config, iplist, p);
 
     if (DECISION_NULL == decision)
         return;
@@ -319,6 +329,58 @@ static void snort_reputation(ReputationConfig* config, Packet* p)
     }
 }
 
+//-------------------------------------------------------------------------
+// image swap
+//-------------------------------------------------------------------------
+
+// packet threads load the table once per packet so a thread that has run
+// this command, which happens between packets, no longer uses the image it
+// replaced.  the command is deleted on the main thread once every packet
+// thread has run it, and that releases the image.
+class ReputationRetire : public AnalyzerCommand
+{
+public:
+    ReputationRetire(std::shared_ptr<ReputationImage>& img) : image(img) { }
+
+    void execute(Analyzer&) override { }
+    const char* stringify() override { return "REPUTATION_RETIRE"; }
+
+private:
+    std::shared_ptr<ReputationImage> image;
+};
+
+// an image swapped in with load_image stays in service across reloads
+// until the configured lists change.  only used on the main thread.
+struct LiveImage
+{
+    std::string source;
+    std::string path;
+    std::shared_ptr<ReputationImage> image;
+};
+
+static LiveImage live_image;
+
+static std::string get_source(const ReputationConfig* config)
+{
+    std::string s = config->image_path ? config->image_path : "";
+    s += ":";
+    s += config->blacklist_path ? config->blacklist_path : "";
+    s += ":";
+    s += config->whitelist_path ? config->whitelist_path : "";
+    return s;
+}
+
+static void set_image(ReputationConfig* config, const std::string& path,
+    std::shared_ptr<ReputationImage>& img)
+{
+    if ( config->image_path )
+        snort_free(config->image_path);
+
+    config->image_path = snort_strdup(path.c_str());
+    config->image = img;
+    config->iplist = img->get_table();
+}
+
 //-------------------------------------------------------------------------
 // class stuff
 //-------------------------------------------------------------------------
@@ -332,14 +394,35 @@ public:
     void show(SnortConfig*) override;
     void eval(Packet*) override;
 
+    bool swap_image(const char* path, std::shared_ptr<ReputationImage>&);
+
 private:
     ReputationConfig* config;
+    std::string source;
+
+    // the table packet threads use; config->image keeps it mapped
+    std::atomic<table_flat_t*> iplist;
 };
 
 Reputation::Reputation(ReputationConfig* pc)
 {
     config = pc;
-    reputationstats.memory_allocated = sfrt_flat_usage(config->iplist);
+    source = get_source(config);
+
+    if ( live_image.image )
+    {
+        if ( live_image.source == source &&
+            live_image.image->get_white_action() == config->whiteAction )
+            set_image(config, live_image.path, live_image.image);
+        else
+            live_image = LiveImage();
+    }
+    iplist = config->iplist;
+
+    if ( config->image )
+        reputationstats.memory_allocated = config->image->get_usage();
+    else
+        reputationstats.memory_allocated = sfrt_flat_usage(config->iplist);
 }
 
 Reputation::~Reputation()
@@ -364,12 +447,53 @@ void Reputation::eval(Packet* p)
 
     if (!p->is_rebuilt() && !IsReputationDisabled(p->flow))
     {
-        snort_reputation(config, p);
+        snort_reputation(config, iplist.load(std::memory_order_acquire), p);
         DisableReputation(p->flow);
         ++reputationstats.packets;
     }
 }
 
+bool Reputation::swap_image(const char* path, std::shared_ptr<ReputationImage>& img)
+{
+    if ( img->get_white_action() != config->whiteAction )
+    {
+        ErrorMessage("reputation: image white action differs from the running config\n");
+        return false;
+    }
+
+    std::shared_ptr<ReputationImage> old = config->image;
+
+    set_image(config, path, img);
+    iplist.store(config->iplist, std::memory_order_release);
+
+    live_image.source = source;
+    live_image.path = path;
+    live_image.image = img;
+    reputationstats.memory_allocated = img->get_usage();
+
+    if ( old )
+        main_broadcast_command(new ReputationRetire(old));
+
+    LogMessage("reputation: swapped in list image with %u entries\n", img->get_num_entries());
+    return true;
+}
+
+void reputation_swap_image(const char* path)
+{
+    Reputation* rep = (Reputation*)InspectorManager::get_inspector(REPUTATION_NAME, true);
+
+    if ( !rep )
+    {
+        ErrorMessage("reputation: not configured\n");
+        return;
+    }
+
+    std::shared_ptr<ReputationImage> img = ReputationImage::load(path);
+
+    if ( img )
+        rep->swap_image(path, img);
+}
+
 //-------------------------------------------------------------------------
 // api stuff
 //-------------------------------------------------------------------------
@@ -43,5 +43,8 @@ public:
     ReputationData session;
 };
 
+// map the image at path and swap it into the running inspector
+void reputation_swap_image(const char* path);
+
 #endif
 
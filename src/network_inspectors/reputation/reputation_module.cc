@@ -24,11 +24,15 @@
 
 #include "reputation_module.h"
 
+#include <lua.hpp>
+
 #include <cassert>
 
 #include "log/messages.h"
 #include "utils/util.h"
 
+#include "reputation_image.h"
+#include "reputation_inspect.h"
 #include "reputation_parse.h"
 
 using namespace std;
@@ -45,6 +49,9 @@ static const Parameter s_params[] =
     { "blacklist", Parameter::PT_STRING, nullptr, nullptr,
       "blacklist file name with IP lists" },
 
+    { "image", Parameter::PT_STRING, nullptr, nullptr,
+      "precompiled list image to map instead of loading the IP list files" },
+
     { "memcap", Parameter::PT_INT, "1:4095", "500",
       "maximum total MB of memory allocated" },
 
@@ -66,6 +73,26 @@ static const Parameter s_params[] =
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
+static const Parameter s_image[] =
+{
+    { "image", Parameter::PT_STRING, nullptr, nullptr,
+      "precompiled list image file name" },
+
+    { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
+};
+
+static int load_image(lua_State* L)
+{
+    reputation_swap_image(luaL_checkstring(L, 1));
+    return 0;
+}
+
+static const Command reputation_cmds[] =
+{
+    { "load_image", load_image, s_image, "map a precompiled list image and swap it in" },
+    { nullptr, nullptr, nullptr, nullptr }
+};
+
 static const RuleMap reputation_rules[] =
 {
     { REPUTATION_EVENT_BLACKLIST, REPUTATION_EVENT_BLACKLIST_STR },
@@ -90,6 +117,9 @@ ReputationModule::~ReputationModule()
         delete conf;
 }
 
+const Command* ReputationModule::get_commands() const
+{ return reputation_cmds; }
+
 const RuleMap* ReputationModule::get_rules() const
 { return reputation_rules; }
 
@@ -107,6 +137,9 @@ bool ReputationModule::set(const char*, Value& v, SnortConfig*)
     if ( v.is("blacklist") )
         conf->blacklist_path = snort_strdup(v.get_string());
 
+    else if ( v.is("image") )
+        conf->image_path = snort_strdup(v.get_string());
+
     else if ( v.is("memcap") )
         conf->memcap = v.get_long();
 
@@ -147,15 +180,37 @@ bool ReputationModule::begin(const char*, int, SnortConfig*)
 
 bool ReputationModule::end(const char*, int, SnortConfig*)
 {
-    EstimateNumEntries(conf);
-    if (conf->numEntries <= 0)
+    if ( conf->image_path )
     {
-        ParseWarning(WARN_CONF,
-            "reputation: can't find any whitelist/blacklist entries; disabled.");
-        return true;
-    }
+        conf->image = ReputationImage::load(conf->image_path);
+
+        if ( !conf->image )
+        {
+            ParseError("reputation: can't load image %s", conf->image_path);
+            return true;
+        }
 
-    IpListInit(conf->numEntries + 1, conf);
+        if ( conf->blacklist_path || conf->whitelist_path )
+            ParseWarning(WARN_CONF, "reputation: list files are ignored when image is set");
+
+        // the list types were fixed when the image was compiled
+        conf->whiteAction = conf->image->get_white_action();
+        conf->iplist = conf->image->get_table();
+    }
+    else
+    {
+        EstimateNumEntries(conf);
+        if (conf->numEntries <= 0)
+        {
+            ParseWarning(WARN_CONF,
+                "reputation: can't find any whitelist/blacklist entries; disabled.");
+            return true;
+        }
+
+        IpListInit(conf->numEntries + 1, conf);
+        LoadListFile(conf->blacklist_path, conf->local_black_ptr, conf);
+        LoadListFile(conf->whitelist_path, conf->local_white_ptr, conf);
+    }
 
     if ( (conf->priority == WHITELISTED_TRUST) && (conf->whiteAction == UNBLACK) )
     {
@@ -164,8 +219,6 @@ bool ReputationModule::end(const char*, int, SnortConfig*)
             conf->priority = WHITELISTED_UNBLACK;
     }
 
-    LoadListFile(conf->blacklist_path, conf->local_black_ptr, conf);
-    LoadListFile(conf->whitelist_path, conf->local_white_ptr, conf);
     return true;
 }
 
@@ -54,6 +54,7 @@ public:
     unsigned get_gid() const override
     { return GID_REPUTATION; }
 
+    const Command* get_commands() const override;
     const RuleMap* get_rules() const override;
     const PegInfo* get_pegs() const override;
     PegCount* get_counts() const override;
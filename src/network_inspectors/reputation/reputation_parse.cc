@@ -68,6 +68,9 @@ ReputationConfig::~ReputationConfig()
 
     if (whitelist_path)
         snort_free(whitelist_path);
+
+    if (image_path)
+        snort_free(image_path);
 }
 
 
@@ -24,6 +24,11 @@
 
 #include "memory_profiler.h"
 
+#include <sstream>
+
+#include "log/messages.h"
+#include "memory/memory_cap.h"
+
 #include "profiler_nodes.h"
 #include "profiler_printer.h"
 #include "memory_defs.h"
@@ -143,6 +148,57 @@ static void print_fn(StatsTable& t, const View& v)
 
 } // namespace memory_stats
 
+namespace memory_domain_stats
+{
+
+static const StatsTable::Field fields[] =
+{
+    { "domain", 12, ' ', 0, std::ios_base::left },
+    { "allocs", 10, ' ', 0, std::ios_base::fmtflags() },
+    { "used (kb)", 12, ' ', 2, std::ios_base::fmtflags() },
+    { "cap (kb)", 12, ' ', 0, std::ios_base::fmtflags() },
+    { "prunes", 8, ' ', 0, std::ios_base::fmtflags() },
+    { nullptr, 0, '\0', 0, std::ios_base::fmtflags() }
+};
+
+static void print()
+{
+    bool used = false;
+
+    for ( unsigned i = 0; i < memory::NUM_DOMAINS; ++i )
+        used = used or memory::MemoryCap::get_domain_stats((memory::Domain)i).allocations;
+
+    if ( !used )
+        return;
+
+    std::ostringstream ss;
+
+    {
+        StatsTable table(fields, ss);
+
+        table << StatsTable::SEP;
+        table << "memory domains\n";
+        table << StatsTable::HEADER;
+
+        for ( unsigned i = 0; i < memory::NUM_DOMAINS; ++i )
+        {
+            const auto d = (memory::Domain)i;
+            const auto& stats = memory::MemoryCap::get_domain_stats(d);
+
+            table << StatsTable::ROW;
+            table << memory::get_domain_name(d);
+            table << stats.allocations;
+            table << double(stats.in_use()) / 1024.0;
+            table << memory::MemoryCap::get_domain_cap(d) / 1024;
+            table << stats.prunes;
+        }
+    }
+
+    LogMessage("%s", ss.str().c_str());
+}
+
+} // namespace memory_domain_stats
+
 void show_memory_profiler_stats(ProfilerNodeMap& nodes, const MemoryProfilerConfig& config)
 {
     if ( !config.show )
@@ -151,13 +207,17 @@ void show_memory_profiler_stats(ProfilerNodeMap& nodes, const MemoryProfilerConf
     ProfilerBuilder<memory_stats::View> builder(memory_stats::include_fn);
     auto root = builder.build(nodes.get_root());
 
-    if ( root.children.empty() && !root.view.stats )
-        return;
+    if ( !root.children.empty() || root.view.stats )
+    {
+        const auto& sorter = memory_stats::sorters[config.sort];
+
+        ProfilerPrinter<memory_stats::View> printer(
+            memory_stats::fields, memory_stats::print_fn, sorter);
 
-    const auto& sorter = memory_stats::sorters[config.sort];
+        printer.print_table(s_memory_table_title, root, config.count, config.max_depth);
+    }
 
-    ProfilerPrinter<memory_stats::View> printer(memory_stats::fields, memory_stats::print_fn, sorter);
-    printer.print_table(s_memory_table_title, root, config.count, config.max_depth);
+    memory_domain_stats::print();
 }
 
 #ifdef UNIT_TEST
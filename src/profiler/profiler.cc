@@ -28,6 +28,7 @@
 
 #include "framework/module.h"
 #include "main/snort_config.h"
+#include "memory/memory_cap.h"
 
 #include "memory_context.h"
 #include "memory_profiler.h"
@@ -73,6 +74,7 @@ void Profiler::consolidate_stats()
 {
     s_profiler_nodes.accumulate_nodes();
     MemoryProfiler::consolidate_fallthrough_stats();
+    memory::MemoryCap::consolidate();
 }
 
 void Profiler::reset_stats()
@@ -36,6 +36,12 @@
 
 static THREAD_LOCAL int co_reassembled = 0;
 
+/* Context id nodes are allocated for every context in every bind and
+ * alter context so they are recycled per thread. */
+#define DCE2_CO_CTX_POOL_MAX 256
+
+static THREAD_LOCAL DCE2_Pool<DCE2_CoCtxIdNode> ctx_pool;
+
 /********************************************************************
  * Function: DCE2_CoInitTracker()
  *
@@ -459,7 +465,7 @@ static void DCE2_CoCtxFree(void* data)
     if (data == nullptr)
         return;
 
-    snort_free(data);
+    ctx_pool.put((DCE2_CoCtxIdNode*)data);
 }
 
 /********************************************************************
@@ -477,7 +483,7 @@ static inline DCE2_Ret DCE2_CoInitCtxStorage(DCE2_CoTracker* cot)
 
     if (cot->ctx_ids == nullptr)
     {
-        cot->ctx_ids = DCE2_ListNew(DCE2_LIST_TYPE__SPLAYED, DCE2_CoCtxCompare, DCE2_CoCtxFree,
+        cot->ctx_ids = DCE2_ListNew(DCE2_LIST_TYPE__HASHED, DCE2_CoCtxCompare, DCE2_CoCtxFree,
             nullptr, DCE2_LIST_FLAG__NO_DUPS);
         if (cot->ctx_ids == nullptr)
             return DCE2_RET__ERROR;
@@ -586,14 +592,14 @@ static DCE2_CoCtxIdNode* dce_co_process_ctx_id(DCE2_SsnData* sd,DCE2_CoTracker*
         }
     }
 
-    ctx_node = (DCE2_CoCtxIdNode*)snort_calloc(sizeof(DCE2_CoCtxIdNode));
+    ctx_node = ctx_pool.get();
 
     /* Add context id to pending queue */
     status = DCE2_QueueEnqueue(cot->pending_ctx_ids, ctx_node);
 
     if (status != DCE2_RET__SUCCESS)
     {
-        snort_free(ctx_node);
+        ctx_pool.put(ctx_node);
         return nullptr;
     }
 
@@ -762,7 +768,7 @@ static void dce_co_process_ctx_result(DCE2_SsnData* sd,DCE2_CoTracker* cot,
             break;
         }
 
-        snort_free((void*)ctx_node);
+        ctx_pool.put(ctx_node);
     }
     else
     {
@@ -770,7 +776,7 @@ static void dce_co_process_ctx_result(DCE2_SsnData* sd,DCE2_CoTracker* cot,
             (void*)ctx_node);
         if (status != DCE2_RET__SUCCESS)
         {
-            snort_free((void*)ctx_node);
+            ctx_pool.put(ctx_node);
             DebugMessage(DEBUG_DCE_COMMON,
                 "Failed to add context id node to list.\n");
             return;
@@ -1748,7 +1754,7 @@ static void DCE2_CoResponse(DCE2_SsnData* sd, DCE2_CoTracker* cot,
         {
             /* Might be a duplicate in there already.  If there is we would have used it
              * anyway before looking at the pending queue.  Just get rid of it */
-            snort_free((void*)ctx_node);
+            ctx_pool.put(ctx_node);
             return;
         }
     }
@@ -2461,3 +2467,18 @@ dce2_coprocess_exit:
         DCE2_CoEarlyReassemble(sd, cot);
 }
 
+void DCE2_CoInitPools()
+{
+    ctx_pool.max_free = DCE2_CO_CTX_POOL_MAX;
+}
+
+bool DCE2_CoPrunePools()
+{
+    return ctx_pool.shed() > 0;
+}
+
+void DCE2_CoReleasePools()
+{
+    ctx_pool.release();
+}
+
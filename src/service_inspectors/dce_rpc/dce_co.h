@@ -414,6 +414,9 @@ void DCE2_CoProcess(DCE2_SsnData*, DCE2_CoTracker*,
     const uint8_t*, uint16_t);
 void DCE2_CoInitRdata(uint8_t*, int);
 void DCE2_CoCleanTracker(DCE2_CoTracker*);
+void DCE2_CoInitPools();
+bool DCE2_CoPrunePools();
+void DCE2_CoReleasePools();
 
 #endif
 
@@ -40,6 +40,29 @@
 static void DCE2_ListInsertTail(DCE2_List*, DCE2_ListNode*);
 static void DCE2_ListInsertHead(DCE2_List*, DCE2_ListNode*);
 static void DCE2_ListInsertBefore(DCE2_List*, DCE2_ListNode*, DCE2_ListNode*);
+static DCE2_ListNode* DCE2_ListIndexFind(DCE2_List*, const void*);
+static void DCE2_ListIndexAdd(DCE2_List*, DCE2_ListNode*);
+static void DCE2_ListIndexRemove(DCE2_List*, DCE2_ListNode*);
+static void DCE2_ListIndexFree(DCE2_List*);
+
+/********************************************************************
+ * Hash index for DCE2_LIST_TYPE__HASHED lists
+ *
+ * Keys of hashed lists are integer ids cast to pointers, like uids,
+ * tids, fids and context ids, and the compare functions only look at
+ * the low 32 bits so that's what gets hashed.  Short lists are still
+ * just walked; once a list reaches DCE2_LIST_INDEX_MIN nodes an open
+ * addressing table with linear probing is built over the nodes and
+ * kept up to date from then on.  The nodes stay linked in splayed
+ * order so iterating a hashed list is the same as a splayed one.
+ ********************************************************************/
+#define DCE2_LIST_INDEX_MIN   8
+#define DCE2_LIST_INDEX_START 32
+
+/* Marks an index slot whose node was removed so probing continues
+ * past it */
+static DCE2_ListNode dce2_list_deleted;
+#define DCE2_LIST_DELETED (&dce2_list_deleted)
 
 /********************************************************************
  * Function: DCE2_ListNew()
@@ -242,7 +265,14 @@ DCE2_Ret DCE2_ListInsert(DCE2_List* list, void* key, void* data)
     if (list == nullptr)
         return DCE2_RET__ERROR;
 
-    if (list->flags & DCE2_LIST_FLAG__NO_DUPS)
+    if ((list->flags & DCE2_LIST_FLAG__NO_DUPS) && (list->index != nullptr))
+    {
+        if (DCE2_ListIndexFind(list, key) != nullptr)
+            return DCE2_RET__DUPLICATE;
+
+        dup_check = 1;
+    }
+    else if (list->flags & DCE2_LIST_FLAG__NO_DUPS)
     {
         for (last = list->head; last != nullptr; last = last->next)
         {
@@ -301,6 +331,9 @@ DCE2_Ret DCE2_ListInsert(DCE2_List* list, void* key, void* data)
             DCE2_ListInsertBefore(list, n, tmp);
     }
 
+    if (list->type == DCE2_LIST_TYPE__HASHED)
+        DCE2_ListIndexAdd(list, n);
+
     return DCE2_RET__SUCCESS;
 }
 
@@ -415,6 +448,8 @@ void DCE2_ListEmpty(DCE2_List* list)
 
     list->head = list->tail = list->current = nullptr;
     list->num_nodes = 0;
+
+    DCE2_ListIndexFree(list);
 }
 
 /********************************************************************
@@ -465,7 +500,11 @@ void* DCE2_ListFind(DCE2_List* list, void* key)
     if (list == nullptr)
         return nullptr;
 
-    for (n = list->head; n != nullptr; n = n->next)
+    if (list->index != nullptr)
+    {
+        n = DCE2_ListIndexFind(list, key);
+    }
+    else for (n = list->head; n != nullptr; n = n->next)
     {
         int comp = list->compare(key, n->key);
         if (comp == 0)
@@ -483,7 +522,8 @@ void* DCE2_ListFind(DCE2_List* list, void* key)
     if (n != nullptr)
     {
         /* If list is splayed, move found node to front of list */
-        if ((list->type == DCE2_LIST_TYPE__SPLAYED) &&
+        if (((list->type == DCE2_LIST_TYPE__SPLAYED) ||
+            (list->type == DCE2_LIST_TYPE__HASHED)) &&
             (n != list->head))
         {
             n->prev->next = n->next;
@@ -531,7 +571,11 @@ DCE2_Ret DCE2_ListFindKey(DCE2_List* list, void* key)
     if (list == nullptr)
         return DCE2_RET__ERROR;
 
-    for (n = list->head; n != nullptr; n = n->next)
+    if (list->index != nullptr)
+    {
+        n = DCE2_ListIndexFind(list, key);
+    }
+    else for (n = list->head; n != nullptr; n = n->next)
     {
         int comp = list->compare(key, n->key);
         if (comp == 0)
@@ -549,7 +593,8 @@ DCE2_Ret DCE2_ListFindKey(DCE2_List* list, void* key)
     if (n != nullptr)
     {
         /* If list is splayed, move found node to front of list */
-        if ((list->type == DCE2_LIST_TYPE__SPLAYED) &&
+        if (((list->type == DCE2_LIST_TYPE__SPLAYED) ||
+            (list->type == DCE2_LIST_TYPE__HASHED)) &&
             (n != list->head))
         {
             n->prev->next = n->next;
@@ -600,7 +645,11 @@ DCE2_Ret DCE2_ListRemove(DCE2_List* list, void* key)
     if (list == nullptr)
         return DCE2_RET__ERROR;
 
-    for (n = list->head; n != nullptr; n = n->next)
+    if (list->index != nullptr)
+    {
+        n = DCE2_ListIndexFind(list, key);
+    }
+    else for (n = list->head; n != nullptr; n = n->next)
     {
         int comp = list->compare(key, n->key);
         if (comp == 0)
@@ -618,6 +667,8 @@ DCE2_Ret DCE2_ListRemove(DCE2_List* list, void* key)
     if (n == nullptr)
         return DCE2_RET__ERROR;
 
+    DCE2_ListIndexRemove(list, n);
+
     if (n == list->head)
         list->head = n->next;
     if (n == list->tail)
@@ -668,6 +719,8 @@ void DCE2_ListRemoveCurrent(DCE2_List* list)
     list->next = list->current->next;
     list->prev = list->current->prev;
 
+    DCE2_ListIndexRemove(list, list->current);
+
     if (list->current == list->head)
         list->head = list->current->next;
     if (list->current == list->tail)
@@ -689,6 +742,158 @@ void DCE2_ListRemoveCurrent(DCE2_List* list)
     list->num_nodes--;
 }
 
+/********************************************************************
+ * Function: DCE2_ListIndexSlot()
+ *
+ * Private function returning the first slot to probe for a key in
+ * a hash index of the given size, which is a power of 2.
+ *
+ ********************************************************************/
+static inline uint32_t DCE2_ListIndexSlot(const void* key, uint32_t size)
+{
+    uint32_t h = (uint32_t)(uintptr_t)key * 0x9e3779b1;
+    return (h ^ (h >> 16)) & (size - 1);
+}
+
+/********************************************************************
+ * Function: DCE2_ListIndexBuild()
+ *
+ * Private function that (re)builds the hash index of a list with
+ * the given number of slots from the nodes currently in the list.
+ * Rebuilding also drops any deleted markers.
+ *
+ ********************************************************************/
+static void DCE2_ListIndexBuild(DCE2_List* list, uint32_t size)
+{
+    DCE2_ListIndexFree(list);
+
+    list->index = (DCE2_ListNode**)snort_calloc(size, sizeof(DCE2_ListNode*));
+    list->index_size = size;
+
+    for (DCE2_ListNode* n = list->head; n != nullptr; n = n->next)
+    {
+        uint32_t i = DCE2_ListIndexSlot(n->key, size);
+
+        while (list->index[i] != nullptr)
+            i = (i + 1) & (size - 1);
+
+        list->index[i] = n;
+        list->index_used++;
+    }
+}
+
+/********************************************************************
+ * Function: DCE2_ListIndexFind()
+ *
+ * Private function for looking up a key in the hash index of a
+ * list.  The index must exist.
+ *
+ * Returns:
+ *  DCE2_ListNode *
+ *      The node with the key or NULL if there isn't one.
+ *
+ ********************************************************************/
+static DCE2_ListNode* DCE2_ListIndexFind(DCE2_List* list, const void* key)
+{
+    const uint32_t mask = list->index_size - 1;
+    uint32_t i = DCE2_ListIndexSlot(key, list->index_size);
+
+    for (DCE2_ListNode* n = list->index[i]; n != nullptr; n = list->index[i])
+    {
+        if ((n != DCE2_LIST_DELETED) && (list->compare(key, n->key) == 0))
+            return n;
+
+        i = (i + 1) & mask;
+    }
+
+    return nullptr;
+}
+
+/********************************************************************
+ * Function: DCE2_ListIndexAdd()
+ *
+ * Private function for adding a node just inserted into a hashed
+ * list to its index.  Builds the index once the list is long
+ * enough and grows it to keep it no more than half full of live
+ * nodes and three quarters full counting deleted markers.
+ *
+ ********************************************************************/
+static void DCE2_ListIndexAdd(DCE2_List* list, DCE2_ListNode* n)
+{
+    if (list->index == nullptr)
+    {
+        if (list->num_nodes >= DCE2_LIST_INDEX_MIN)
+            DCE2_ListIndexBuild(list, DCE2_LIST_INDEX_START);
+        return;
+    }
+
+    if ((list->index_used + 1) * 4 > list->index_size * 3)
+    {
+        uint32_t size = list->index_size;
+
+        while (list->num_nodes * 2 > size)
+            size *= 2;
+
+        /* Includes the new node */
+        DCE2_ListIndexBuild(list, size);
+        return;
+    }
+
+    const uint32_t mask = list->index_size - 1;
+    uint32_t i = DCE2_ListIndexSlot(n->key, list->index_size);
+
+    while ((list->index[i] != nullptr) && (list->index[i] != DCE2_LIST_DELETED))
+        i = (i + 1) & mask;
+
+    if (list->index[i] == nullptr)
+        list->index_used++;
+
+    list->index[i] = n;
+}
+
+/********************************************************************
+ * Function: DCE2_ListIndexRemove()
+ *
+ * Private function for taking a node that is about to be removed
+ * from a list out of the list's hash index, if it has one.
+ *
+ ********************************************************************/
+static void DCE2_ListIndexRemove(DCE2_List* list, DCE2_ListNode* n)
+{
+    if (list->index == nullptr)
+        return;
+
+    const uint32_t mask = list->index_size - 1;
+    uint32_t i = DCE2_ListIndexSlot(n->key, list->index_size);
+
+    while (list->index[i] != nullptr)
+    {
+        if (list->index[i] == n)
+        {
+            list->index[i] = DCE2_LIST_DELETED;
+            return;
+        }
+
+        i = (i + 1) & mask;
+    }
+}
+
+/********************************************************************
+ * Function: DCE2_ListIndexFree()
+ *
+ * Private function that frees the hash index of a list, if any.
+ *
+ ********************************************************************/
+static void DCE2_ListIndexFree(DCE2_List* list)
+{
+    if (list->index != nullptr)
+        snort_free((void*)list->index);
+
+    list->index = nullptr;
+    list->index_size = 0;
+    list->index_used = 0;
+}
+
 /********************************************************************
  * Function: DCE2_QueueNew()
  *
@@ -31,6 +31,7 @@
 #include "dce_utils.h"
 
 #include "main/snort_types.h"
+#include "utils/util.h"
 
 /********************************************************************
  * Enumerations
@@ -39,7 +40,8 @@ enum DCE2_ListType
 {
     DCE2_LIST_TYPE__NORMAL = 0,  /* Don't do anything special */
     DCE2_LIST_TYPE__SORTED,      /* Sort list by key */
-    DCE2_LIST_TYPE__SPLAYED      /* Move most recently accessed node to head */
+    DCE2_LIST_TYPE__SPLAYED,     /* Move most recently accessed node to head */
+    DCE2_LIST_TYPE__HASHED       /* Splayed, plus a hash index on integer keys */
 };
 
 enum DCE2_ListFlags
@@ -80,6 +82,12 @@ struct DCE2_List
     struct DCE2_ListNode* current;
     struct DCE2_ListNode* next;
     struct DCE2_ListNode* prev;
+
+    /* Open addressing index for hashed lists, built once the list gets
+     * long enough that walking it costs more than hashing. */
+    struct DCE2_ListNode** index;
+    uint32_t index_size;
+    uint32_t index_used;   /* live entries plus deleted markers */
 };
 
 struct DCE2_QueueNode
@@ -171,5 +179,90 @@ inline bool DCE2_QueueIsEmpty(DCE2_Queue* queue)
     return false;
 }
 
+/********************************************************************
+ * DCE2_Pool
+ *
+ * Per thread free list of fixed size session objects such as request,
+ * file and context id trackers.  get() returns zeroed memory just like
+ * snort_calloc() and put() keeps up to max_free released objects for
+ * reuse.  Pools are declared THREAD_LOCAL and start out with max_free
+ * of zero, ie disabled, so the owning inspector sets it in tinit and
+ * calls release() in tterm.  shed() gives up to DCE2_POOL_PRUNE objects
+ * back to the heap when the memory cap needs space.
+ ********************************************************************/
+#define DCE2_POOL_PRUNE 64
+
+template<typename T>
+struct DCE2_Pool
+{
+    struct Link
+    {
+        Link* next;
+    };
+    static_assert(sizeof(T) >= sizeof(Link), "pooled type too small");
+
+    Link* free_list;
+    unsigned free_count;
+    unsigned max_free;
+
+    T* get()
+    {
+        if (free_list == nullptr)
+            return (T*)snort_calloc(sizeof(T));
+
+        Link* p = free_list;
+        free_list = p->next;
+        free_count--;
+
+        memset((void*)p, 0, sizeof(T));
+        return (T*)p;
+    }
+
+    void put(T* t)
+    {
+        if (t == nullptr)
+            return;
+
+        if (free_count >= max_free)
+        {
+            snort_free((void*)t);
+            return;
+        }
+
+        Link* p = (Link*)t;
+        p->next = free_list;
+        free_list = p;
+        free_count++;
+    }
+
+    // returns the number of objects freed
+    unsigned shed(unsigned n = DCE2_POOL_PRUNE)
+    {
+        unsigned freed = 0;
+
+        while (free_list != nullptr && freed < n)
+        {
+            Link* p = free_list;
+            free_list = p->next;
+            snort_free((void*)p);
+            freed++;
+        }
+        free_count -= freed;
+        return freed;
+    }
+
+    void release()
+    {
+        while (free_list != nullptr)
+        {
+            Link* p = free_list;
+            free_list = p->next;
+            snort_free((void*)p);
+        }
+        free_count = 0;
+        max_free = 0;
+    }
+};
+
 #endif
 
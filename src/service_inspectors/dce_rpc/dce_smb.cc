@@ -26,6 +26,7 @@
 
 #include "detection/detection_engine.h"
 #include "file_api/file_service.h"
+#include "memory/memory_domain.h"
 #include "protocols/packet.h"
 #include "utils/util.h"
 #include "packet_io/active.h"
@@ -430,6 +431,25 @@ static void dce2_smb_init()
     Dce2SmbFlowData::init();
     DCE2_SmbInitGlobals();
     DCE2_SmbInitDeletePdu();
+
+    // pooled trackers go before flows when the memory cap is reached
+    memory::add_pruner(memory::Domain::FLOW, DCE2_SmbPrunePools);
+    memory::add_pruner(memory::Domain::FLOW, DCE2_Smb2PrunePools);
+    memory::add_pruner(memory::Domain::FLOW, DCE2_CoPrunePools);
+}
+
+static void dce2_smb_tinit()
+{
+    DCE2_SmbInitPools();
+    DCE2_Smb2InitPools();
+    DCE2_CoInitPools();
+}
+
+static void dce2_smb_tterm()
+{
+    DCE2_SmbReleasePools();
+    DCE2_Smb2ReleasePools();
+    DCE2_CoReleasePools();
 }
 
 static Inspector* dce2_smb_ctor(Module* m)
@@ -465,8 +485,8 @@ const InspectApi dce2_smb_api =
     "netbios-ssn",
     dce2_smb_init,
     nullptr, // pterm
-    nullptr, // tinit
-    nullptr, // tterm
+    dce2_smb_tinit,
+    dce2_smb_tterm,
     dce2_smb_ctor,
     dce2_smb_dtor,
     nullptr, // ssn
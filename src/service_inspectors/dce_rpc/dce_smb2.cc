@@ -35,6 +35,12 @@
 
 #define   UNKNOWN_FILE_SIZE                  ~0
 
+// outstanding requests are tracked per message id, up to 128 per session,
+// so released ones are recycled per thread
+#define   SMB2_REQUEST_POOL_MAX              1024
+
+static THREAD_LOCAL DCE2_Pool<Smb2Request> smb2_request_pool;
+
 // FIXIT-L port fileCache related code along with
 // DCE2_Smb2Init, DCE2_Smb2Close and DCE2_Smb2UpdateStats
 
@@ -84,7 +90,7 @@ static inline void DCE2_Smb2InsertTid(DCE2_SmbSsnData* ssd, const uint32_t tid,
 
     if (ssd->tids == nullptr)
     {
-        ssd->tids = DCE2_ListNew(DCE2_LIST_TYPE__SPLAYED, DCE2_Smb2TidCompare,
+        ssd->tids = DCE2_ListNew(DCE2_LIST_TYPE__HASHED, DCE2_Smb2TidCompare,
             nullptr, nullptr, DCE2_LIST_FLAG__NO_DUPS);
 
         if (ssd->tids == nullptr)
@@ -123,14 +129,14 @@ static inline void DCE2_Smb2StoreRequest(DCE2_SmbSsnData* ssd,
         request = request->next;
     }
 
-    request = (Smb2Request*)snort_calloc(sizeof(*request));
+    request = smb2_request_pool.get();
 
     ssd->outstanding_requests++;
 
     if (ssd->outstanding_requests >= ssd->max_outstanding_requests)
     {
         dce_alert(GID_DCE2, DCE2_SMB_MAX_REQS_EXCEEDED, (dce2CommonStats*)&dce2_smb_stats);
-        snort_free((void*)request);
+        smb2_request_pool.put(request);
         return;
     }
 
@@ -178,7 +184,7 @@ static inline void DCE2_Smb2RemoveRequest(DCE2_SmbSsnData* ssd,
     }
 
     ssd->outstanding_requests--;
-    snort_free((void*)request);
+    smb2_request_pool.put(request);
 }
 
 static inline void DCE2_Smb2FreeFileName(DCE2_SmbFileTracker* ftracker)
@@ -820,8 +826,23 @@ void DCE2_Smb2CleanRequests(Smb2Request* requests)
     {
         Smb2Request* next;
         next = request->next;
-        snort_free((void*)request);
+        smb2_request_pool.put(request);
         request = next;
     }
 }
 
+void DCE2_Smb2InitPools()
+{
+    smb2_request_pool.max_free = SMB2_REQUEST_POOL_MAX;
+}
+
+bool DCE2_Smb2PrunePools()
+{
+    return smb2_request_pool.shed() > 0;
+}
+
+void DCE2_Smb2ReleasePools()
+{
+    smb2_request_pool.release();
+}
+
@@ -262,6 +262,9 @@ struct Smb2TreeDisConnectHdr
 
 /* Clean up all the pending requests*/
 void DCE2_Smb2CleanRequests(Smb2Request* requests);
+void DCE2_Smb2InitPools();
+bool DCE2_Smb2PrunePools();
+void DCE2_Smb2ReleasePools();
 
 /* Process smb2 message */
 void DCE2_Smb2Process(DCE2_SmbSsnData* ssd);
@@ -36,6 +36,15 @@
 
 static uint8_t dce2_smb_delete_pdu[65535];
 
+/* Request and file trackers past the ones embedded in the session data
+ * come and go with every outstanding request and open file so they are
+ * recycled per thread instead of going back to the heap each time. */
+#define DCE2_SMB_RTRACKER_POOL_MAX 1024
+#define DCE2_SMB_FTRACKER_POOL_MAX 256
+
+static THREAD_LOCAL DCE2_Pool<DCE2_SmbRequestTracker> rtracker_pool;
+static THREAD_LOCAL DCE2_Pool<DCE2_SmbFileTracker> ftracker_pool;
+
 /********************************************************************
  * Private function prototypes
  ********************************************************************/
@@ -177,7 +186,7 @@ void DCE2_SmbInsertUid(DCE2_SmbSsnData* ssd, const uint16_t uid)
     {
         if (ssd->uids == nullptr)
         {
-            ssd->uids = DCE2_ListNew(DCE2_LIST_TYPE__SPLAYED, DCE2_SmbUidTidFidCompare,
+            ssd->uids = DCE2_ListNew(DCE2_LIST_TYPE__HASHED, DCE2_SmbUidTidFidCompare,
                 nullptr, nullptr, DCE2_LIST_FLAG__NO_DUPS);
 
             if (ssd->uids == nullptr)
@@ -310,7 +319,7 @@ DCE2_SmbRequestTracker* DCE2_SmbNewRequestTracker(DCE2_SmbSsnData* ssd,
             }
         }
 
-        rtracker = (DCE2_SmbRequestTracker*)snort_calloc(sizeof(DCE2_SmbRequestTracker));
+        rtracker = rtracker_pool.get();
         if (rtracker == nullptr)
         {
             return nullptr;
@@ -318,7 +327,7 @@ DCE2_SmbRequestTracker* DCE2_SmbNewRequestTracker(DCE2_SmbSsnData* ssd,
 
         if (DCE2_QueueEnqueue(ssd->rtrackers, (void*)rtracker) != DCE2_RET__SUCCESS)
         {
-            snort_free((void*)rtracker);
+            rtracker_pool.put(rtracker);
             return nullptr;
         }
     }
@@ -373,7 +382,7 @@ DCE2_SmbFileTracker* DCE2_SmbNewFileTracker(DCE2_SmbSsnData* ssd,
     }
     else
     {
-        ftracker = (DCE2_SmbFileTracker*)snort_calloc(sizeof(DCE2_SmbFileTracker));
+        ftracker = ftracker_pool.get();
 
         if (ftracker == nullptr)
         {
@@ -384,13 +393,13 @@ DCE2_SmbFileTracker* DCE2_SmbNewFileTracker(DCE2_SmbSsnData* ssd,
             DCE2_RET__SUCCESS)
         {
             DCE2_SmbCleanFileTracker(ftracker);
-            snort_free((void*)ftracker);
+            ftracker_pool.put(ftracker);
             return nullptr;
         }
 
         if (ssd->ftrackers == nullptr)
         {
-            ssd->ftrackers = DCE2_ListNew(DCE2_LIST_TYPE__SPLAYED,
+            ssd->ftrackers = DCE2_ListNew(DCE2_LIST_TYPE__HASHED,
                 DCE2_SmbUidTidFidCompare, DCE2_SmbFileTrackerDataFree, nullptr,
                 DCE2_LIST_FLAG__NO_DUPS);
 
@@ -654,7 +663,7 @@ void DCE2_SmbFileTrackerDataFree(void* data)
         ftracker->uid_v1, ftracker->tid_v1, ftracker->fid_v1);
 
     DCE2_SmbCleanFileTracker(ftracker);
-    snort_free((void*)ftracker);
+    ftracker_pool.put(ftracker);
 }
 
 /********************************************************************
@@ -665,7 +674,7 @@ void DCE2_SmbFileTrackerDataFree(void* data)
 void DCE2_SmbCleanSessionFileTracker(DCE2_SmbSsnData* ssd, DCE2_SmbFileTracker* ftracker)
 {
     DCE2_SmbCleanFileTracker(ftracker);
-    snort_free((void*)ftracker);
+    ftracker_pool.put(ftracker);
     if (ssd->fapi_ftracker == ftracker)
         ssd->fapi_ftracker = nullptr;
 }
@@ -799,7 +808,7 @@ DCE2_SmbFileTracker* DCE2_SmbDequeueTmpFileTracker(DCE2_SmbSsnData* ssd,
     if (ssd->ftracker.fid_v1 == DCE2_SENTINEL)
     {
         memcpy(&ssd->ftracker, ftracker, sizeof(DCE2_SmbFileTracker));
-        snort_free((void*)ftracker);
+        ftracker_pool.put(ftracker);
         if (ssd->fapi_ftracker == ftracker)
             ssd->fapi_ftracker = &ssd->ftracker;
         ftracker = &ssd->ftracker;
@@ -808,7 +817,7 @@ DCE2_SmbFileTracker* DCE2_SmbDequeueTmpFileTracker(DCE2_SmbSsnData* ssd,
     {
         if (ssd->ftrackers == nullptr)
         {
-            ssd->ftrackers = DCE2_ListNew(DCE2_LIST_TYPE__SPLAYED,
+            ssd->ftrackers = DCE2_ListNew(DCE2_LIST_TYPE__HASHED,
                 DCE2_SmbUidTidFidCompare, DCE2_SmbFileTrackerDataFree, nullptr,
                 DCE2_LIST_FLAG__NO_DUPS);
 
@@ -845,7 +854,7 @@ void DCE2_SmbRequestTrackerDataFree(void* data)
         rtracker->uid, rtracker->tid, rtracker->pid, rtracker->mid);
 
     DCE2_SmbCleanRequestTracker(rtracker);
-    snort_free((void*)rtracker);
+    rtracker_pool.put(rtracker);
 }
 
 DCE2_Ret DCE2_SmbFindTid(DCE2_SmbSsnData* ssd, const uint16_t tid)
@@ -940,7 +949,7 @@ void DCE2_SmbInsertTid(DCE2_SmbSsnData* ssd,
     {
         if (ssd->tids == nullptr)
         {
-            ssd->tids = DCE2_ListNew(DCE2_LIST_TYPE__SPLAYED, DCE2_SmbUidTidFidCompare,
+            ssd->tids = DCE2_ListNew(DCE2_LIST_TYPE__HASHED, DCE2_SmbUidTidFidCompare,
                 nullptr, nullptr, DCE2_LIST_FLAG__NO_DUPS);
 
             if (ssd->tids == nullptr)
@@ -1028,8 +1037,7 @@ void DCE2_SmbQueueTmpFileTracker(DCE2_SmbSsnData* ssd,
     DebugFormat(DEBUG_DCE_SMB, "Queuing file tracker "
         "with Uid: %hu, Tid: %hu\n", uid, tid);
 
-    DCE2_SmbFileTracker* ftracker = (DCE2_SmbFileTracker*)
-        snort_calloc(sizeof(DCE2_SmbFileTracker));
+    DCE2_SmbFileTracker* ftracker = ftracker_pool.get();
 
     if (ftracker == nullptr)
     {
@@ -1041,7 +1049,7 @@ void DCE2_SmbQueueTmpFileTracker(DCE2_SmbSsnData* ssd,
         DCE2_RET__SUCCESS)
     {
         DCE2_SmbCleanFileTracker(ftracker);
-        snort_free((void*)ftracker);
+        ftracker_pool.put(ftracker);
         return;
     }
 
@@ -2009,3 +2017,22 @@ void DCE2_Update_Ftracker_from_ReqTracker(DCE2_SmbFileTracker* ftracker,
     cur_rtracker->file_name_size = 0;
 }
 
+void DCE2_SmbInitPools()
+{
+    rtracker_pool.max_free = DCE2_SMB_RTRACKER_POOL_MAX;
+    ftracker_pool.max_free = DCE2_SMB_FTRACKER_POOL_MAX;
+}
+
+bool DCE2_SmbPrunePools()
+{
+    unsigned freed = rtracker_pool.shed();
+    freed += ftracker_pool.shed();
+    return freed > 0;
+}
+
+void DCE2_SmbReleasePools()
+{
+    rtracker_pool.release();
+    ftracker_pool.release();
+}
+
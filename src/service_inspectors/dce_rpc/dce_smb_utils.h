@@ -173,6 +173,9 @@ DCE2_Ret DCE2_SmbHandleSegmentation(DCE2_Buffer**,
 bool DCE2_SmbIsSegBuffer(DCE2_SmbSsnData*, const uint8_t*);
 void DCE2_SmbSegAlert(DCE2_SmbSsnData*, uint32_t rule_id);
 void DCE2_SmbAbortFileAPI(DCE2_SmbSsnData*);
+void DCE2_SmbInitPools();
+bool DCE2_SmbPrunePools();
+void DCE2_SmbReleasePools();
 void DCE2_SmbProcessFileData(DCE2_SmbSsnData* ssd,
     DCE2_SmbFileTracker* ftracker, const uint8_t* data_ptr,
     uint32_t data_len, bool upload);
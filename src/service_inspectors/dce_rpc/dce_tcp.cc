@@ -26,6 +26,7 @@
 #include "dce_tcp.h"
 
 #include "detection/detection_engine.h"
+#include "memory/memory_domain.h"
 #include "utils/util.h"
 
 #include "dce_tcp_module.h"
@@ -220,6 +221,17 @@ static void dce2_tcp_dtor(Inspector* p)
 static void dce2_tcp_init()
 {
     Dce2TcpFlowData::init();
+    memory::add_pruner(memory::Domain::FLOW, DCE2_CoPrunePools);
+}
+
+static void dce2_tcp_tinit()
+{
+    DCE2_CoInitPools();
+}
+
+static void dce2_tcp_tterm()
+{
+    DCE2_CoReleasePools();
 }
 
 const InspectApi dce2_tcp_api =
@@ -242,8 +254,8 @@ const InspectApi dce2_tcp_api =
     "dcerpc",
     dce2_tcp_init,
     nullptr, // pterm
-    nullptr, // tinit
-    nullptr, // tterm
+    dce2_tcp_tinit,
+    dce2_tcp_tterm,
     dce2_tcp_ctor,
     dce2_tcp_dtor,
     nullptr, // ssn
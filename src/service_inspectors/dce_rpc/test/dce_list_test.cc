@@ -0,0 +1,313 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// dce_list_test.cc checks hashed lists against splayed lists and times both
+// on a synthetic SMB2 session.  the benchmark is an ignored test; run it
+// with dce_list_test -ri -v
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "service_inspectors/dce_rpc/dce_list.cc"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+static int id_compare(const void* a, const void* b)
+{
+    uint32_t x = (uint32_t)(uintptr_t)a;
+    uint32_t y = (uint32_t)(uintptr_t)b;
+
+    if (x == y)
+        return 0;
+
+    return -1;
+}
+
+static void* key(uint32_t id)
+{ return (void*)(uintptr_t)id; }
+
+// the nodes of a hashed list must be in the same order as a splayed list
+static void check_same(DCE2_List* splayed, DCE2_List* hashed)
+{
+    CHECK(splayed->num_nodes == hashed->num_nodes);
+
+    void* a = DCE2_ListFirst(splayed);
+    void* b = DCE2_ListFirst(hashed);
+
+    while (a or b)
+    {
+        CHECK(a == b);
+        a = DCE2_ListNext(splayed);
+        b = DCE2_ListNext(hashed);
+    }
+}
+
+TEST_GROUP(dce_list_test)
+{
+    DCE2_List* splayed = nullptr;
+    DCE2_List* hashed = nullptr;
+
+    void setup() override
+    {
+        splayed = DCE2_ListNew(DCE2_LIST_TYPE__SPLAYED, id_compare, nullptr, nullptr,
+            DCE2_LIST_FLAG__NO_DUPS);
+        hashed = DCE2_ListNew(DCE2_LIST_TYPE__HASHED, id_compare, nullptr, nullptr,
+            DCE2_LIST_FLAG__NO_DUPS);
+    }
+
+    void teardown() override
+    {
+        DCE2_ListDestroy(splayed);
+        DCE2_ListDestroy(hashed);
+    }
+};
+
+TEST(dce_list_test, short_list_has_no_index)
+{
+    for (uint32_t id = 1; id < DCE2_LIST_INDEX_MIN; id++)
+        CHECK(DCE2_ListInsert(hashed, key(id), key(id)) == DCE2_RET__SUCCESS);
+
+    CHECK(hashed->index == nullptr);
+    CHECK(DCE2_ListInsert(hashed, key(1), key(1)) == DCE2_RET__DUPLICATE);
+
+    CHECK(DCE2_ListInsert(hashed, key(100), key(100)) == DCE2_RET__SUCCESS);
+    CHECK(hashed->index != nullptr);
+    CHECK(DCE2_ListInsert(hashed, key(1), key(1)) == DCE2_RET__DUPLICATE);
+    CHECK(DCE2_ListFind(hashed, key(100)) == key(100));
+
+    DCE2_ListEmpty(hashed);
+    CHECK(hashed->index == nullptr);
+    CHECK(DCE2_ListFind(hashed, key(100)) == nullptr);
+}
+
+TEST(dce_list_test, matches_splayed)
+{
+    srand(1);
+
+    // a small id space gives plenty of duplicates, misses and reinserts
+    for (unsigned i = 0; i < 100000; i++)
+    {
+        uint32_t id = rand() % 300;
+
+        switch (rand() % 4)
+        {
+        case 0:
+            CHECK(DCE2_ListInsert(splayed, key(id), key(id)) ==
+                DCE2_ListInsert(hashed, key(id), key(id)));
+            break;
+        case 1:
+            CHECK(DCE2_ListRemove(splayed, key(id)) == DCE2_ListRemove(hashed, key(id)));
+            break;
+        case 2:
+            CHECK(DCE2_ListFind(splayed, key(id)) == DCE2_ListFind(hashed, key(id)));
+            break;
+        case 3:
+            CHECK(DCE2_ListFindKey(splayed, key(id)) == DCE2_ListFindKey(hashed, key(id)));
+            break;
+        }
+    }
+    check_same(splayed, hashed);
+}
+
+TEST(dce_list_test, remove_current)
+{
+    for (uint32_t id = 0; id < 1000; id++)
+        DCE2_ListInsert(hashed, key(id), key(id));
+
+    // drop the odd ids while iterating, the way trackers are removed by uid or tid
+    for (void* p = DCE2_ListFirst(hashed); p; p = DCE2_ListNext(hashed))
+    {
+        if ((uintptr_t)p & 1)
+            DCE2_ListRemoveCurrent(hashed);
+    }
+    CHECK(hashed->num_nodes == 500);
+
+    for (uint32_t id = 0; id < 1000; id++)
+        CHECK((DCE2_ListFindKey(hashed, key(id)) == DCE2_RET__SUCCESS) == !(id & 1));
+
+    // reinserting reuses deleted slots without growing the index
+    uint32_t size = hashed->index_size;
+
+    for (uint32_t id = 1; id < 1000; id += 2)
+        CHECK(DCE2_ListInsert(hashed, key(id), key(id)) == DCE2_RET__SUCCESS);
+
+    CHECK(hashed->index_size == size);
+    CHECK(hashed->num_nodes == 1000);
+}
+
+TEST(dce_list_test, churn_keeps_index_small)
+{
+    // a long lived session opening and closing files
+    for (uint32_t id = 0; id < 100000; id++)
+    {
+        DCE2_ListInsert(hashed, key(id), key(id));
+
+        if (id >= 64)
+            CHECK(DCE2_ListRemove(hashed, key(id - 64)) == DCE2_RET__SUCCESS);
+    }
+    CHECK(hashed->num_nodes == 64);
+    CHECK(hashed->index_size <= 256);
+}
+
+struct Tracker
+{
+    uint64_t id;
+    uint8_t data[120];
+};
+
+TEST_GROUP(dce_pool_test)
+{
+    DCE2_Pool<Tracker> pool = { };
+
+    void teardown() override
+    {
+        pool.release();
+    }
+};
+
+TEST(dce_pool_test, disabled)
+{
+    Tracker* t = pool.get();
+    t->id = 1;
+    pool.put(t);
+    CHECK(pool.free_list == nullptr);
+    CHECK(pool.free_count == 0);
+}
+
+TEST(dce_pool_test, reuse)
+{
+    pool.max_free = 2;
+
+    Tracker* a = pool.get();
+    Tracker* b = pool.get();
+    Tracker* c = pool.get();
+
+    a->id = b->id = c->id = 7;
+    memset(a->data, 0xff, sizeof(a->data));
+
+    pool.put(a);
+    pool.put(b);
+    pool.put(c);
+    CHECK(pool.free_count == 2);
+
+    // last in first out and zeroed like snort_calloc
+    Tracker* d = pool.get();
+    CHECK(d == b);
+    d = pool.get();
+    CHECK(d == a);
+    CHECK(d->id == 0);
+
+    for (unsigned i = 0; i < sizeof(d->data); i++)
+        CHECK(d->data[i] == 0);
+
+    pool.put(a);
+    pool.put(b);
+    pool.release();
+    CHECK(pool.free_list == nullptr);
+    CHECK(pool.max_free == 0);
+}
+
+//-------------------------------------------------------------------------
+// synthetic SMB2 session: a client with many tree connects and open files
+// sends requests that each look up a tid and a file id, track the request
+// until it's answered, and now and then closes one file and opens another.
+//-------------------------------------------------------------------------
+
+static double run_session(DCE2_ListType type, bool pooled, unsigned tids, unsigned fids)
+{
+    DCE2_List* tid_list = DCE2_ListNew(type, id_compare, nullptr, nullptr,
+        DCE2_LIST_FLAG__NO_DUPS);
+    DCE2_List* fid_list = DCE2_ListNew(type, id_compare, nullptr, nullptr,
+        DCE2_LIST_FLAG__NO_DUPS);
+
+    DCE2_Pool<Tracker> pool = { };
+    pool.max_free = pooled ? 1024 : 0;
+
+    for (uint32_t t = 0; t < tids; t++)
+        DCE2_ListInsert(tid_list, key(t + 1), key(t + 1));
+
+    for (uint32_t f = 0; f < fids; f++)
+        DCE2_ListInsert(fid_list, key(f + 1), key(f + 1));
+
+    const unsigned outstanding = 32;
+    Tracker* requests[outstanding] = { };
+    uint32_t next_fid = fids + 1;
+    unsigned hits = 0;
+
+    srand(7);
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned i = 0; i < 1000000; i++)
+    {
+        uint32_t tid = rand() % tids + 1;
+        uint32_t fid = next_fid - (rand() % fids) - 1;
+
+        hits += (DCE2_ListFindKey(tid_list, key(tid)) == DCE2_RET__SUCCESS);
+        hits += (DCE2_ListFind(fid_list, key(fid)) != nullptr);
+
+        Tracker*& r = requests[i % outstanding];
+        pooled ? pool.put(r) : snort_free(r);
+        r = pooled ? pool.get() : (Tracker*)snort_calloc(sizeof(Tracker));
+        r->id = i;
+
+        if (!(i % 64))
+        {
+            DCE2_ListRemove(fid_list, key(next_fid - fids));
+            DCE2_ListInsert(fid_list, key(next_fid), key(next_fid));
+            next_fid++;
+        }
+    }
+    std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+
+    for (auto r : requests)
+        pooled ? pool.put(r) : snort_free(r);
+
+    pool.release();
+    DCE2_ListDestroy(tid_list);
+    DCE2_ListDestroy(fid_list);
+
+    CHECK(hits == 2000000);
+    return ms.count();
+}
+
+TEST_GROUP(dce_list_benchmark) { };
+
+IGNORE_TEST(dce_list_benchmark, smb2_session)
+{
+    for (unsigned n : { 4, 16, 64, 256, 1024 })
+    {
+        double splayed = run_session(DCE2_LIST_TYPE__SPLAYED, false, n, n);
+        double hashed = run_session(DCE2_LIST_TYPE__HASHED, true, n, n);
+
+        printf("\n%4u tids and fids: splayed + calloc %8.1f ms, hashed + pool %8.1f ms",
+            n, splayed, hashed);
+    }
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
+
@@ -23,11 +23,19 @@
 
 #include "http_api.h"
 
+#include "memory/memory_domain.h"
+
 #include "http_inspect.h"
 
 const char* HttpApi::http_my_name = HTTP_NAME;
 const char* HttpApi::http_help = "the new HTTP inspector!";
 
+void HttpApi::http_init()
+{
+    HttpFlowData::init();
+    memory::add_pruner(memory::Domain::HTTP, HttpFlowData::prune_compress_stream);
+}
+
 Inspector* HttpApi::http_ctor(Module* mod)
 {
     HttpModule* const http_mod = (HttpModule*)mod;
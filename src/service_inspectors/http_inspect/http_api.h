@@ -38,7 +38,7 @@ private:
     static void http_mod_dtor(Module* m) { delete m; }
     static const char* http_my_name;
     static const char* http_help;
-    static void http_init() { HttpFlowData::init(); }
+    static void http_init();
     static void http_term() { }
     static Inspector* http_ctor(Module* mod);
     static void http_dtor(Inspector* p) { delete p; }
@@ -0,0 +1,132 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "http_arena.h"
+
+#include <cassert>
+
+static const size_t ALIGNMENT = alignof(std::max_align_t);
+
+static inline size_t round_up(size_t size)
+{
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+HttpArena::~HttpArena()
+{
+    while (head != nullptr)
+    {
+        Block* const block = head;
+        head = head->next;
+        delete[] reinterpret_cast<uint8_t*>(block);
+    }
+}
+
+uint8_t* HttpArena::allocate(size_t size)
+{
+    size = round_up(size);
+
+    if ((current == nullptr) || (current->used + size > current->size))
+        next_block(size);
+
+    latest = current->data() + current->used;
+    current->used += size;
+    total_bytes += size;
+    in_use += size;
+    if (in_use > peak_bytes)
+        peak_bytes = in_use;
+    return latest;
+}
+
+void HttpArena::next_block(size_t size)
+{
+    // Blocks past the current one are unused. Those retained by reset() are tried before going
+    // back to the heap.
+    Block* const prev = current;
+    for (Block* block = (prev != nullptr) ? prev->next : head; block != nullptr;
+        block = block->next)
+    {
+        if (block->size >= size)
+        {
+            assert(block->used == 0);
+            current = block;
+            return;
+        }
+    }
+
+    const size_t block_size = (size > BLOCK_SIZE) ? size : BLOCK_SIZE;
+    Block* const block = new (new uint8_t[sizeof(Block) + block_size]) Block;
+    block->size = block_size;
+    block->used = 0;
+
+    if (prev == nullptr)
+    {
+        block->next = head;
+        head = block;
+    }
+    else
+    {
+        block->next = prev->next;
+        prev->next = block;
+    }
+    current = block;
+    heap_blocks++;
+}
+
+void HttpArena::shrink(const void* memory, size_t used)
+{
+    if ((memory == nullptr) || (memory != latest))
+        return;
+
+    const size_t end = (latest - current->data()) + round_up(used);
+    assert(end <= current->used);
+    total_bytes -= current->used - end;
+    in_use -= current->used - end;
+    current->used = end;
+}
+
+void HttpArena::reset()
+{
+    size_t retained = 0;
+    Block** link = &head;
+
+    while (*link != nullptr)
+    {
+        Block* const block = *link;
+
+        if (retained + block->size <= RETAIN_SIZE)
+        {
+            retained += block->size;
+            block->used = 0;
+            link = &block->next;
+        }
+        else
+        {
+            *link = block->next;
+            delete[] reinterpret_cast<uint8_t*>(block);
+        }
+    }
+    current = nullptr;
+    latest = nullptr;
+    in_use = 0;
+}
+
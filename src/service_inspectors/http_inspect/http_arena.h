@@ -0,0 +1,94 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifndef HTTP_ARENA_H
+#define HTTP_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "http_enum.h"
+
+// Bump allocator for the buffers and arrays built while analyzing message sections. Everything
+// drawn from an arena is released together when the arena is reset or destroyed. Destructors of
+// objects placed in an arena are never run so they must not own any other resources. In
+// particular a Field pointing into arena memory must not be marked as owning its buffer.
+class HttpArena
+{
+public:
+    HttpArena() = default;
+    ~HttpArena();
+
+    // Returned memory is suitably aligned for any type
+    uint8_t* allocate(size_t size);
+
+    template <typename T>
+    T* allocate_array(size_t count)
+    {
+        T* const array = reinterpret_cast<T*>(allocate(count * sizeof(T)));
+        for (size_t k = 0; k < count; k++)
+            new (array + k) T;
+        return array;
+    }
+
+    // Return the unused tail of the most recent allocation. A used length of zero releases the
+    // whole allocation. Has no effect on anything other than the most recent allocation.
+    void shrink(const void* memory, size_t used);
+
+    // Release everything for reuse. Blocks up to RETAIN_SIZE are kept for the next generation of
+    // allocations and the rest are returned to the heap. RETAIN_SIZE allows for a body section
+    // holding two normalization buffers of MAX_OCTETS.
+    void reset();
+
+    // Bytes handed out and heap blocks obtained over the life of the arena
+    uint64_t get_total_bytes() const { return total_bytes; }
+    uint64_t get_heap_blocks() const { return heap_blocks; }
+
+    // Most bytes outstanding at any one time between resets
+    uint64_t get_peak_bytes() const { return peak_bytes; }
+
+    static const size_t BLOCK_SIZE = 4096;
+    static const size_t RETAIN_SIZE = 2 * HttpEnums::MAX_OCTETS + BLOCK_SIZE;
+
+private:
+    HttpArena(const HttpArena&) = delete;
+    HttpArena& operator=(const HttpArena&) = delete;
+
+    struct alignas(alignof(std::max_align_t)) Block
+    {
+        Block* next;
+        size_t size;
+        size_t used;
+
+        uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+    };
+
+    void next_block(size_t size);
+
+    Block* head = nullptr;
+    Block* current = nullptr;
+    uint8_t* latest = nullptr;
+    uint64_t total_bytes = 0;
+    uint64_t heap_blocks = 0;
+    uint64_t in_use = 0;
+    uint64_t peak_bytes = 0;
+};
+
+#endif
+
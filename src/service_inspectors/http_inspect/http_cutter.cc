@@ -23,6 +23,8 @@
 
 #include "http_cutter.h"
 
+#include "utils/byte_scan.h"
+
 using namespace HttpEnums;
 
 ScanResult HttpStartCutter::cut(const uint8_t* buffer, uint32_t length,
@@ -30,6 +32,14 @@ ScanResult HttpStartCutter::cut(const uint8_t* buffer, uint32_t length,
 {
     for (uint32_t k = 0; k < length; k++)
     {
+        // Once the start of the message is validated nothing matters until the next CR or LF
+        if (validated && (num_crlf == 0))
+        {
+            k = byte_scan::find_eol(buffer + k, buffer + length) - buffer;
+            if (k == length)
+                break;
+        }
+
         // Discard magic six white space characters CR, LF, Tab, VT, FF, and SP when they occur
         // before the start line.
         // If we have seen nothing but white space so far ...
@@ -163,6 +173,14 @@ ScanResult HttpHeaderCutter::cut(const uint8_t* buffer, uint32_t length,
     // header block.
     for (uint32_t k = 0; k < length; k++)
     {
+        // Within a header line nothing matters until the next CR or LF
+        if (state == ZERO)
+        {
+            k = byte_scan::find_eol(buffer + k, buffer + length) - buffer;
+            if (k == length)
+                break;
+        }
+
         switch (state)
         {
         case ZERO:
@@ -418,6 +436,9 @@ ScanResult HttpBodyChunkCutter::cut(const uint8_t* buffer, uint32_t length,
             break;
         case CHUNK_OPTIONS:
             // The RFC permits options to follow the chunk size. No one normally does this.
+            k = byte_scan::find_eol(buffer + k, buffer + length) - buffer;
+            if (k == static_cast<int32_t>(length))
+                break;
             if (buffer[k] == '\r')
             {
                 curr_state = CHUNK_HCRLF;
@@ -45,11 +45,11 @@ enum StatusCode { STAT_NO_SOURCE=-16, STAT_NOT_CONFIGURED=-15, STAT_NOT_COMPUTE=
 enum SourceId { SRC__NOT_COMPUTE=-14, SRC_CLIENT=0, SRC_SERVER=1 };
 
 // Type of message section
-enum SectionType { SEC_DISCARD = -19, SEC_ABORT = -18, SEC__NOT_COMPUTE=-14, SEC__NOT_PRESENT=-11,
-    SEC_REQUEST = 2, SEC_STATUS, SEC_HEADER, SEC_BODY_CL, SEC_BODY_CHUNK, SEC_TRAILER,
-    SEC_BODY_OLD };
+enum SectionType : int8_t { SEC_DISCARD = -19, SEC_ABORT = -18, SEC__NOT_COMPUTE=-14,
+    SEC__NOT_PRESENT=-11, SEC_REQUEST = 2, SEC_STATUS, SEC_HEADER, SEC_BODY_CL, SEC_BODY_CHUNK,
+    SEC_TRAILER, SEC_BODY_OLD };
 
-enum DetectionStatus { DET_REACTIVATING = 1, DET_ON, DET_DEACTIVATING, DET_OFF };
+enum DetectionStatus : int8_t { DET_REACTIVATING = 1, DET_ON, DET_DEACTIVATING, DET_OFF };
 
 // Message buffers available to clients
 // This enum must remain synchronized with HttpApi::classic_buffer_names[]
@@ -64,22 +64,23 @@ enum HTTP_BUFFER { HTTP_BUFFER_CLIENT_BODY = 1, HTTP_BUFFER_COOKIE, HTTP_BUFFER_
 enum PEG_COUNT { PEG_FLOW = 0, PEG_SCAN, PEG_REASSEMBLE, PEG_INSPECT, PEG_REQUEST, PEG_RESPONSE,
     PEG_GET, PEG_HEAD, PEG_POST, PEG_PUT, PEG_DELETE, PEG_CONNECT, PEG_OPTIONS, PEG_TRACE,
     PEG_OTHER_METHOD, PEG_REQUEST_BODY, PEG_CHUNKED, PEG_URI_NORM, PEG_URI_PATH, PEG_URI_CODING,
-    PEG_CONCURRENT_SESSIONS, PEG_MAX_CONCURRENT_SESSIONS, PEG_COUNT_MAX };
+    PEG_CONCURRENT_SESSIONS, PEG_MAX_CONCURRENT_SESSIONS, PEG_ARENA_BYTES, PEG_ARENA_BLOCKS,
+    PEG_MAX_ARENA_BYTES, PEG_COUNT_MAX };
 
 // Result of scanning by splitter
 enum ScanResult { SCAN_NOTFOUND, SCAN_FOUND, SCAN_FOUND_PIECE, SCAN_DISCARD, SCAN_DISCARD_PIECE,
     SCAN_ABORT, SCAN_END };
 
 // State machine for chunk parsing
-enum ChunkState { CHUNK_NEWLINES, CHUNK_ZEROS, CHUNK_NUMBER, CHUNK_WHITESPACE, CHUNK_OPTIONS,
-    CHUNK_HCRLF, CHUNK_DATA, CHUNK_DCRLF1, CHUNK_DCRLF2, CHUNK_BAD };
+enum ChunkState : int8_t { CHUNK_NEWLINES, CHUNK_ZEROS, CHUNK_NUMBER, CHUNK_WHITESPACE,
+    CHUNK_OPTIONS, CHUNK_HCRLF, CHUNK_DATA, CHUNK_DCRLF1, CHUNK_DCRLF2, CHUNK_BAD };
 
 // List of possible HTTP versions.
-enum VersionId { VERS__NO_SOURCE=-16, VERS__NOT_COMPUTE=-14, VERS__PROBLEMATIC=-12,
+enum VersionId : int8_t { VERS__NO_SOURCE=-16, VERS__NOT_COMPUTE=-14, VERS__PROBLEMATIC=-12,
     VERS__NOT_PRESENT=-11, VERS__OTHER=1, VERS_1_0, VERS_1_1, VERS_2_0, VERS_0_9 };
 
 // Every request method we have ever heard of
-enum MethodId {
+enum MethodId : int16_t {
     METH__NO_SOURCE=-16, METH__NOT_COMPUTE=-14, METH__PROBLEMATIC=-12,
     METH__NOT_PRESENT=-11, METH__OTHER=1, METH_OPTIONS, METH_GET,
     METH_HEAD, METH_POST, METH_PUT, METH_DELETE, METH_TRACE, METH_CONNECT,
@@ -102,7 +103,7 @@ enum UriType { URI__NOT_COMPUTE=-14, URI__PROBLEMATIC=-12, URI_ASTERISK = 2, URI
     URI_ABSPATH, URI_ABSOLUTE };
 
 // Body compression types
-enum CompressId { CMP_NONE=2, CMP_GZIP, CMP_DEFLATE };
+enum CompressId : int8_t { CMP_NONE=2, CMP_GZIP, CMP_DEFLATE };
 
 // Message section in which an IPS option provides the buffer
 enum InspectSection { IS_NONE, IS_DETECTION, IS_BODY, IS_TRAILER };
@@ -231,6 +232,7 @@ enum Infraction
     INF_CONTENT_ENCODING_CHUNKED,
     INF_206_WITHOUT_RANGE,
     INF_VERSION_NOT_UPPERCASE,
+    INF_GZIP_PRUNED,
     INF__MAX_VALUE
 };
 
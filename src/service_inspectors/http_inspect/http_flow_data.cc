@@ -33,6 +33,10 @@ using namespace HttpEnums;
 
 unsigned HttpFlowData::inspector_id = 0;
 
+// Flows with a zlib stream on this thread, least recently used first
+static THREAD_LOCAL HttpFlowData* compress_head = nullptr;
+static THREAD_LOCAL HttpFlowData* compress_tail = nullptr;
+
 #ifdef REG_TEST
 uint64_t HttpFlowData::instance_count = 0;
 #endif
@@ -75,21 +79,115 @@ HttpFlowData::~HttpFlowData()
         delete[] section_buffer[k];
         HttpTransaction::delete_transaction(transaction[k]);
         delete cutter[k];
-        if (compress_stream[k] != nullptr)
+    }
+
+    if (decode != nullptr)
+    {
+        for (int k=0; k <= 1; k++)
         {
-            inflateEnd(compress_stream[k]);
-            delete compress_stream[k];
+            delete_compress_stream((SourceId)k);
+            delete_mime_state((SourceId)k);
         }
-        if (mime_state[k] != nullptr)
+        delete_server_decoders();
+        delete decode;
+    }
+    delete_pipeline();
+}
+
+HttpFlowData::DecodeState& HttpFlowData::get_decode()
+{
+    if (decode == nullptr)
+    {
+        MemoryContext profile(HttpModule::get_flow_data_profile_stats().memory);
+        decode = new DecodeState;
+    }
+    return *decode;
+}
+
+void HttpFlowData::delete_compress_stream(SourceId source_id)
+{
+    if ((decode != nullptr) && (decode->compress_stream[source_id] != nullptr))
+    {
+        inflateEnd(decode->compress_stream[source_id]);
+        delete decode->compress_stream[source_id];
+        decode->compress_stream[source_id] = nullptr;
+
+        if (decode->compress_stream[1 - source_id] == nullptr)
+            unlink_compress_stream();
+    }
+}
+
+// Called before a stream is used so that the flow being worked on is always at the tail
+void HttpFlowData::touch_compress_stream()
+{
+    if (compress_tail == this)
+        return;
+
+    unlink_compress_stream();
+
+    compress_prev = compress_tail;
+    compress_next = nullptr;
+    if (compress_tail != nullptr)
+        compress_tail->compress_next = this;
+    else
+        compress_head = this;
+    compress_tail = this;
+    compress_linked = true;
+}
+
+void HttpFlowData::unlink_compress_stream()
+{
+    if (!compress_linked)
+        return;
+
+    if (compress_prev != nullptr)
+        compress_prev->compress_next = compress_next;
+    else
+        compress_head = compress_next;
+    if (compress_next != nullptr)
+        compress_next->compress_prev = compress_prev;
+    else
+        compress_tail = compress_prev;
+
+    compress_prev = compress_next = nullptr;
+    compress_linked = false;
+}
+
+bool HttpFlowData::prune_compress_stream()
+{
+    // The tail may have a stream in the middle of inflate()
+    HttpFlowData* const victim = compress_head;
+    if ((victim == nullptr) || (victim == compress_tail))
+        return false;
+
+    // Compression is left on so that the splitter reports the lost stream when the flow's next
+    // body data arrives. Raising the event now would attach it to whichever packet is allocating.
+    for (int k=0; k <= 1; k++)
+        victim->delete_compress_stream((SourceId)k);
+    return true;
+}
+
+void HttpFlowData::delete_mime_state(SourceId source_id)
+{
+    if (decode != nullptr)
+    {
+        delete decode->mime_state[source_id];
+        decode->mime_state[source_id] = nullptr;
+    }
+}
+
+void HttpFlowData::delete_server_decoders()
+{
+    if (decode != nullptr)
+    {
+        delete decode->utf_state;
+        decode->utf_state = nullptr;
+        if (decode->fd_state != nullptr)
         {
-            delete mime_state[k];
+            File_Decomp_StopFree(decode->fd_state);
+            decode->fd_state = nullptr;
         }
     }
-
-    delete utf_state;
-    if (fd_state != nullptr)
-        File_Decomp_StopFree(fd_state);
-    delete_pipeline();
 }
 
 void HttpFlowData::half_reset(SourceId source_id)
@@ -106,17 +204,8 @@ void HttpFlowData::half_reset(SourceId source_id)
     detection_status[source_id] = DET_REACTIVATING;
 
     compression[source_id] = CMP_NONE;
-    if (compress_stream[source_id] != nullptr)
-    {
-        inflateEnd(compress_stream[source_id]);
-        delete compress_stream[source_id];
-        compress_stream[source_id] = nullptr;
-    }
-    if (mime_state[source_id] != nullptr)
-    {
-        delete mime_state[source_id];
-        mime_state[source_id] = nullptr;
-    }
+    delete_compress_stream(source_id);
+    delete_mime_state(source_id);
     delete infractions[source_id];
     infractions[source_id] = new HttpInfractions;
     delete events[source_id];
@@ -137,13 +226,7 @@ void HttpFlowData::half_reset(SourceId source_id)
         if (transaction[SRC_SERVER]->final_response())
             expected_trans_num[SRC_SERVER]++;
         status_code_num = STAT_NOT_PRESENT;
-        delete utf_state;
-        utf_state = nullptr;
-        if (fd_state != nullptr)
-        {
-            File_Decomp_StopFree(fd_state);
-            fd_state = nullptr;
-        }
+        delete_server_decoders();
     }
 }
 
@@ -151,12 +234,7 @@ void HttpFlowData::trailer_prep(SourceId source_id)
 {
     type_expected[source_id] = SEC_TRAILER;
     compression[source_id] = CMP_NONE;
-    if (compress_stream[source_id] != nullptr)
-    {
-        inflateEnd(compress_stream[source_id]);
-        delete compress_stream[source_id];
-        compress_stream[source_id] = nullptr;
-    }
+    delete_compress_stream(source_id);
     detection_status[source_id] = DET_REACTIVATING;
 }
 
@@ -236,10 +314,11 @@ void HttpFlowData::show(FILE* out_file) const
         pipeline_back, pipeline_overflow, pipeline_underflow);
     fprintf(out_file, "Cutter: %s/%s\n", (cutter[0] != nullptr) ? "Present" : "nullptr",
         (cutter[1] != nullptr) ? "Present" : "nullptr");
-    fprintf(out_file, "utf_state: %s\n", (utf_state != nullptr) ? "Present" : "nullptr");
-    fprintf(out_file, "fd_state: %s\n", (fd_state != nullptr) ? "Present" : "nullptr");
-    fprintf(out_file, "mime_state: %s/%s\n", (mime_state[0] != nullptr) ? "Present" : "nullptr",
-        (mime_state[1] != nullptr) ? "Present" : "nullptr");
+    fprintf(out_file, "utf_state: %s\n", (get_utf_state() != nullptr) ? "Present" : "nullptr");
+    fprintf(out_file, "fd_state: %s\n", (get_fd_state() != nullptr) ? "Present" : "nullptr");
+    fprintf(out_file, "mime_state: %s/%s\n",
+        (get_mime_state(SRC_CLIENT) != nullptr) ? "Present" : "nullptr",
+        (get_mime_state(SRC_SERVER) != nullptr) ? "Present" : "nullptr");
 }
 #endif
 
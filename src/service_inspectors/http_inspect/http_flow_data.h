@@ -45,6 +45,10 @@ public:
     static unsigned inspector_id;
     static void init() { inspector_id = FlowData::create_flow_data_id(); }
 
+    // Give up the decompression state of the least recently used flow on this thread. The rest
+    // of its message bodies is flagged as undecompressible. Registered as the http pruner.
+    static bool prune_compress_stream();
+
     friend class HttpInspect;
     friend class HttpMsgSection;
     friend class HttpMsgStart;
@@ -70,33 +74,17 @@ private:
 
     // 0 element refers to client request, 1 element refers to server response
 
-    // FIXIT-P reorganize HttpFlowData to minimize void space
+    // Members are grouped by size so that there are no holes to pad out. State that only some
+    // messages need is kept in a separately allocated DecodeState. Every byte here is multiplied
+    // by the number of concurrent HTTP flows.
+
+    // --- pointers and 64-bit values ---
 
     // *** StreamSplitter internal data - scan()
     HttpCutter* cutter[2] = { nullptr, nullptr };
 
     // *** StreamSplitter internal data - reassemble()
     uint8_t* section_buffer[2] = { nullptr, nullptr };
-    uint32_t section_total[2] = { 0, 0 };
-    uint32_t section_offset[2] = { 0, 0 };
-    HttpEnums::ChunkState chunk_state[2] = { HttpEnums::CHUNK_NEWLINES,
-        HttpEnums::CHUNK_NEWLINES };
-    uint32_t chunk_expected_length[2] = { 0, 0 };
-    uint32_t running_total[2] = { 0, 0 };
-
-    // *** StreamSplitter internal data - scan() => reassemble()
-    uint32_t num_excess[2] = { 0, 0 };
-    bool is_broken_chunk[2] = { false, false };
-    uint32_t num_good_chunks[2] = { 0, 0 };
-    uint32_t octets_expected[2] = { 0, 0 };
-    bool strict_length[2] = { false, false };
-
-    // *** StreamSplitter => Inspector (facts about the most recent message section)
-    HttpEnums::SectionType section_type[2] = { HttpEnums::SEC__NOT_COMPUTE,
-                                                HttpEnums::SEC__NOT_COMPUTE };
-    bool tcp_close[2] = { false, false };
-    int32_t num_head_lines[2] = { HttpEnums::STAT_NOT_PRESENT, HttpEnums::STAT_NOT_PRESENT };
-    bool zero_byte_workaround[2];
 
     // Infractions and events are associated with a specific message and are stored in the
     // transaction for that message. But StreamSplitter splits the start line before there is
@@ -110,35 +98,15 @@ private:
     HttpEventGen* get_events(HttpEnums::SourceId source_id);
 
     // *** Inspector => StreamSplitter (facts about the message section that is coming next)
-    HttpEnums::SectionType type_expected[2] = { HttpEnums::SEC_REQUEST, HttpEnums::SEC_STATUS };
     // length of the data from Content-Length field
     int64_t data_length[2] = { HttpEnums::STAT_NOT_PRESENT, HttpEnums::STAT_NOT_PRESENT };
-    uint32_t section_size_target[2] = { 0, 0 };
-    uint32_t section_size_max[2] = { 0, 0 };
-    HttpEnums::CompressId compression[2] = { HttpEnums::CMP_NONE, HttpEnums::CMP_NONE };
-    z_stream* compress_stream[2] = { nullptr, nullptr };
     uint64_t zero_nine_expected = 0;
 
-    HttpEnums::DetectionStatus detection_status[2] = { HttpEnums::DET_ON, HttpEnums::DET_ON };
-
     // *** Inspector's internal data about the current message
-    HttpEnums::VersionId version_id[2] = { HttpEnums::VERS__NOT_PRESENT,
-                                            HttpEnums::VERS__NOT_PRESENT };
-    HttpEnums::MethodId method_id = HttpEnums::METH__NOT_PRESENT;
-    int32_t status_code_num = HttpEnums::STAT_NOT_PRESENT;
     int64_t file_depth_remaining[2] = { HttpEnums::STAT_NOT_PRESENT,
         HttpEnums::STAT_NOT_PRESENT };
     int64_t detect_depth_remaining[2] = { HttpEnums::STAT_NOT_PRESENT,
         HttpEnums::STAT_NOT_PRESENT };
-    MimeSession* mime_state[2] = { nullptr, nullptr };
-    UtfDecodeSession* utf_state = nullptr; // SRC_SERVER only
-    fd_session_t* fd_state = nullptr; // SRC_SERVER only
-    struct FdCallbackContext
-    {
-        HttpInfractions* infractions = nullptr;
-        HttpEventGen* events = nullptr;
-    };
-    FdCallbackContext fd_alert_context; // SRC_SERVER only
     uint64_t expected_trans_num[2] = { 1, 1 };
     HttpMsgSection* latest_section = nullptr;
 
@@ -150,15 +118,101 @@ private:
     HttpTransaction* transaction[2] = { nullptr, nullptr };
     static const int MAX_PIPELINE = 100;  // requests seen - responses seen <= MAX_PIPELINE
     HttpTransaction** pipeline = nullptr;
-    int pipeline_front = 0;
-    int pipeline_back = 0;
-    bool pipeline_overflow = false;
-    bool pipeline_underflow = false;
 
     bool add_to_pipeline(HttpTransaction* latest);
     HttpTransaction* take_from_pipeline();
     void delete_pipeline();
 
+    // *** Decompression, MIME, UTF, and PDF/SWF decoding state. Most flows never need any of it
+    // so it is allocated by get_decode() the first time a message asks for it and then stays
+    // with the flow. The get_*() accessors return nullptr when it hasn't been allocated.
+    struct FdCallbackContext
+    {
+        HttpInfractions* infractions = nullptr;
+        HttpEventGen* events = nullptr;
+    };
+    struct DecodeState
+    {
+        z_stream* compress_stream[2] = { nullptr, nullptr };
+        MimeSession* mime_state[2] = { nullptr, nullptr };
+        UtfDecodeSession* utf_state = nullptr; // SRC_SERVER only
+        fd_session_t* fd_state = nullptr; // SRC_SERVER only
+        FdCallbackContext fd_alert_context; // SRC_SERVER only
+    };
+    DecodeState* decode = nullptr;
+    DecodeState& get_decode();
+    void delete_compress_stream(HttpEnums::SourceId source_id);
+    void touch_compress_stream();
+    void unlink_compress_stream();
+    HttpFlowData* compress_prev = nullptr;
+    HttpFlowData* compress_next = nullptr;
+    bool compress_linked = false;
+    void delete_mime_state(HttpEnums::SourceId source_id);
+    void delete_server_decoders();
+    MimeSession* get_mime_state(HttpEnums::SourceId source_id) const
+        { return (decode != nullptr) ? decode->mime_state[source_id] : nullptr; }
+    UtfDecodeSession* get_utf_state() const
+        { return (decode != nullptr) ? decode->utf_state : nullptr; }
+    fd_session_t* get_fd_state() const
+        { return (decode != nullptr) ? decode->fd_state : nullptr; }
+
+    // --- 32-bit values ---
+
+    // *** StreamSplitter internal data - reassemble()
+    uint32_t section_total[2] = { 0, 0 };
+    uint32_t section_offset[2] = { 0, 0 };
+    uint32_t chunk_expected_length[2] = { 0, 0 };
+    uint32_t running_total[2] = { 0, 0 };
+
+    // *** StreamSplitter internal data - scan() => reassemble()
+    uint32_t num_excess[2] = { 0, 0 };
+    uint32_t num_good_chunks[2] = { 0, 0 };
+    uint32_t octets_expected[2] = { 0, 0 };
+
+    // *** StreamSplitter => Inspector (facts about the most recent message section)
+    int32_t num_head_lines[2] = { HttpEnums::STAT_NOT_PRESENT, HttpEnums::STAT_NOT_PRESENT };
+
+    // *** Inspector => StreamSplitter (facts about the message section that is coming next)
+    uint32_t section_size_target[2] = { 0, 0 };
+    uint32_t section_size_max[2] = { 0, 0 };
+
+    // *** Inspector's internal data about the current message
+    int32_t status_code_num = HttpEnums::STAT_NOT_PRESENT;
+
+    // Transaction management including pipelining
+    int pipeline_front = 0;
+    int pipeline_back = 0;
+
+    // --- bytes ---
+
+    // *** StreamSplitter internal data - reassemble()
+    HttpEnums::ChunkState chunk_state[2] = { HttpEnums::CHUNK_NEWLINES,
+        HttpEnums::CHUNK_NEWLINES };
+
+    // *** StreamSplitter internal data - scan() => reassemble()
+    bool is_broken_chunk[2] = { false, false };
+    bool strict_length[2] = { false, false };
+
+    // *** StreamSplitter => Inspector (facts about the most recent message section)
+    HttpEnums::SectionType section_type[2] = { HttpEnums::SEC__NOT_COMPUTE,
+                                                HttpEnums::SEC__NOT_COMPUTE };
+    bool tcp_close[2] = { false, false };
+    bool zero_byte_workaround[2];
+
+    // *** Inspector => StreamSplitter (facts about the message section that is coming next)
+    HttpEnums::SectionType type_expected[2] = { HttpEnums::SEC_REQUEST, HttpEnums::SEC_STATUS };
+    HttpEnums::CompressId compression[2] = { HttpEnums::CMP_NONE, HttpEnums::CMP_NONE };
+    HttpEnums::DetectionStatus detection_status[2] = { HttpEnums::DET_ON, HttpEnums::DET_ON };
+
+    // *** Inspector's internal data about the current message
+    HttpEnums::VersionId version_id[2] = { HttpEnums::VERS__NOT_PRESENT,
+                                            HttpEnums::VERS__NOT_PRESENT };
+    HttpEnums::MethodId method_id = HttpEnums::METH__NOT_PRESENT;
+
+    // Transaction management including pipelining
+    bool pipeline_overflow = false;
+    bool pipeline_underflow = false;
+
 #ifdef REG_TEST
     void show(FILE* out_file) const;
 
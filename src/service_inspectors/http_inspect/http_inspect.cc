@@ -26,6 +26,7 @@
 #include "detection/detection_engine.h"
 #include "detection/detection_util.h"
 #include "log/unified2.h"
+#include "memory/memory_domain.h"
 #include "protocols/packet.h"
 #include "stream/stream.h"
 
@@ -265,6 +266,7 @@ int HttpInspect::get_xtra_jsnorm(Flow* flow, uint8_t** buf, uint32_t* len, uint3
 void HttpInspect::eval(Packet* p)
 {
     Profile profile(HttpModule::get_profile_stats());
+    memory::DomainContext domain(memory::Domain::HTTP);
 
     const SourceId source_id = p->is_from_client() ? SRC_CLIENT : SRC_SERVER;
 
@@ -72,7 +72,7 @@ void HttpJsNorm::configure()
 }
 
 void HttpJsNorm::normalize(const Field& input, Field& output, HttpInfractions* infractions,
-    HttpEventGen* events) const
+    HttpEventGen* events, HttpArena& arena) const
 {
     bool js_present = false;
     int index = 0;
@@ -84,7 +84,7 @@ void HttpJsNorm::normalize(const Field& input, Field& output, HttpInfractions* i
     js.allowed_levels = MAX_ALLOWED_OBFUSCATION;
     js.alerts = 0;
 
-    uint8_t* buffer = new uint8_t[input.length()];
+    uint8_t* const buffer = arena.allocate(input.length());
 
     while (ptr < end)
     {
@@ -174,11 +174,12 @@ void HttpJsNorm::normalize(const Field& input, Field& output, HttpInfractions* i
                 events->create_event(EVENT_MIXED_ENCODINGS);
             }
         }
-        output.set(index, buffer, true);
+        arena.shrink(buffer, index);
+        output.set(index, buffer);
     }
     else
     {
-        delete[] buffer;
+        arena.shrink(buffer, 0);
         output.set(input);
     }
 }
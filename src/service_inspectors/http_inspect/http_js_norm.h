@@ -25,6 +25,7 @@
 #include "search_engines/search_tool.h"
 
 #include "http_field.h"
+#include "http_arena.h"
 #include "http_event_gen.h"
 #include "http_infractions.h"
 #include "http_module.h"
@@ -39,7 +40,7 @@ public:
     HttpJsNorm(int max_javascript_whitespaces_, const HttpParaList::UriParam& uri_param_);
     ~HttpJsNorm();
     void normalize(const Field& input, Field& output, HttpInfractions* infractions,
-        HttpEventGen* events) const;
+        HttpEventGen* events, HttpArena& arena) const;
     void configure();
 private:
     enum JsSearchId { JS_JAVASCRIPT };
@@ -87,9 +87,25 @@ const Parameter HttpModule::http_params[] =
 };
 
 THREAD_LOCAL ProfileStats HttpModule::http_profile;
+THREAD_LOCAL ProfileStats HttpModule::http_flow_data_profile;
 
-ProfileStats* HttpModule::get_profile() const
-{ return &http_profile; }
+ProfileStats* HttpModule::get_profile(
+    unsigned index, const char*& name, const char*& parent) const
+{
+    switch (index)
+    {
+    case 0:
+        name = HTTP_NAME;
+        parent = nullptr;
+        return &http_profile;
+
+    case 1:
+        name = "http_flow_data";
+        parent = HTTP_NAME;
+        return &http_flow_data_profile;
+    }
+    return nullptr;
+}
 
 THREAD_LOCAL PegCount HttpModule::peg_counts[PEG_COUNT_MAX] = { 0 };
 
@@ -106,16 +106,25 @@ public:
     PegCount* get_counts() const override { return peg_counts; }
     static void increment_peg_counts(HttpEnums::PEG_COUNT counter)
         { peg_counts[counter]++; }
+    static void increment_peg_counts(HttpEnums::PEG_COUNT counter, PegCount amount)
+        { peg_counts[counter] += amount; }
+    static void set_peg_counts(HttpEnums::PEG_COUNT counter, PegCount value)
+        { peg_counts[counter] = value; }
     static void decrement_peg_counts(HttpEnums::PEG_COUNT counter)
         { peg_counts[counter]--; }
     static PegCount get_peg_counts(HttpEnums::PEG_COUNT counter)
         { return peg_counts[counter]; }
 
-    ProfileStats* get_profile() const override;
+    ProfileStats* get_profile(unsigned, const char*&, const char*&) const override;
 
     static ProfileStats& get_profile_stats()
     { return http_profile; }
 
+    // The memory profiler shows HttpFlowData and its decoding state under this node so the
+    // average allocation is the per-flow footprint
+    static ProfileStats& get_flow_data_profile_stats()
+    { return http_flow_data_profile; }
+
     Usage get_usage() const override
     { return INSPECT; }
 
@@ -134,6 +143,7 @@ private:
     HttpParaList* params = nullptr;
     static const PegInfo peg_names[];
     static THREAD_LOCAL ProfileStats http_profile;
+    static THREAD_LOCAL ProfileStats http_flow_data_profile;
     static THREAD_LOCAL PegCount peg_counts[];
 };
 
@@ -73,34 +73,36 @@ bool HttpMsgBody::detection_required() const
 
 void HttpMsgBody::do_utf_decoding(const Field& input, Field& output)
 {
-    if ((source_id == SRC_CLIENT) || (session_data->utf_state == nullptr) || (input.length() == 0))
+    UtfDecodeSession* const utf_state = session_data->get_utf_state();
+    if ((source_id == SRC_CLIENT) || (utf_state == nullptr) || (input.length() == 0))
     {
         output.set(input);
         return;
     }
 
-    if (session_data->utf_state->is_utf_encoding_present())
+    if (utf_state->is_utf_encoding_present())
     {
         int bytes_copied;
         bool decoded;
-        uint8_t* buffer = new uint8_t[input.length()];
-        decoded = session_data->utf_state->decode_utf(
+        uint8_t* const buffer = get_arena().allocate(input.length());
+        decoded = utf_state->decode_utf(
             input.start(), input.length(), buffer, input.length(), &bytes_copied);
 
         if (!decoded)
         {
-            delete[] buffer;
+            get_arena().shrink(buffer, 0);
             output.set(input);
             add_infraction(INF_UTF_NORM_FAIL);
             create_event(EVENT_UTF_NORM_FAIL);
         }
         else if (bytes_copied > 0)
         {
-            output.set(bytes_copied, buffer, true);
+            get_arena().shrink(buffer, bytes_copied);
+            output.set(bytes_copied, buffer);
         }
         else
         {
-            delete[] buffer;
+            get_arena().shrink(buffer, 0);
             output.set(input);
         }
     }
@@ -111,39 +113,42 @@ void HttpMsgBody::do_utf_decoding(const Field& input, Field& output)
 
 void HttpMsgBody::do_pdf_swf_decompression(const Field& input, Field& output)
 {
-    if ((source_id == SRC_CLIENT) || (session_data->fd_state == nullptr))
+    fd_session_t* const fd_state = session_data->get_fd_state();
+    if ((source_id == SRC_CLIENT) || (fd_state == nullptr))
     {
         output.set(input);
         return;
     }
-    uint8_t* buffer = new uint8_t[MAX_OCTETS];
-    session_data->fd_alert_context.infractions = transaction->get_infractions(source_id);
-    session_data->fd_alert_context.events = transaction->get_events(source_id);
-    session_data->fd_state->Next_In = input.start();
-    session_data->fd_state->Avail_In = (uint32_t)input.length();
-    session_data->fd_state->Next_Out = buffer;
-    session_data->fd_state->Avail_Out = MAX_OCTETS;
+    uint8_t* const buffer = get_arena().allocate(MAX_OCTETS);
+    session_data->decode->fd_alert_context.infractions = transaction->get_infractions(source_id);
+    session_data->decode->fd_alert_context.events = transaction->get_events(source_id);
+    fd_state->Next_In = input.start();
+    fd_state->Avail_In = (uint32_t)input.length();
+    fd_state->Next_Out = buffer;
+    fd_state->Avail_Out = MAX_OCTETS;
 
-    const fd_status_t status = File_Decomp(session_data->fd_state);
+    const fd_status_t status = File_Decomp(fd_state);
 
     switch(status)
     {
     case File_Decomp_DecompError:
-        File_Decomp_Alert(session_data->fd_state, session_data->fd_state->Error_Event);
+        File_Decomp_Alert(fd_state, fd_state->Error_Event);
         // Fall through
     case File_Decomp_NoSig:
     case File_Decomp_Error:
-        delete[] buffer;
+        get_arena().shrink(buffer, 0);
         output.set(input);
-        File_Decomp_StopFree(session_data->fd_state);
-        session_data->fd_state = nullptr;
+        File_Decomp_StopFree(fd_state);
+        session_data->decode->fd_state = nullptr;
         break;
     case File_Decomp_BlockOut:
         add_infraction(INF_PDF_SWF_OVERRUN);
         create_event(EVENT_PDF_SWF_OVERRUN);
         // Fall through
     default:
-        output.set(session_data->fd_state->Next_Out - buffer, buffer, true);
+        const int32_t length = fd_state->Next_Out - buffer;
+        get_arena().shrink(buffer, length);
+        output.set(length, buffer);
         break;
     }
 }
@@ -193,7 +198,8 @@ void HttpMsgBody::do_js_normalization(const Field& input, Field& output)
     }
 
     params->js_norm_param.js_norm->normalize(input, output,
-        transaction->get_infractions(source_id), transaction->get_events(source_id));
+        transaction->get_infractions(source_id), transaction->get_events(source_id),
+        get_arena());
 }
 
 void HttpMsgBody::do_file_processing(Field& file_data)
@@ -217,7 +223,8 @@ void HttpMsgBody::do_file_processing(Field& file_data)
     const int32_t fp_length = (file_data.length() <= session_data->file_depth_remaining[source_id])
         ? file_data.length() : session_data->file_depth_remaining[source_id];
 
-    if (!session_data->mime_state[source_id])
+    MimeSession* const mime_state = session_data->get_mime_state(source_id);
+    if (mime_state == nullptr)
     {
         FileFlows* file_flows = FileFlows::get_file_flows(flow);
         const bool download = (source_id == SRC_SERVER);
@@ -258,21 +265,18 @@ void HttpMsgBody::do_file_processing(Field& file_data)
     }
     else
     {
-        session_data->mime_state[source_id]->process_mime_data(flow, file_data.start(),
-            fp_length, true, SNORT_FILE_POSITION_UNKNOWN);
+        mime_state->process_mime_data(flow, file_data.start(), fp_length, true,
+            SNORT_FILE_POSITION_UNKNOWN);
 
         session_data->file_depth_remaining[source_id] -= fp_length;
         if (session_data->file_depth_remaining[source_id] == 0)
-        {
-            delete session_data->mime_state[source_id];
-            session_data->mime_state[source_id] = nullptr;
-        }
+            session_data->delete_mime_state(source_id);
     }
 }
 
 const Field& HttpMsgBody::get_classic_client_body()
 {
-    return classic_normalize(detect_data, classic_client_body, params->uri_param);
+    return classic_normalize(detect_data, classic_client_body, params->uri_param, get_arena());
 }
 
 #ifdef REG_TEST
@@ -45,6 +45,9 @@ protected:
 
     int64_t body_octets;
 
+    // Body buffers are released as soon as the next body section arrives
+    HttpArena& get_arena() const override { return transaction->get_body_arena(); }
+
 #ifdef REG_TEST
     void print_body_section(FILE* output);
 #endif
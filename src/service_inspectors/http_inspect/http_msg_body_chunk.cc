@@ -32,16 +32,12 @@ void HttpMsgBodyChunk::update_flow()
     {
         session_data->body_octets[source_id] = body_octets;
         session_data->trailer_prep(source_id);
-        if (session_data->mime_state[source_id] != nullptr)
-        {
-            delete session_data->mime_state[source_id];
-            session_data->mime_state[source_id] = nullptr;
-        }
+        session_data->delete_mime_state(source_id);
 
-        if ((source_id == SRC_SERVER) && (session_data->utf_state != nullptr))
+        if ((source_id == SRC_SERVER) && (session_data->get_utf_state() != nullptr))
         {
-            delete session_data->utf_state;
-            session_data->utf_state = nullptr;
+            delete session_data->decode->utf_state;
+            session_data->decode->utf_state = nullptr;
         }
     }
     else
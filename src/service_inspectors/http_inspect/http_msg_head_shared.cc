@@ -25,21 +25,6 @@
 
 using namespace HttpEnums;
 
-HttpMsgHeadShared::~HttpMsgHeadShared()
-{
-    delete[] header_line;
-    delete[] header_name;
-    delete[] header_name_id;
-    delete[] header_value;
-    NormalizedHeader* list_ptr = norm_heads;
-    while (list_ptr != nullptr)
-    {
-        NormalizedHeader* temp_ptr = list_ptr;
-        list_ptr = list_ptr->next;
-        delete temp_ptr;
-    }
-}
-
 // All the header processing that is done for every message (i.e. not just-in-time) is done here.
 void HttpMsgHeadShared::analyze()
 {
@@ -69,7 +54,8 @@ void HttpMsgHeadShared::create_norm_head_list()
             {
                 headers_present[header_name_id[j]] = true;
                 NormalizedHeader* tmp_ptr = norm_heads;
-                norm_heads = new NormalizedHeader(header_name_id[j]);
+                norm_heads = new (get_arena().allocate(sizeof(NormalizedHeader)))
+                    NormalizedHeader(header_name_id[j]);
                 norm_heads->next = tmp_ptr;
                 norm_heads->count = 1;
             }
@@ -85,7 +71,7 @@ void HttpMsgHeadShared::parse_header_block()
     int32_t num_seps;
     // session_data->num_head_lines is computed without consideration of wrapping and may overstate
     // actual number of headers. Rely on num_headers which is calculated correctly.
-    header_line = new Field[session_data->num_head_lines[source_id]];
+    header_line = get_arena().allocate_array<Field>(session_data->num_head_lines[source_id]);
     while (bytes_used < msg_text.length())
     {
         assert(num_headers < session_data->num_head_lines[source_id]);
@@ -167,9 +153,9 @@ int32_t HttpMsgHeadShared::find_next_header(const uint8_t* buffer, int32_t lengt
 // Divide header field lines into field name and field value
 void HttpMsgHeadShared::parse_header_lines()
 {
-    header_name = new Field[num_headers];
-    header_value = new Field[num_headers];
-    header_name_id = new HeaderId[num_headers];
+    header_name = get_arena().allocate_array<Field>(num_headers);
+    header_value = get_arena().allocate_array<Field>(num_headers);
+    header_name_id = get_arena().allocate_array<HeaderId>(num_headers);
 
     for (int k=0; k < num_headers; k++)
     {
@@ -208,7 +194,7 @@ void HttpMsgHeadShared::derive_header_name_id(int index)
 
     // Normalize header field name to lower case and remove LWS for matching purposes
     int32_t lower_length = 0;
-    uint8_t* lower_name = new uint8_t[length];
+    uint8_t* const lower_name = get_arena().allocate(length);
     for (int32_t k=0; k < length; k++)
     {
         if (!is_sp_tab_cr_lf[buffer[k]])
@@ -228,7 +214,7 @@ void HttpMsgHeadShared::derive_header_name_id(int index)
         }
     }
     header_name_id[index] = (HeaderId)str_to_code(lower_name, lower_length, header_list);
-    delete[] lower_name;
+    get_arena().shrink(lower_name, 0);
 }
 
 HttpMsgHeadShared::NormalizedHeader* HttpMsgHeadShared::get_header_node(HeaderId header_id) const
@@ -274,7 +260,7 @@ const Field& HttpMsgHeadShared::get_classic_raw_header()
     }
 
     // Step through headers again and do the copying this time
-    uint8_t* const buffer = new uint8_t[length];
+    uint8_t* const buffer = get_arena().allocate(length);
     int32_t current = 0;
     for (int k = 0; k < num_headers; k++)
     {
@@ -287,13 +273,14 @@ const Field& HttpMsgHeadShared::get_classic_raw_header()
     }
     assert(current == length);
 
-    classic_raw_header.set(length, buffer, true);
+    classic_raw_header.set(length, buffer);
     return classic_raw_header;
 }
 
 const Field& HttpMsgHeadShared::get_classic_norm_header()
 {
-    return classic_normalize(get_classic_raw_header(), classic_norm_header, params->uri_param);
+    return classic_normalize(get_classic_raw_header(), classic_norm_header, params->uri_param,
+        get_arena());
 }
 
 const Field& HttpMsgHeadShared::get_classic_raw_cookie()
@@ -304,7 +291,8 @@ const Field& HttpMsgHeadShared::get_classic_raw_cookie()
 
 const Field& HttpMsgHeadShared::get_classic_norm_cookie()
 {
-    return classic_normalize(get_classic_raw_cookie(), classic_norm_cookie, params->uri_param);
+    return classic_normalize(get_classic_raw_cookie(), classic_norm_cookie, params->uri_param,
+        get_arena());
 }
 
 const Field& HttpMsgHeadShared::get_header_value_raw(HeaderId header_id) const
@@ -330,7 +318,7 @@ const Field& HttpMsgHeadShared::get_header_value_norm(HeaderId header_id)
         return Field::FIELD_NULL;
     header_norms[header_id]->normalize(header_id, node->count,
         transaction->get_infractions(source_id), transaction->get_events(source_id),
-        header_name_id, header_value, num_headers, node->norm);
+        header_name_id, header_value, num_headers, node->norm, get_arena());
     return node->norm;
 }
 
@@ -56,7 +56,6 @@ protected:
         const HttpParaList* params_)
         : HttpMsgSection(buffer, buf_size, session_data_, source_id_, buf_owner, flow_, params_)
         { }
-    ~HttpMsgHeadShared() override;
     // Get the next item in a comma-separated header value and convert it to an enum value
     static int32_t get_next_code(const Field& field, int32_t& offset, const StrCode table[]);
     // Do a case insensitive search for "boundary=" in a Field
@@ -23,6 +23,8 @@
 
 #include "http_msg_header.h"
 
+#include <new>
+
 #include "decompress/file_decomp.h"
 #include "file_api/file_flows.h"
 #include "file_api/file_service.h"
@@ -99,13 +101,13 @@ const Field& HttpMsgHeader::get_true_ip_addr()
     }
 
     // Need a temporary copy so we can add null termination
-    uint8_t* addr_str = new uint8_t[true_ip.length()+1];
+    uint8_t* const addr_str = get_arena().allocate(true_ip.length()+1);
     memcpy(addr_str, true_ip.start(), true_ip.length());
     addr_str[true_ip.length()] = '\0';
 
     SfIp tmp_sfip;
     const SfIpRet status = tmp_sfip.set((char*)addr_str);
-    delete[] addr_str;
+    get_arena().shrink(addr_str, 0);
     if (status != SFIP_SUCCESS)
     {
         true_ip_addr.set(STAT_PROBLEMATIC);
@@ -113,9 +115,9 @@ const Field& HttpMsgHeader::get_true_ip_addr()
     else
     {
         const size_t addr_length = (tmp_sfip.is_ip6() ? 4 : 1);
-        uint32_t* const addr_buf = new uint32_t[addr_length];
+        uint8_t* const addr_buf = get_arena().allocate(addr_length * sizeof(uint32_t));
         memcpy(addr_buf, tmp_sfip.get_ptr(), addr_length * sizeof(uint32_t));
-        true_ip_addr.set(addr_length * sizeof(uint32_t), (uint8_t*)addr_buf, true);
+        true_ip_addr.set(addr_length * sizeof(uint32_t), addr_buf);
     }
     return true_ip_addr;
 }
@@ -330,24 +332,24 @@ void HttpMsgHeader::setup_file_processing()
             {
                 if (boundary_present(content_type))
                 {
-                    session_data->mime_state[source_id] =
-                        new MimeSession(&decode_conf, &mime_conf);
+                    MimeSession*& mime_state = session_data->get_decode().mime_state[source_id];
+                    mime_state = new MimeSession(&decode_conf, &mime_conf);
                     // Show file processing the Content-Type header as if it were regular data.
                     // This will enable it to find the boundary string.
                     // FIXIT-L develop a proper interface for passing the boundary string.
                     // This interface is a leftover from when OHI pushed whole messages through
                     // this interface.
-                    session_data->mime_state[source_id]->process_mime_data(flow,
+                    mime_state->process_mime_data(flow,
                         content_type.start(), content_type.length(), true,
                         SNORT_FILE_POSITION_UNKNOWN);
-                    session_data->mime_state[source_id]->process_mime_data(flow,
+                    mime_state->process_mime_data(flow,
                         (const uint8_t*)"\r\n", 2, true, SNORT_FILE_POSITION_UNKNOWN);
                 }
             }
         }
 
         // Otherwise do regular file processing
-        if (session_data->mime_state[source_id] == nullptr)
+        if (session_data->get_mime_state(source_id) == nullptr)
         {
             FileFlows* file_flows = FileFlows::get_file_flows(flow);
             if (!file_flows)
@@ -416,18 +418,33 @@ void HttpMsgHeader::setup_encoding_decompression()
     if (compression == CMP_NONE)
         return;
 
-    session_data->compress_stream[source_id] = new z_stream;
-    session_data->compress_stream[source_id]->zalloc = Z_NULL;
-    session_data->compress_stream[source_id]->zfree = Z_NULL;
-    session_data->compress_stream[source_id]->next_in = Z_NULL;
-    session_data->compress_stream[source_id]->avail_in = 0;
+    z_stream*& compress_stream = session_data->get_decode().compress_stream[source_id];
+    compress_stream = new z_stream;
+    compress_stream->zalloc = compress_alloc;
+    compress_stream->zfree = compress_free;
+    compress_stream->next_in = Z_NULL;
+    compress_stream->avail_in = 0;
     const int window_bits = (compression == CMP_GZIP) ? GZIP_WINDOW_BITS : DEFLATE_WINDOW_BITS;
-    if (inflateInit2(session_data->compress_stream[source_id], window_bits) != Z_OK)
+    if (inflateInit2(compress_stream, window_bits) != Z_OK)
     {
         session_data->compression[source_id] = CMP_NONE;
-        delete session_data->compress_stream[source_id];
-        session_data->compress_stream[source_id] = nullptr;
+        delete compress_stream;
+        compress_stream = nullptr;
     }
+    else
+        session_data->touch_compress_stream();
+}
+
+// zlib's state and window are by far the largest part of a decompressing flow so they are
+// allocated with new to be charged to the http memory domain like everything else
+void* HttpMsgHeader::compress_alloc(void*, unsigned items, unsigned size)
+{
+    return new (std::nothrow) uint8_t[(size_t)items * size];
+}
+
+void HttpMsgHeader::compress_free(void*, void* address)
+{
+    delete[] (uint8_t*)address;
 }
 
 void HttpMsgHeader::setup_utf_decoding()
@@ -475,8 +492,9 @@ void HttpMsgHeader::setup_utf_decoding()
         }
     }
 
-    session_data->utf_state = new UtfDecodeSession();
-    session_data->utf_state->set_decode_utf_state_charset(charset_code);
+    UtfDecodeSession*& utf_state = session_data->get_decode().utf_state;
+    utf_state = new UtfDecodeSession();
+    utf_state->set_decode_utf_state_charset(charset_code);
 }
 
 void HttpMsgHeader::setup_pdf_swf_decompression()
@@ -484,16 +502,17 @@ void HttpMsgHeader::setup_pdf_swf_decompression()
     if (source_id == SRC_CLIENT || (!params->decompress_pdf && !params->decompress_swf))
         return;
 
-    session_data->fd_state = File_Decomp_New();
-    session_data->fd_state->Modes =
+    HttpFlowData::DecodeState& decode = session_data->get_decode();
+    decode.fd_state = File_Decomp_New();
+    decode.fd_state->Modes =
         (params->decompress_pdf ? FILE_PDF_DEFL_BIT : 0) |
         (params->decompress_swf ? (FILE_SWF_ZLIB_BIT | FILE_SWF_LZMA_BIT) : 0);
-    session_data->fd_state->Alert_Callback = HttpMsgBody::fd_event_callback;
-    session_data->fd_state->Alert_Context = &session_data->fd_alert_context;
-    session_data->fd_state->Compr_Depth = 0;
-    session_data->fd_state->Decompr_Depth = 0;
+    decode.fd_state->Alert_Callback = HttpMsgBody::fd_event_callback;
+    decode.fd_state->Alert_Context = &decode.fd_alert_context;
+    decode.fd_state->Compr_Depth = 0;
+    decode.fd_state->Decompr_Depth = 0;
 
-    (void)File_Decomp_Init(session_data->fd_state);
+    (void)File_Decomp_Init(decode.fd_state);
 }
 
 #ifdef REG_TEST
@@ -52,6 +52,8 @@ private:
     void prepare_body();
     void setup_file_processing();
     void setup_encoding_decompression();
+    static void* compress_alloc(void* opaque, unsigned items, unsigned size);
+    static void compress_free(void* opaque, void* address);
     void setup_utf_decoding();
     void setup_pdf_swf_decompression();
 
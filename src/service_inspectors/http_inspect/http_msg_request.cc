@@ -103,7 +103,7 @@ void HttpMsgRequest::parse_start_line()
     {
         uri = new HttpUri(start_line.start() + first_end + 1, last_begin - first_end - 1,
             method_id, params->uri_param, transaction->get_infractions(source_id),
-            transaction->get_events(source_id));
+            transaction->get_events(source_id), get_arena());
     }
     else
     {
@@ -146,7 +146,7 @@ bool HttpMsgRequest::handle_zero_nine()
                 uri_end--);
             uri = new HttpUri(start_line.start() + uri_begin, uri_end - uri_begin + 1, method_id,
                 params->uri_param, transaction->get_infractions(source_id),
-                transaction->get_events(source_id));
+                transaction->get_events(source_id), get_arena());
         }
         else
         {
@@ -108,7 +108,7 @@ void HttpMsgSection::update_depth() const
 }
 
 const Field& HttpMsgSection::classic_normalize(const Field& raw, Field& norm,
-    const HttpParaList::UriParam& uri_param)
+    const HttpParaList::UriParam& uri_param, HttpArena& arena)
 {
     if (norm.length() != STAT_NOT_COMPUTE)
         return norm;
@@ -118,7 +118,7 @@ const Field& HttpMsgSection::classic_normalize(const Field& raw, Field& norm,
         norm.set(raw);
         return norm;
     }
-    UriNormalizer::classic_normalize(raw, norm, uri_param);
+    UriNormalizer::classic_normalize(raw, norm, uri_param, arena);
     return norm;
 }
 
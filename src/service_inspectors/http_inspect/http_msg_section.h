@@ -92,7 +92,10 @@ protected:
     void create_event(int sid);
     void update_depth() const;
     static const Field& classic_normalize(const Field& raw, Field& norm,
-        const HttpParaList::UriParam& uri_param);
+        const HttpParaList::UriParam& uri_param, HttpArena& arena);
+
+    // Buffers derived from this section are released along with the transaction
+    virtual HttpArena& get_arena() const { return transaction->get_arena(source_id); }
 #ifdef REG_TEST
     void print_section_title(FILE* output, const char* title) const;
     void print_section_wrapup(FILE* output) const;
@@ -54,9 +54,8 @@ private:
     HttpCutter* get_cutter(HttpEnums::SectionType type, const HttpFlowData* session) const;
     void chunk_spray(HttpFlowData* session_data, uint8_t* buffer, const uint8_t* data,
         unsigned length) const;
-    static void decompress_copy(uint8_t* buffer, uint32_t& offset, const uint8_t* data,
-        uint32_t length, HttpEnums::CompressId& compression, z_stream*& compress_stream,
-        bool at_start, HttpInfractions* infractions, HttpEventGen* events);
+    void decompress_copy(uint8_t* buffer, uint32_t& offset, const uint8_t* data,
+        uint32_t length, HttpFlowData* session_data, bool at_start) const;
 
     const HttpEnums::SourceId source_id;
     HttpInspect* const my_inspector;
@@ -114,7 +114,8 @@ bool HttpStreamSplitter::finish(Flow* flow)
         (session_data->cutter[source_id] != nullptr)               &&
         (session_data->cutter[source_id]->get_octets_seen() == 0))
     {
-        if (!session_data->mime_state[source_id])
+        MimeSession* const mime_state = session_data->get_mime_state(source_id);
+        if (mime_state == nullptr)
         {
             FileFlows* file_flows = FileFlows::get_file_flows(flow);
             const bool download = (source_id == SRC_SERVER);
@@ -134,10 +135,8 @@ bool HttpStreamSplitter::finish(Flow* flow)
         }
         else
         {
-            session_data->mime_state[source_id]->process_mime_data(flow, nullptr, 0, true,
-                SNORT_FILE_POSITION_UNKNOWN);
-            delete session_data->mime_state[source_id];
-            session_data->mime_state[source_id] = nullptr;
+            mime_state->process_mime_data(flow, nullptr, 0, true, SNORT_FILE_POSITION_UNKNOWN);
+            session_data->delete_mime_state(source_id);
         }
         return false;
     }
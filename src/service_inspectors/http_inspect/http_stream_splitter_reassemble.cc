@@ -21,6 +21,7 @@
 #include "config.h"
 #endif
 
+#include "memory/memory_domain.h"
 #include "protocols/packet.h"
 
 #include "http_inspect.h"
@@ -95,9 +96,7 @@ void HttpStreamSplitter::chunk_spray(HttpFlowData* session_data, uint8_t* buffer
             const bool at_start = (session_data->body_octets[source_id] == 0) &&
                 (session_data->section_offset[source_id] == 0);
             decompress_copy(buffer, session_data->section_offset[source_id], data+k, skip_amount,
-                session_data->compression[source_id], session_data->compress_stream[source_id],
-                at_start, session_data->get_infractions(source_id),
-                session_data->get_events(source_id));
+                session_data, at_start);
             if ((expected -= skip_amount) == 0)
                 curr_state = CHUNK_DCRLF1;
             k += skip_amount-1;
@@ -125,9 +124,7 @@ void HttpStreamSplitter::chunk_spray(HttpFlowData* session_data, uint8_t* buffer
             const bool at_start = (session_data->body_octets[source_id] == 0) &&
                 (session_data->section_offset[source_id] == 0);
             decompress_copy(buffer, session_data->section_offset[source_id], data+k, skip_amount,
-                session_data->compression[source_id], session_data->compress_stream[source_id],
-                at_start, session_data->get_infractions(source_id),
-                session_data->get_events(source_id));
+                session_data, at_start);
             k += skip_amount-1;
             break;
           }
@@ -136,11 +133,26 @@ void HttpStreamSplitter::chunk_spray(HttpFlowData* session_data, uint8_t* buffer
 }
 
 void HttpStreamSplitter::decompress_copy(uint8_t* buffer, uint32_t& offset, const uint8_t* data,
-    uint32_t length, HttpEnums::CompressId& compression, z_stream*& compress_stream,
-    bool at_start, HttpInfractions* infractions, HttpEventGen* events)
+    uint32_t length, HttpFlowData* session_data, bool at_start) const
 {
+    CompressId& compression = session_data->compression[source_id];
+    HttpInfractions* const infractions = session_data->get_infractions(source_id);
+    HttpEventGen* const events = session_data->get_events(source_id);
+
+    if (((compression == CMP_GZIP) || (compression == CMP_DEFLATE)) &&
+        (session_data->decode->compress_stream[source_id] == nullptr))
+    {
+        // Compression is only turned on after the decode state and stream are set up. The stream
+        // is gone because the http pruner took it to free memory.
+        *infractions += INF_GZIP_PRUNED;
+        events->create_event(EVENT_GZIP_FAILURE);
+        compression = CMP_NONE;
+    }
+
     if ((compression == CMP_GZIP) || (compression == CMP_DEFLATE))
     {
+        z_stream* const compress_stream = session_data->decode->compress_stream[source_id];
+        session_data->touch_compress_stream();
         compress_stream->next_in = (Bytef*)data;
         compress_stream->avail_in = length;
         compress_stream->next_out = buffer + offset;
@@ -172,9 +184,7 @@ void HttpStreamSplitter::decompress_copy(uint8_t* buffer, uint32_t& offset, cons
                     events->create_event(EVENT_GZIP_OVERRUN);
                 }
                 compression = CMP_NONE;
-                inflateEnd(compress_stream);
-                delete compress_stream;
-                compress_stream = nullptr;
+                session_data->delete_compress_stream(source_id);
             }
             return;
         }
@@ -190,8 +200,7 @@ void HttpStreamSplitter::decompress_copy(uint8_t* buffer, uint32_t& offset, cons
             inflate(compress_stream, Z_SYNC_FLUSH);
 
             // Start over at the beginning
-            decompress_copy(buffer, offset, data, length, compression, compress_stream, false,
-                infractions, events);
+            decompress_copy(buffer, offset, data, length, session_data, false);
             return;
         }
         else
@@ -199,9 +208,7 @@ void HttpStreamSplitter::decompress_copy(uint8_t* buffer, uint32_t& offset, cons
             *infractions += INF_GZIP_FAILURE;
             events->create_event(EVENT_GZIP_FAILURE);
             compression = CMP_NONE;
-            inflateEnd(compress_stream);
-            delete compress_stream;
-            compress_stream = nullptr;
+            session_data->delete_compress_stream(source_id);
             // Since we failed to uncompress the data, fall through
         }
     }
@@ -222,6 +229,7 @@ const StreamBuffer HttpStreamSplitter::reassemble(Flow* flow, unsigned total, un
     const uint8_t* data, unsigned len, uint32_t flags, unsigned& copied)
 {
     StreamBuffer http_buf { nullptr, 0 };
+    memory::DomainContext domain(memory::Domain::HTTP);
 
     copied = len;
 
@@ -363,9 +371,7 @@ const StreamBuffer HttpStreamSplitter::reassemble(Flow* flow, unsigned total, un
         const bool at_start = (session_data->body_octets[source_id] == 0) &&
              (session_data->section_offset[source_id] == 0);
         decompress_copy(buffer, session_data->section_offset[source_id], data, len,
-            session_data->compression[source_id], session_data->compress_stream[source_id],
-            at_start, session_data->get_infractions(source_id),
-            session_data->get_events(source_id));
+            session_data, at_start);
     }
     else
     {
@@ -21,6 +21,8 @@
 #include "config.h"
 #endif
 
+#include "memory/memory_domain.h"
+
 #include "http_inspect.h"
 #include "http_stream_splitter.h"
 #include "http_test_input.h"
@@ -82,6 +84,8 @@ StreamSplitter::Status HttpStreamSplitter::scan(Flow* flow, const uint8_t* data,
 {
     assert(length <= MAX_OCTETS);
 
+    memory::DomainContext domain(memory::Domain::HTTP);
+
     // This is the session state information we share with HttpInspect and store with stream. A
     // session is defined by a TCP connection. Since scan() is the first to see a new TCP
     // connection the new flow data object is created here.
@@ -89,6 +93,7 @@ StreamSplitter::Status HttpStreamSplitter::scan(Flow* flow, const uint8_t* data,
 
     if (session_data == nullptr)
     {
+        MemoryContext profile(HttpModule::get_flow_data_profile_stats().memory);
         flow->set_flow_data(session_data = new HttpFlowData);
         HttpModule::increment_peg_counts(PEG_FLOW);
     }
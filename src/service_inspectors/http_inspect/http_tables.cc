@@ -405,6 +405,9 @@ const PegInfo HttpModule::peg_names[PEG_COUNT_MAX+1] =
     { CountType::SUM, "uri_coding", "URIs with character coding problems" },
     { CountType::NOW, "concurrent_sessions", "total concurrent http sessions" },
     { CountType::MAX, "max_concurrent_sessions", "maximum concurrent http sessions" },
+    { CountType::SUM, "arena_bytes", "bytes of message buffers drawn from transaction arenas" },
+    { CountType::SUM, "arena_blocks", "heap blocks allocated by transaction arenas" },
+    { CountType::MAX, "max_arena_bytes", "most bytes held at once by a single transaction arena" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -25,6 +25,7 @@
 
 #include "http_event_gen.h"
 #include "http_infractions.h"
+#include "http_module.h"
 #include "http_msg_body.h"
 #include "http_msg_header.h"
 #include "http_msg_request.h"
@@ -45,6 +46,15 @@ HttpTransaction::~HttpTransaction()
         delete events[k];
     }
     delete latest_body;
+
+    const HttpArena* const arenas[] = { &arena, &response_arena, &body_arena };
+    for (const HttpArena* a : arenas)
+    {
+        HttpModule::increment_peg_counts(PEG_ARENA_BYTES, a->get_total_bytes());
+        HttpModule::increment_peg_counts(PEG_ARENA_BLOCKS, a->get_heap_blocks());
+        if (HttpModule::get_peg_counts(PEG_MAX_ARENA_BYTES) < a->get_peak_bytes())
+            HttpModule::set_peg_counts(PEG_MAX_ARENA_BYTES, a->get_peak_bytes());
+    }
 }
 
 HttpTransaction* HttpTransaction::attach_my_transaction(HttpFlowData* session_data, SourceId
@@ -117,6 +127,8 @@ HttpTransaction* HttpTransaction::attach_my_transaction(HttpFlowData* session_da
         session_data->transaction[SRC_SERVER]->header[SRC_SERVER] = nullptr;
         delete session_data->transaction[SRC_SERVER]->trailer[SRC_SERVER];
         session_data->transaction[SRC_SERVER]->trailer[SRC_SERVER] = nullptr;
+        // Nothing else refers to the interim response so its arena memory can be reused
+        session_data->transaction[SRC_SERVER]->response_arena.reset();
     }
     // Status section: delete the current transaction and get a new one from the pipeline. If the
     // pipeline is empty check for a request transaction and take it. If there is no transaction
@@ -187,6 +199,7 @@ void HttpTransaction::delete_transaction(HttpTransaction* transaction)
 void HttpTransaction::set_body(HttpMsgBody* latest_body_)
 {
     delete latest_body;
+    body_arena.reset();
     latest_body = latest_body_;
 }
 
@@ -20,6 +20,7 @@
 #ifndef TRANSACTION_H
 #define TRANSACTION_H
 
+#include "http_arena.h"
 #include "http_enum.h"
 #include "http_flow_data.h"
 
@@ -64,6 +65,14 @@ public:
     void set_one_hundred_response();
     bool final_response() const { return !second_response_expected; }
 
+    // Start lines, headers, and trailers draw from a per-direction arena which is released when
+    // the transaction is deleted. The response arena is also recycled when an interim response is
+    // replaced. Only the latest body section is kept so body sections draw from a separate arena
+    // that is recycled each time the body is replaced.
+    HttpArena& get_arena(HttpEnums::SourceId source_id)
+        { return (source_id == HttpEnums::SRC_SERVER) ? response_arena : arena; }
+    HttpArena& get_body_arena() { return body_arena; }
+
 private:
     HttpTransaction() = default;
     ~HttpTransaction();
@@ -76,6 +85,10 @@ private:
     HttpInfractions* infractions[2] = { nullptr, nullptr };
     HttpEventGen* events[2] = { nullptr, nullptr };
 
+    HttpArena arena;
+    HttpArena response_arena;
+    HttpArena body_arena;
+
     bool response_seen = false;
     bool one_hundred_response = false;
     bool second_response_expected = false;
@@ -36,10 +36,10 @@ class HttpUri
 public:
     HttpUri(const uint8_t* start, int32_t length, HttpEnums::MethodId method_id_,
         const HttpParaList::UriParam& uri_param_, HttpInfractions* infractions_,
-        HttpEventGen* events_) :
+        HttpEventGen* events_, HttpArena& arena) :
         uri(length, start), method_id(method_id_), uri_param(uri_param_),
         infractions(infractions_), events(events_)
-        { normalize(); }
+        { normalize(arena); }
     const Field& get_uri() const { return uri; }
     HttpEnums::UriType get_uri_type() { return uri_type; }
     const Field& get_scheme() { return scheme; }
@@ -82,7 +82,7 @@ private:
     Field classic_norm;
     size_t abs_path_hash = 0;
 
-    void normalize();
+    void normalize(HttpArena& arena);
     void parse_uri();
     void parse_authority();
     void parse_abs_path();
@@ -23,6 +23,7 @@
 #include <vector>
 #include <string>
 
+#include "http_arena.h"
 #include "http_enum.h"
 #include "http_field.h"
 #include "http_module.h"
@@ -43,7 +44,7 @@ public:
     static bool classic_need_norm(const Field& uri_component, bool do_path,
         const HttpParaList::UriParam& uri_param);
     static void classic_normalize(const Field& input, Field& result,
-        const HttpParaList::UriParam& uri_param);
+        const HttpParaList::UriParam& uri_param, HttpArena& arena);
     static void load_default_unicode_map(uint8_t map[65536]);
     static void load_unicode_map(uint8_t map[65536], const char* filename, int code_page);
 
@@ -0,0 +1,144 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// http_arena_test.cc
+// unit test main
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "service_inspectors/http_inspect/http_arena.h"
+#include "service_inspectors/http_inspect/http_field.h"
+#include "service_inspectors/http_inspect/http_test_manager.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+#include <CppUTestExt/MockSupport.h>
+
+using namespace HttpEnums;
+
+// Stubs whose sole purpose is to make the test code link
+long HttpTestManager::print_amount {};
+bool HttpTestManager::print_hex {};
+
+TEST_GROUP(http_arena_test)
+{
+    HttpArena arena;
+};
+
+TEST(http_arena_test, alignment)
+{
+    for (size_t k = 1; k < 100; k++)
+    {
+        const uint8_t* memory = arena.allocate(k);
+        CHECK(((uintptr_t)memory % alignof(std::max_align_t)) == 0);
+    }
+}
+
+TEST(http_arena_test, shrink_latest)
+{
+    uint8_t* const first = arena.allocate(100);
+    uint8_t* const second = arena.allocate(MAX_OCTETS);
+    arena.shrink(second, 10);
+    CHECK(arena.allocate(16) == second + 16);
+
+    // Only the most recent allocation can be shrunk
+    const uint64_t total = arena.get_total_bytes();
+    arena.shrink(first, 0);
+    CHECK(arena.get_total_bytes() == total);
+
+    uint8_t* const third = arena.allocate(50);
+    arena.shrink(third, 0);
+    CHECK(arena.allocate(50) == third);
+}
+
+TEST(http_arena_test, oversize_allocation)
+{
+    arena.allocate(100);
+    uint8_t* const large = arena.allocate(2 * HttpArena::BLOCK_SIZE);
+    CHECK(arena.get_heap_blocks() == 2);
+
+    // The oversize block is sized exactly so the next allocation needs another block
+    CHECK(arena.allocate(100) != large + 2 * HttpArena::BLOCK_SIZE);
+    CHECK(arena.get_heap_blocks() == 3);
+}
+
+TEST(http_arena_test, reset_reuses_blocks)
+{
+    uint8_t* const first = arena.allocate(MAX_OCTETS);
+    arena.allocate(MAX_OCTETS);
+    const uint64_t blocks = arena.get_heap_blocks();
+
+    for (unsigned k = 0; k < 100; k++)
+    {
+        arena.reset();
+        CHECK(arena.allocate(MAX_OCTETS) == first);
+        arena.allocate(MAX_OCTETS);
+    }
+    CHECK(arena.get_heap_blocks() == blocks);
+    CHECK(arena.get_total_bytes() >= 202 * (uint64_t)MAX_OCTETS);
+}
+
+TEST(http_arena_test, reset_releases_excess)
+{
+    for (unsigned k = 0; k < 10; k++)
+        arena.allocate(MAX_OCTETS);
+    const uint64_t blocks = arena.get_heap_blocks();
+
+    arena.reset();
+    for (unsigned k = 0; k < 10; k++)
+        arena.allocate(MAX_OCTETS);
+
+    // Two blocks were retained and the rest came back from the heap
+    CHECK(arena.get_heap_blocks() == blocks + 8);
+}
+
+TEST(http_arena_test, peak_bytes)
+{
+    arena.allocate(1000);
+    uint8_t* const buffer = arena.allocate(MAX_OCTETS);
+    const uint64_t peak = arena.get_peak_bytes();
+    arena.shrink(buffer, 0);
+    CHECK(arena.get_peak_bytes() == peak);
+
+    // The high-water mark is not raised by allocations that only reuse memory after a reset
+    for (unsigned k = 0; k < 10; k++)
+    {
+        arena.reset();
+        arena.allocate(1000);
+    }
+    CHECK(arena.get_peak_bytes() == peak);
+}
+
+TEST(http_arena_test, field_array)
+{
+    const uint8_t text[] = "Host: www.example.com";
+    Field* const fields = arena.allocate_array<Field>(3);
+    for (int k = 0; k < 3; k++)
+        CHECK(fields[k].length() == STAT_NOT_COMPUTE);
+    fields[1].set(4, text);
+    CHECK(fields[1].length() == 4);
+    CHECK(fields[1].start() == text);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
+
@@ -39,7 +39,10 @@ unsigned FlowData::flow_data_id = 0;
 FlowData::FlowData(unsigned, Inspector*) {}
 FlowData::~FlowData() {}
 int DetectionEngine::queue_event(unsigned int, unsigned int, RuleType) { return 0; }
-THREAD_LOCAL PegCount HttpModule::peg_counts[1];
+THREAD_LOCAL PegCount HttpModule::peg_counts[PEG_COUNT_MAX];
+THREAD_LOCAL ProfileStats HttpModule::http_flow_data_profile;
+MemoryContext::MemoryContext(MemoryTracker&) : saved(nullptr) { }
+MemoryContext::~MemoryContext() { }
 fd_status_t File_Decomp_StopFree(fd_session_t*) { return File_Decomp_OK; }
 
 class HttpUnitTestSetup
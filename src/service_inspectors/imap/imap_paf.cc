@@ -25,6 +25,7 @@
 #include "main/snort_debug.h"
 #include "protocols/packet.h"
 #include "stream/stream.h"
+#include "utils/byte_scan.h"
 
 #include "imap.h"
 
@@ -357,6 +358,14 @@ static StreamSplitter::Status imap_paf_server(ImapPafData* pfdata,
 
     for (i = 0; i < len; i++)
     {
+        // these states only look for the end of line
+        if (pfdata->imap_state == IMAP_PAF_REG_STATE || pfdata->imap_state == IMAP_PAF_FLUSH_STATE)
+        {
+            i = byte_scan::find(data + i, data + len, '\n') - data;
+            if (i == len)
+                break;
+        }
+
         uint8_t ch = data[i];
         switch (pfdata->imap_state)
         {
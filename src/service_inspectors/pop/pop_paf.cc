@@ -25,6 +25,7 @@
 #include "main/snort_debug.h"
 #include "protocols/packet.h"
 #include "stream/stream.h"
+#include "utils/byte_scan.h"
 
 #include "pop.h"
 
@@ -264,6 +265,14 @@ static StreamSplitter::Status pop_paf_server(PopPafData* pfdata,
 
     for (i = 0; i < len; i++)
     {
+        // a single line response ends at the next LF
+        if (pfdata->pop_state == POP_PAF_SINGLE_LINE_STATE)
+        {
+            i = byte_scan::find(data + i, data + len, '\n') - data;
+            if (i == len)
+                break;
+        }
+
         uint8_t ch = data[i];
 
         // find the termination sequence based upon the current state
@@ -322,6 +331,14 @@ static StreamSplitter::Status pop_paf_client(Flow* ssn, PopPafData* pfdata,
 
     for (i = 0; i < len; i++)
     {
+        // once the command is known only the end of line matters
+        if (pfdata->cmd_state.status == POP_CMD_FIN)
+        {
+            i = byte_scan::find(data + i, data + len, '\n') - data;
+            if (i == len)
+                break;
+        }
+
         uint8_t ch = data[i];
 
         switch (pfdata->cmd_state.status)
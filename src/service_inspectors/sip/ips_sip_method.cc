@@ -60,8 +60,7 @@ static inline bool IsRequest(SIP_Roptions* ropts)
 class SipMethodOption : public IpsOption
 {
 public:
-    SipMethodOption(const MethodMap& m) :
-        IpsOption(s_name), methods(m) {}
+    SipMethodOption(const MethodMap&);
 
     uint32_t hash() const override;
     bool operator==(const IpsOption&) const override;
@@ -69,8 +68,26 @@ public:
 
 private:
     MethodMap methods;
+    SipNameTable names;     // methods compiled for lookup by name
+    uint32_t standard = 0;  // flag bits of the standard methods
 };
 
+SipMethodOption::SipMethodOption(const MethodMap& m) :
+    IpsOption(s_name), methods(m)
+{
+    for ( auto& method : methods )
+    {
+        names.add(method.first.c_str(), method.first.size(), 1);
+
+        for ( unsigned i = 0; StandardMethods[i].name; ++i )
+        {
+            if ( !strcasecmp(StandardMethods[i].name, method.first.c_str()) )
+                standard |= 1 << (StandardMethods[i].methodFlag - 1);
+        }
+    }
+    names.compile();
+}
+
 uint32_t SipMethodOption::hash() const
 {
     uint32_t a,b,c;
@@ -119,13 +136,18 @@ IpsOption::EvalStatus SipMethodOption::eval(Cursor&, Packet* p)
         if ( !ropts->method_data )
             return NO_MATCH;
 
-        //FIXIT-P This should really be evaluated once per request instead of once
-        //per rule option evaluation.
-        std::string method(ropts->method_data, ropts->method_len);
-        std::transform(method.begin(), method.end(), method.begin(), ::toupper);
+        // The parser looked up the method in the configured methods, and a
+        // standard method has the same flag in every configuration, so that
+        // is just a bit test.  Anything else is looked up by name.
+        SIPMethodsFlag flag = ropts->method_flag;
+        bool match;
+
+        if ( (flag > SIP_METHOD_NULL) and (flag < SIP_METHOD_USER_DEFINE) )
+            match = (standard & (1 << (flag - 1))) != 0;
+        else
+            match = names.find(ropts->method_data, ropts->method_len) >= 0;
 
         bool negated = methods.begin()->second;
-        bool match = methods.find(method) != methods.cend(); 
 
         if ( negated ^ match )
             return MATCH;
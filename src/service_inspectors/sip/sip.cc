@@ -186,6 +186,7 @@ static inline int SIP_Process(Packet* p, SIPData* sessp, SIP_PROTO_CONF* config)
     pRopts = &(sessp->ropts);
     pRopts->method_data = sipMsg.method;
     pRopts->method_len = sipMsg.methodLen;
+    pRopts->method_flag = sipMsg.methodFlag;
     pRopts->header_data = sipMsg.header;
     pRopts->header_len = sipMsg.headerLen;
     pRopts->body_len = sipMsg.bodyLen;
@@ -349,6 +350,7 @@ static void mod_dtor(Module* m)
 static void sip_init()
 {
     SipFlowData::init();
+    sip_parser_init();
 }
 
 static Inspector* sip_ctor(Module* m)
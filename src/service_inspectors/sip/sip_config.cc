@@ -214,6 +214,14 @@ SIPMethodNode* SIP_AddUserDefinedMethod(
     return method;
 }
 
+void SIP_CompileMethods(SIP_PROTO_CONF* config)
+{
+    for (SIPMethodNode* method = config->methods; method; method = method->nextm)
+        config->method_names.add(method->methodName, method->methodLen, method->methodFlag);
+
+    config->method_names.compile();
+}
+
 void SIP_DeleteMethods(SIPMethodNode* node)
 {
     while (node)
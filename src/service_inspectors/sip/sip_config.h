@@ -27,6 +27,7 @@
 #include "framework/counts.h"
 #include "main/thread.h"
 #include "sip_common.h"
+#include "sip_name_table.h"
 
 #define SIP_METHOD_DEFAULT     0x003f
 #define SIP_METHOD_ALL     0xffffffff
@@ -95,6 +96,7 @@ struct SIP_PROTO_CONF
     uint32_t maxNumDialogsInSession;
     uint32_t methodsConfig;
     SIPMethodlist methods;   // Which methods to check
+    SipNameTable method_names;  // methods compiled for lookup, name => flag
     uint16_t maxUriLen;      // Maximum request_URI size
     uint16_t maxCallIdLen;   // Maximum call_ID size.
     uint16_t maxRequestNameLen;  // Maximum length of request name in the CSeqID.
@@ -120,5 +122,8 @@ SIPMethodNode* SIP_AddUserDefinedMethod(
 // API to delete a method from SIP config
 void SIP_DeleteMethods(SIPMethodNode*);
 
+// Builds the method lookup table once the method list is complete
+void SIP_CompileMethods(SIP_PROTO_CONF*);
+
 #endif
 
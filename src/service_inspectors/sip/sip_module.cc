@@ -269,6 +269,7 @@ bool SipModule::end(const char*, int, SnortConfig*)
     {
         SIP_SetDefaultMethods(conf);
     }
+    SIP_CompileMethods(conf);
 
     return true;
 }
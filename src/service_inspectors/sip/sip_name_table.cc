@@ -0,0 +1,262 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// sip_name_table.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "sip_name_table.h"
+
+#include <cstring>
+
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
+// seeds tried per table size before doubling it
+#define SIP_NAME_SEEDS     64
+#define SIP_NAME_MAX_SLOTS 4096
+
+// ascii only, like strncasecmp in the C locale
+static inline uint8_t lower(uint8_t c)
+{ return c + ((uint8_t)(c - 'A') < 26 ? 'a' - 'A' : 0); }
+
+// names are stored folded so only the input needs folding
+static inline bool same(const std::string& name, const char* s, unsigned len)
+{
+    if ( name.size() != len )
+        return false;
+
+    for ( unsigned i = 0; i < len; ++i )
+    {
+        if ( name[i] != (char)lower(s[i]) )
+            return false;
+    }
+    return true;
+}
+
+// the quick hash only looks at the length and the first, middle and last
+// characters, which is enough to tell apart header names and methods.  sets
+// of names that can't be separated that way hash every character.
+uint32_t SipNameTable::hash(uint32_t seed, const char* s, unsigned len) const
+{
+    uint32_t h = seed ^ len;
+
+    if ( quick )
+    {
+        h = (h ^ lower(s[0])) * 0x01000193;
+        h = (h ^ lower(s[len >> 1])) * 0x01000193;
+        h = (h ^ lower(s[len - 1])) * 0x01000193;
+    }
+    else
+    {
+        for ( unsigned i = 0; i < len; ++i )
+            h = (h ^ lower(s[i])) * 0x01000193;
+    }
+    return h ^ (h >> 15);
+}
+
+void SipNameTable::add(const char* name, unsigned len, int id)
+{
+    if ( !len or walk(name, len) >= 0 )
+        return;
+
+    std::string s(name, len);
+
+    for ( auto& c : s )
+        c = lower(c);
+
+    names.push_back({ s, id });
+
+    if ( len > max_len )
+        max_len = len;
+
+    // anything added after compile() is only found by walking
+    slots.clear();
+}
+
+void SipNameTable::add(const char* name, int id)
+{ add(name, strlen(name), id); }
+
+bool SipNameTable::try_seed(uint32_t s, unsigned size)
+{
+    slots.assign(size, -1);
+
+    for ( unsigned i = 0; i < names.size(); ++i )
+    {
+        const std::string& n = names[i].name;
+        int16_t& slot = slots[hash(s, n.c_str(), n.size()) & (size - 1)];
+
+        if ( slot >= 0 )
+            return false;
+
+        slot = i;
+    }
+    seed = s;
+    mask = size - 1;
+    return true;
+}
+
+void SipNameTable::compile()
+{
+    if ( names.empty() )
+        return;
+
+    unsigned min_size = 8;
+
+    while ( min_size < 2 * names.size() )
+        min_size *= 2;
+
+    for ( bool q : { true, false } )
+    {
+        quick = q;
+
+        for ( unsigned size = min_size; size <= SIP_NAME_MAX_SLOTS; size *= 2 )
+        {
+            for ( uint32_t s = 1; s <= SIP_NAME_SEEDS; ++s )
+            {
+                if ( try_seed(s * 0x9e3779b9, size) )
+                    return;
+            }
+        }
+    }
+    slots.clear();
+}
+
+int SipNameTable::walk(const char* name, unsigned len) const
+{
+    for ( const auto& n : names )
+    {
+        if ( same(n.name, name, len) )
+            return n.id;
+    }
+    return -1;
+}
+
+int SipNameTable::find(const char* name, unsigned len) const
+{
+    if ( !len or len > max_len )
+        return -1;
+
+    if ( slots.empty() )
+        return walk(name, len);
+
+    int16_t slot = slots[hash(seed, name, len) & mask];
+
+    if ( slot < 0 )
+        return -1;
+
+    if ( !same(names[slot].name, name, len) )
+        return -1;
+
+    return names[slot].id;
+}
+
+//--------------------------------------------------------------------------
+// unit tests
+//--------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+static const char* const methods[] =
+{
+    "invite", "cancel", "ack", "bye", "register", "options", "refer",
+    "subscribe", "update", "join", "info", "message", "notify", "prack"
+};
+
+TEST_CASE("sip name table", "[sip]")
+{
+    SipNameTable t;
+
+    CHECK(t.find("ack", 3) == -1);
+
+    for ( unsigned i = 0; i < sizeof(methods) / sizeof(methods[0]); ++i )
+        t.add(methods[i], i + 1);
+
+    // duplicates keep the first id
+    t.add("INVITE", 99);
+
+    SECTION("walk")
+    {
+        CHECK(t.find("InViTe", 6) == 1);
+        CHECK(t.find("prack", 5) == 14);
+        CHECK(t.find("pracks", 6) == -1);
+        CHECK(t.find("invite", 5) == -1);
+    }
+    SECTION("compiled")
+    {
+        t.compile();
+
+        for ( unsigned i = 0; i < sizeof(methods) / sizeof(methods[0]); ++i )
+        {
+            std::string upper = methods[i];
+
+            for ( auto& c : upper )
+                c -= 'a' - 'A';
+
+            CHECK(t.find(methods[i], strlen(methods[i])) == (int)i + 1);
+            CHECK(t.find(upper.c_str(), upper.size()) == (int)i + 1);
+        }
+        CHECK(t.find("inviter", 7) == -1);
+        CHECK(t.find("invitE ", 6) == 1);
+        CHECK(t.find("bey", 3) == -1);
+        CHECK(t.find("", 0) == -1);
+
+        // only letters fold
+        t.add("a^b", 20);
+        t.compile();
+        CHECK(t.find("A^B", 3) == 20);
+        CHECK(t.find("a~b", 3) == -1);
+    }
+}
+
+TEST_CASE("sip name table benchmarks", "[sip][!benchmark]")
+{
+    SipNameTable t;
+
+    for ( unsigned i = 0; i < sizeof(methods) / sizeof(methods[0]); ++i )
+        t.add(methods[i], i + 1);
+
+    const char* lines[] = { "REGISTER", "NOTIFY", "PRACK", "OPTIONS", "PUBLISH" };
+    // lookups are kept by storing their results through a volatile
+    volatile int sink = 0;
+
+    BENCHMARK("walk")
+    {
+        for ( int i = 0; i < 1000000; ++i )
+        {
+            const char* s = lines[i % 5];
+            sink += t.find(s, strlen(s));
+        }
+    }
+    t.compile();
+
+    BENCHMARK("compiled")
+    {
+        for ( int i = 0; i < 1000000; ++i )
+        {
+            const char* s = lines[i % 5];
+            sink += t.find(s, strlen(s));
+        }
+    }
+}
+
+#endif
+
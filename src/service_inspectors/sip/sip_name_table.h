@@ -0,0 +1,69 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// sip_name_table.h
+
+#ifndef SIP_NAME_TABLE_H
+#define SIP_NAME_TABLE_H
+
+// SipNameTable maps a small, fixed set of case insensitive names such as
+// header names or methods to ids.  Once all names are added, compile()
+// searches for a hash seed and table size without collisions so a lookup
+// is one hash of the name and one compare.  If no perfect hash is found
+// lookups fall back to a walk of the names.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class SipNameTable
+{
+public:
+    // names that are already present (ignoring case) are skipped
+    void add(const char* name, unsigned len, int id);
+    void add(const char* name, int id);
+
+    void compile();
+
+    // returns the id or -1 if not found
+    int find(const char* name, unsigned len) const;
+
+    bool empty() const
+    { return names.empty(); }
+
+private:
+    struct Name
+    {
+        std::string name;
+        int id;
+    };
+
+    uint32_t hash(uint32_t seed, const char*, unsigned len) const;
+    bool try_seed(uint32_t seed, unsigned size);
+    int walk(const char*, unsigned len) const;
+
+    std::vector<Name> names;
+    std::vector<int16_t> slots;  // index into names or -1
+    uint32_t seed = 0;
+    uint32_t mask = 0;
+    unsigned max_len = 0;
+    bool quick = true;
+};
+
+#endif
+
@@ -25,6 +25,8 @@
 
 #include "sip_parser.h"
 
+#include <cassert>
+
 #include "detection/detection_engine.h"
 #include "events/event_queue.h"
 #include "main/snort_debug.h"
@@ -122,6 +124,35 @@ SIPbodyField bodyFields[] =
     { nullptr, 0, nullptr }
 };
 
+/*
+ * header names (full and short form) and body field names compiled for
+ * lookup, name => index in headerFields or bodyFields
+ */
+
+#define SIP_BODY_FIELD_LEN 2
+
+static SipNameTable headerNames;
+static SipNameTable bodyNames;
+
+void sip_parser_init()
+{
+    for (int findex = 0; nullptr != headerFields[findex].fname; findex++)
+    {
+        headerNames.add(headerFields[findex].fname, headerFields[findex].fnameLen, findex);
+
+        if (nullptr != headerFields[findex].shortName)
+            headerNames.add(headerFields[findex].shortName, findex);
+    }
+    headerNames.compile();
+
+    for (int findex = 0; nullptr != bodyFields[findex].fname; findex++)
+    {
+        assert(bodyFields[findex].fnameLen == SIP_BODY_FIELD_LEN);
+        bodyNames.add(bodyFields[findex].fname, bodyFields[findex].fnameLen, findex);
+    }
+    bodyNames.compile();
+}
+
 /********************************************************************
  * Function: sip_process_headField()
  *
@@ -140,7 +171,7 @@ SIPbodyField bodyFields[] =
 static int sip_process_headField(SIPMsg* msg, const char* start, const char* end,
     int* lastFieldIndex, SIP_PROTO_CONF* config)
 {
-    int findex =0;
+    int findex;
     int length = end -start;
     char* colonIndex;
     const char* newStart, * newEnd;
@@ -168,25 +199,9 @@ static int sip_process_headField(SIPMsg* msg, const char* start, const char* end
     newLength =  newEnd - newStart;
 
     /*Find out whether the field name needs to process*/
-    while (nullptr != headerFields[findex].fname)
-    {
-        //Use the full name to check
-        if ((headerFields[findex].fnameLen == newLength)&&
-            (0 == strncasecmp(headerFields[findex].fname, newStart, newLength)))
-        {
-            break;
-        }
-        //Use short name to check
-        else if ((nullptr != headerFields[findex].shortName) &&
-            ( 1 == newLength)&&
-            (0 == strncasecmp(headerFields[findex].shortName, newStart, newLength)))
-        {
-            break;
-        }
-        findex++;
-    }
+    findex = headerNames.find(newStart, newLength);
 
-    if (nullptr != headerFields[findex].fname)
+    if (findex >= 0)
     {
         // Found the field name, evaluate the value
         SIP_TrimSP(colonIndex + 1, end, &newStart, &newEnd);
@@ -213,19 +228,14 @@ static int sip_process_headField(SIPMsg* msg, const char* start, const char* end
  ********************************************************************/
 static int sip_process_bodyField(SIPMsg* msg, const char* start, const char* end)
 {
-    int findex =0;
-    if (start == end)
+    int findex;
+    if (end - start < SIP_BODY_FIELD_LEN)
         return SIP_PARSE_SUCCESS;
     /*Find out whether the field name needs to process*/
-    while (nullptr != bodyFields[findex].fname)
+    findex = bodyNames.find(start, SIP_BODY_FIELD_LEN);
+    if (findex >= 0)
     {
-        int length = bodyFields[findex].fnameLen;
-        if (0 == strncasecmp(bodyFields[findex].fname, start,length))
-        {
-            return (bodyFields[findex].setfield(msg,start + length, end));
-        }
-
-        findex++;
+        return (bodyFields[findex].setfield(msg, start + SIP_BODY_FIELD_LEN, end));
     }
     return SIP_PARSE_SUCCESS;
 }
@@ -378,7 +388,6 @@ static bool sip_startline_parse(SIPMsg* msg, const char* buff, const char* end,
     {
         char* space;
         char* version;
-        SIPMethodNode* method;
 
         /*Process request*/
         msg->status_code = 0;
@@ -391,13 +400,8 @@ static bool sip_startline_parse(SIPMsg* msg, const char* buff, const char* end,
         msg->methodLen = space - buff;
         DebugFormat(DEBUG_SIP, "method: %.*s\n", msg->methodLen, msg->method);
 
-        method = SIP_FindMethod (config->methods, msg->method, msg->methodLen);
-        if (method)
-        {
-            msg->methodFlag = method->methodFlag;
-            DebugFormat(DEBUG_SIP, "Found the method: %s, Flag: 0x%x\n",
-                method->methodName, method->methodFlag);
-        }
+        msg->methodFlag = SIP_FindMethodFlag(config, msg->method, msg->methodLen);
+        DebugFormat(DEBUG_SIP, "Method flag: 0x%x\n", msg->methodFlag);
 
         // parse the uri
         if (space + 1 > end)
@@ -425,7 +429,7 @@ static bool sip_startline_parse(SIPMsg* msg, const char* buff, const char* end,
             DetectionEngine::queue_event(GID_SIP, SIP_EVENT_INVALID_VERSION);
         }
 
-        if (nullptr == method)
+        if (SIP_METHOD_NULL == msg->methodFlag)
         {
             DetectionEngine::queue_event(GID_SIP, SIP_EVENT_UNKOWN_METHOD);
             return false;
@@ -907,7 +911,7 @@ static int sip_parse_cseq(SIPMsg* msg, const char* start, const char* end, SIP_P
 {
     char* next = nullptr;
     DEBUG_WRAP(int length = end -start; )
-    SIPMethodNode* method = nullptr;
+    SIPMethodsFlag methodFlag = SIP_METHOD_NULL;
 
     DebugFormat(DEBUG_SIP, "CSeq value: %.*s\n", length, start);
     msg->cseqnum = SnortStrtoul(start, &next, 10);
@@ -915,12 +919,12 @@ static int sip_parse_cseq(SIPMsg* msg, const char* start, const char* end, SIP_P
     {
         msg->cseqName = next + 1;
         msg->cseqNameLen = end - msg->cseqName;
-        method = SIP_FindMethod (config->methods, msg->cseqName, msg->cseqNameLen);
+        methodFlag = SIP_FindMethodFlag(config, msg->cseqName, msg->cseqNameLen);
     }
     DebugFormat(DEBUG_SIP, "CSeq number: %" PRIu64 ", CSeqName: %.*s\n",
         msg->cseqnum, msg->cseqNameLen, msg->cseqName);
 
-    if (nullptr == method)
+    if (SIP_METHOD_NULL == methodFlag)
     {
         DetectionEngine::queue_event(GID_SIP, SIP_EVENT_INVALID_CSEQ_NAME);
         return SIP_PARSE_ERROR;
@@ -929,13 +933,13 @@ static int sip_parse_cseq(SIPMsg* msg, const char* start, const char* end, SIP_P
     {
         /*Use request name only for response message*/
         if ((SIP_METHOD_NULL == msg->methodFlag)&&( msg->status_code > 0))
-            msg->methodFlag = method->methodFlag;
-        else if ( method->methodFlag != msg->methodFlag)
+            msg->methodFlag = methodFlag;
+        else if ( methodFlag != msg->methodFlag)
         {
             DetectionEngine::queue_event(GID_SIP, SIP_EVENT_MISMATCH_METHOD);
         }
-        DebugFormat(DEBUG_SIP, "Found the method: %s, Flag: 0x%x\n",
-            method->methodName, method->methodFlag);
+        DebugFormat(DEBUG_SIP, "Found the method: %.*s, Flag: 0x%x\n",
+            msg->cseqNameLen, msg->cseqName, methodFlag);
     }
 
     return SIP_PARSE_SUCCESS;
@@ -90,6 +90,7 @@ struct SIPMsg
 #define MAX_STAT_CODE      999
 #define MIN_STAT_CODE      100
 
+void sip_parser_init();
 bool sip_parse(SIPMsg*, const char*, const char*, SIP_PROTO_CONF*);
 void sip_freeMsg(SIPMsg* msg);
 void sip_freeMediaSession(SIP_MediaSession*);
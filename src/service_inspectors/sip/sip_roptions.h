@@ -32,6 +32,7 @@ struct SIP_Roptions
 {
     const char* method_data;
     uint16_t method_len;
+    SIPMethodsFlag method_flag; // configured method found at parse time
 
     uint16_t status_code;       // sip_stat_code data
 
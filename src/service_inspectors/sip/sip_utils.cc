@@ -103,6 +103,33 @@ SIPMethodNode* SIP_FindMethod(SIPMethodlist methods, const char* methodName, uns
     return method;
 }
 
+/********************************************************************
+ * Function: SIP_FindMethodFlag()
+ *
+ * Find method in the configured methods by name using the compiled
+ * method table
+ *
+ * Arguments:
+ *  SIP_PROTO_CONF* - configuration with compiled methods,
+ *  char *          - method name,
+ *  int             - length of the method name
+ *
+ * Returns:
+ *  SIPMethodsFlag  - flag of the method, or SIP_METHOD_NULL if not found
+ *
+ ********************************************************************/
+
+SIPMethodsFlag SIP_FindMethodFlag(const SIP_PROTO_CONF* config, const char* methodName,
+    unsigned int length)
+{
+    int flag = config->method_names.find(methodName, length);
+
+    if (flag < 0)
+        return SIP_METHOD_NULL;
+
+    return (SIPMethodsFlag)flag;
+}
+
 /********************************************************************
  * Function: strToHash()
  *
@@ -28,6 +28,7 @@
 
 int SIP_TrimSP(const char*, const char*, const char**, const char**);
 SIPMethodNode* SIP_FindMethod(SIPMethodlist, const char* method, unsigned int);
+SIPMethodsFlag SIP_FindMethodFlag(const SIP_PROTO_CONF*, const char* method, unsigned int);
 uint32_t strToHash(const char*, int);
 
 #endif
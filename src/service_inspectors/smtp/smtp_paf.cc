@@ -27,6 +27,7 @@
 #include "main/snort_debug.h"
 #include "protocols/packet.h"
 #include "stream/stream.h"
+#include "utils/byte_scan.h"
 
 #include "smtp_module.h"
 
@@ -292,6 +293,16 @@ static inline StreamSplitter::Status smtp_paf_client(SmtpPafData* pfdata,
     DebugFormat(DEBUG_SMTP, "From client: %s \n", data);
     for (i = 0; i < len; i++)
     {
+        // an unknown command or the rest of a data command ends at the next LF
+        if ( pfdata->smtp_state == SMTP_PAF_CMD_STATE &&
+            (pfdata->cmd_info.cmd_state == SMTP_PAF_CMD_UNKNOWN ||
+            pfdata->cmd_info.cmd_state == SMTP_PAF_CMD_DATA_END_STATE) )
+        {
+            i = byte_scan::find(data + i, data + len, '\n') - data;
+            if (i == len)
+                break;
+        }
+
         uint8_t ch = data[i];
         switch (pfdata->smtp_state)
         {
@@ -85,7 +85,7 @@ void HexBook::add_spell(
         if ( c == WILD )
             p->any = t;
         else
-            p->next[c] = t;
+            p->set_next(c, t);
 
         p = t;
         ++i;
@@ -111,8 +111,8 @@ bool HexBook::add_spell(const char* key, const char* val)
         if ( c == WILD && p->any )
             p = p->any;
 
-        else if ( p->next[c] )
-            p = p->next[c];
+        else if ( c != WILD && p->get_next(c) )
+            p = p->get_next(c);
 
         else
             break;
@@ -133,16 +133,16 @@ const MagicPage* HexBook::find_spell(
     {
         int c = s[i];
 
-        if ( p->next[c] )
+        if ( const MagicPage* t = p->get_next(c) )
         {
             if ( p->any )
             {
-                if ( const MagicPage* q = find_spell(s, n, p->next[c], i+1) )
+                if ( const MagicPage* q = find_spell(s, n, t, i+1) )
                     return q;
             }
             else
             {
-                p = p->next[c];
+                p = t;
                 ++i;
                 continue;
             }
@@ -23,23 +23,32 @@
 
 #include "magic.h"
 
-MagicPage::MagicPage(const MagicBook& b) : book(b)
+MagicPage::MagicPage(const MagicBook& b) : book(b), next(1, nullptr)
 {
-    for ( int i = 0; i < 256; ++i )
-        next[i] = nullptr;
     any = nullptr;
 }
 
 MagicPage::~MagicPage()
 {
-    for ( int i = 0; i < 256; ++i )
+    for ( auto p : next )
     {
-        if ( next[i] && next[i] != this )
-            delete next[i];
+        if ( p && p != this )
+            delete p;
     }
     delete any;
 }
 
+void MagicPage::set_next(uint8_t c, MagicPage* p)
+{
+    unsigned n = index.size();
+    unsigned slot = index.add(c);
+
+    if ( index.size() > n )
+        next.insert(next.begin() + slot, p);
+    else
+        next[slot] = p;
+}
+
 MagicBook::MagicBook()
 { root = new MagicPage(*this); }
 
@@ -23,6 +23,8 @@
 #include <string>
 #include <vector>
 
+#include "utils/byte_index.h"
+
 class MagicBook;
 
 struct MagicPage
@@ -30,13 +32,22 @@ struct MagicPage
     std::string key;
     std::string value;
 
-    MagicPage* next[256];
     MagicPage* any;
 
     const MagicBook& book;
 
     MagicPage(const MagicBook&);
     ~MagicPage();
+
+    MagicPage* get_next(uint8_t c) const
+    { return next[index.find(c)]; }
+
+    void set_next(uint8_t c, MagicPage*);
+
+private:
+    // branches are kept only for the bytes present; next[0] is always null
+    ByteIndex index;
+    std::vector<MagicPage*> next;
 };
 
 typedef std::vector<uint16_t> HexVector;
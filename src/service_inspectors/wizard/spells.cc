@@ -32,10 +32,10 @@ using namespace std;
 SpellBook::SpellBook()
 {
     // allows skipping leading whitespace only
-    root->next[(int)' '] = root;
-    root->next[(int)'\t'] = root;
-    root->next[(int)'\r'] = root;
-    root->next[(int)'\n'] = root;
+    root->set_next(' ', root);
+    root->set_next('\t', root);
+    root->set_next('\r', root);
+    root->set_next('\n', root);
 }
 
 bool SpellBook::translate(const char* in, HexVector& out)
@@ -75,7 +75,7 @@ void SpellBook::add_spell(
         if ( hv[i] == WILD )
             p->any = t;
         else
-            p->next[toupper(hv[i])] = t;
+            p->set_next(toupper(hv[i]), t);
 
         p = t;
         ++i;
@@ -101,8 +101,8 @@ bool SpellBook::add_spell(const char* key, const char* val)
         if ( c == WILD && p->any )
             p = p->any;
 
-        else if ( p->next[c] )
-            p = p->next[c];
+        else if ( c != WILD && p->get_next(c) )
+            p = p->get_next(c);
 
         else
             break;
@@ -123,16 +123,16 @@ const MagicPage* SpellBook::find_spell(
     {
         int c = toupper(s[i]);
 
-        if ( p->next[c] )
+        if ( const MagicPage* t = p->get_next(c) )
         {
             if ( p->any )
             {
-                if ( const MagicPage* q = find_spell(s, n, p->next[c], i+1) )
+                if ( const MagicPage* q = find_spell(s, n, t, i+1) )
                     return q;
             }
             else
             {
-                p = p->next[c];
+                p = t;
                 ++i;
                 continue;
             }
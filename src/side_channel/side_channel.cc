@@ -301,6 +301,15 @@ bool SideChannel::transmit_message(SCMessage* msg)
         msg->hdr->time_u_seconds = (uint32_t)tm.tv_usec;
         msg->hdr->sequence = sequence++;
 
+        // the sender may have used less than it allocated
+        ConnectorMsg* connector_msg = connector_transmit->get_connector_msg(msg->handle);
+
+        if ( connector_msg )
+        {
+            assert(msg->content_length + sizeof(SCMsgHdr) <= connector_msg->length);
+            connector_msg->length = msg->content_length + sizeof(SCMsgHdr);
+        }
+
         return_value = connector_transmit->transmit_message(msg->handle);
         delete msg;
     }
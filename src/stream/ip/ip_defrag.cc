@@ -75,6 +75,7 @@
 #include "log/messages.h"
 #include "main/snort.h"
 #include "main/snort_config.h"
+#include "memory/memory_domain.h"
 #include "packet_io/active.h"
 #include "packet_io/sfdaq.h"
 #include "profiler/profiler_defs.h"
@@ -96,6 +97,7 @@
 #define FRAG_BAD            0x00000008
 #define FRAG_NO_BSD_VULN    0x00000010
 #define FRAG_DROP_FRAGMENTS 0x00000020
+#define FRAG_OUT_OF_ORDER   0x00000040
 
 /* return values for insert() */
 #define FRAG_INSERT_OK          0
@@ -128,6 +130,23 @@ struct Fragment
 
     int ord;
     char last;
+    char pooled;         /* fptr is part of a pool block */
+};
+
+/* fragments that fit an ethernet mtu are allocated as one block holding the
+ * Fragment followed by its data.  released blocks are kept on a per thread
+ * free list, bounded by pool_memcap, so a fragment flood doesn't turn into
+ * a malloc / free per packet.  larger fragments come from the heap.
+ */
+#define FRAG_POOL_DATA  1536
+#define FRAG_POOL_BLOCK (sizeof(Fragment) + FRAG_POOL_DATA)
+#define FRAG_POOL_PRUNE 32
+
+struct FragPool
+{
+    Fragment* free_list;
+    unsigned free_count;
+    unsigned max_free;
 };
 
 /*  G L O B A L S  **************************************************/
@@ -147,6 +166,7 @@ static const char* const frag_policy_names[] =
 
 // FIXIT-M convert to session memcap
 static THREAD_LOCAL unsigned long mem_in_use = 0; /* memory in use, used for self pres */
+static THREAD_LOCAL FragPool frag_pool;
 
 THREAD_LOCAL ProfileStats fragPerfStats;
 THREAD_LOCAL ProfileStats fragInsertPerfStats;
@@ -166,6 +186,7 @@ static void FragPrintEngineConfig(FragEngine* engine)
         engine->max_overlaps);
     LogMessage("    Min fragment Length:     %d\n",
         engine->min_fragment_length);
+    LogMessage("    Pool memcap:     %u\n", engine->pool_memcap);
 #ifdef REG_TEST
     LogMessage("    FragTracker Size: %zu\n", sizeof(FragTracker));
 #endif
@@ -402,7 +423,7 @@ static int FragHandleIPOptions(
          */
         if (ip_options_len)
         {
-            if (ft->ip_options_data)
+            if (ft->ip_options_len)
             {
                 /* Already seen 0 offset packet and copied some IP options */
                 if ((ft->frag_flags & FRAG_GOT_FIRST)
@@ -413,8 +434,8 @@ static int FragHandleIPOptions(
             }
             else
             {
-                /* Allocate and copy in the options */
-                ft->ip_options_data = (uint8_t*)snort_calloc(ip_options_len);
+                /* Copy in the options */
+                assert(ip_options_len <= sizeof(ft->ip_options_data));
                 memcpy(ft->ip_options_data, p->ptrs.ip_api.get_ip_opt_data(), ip_options_len);
                 ft->ip_options_len = ip_options_len;
             }
@@ -587,7 +608,7 @@ static void FragRebuild(FragTracker* ft, Packet* p)
          * if there are IP options, copy those in as well
          * these are for the inner IP...
          */
-        if (ft->ip_options_data && ft->ip_options_len)
+        if (ft->ip_options_len)
         {
             /* Adjust the IP header size in pseudo packet for the new length */
             uint8_t new_ip_hlen = ip::IP4_HEADER_LEN + ft->ip_options_len;
@@ -763,16 +784,70 @@ static inline void add_node(FragTracker* ft, Fragment* prev, Fragment* node)
     ft->fraglist_count++;
 }
 
+static Fragment* alloc_frag(uint16_t len)
+{
+    Fragment* frag;
+
+    if (len <= FRAG_POOL_DATA)
+    {
+        if (frag_pool.free_list)
+        {
+            frag = frag_pool.free_list;
+            frag_pool.free_list = frag->next;
+            frag_pool.free_count--;
+            ip_stats.pool_hits++;
+        }
+        else
+        {
+            frag = (Fragment*)snort_alloc(FRAG_POOL_BLOCK);
+            ip_stats.pool_misses++;
+        }
+        memset(frag, 0, sizeof(*frag));
+        frag->fptr = (uint8_t*)(frag + 1);
+        frag->pooled = 1;
+        mem_in_use += FRAG_POOL_BLOCK;
+    }
+    else
+    {
+        frag = (Fragment*)snort_calloc(sizeof(Fragment));
+        frag->fptr = (uint8_t*)snort_calloc(len);
+        mem_in_use += sizeof(Fragment) + len;
+        ip_stats.pool_misses++;
+    }
+
+    frag->flen = len;
+    ip_stats.mem_in_use = mem_in_use;
+    ip_stats.nodes_created++;
+
+    return frag;
+}
+
 static void delete_frag(Fragment* frag)
 {
     /*
-     * delete the fragment either in prealloc or dynamic mode
+     * return pool blocks to the free list while under the memcap
      */
-    snort_free(frag->fptr);
-    mem_in_use -= frag->flen;
+    if (frag->pooled)
+    {
+        mem_in_use -= FRAG_POOL_BLOCK;
 
-    snort_free(frag);
-    mem_in_use -= sizeof(Fragment);
+        if (frag_pool.free_count < frag_pool.max_free)
+        {
+            frag->next = frag_pool.free_list;
+            frag_pool.free_list = frag;
+            frag_pool.free_count++;
+        }
+        else
+            snort_free(frag);
+    }
+    else
+    {
+        snort_free(frag->fptr);
+        mem_in_use -= frag->flen;
+
+        snort_free(frag);
+        mem_in_use -= sizeof(Fragment);
+    }
 
     ip_stats.mem_in_use = mem_in_use;
     ip_stats.nodes_released++;
@@ -826,11 +901,7 @@ static void delete_tracker(FragTracker* ft)
         delete_frag(dump_me);
     }
     ft->fraglist = nullptr;
-    if (ft->ip_options_data)
-    {
-        snort_free(ft->ip_options_data);
-        ft->ip_options_data = nullptr;
-    }
+    ft->ip_options_len = 0;
 
     ip_stats.trackers_cleared++;
 }
@@ -847,8 +918,40 @@ static void release_tracker(FragTracker* ft)
 // Defrag methods
 //-------------------------------------------------------------------------
 
+/* the pool is shared by every stream_ip instance on the thread so it takes
+ * the largest of their limits.  the limit only grows here; a reload doesn't
+ * run tinit() on the packet threads, so process() can raise it but a smaller
+ * pool_memcap takes effect when the threads restart.
+ */
+static inline void raise_pool_limit(unsigned max_free)
+{
+    if (frag_pool.max_free < max_free)
+        frag_pool.max_free = max_free;
+}
+
+/* free blocks are the first thing to go when the memory cap is reached */
+static bool prune_frag_pool()
+{
+    unsigned freed = 0;
+
+    while (frag_pool.free_list and freed < FRAG_POOL_PRUNE)
+    {
+        Fragment* frag = frag_pool.free_list;
+        frag_pool.free_list = frag->next;
+        snort_free(frag);
+        freed++;
+    }
+    frag_pool.free_count -= freed;
+    return freed > 0;
+}
+
 Defrag::Defrag(FragEngine& e) : engine(e), layers(DEFAULT_LAYERMAX) { }
 
+void Defrag::init()
+{
+    memory::add_pruner(memory::Domain::REASSEMBLY, prune_frag_pool);
+}
+
 bool Defrag::configure(SnortConfig* sc)
 {
     // FIXIT-L kinda squiffy ... set for each instance (but to same value) ... move to tinit() ?
@@ -861,6 +964,23 @@ void Defrag::show(SnortConfig*)
     FragPrintEngineConfig(&engine);
 }
 
+void Defrag::tinit()
+{
+    raise_pool_limit(engine.pool_memcap / FRAG_POOL_BLOCK);
+}
+
+void Defrag::tterm()
+{
+    while (frag_pool.free_list)
+    {
+        Fragment* frag = frag_pool.free_list;
+        frag_pool.free_list = frag->next;
+        snort_free(frag);
+    }
+    frag_pool.free_count = 0;
+    frag_pool.max_free = 0;
+}
+
 void Defrag::cleanup(FragTracker* ft)
 {
     if ( !ft->engine )
@@ -878,6 +998,8 @@ void Defrag::process(Packet* p, FragTracker* ft)
     assert(p->has_ip() && !(p->ptrs.decode_flags & DECODE_ERR_CKSUM_IP));
     assert(p->is_fragment());
 
+    raise_pool_limit(engine.pool_memcap / FRAG_POOL_BLOCK);
+
     const uint16_t frag_offset = p->ptrs.ip_api.off();
 
     /*
@@ -932,6 +1054,7 @@ void Defrag::process(Packet* p, FragTracker* ft)
     ip_stats.fragmented_bytes += p->pkth->caplen + 4; /* 4 for the CRC */
 
     Profile profile(fragPerfStats);
+    memory::DomainContext domain(memory::Domain::REASSEMBLY);
 
     if (!ft->engine )
     {
@@ -1034,7 +1157,12 @@ void Defrag::process(Packet* p, FragTracker* ft)
          * instead of wasting time on putting it back together
          */
         if (!(ft->frag_flags & FRAG_BAD))
+        {
+            if (!(ft->frag_flags & FRAG_OUT_OF_ORDER))
+                ip_stats.in_order_reassembles++;
+
             FragRebuild(ft, p);
+        }
 
         if (Active::packet_was_dropped())
         {
@@ -1223,9 +1351,28 @@ int Defrag::insert(Packet* p, FragTracker* ft, FragEngine* fe)
 
     /*
      * Need to figure out where in the frag list this frag should go
-     * and who its neighbors are
+     * and who its neighbors are.  The list is sorted by offset so when
+     * this frag starts beyond the tail it goes at the end and the walk
+     * can be skipped; that is the usual case of in order fragments.
      */
-    for (idx = ft->fraglist; idx; idx = idx->next)
+    if (ft->fraglist_tail && ft->fraglist_tail->offset < frag_offset)
+    {
+        left = ft->fraglist_tail;
+
+        if (left->offset + left->size <= frag_offset)
+            ip_stats.in_order_inserts++;
+        else
+            ft->frag_flags |= FRAG_OUT_OF_ORDER;
+
+        idx = nullptr;
+    }
+    else
+    {
+        ft->frag_flags |= FRAG_OUT_OF_ORDER;
+        idx = ft->fraglist;
+    }
+
+    for (; idx; idx = idx->next)
     {
         i++;
         right = idx;
@@ -1836,7 +1983,6 @@ int Defrag::new_tracker(Packet* p, FragTracker* ft)
     ft->frag_time.tv_usec = p->pkth->ts.tv_usec;
     ft->alert_count = 0;
     ft->ip_options_len = 0;
-    ft->ip_options_data = nullptr;
     ft->copied_ip_options_len = 0;
     ft->ordinal = 0;
     ft->frag_policy = p->flow->ssn_policy ? p->flow->ssn_policy : engine.frag_policy;
@@ -1845,17 +1991,7 @@ int Defrag::new_tracker(Packet* p, FragTracker* ft)
     /*
      * get our first fragment storage struct
      */
-    {
-        f = (Fragment*)snort_calloc(sizeof(Fragment));
-        mem_in_use += sizeof(Fragment);
-
-        f->fptr = (uint8_t*)snort_calloc(fragLength);
-        mem_in_use += fragLength;
-
-        ip_stats.mem_in_use = mem_in_use;
-    }
-
-    ip_stats.nodes_created++;
+    f = alloc_frag(fragLength);
 
     /* initialize the fragment list */
     ft->fraglist = nullptr;
@@ -1865,7 +2001,7 @@ int Defrag::new_tracker(Packet* p, FragTracker* ft)
      */
     memcpy(f->fptr, fragStart, fragLength);
 
-    f->size = f->flen = fragLength;
+    f->size = fragLength;
     f->offset = frag_off;
     frag_end = f->offset + fragLength;
     f->ord = ft->ordinal++;
@@ -1985,25 +2121,7 @@ int Defrag::add_frag_node(
     /*
      * grab/generate a new frag node
      */
-    {
-        /*
-         * build a frag struct to track this particular fragment
-         */
-        newfrag = (Fragment*)snort_calloc(sizeof(Fragment));
-        mem_in_use += sizeof(Fragment);
-
-        /*
-         * allocate some space to hold the actual data
-         */
-        newfrag->fptr = (uint8_t*)snort_calloc(fragLength);
-        mem_in_use += fragLength;
-
-        ip_stats.mem_in_use = mem_in_use;
-    }
-
-    ip_stats.nodes_created++;
-
-    newfrag->flen = fragLength;
+    newfrag = alloc_frag(fragLength);
     memcpy(newfrag->fptr, fragStart, fragLength);
     newfrag->ord = ft->ordinal++;
 
@@ -2063,29 +2181,12 @@ int Defrag::dup_frag_node( FragTracker* ft, Fragment* left, Fragment** retFrag)
     /*
      * grab/generate a new frag node
      */
-    {
-        /*
-         * build a frag struct to track this particular fragment
-         */
-        newfrag = (Fragment*)snort_calloc(sizeof(Fragment));
-        mem_in_use += sizeof(Fragment);
-
-        /*
-         * allocate some space to hold the actual data
-         */
-        newfrag->fptr = (uint8_t*)snort_calloc(left->flen);
-        mem_in_use += left->flen;
-
-        ip_stats.mem_in_use = mem_in_use;
-    }
-
-    ip_stats.nodes_created++;
+    newfrag = alloc_frag(left->flen);
 
     newfrag->ord = ft->ordinal++;
     /*
      * twiddle the frag values for overlaps
      */
-    newfrag->flen = left->flen;
     memcpy(newfrag->fptr, left->fptr, newfrag->flen);
     newfrag->data = newfrag->fptr + (left->data - left->fptr);
     newfrag->size = left->size;
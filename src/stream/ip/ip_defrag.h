@@ -39,9 +39,14 @@ public:
     bool configure(SnortConfig*);
     void show(SnortConfig*);
 
+    // per packet thread fragment pool
+    void tinit();
+    void tterm();
+
     void process(Packet*, FragTracker*);
     void cleanup(FragTracker*);
 
+    // once per process, not per instance, so reload doesn't repeat it
     static void init();
 
 private:
@@ -74,6 +74,7 @@ FragEngine::FragEngine()
 {
     memset(this, 0, sizeof(*this));
     frag_timeout = 60;
+    pool_memcap = 1048576;
 }
 
 //-------------------------------------------------------------------------
@@ -116,6 +117,9 @@ static const Parameter s_params[] =
     { "policy", Parameter::PT_ENUM, IP_POLICIES, "linux",
       "fragment reassembly policy" },
 
+    { "pool_memcap", Parameter::PT_INT, "0:1073741824", "1048576",
+      "maximum bytes of released fragments kept by each packet thread for reuse" },
+
     { "session_timeout", Parameter::PT_INT, "1:86400", "30",
       "session tracking timeout" },
 
@@ -187,6 +191,9 @@ bool StreamIpModule::set(const char* f, Value& v, SnortConfig* c)
     else if ( v.is("policy") )
         config->frag_engine.frag_policy = v.get_long() + 1;
 
+    else if ( v.is("pool_memcap") )
+        config->frag_engine.pool_memcap = v.get_long();
+
     else if ( v.is("session_timeout") )
     {
         // FIXIT-L need to integrate to eliminate redundant data
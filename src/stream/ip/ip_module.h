@@ -76,6 +76,10 @@ struct IpStats
     PegCount mem_in_use;        // frag_mem_in_use
     PegCount reassembled_bytes; // total_ipreassembled_bytes
     PegCount fragmented_bytes;  // total_ipfragmented_bytes
+    PegCount pool_hits;
+    PegCount pool_misses;
+    PegCount in_order_inserts;
+    PegCount in_order_reassembles;
 };
 
 extern const PegInfo ip_pegs[];
@@ -52,6 +52,10 @@ const PegInfo ip_pegs[] =
     { CountType::NOW, "memory_used", "current memory usage in bytes" },
     { CountType::SUM, "reassembled_bytes", "total reassembled bytes" },
     { CountType::SUM, "fragmented_bytes", "total fragmented bytes" },
+    { CountType::SUM, "pool_hits", "fragments allocated from the thread pool" },
+    { CountType::SUM, "pool_misses", "fragments allocated from the heap" },
+    { CountType::SUM, "in_order_inserts", "fragments appended without a list walk" },
+    { CountType::SUM, "in_order_reassembles", "datagrams reassembled from in order fragments" },
     { CountType::END, nullptr, nullptr }
 };
 
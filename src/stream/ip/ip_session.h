@@ -28,6 +28,9 @@ struct FragEngine;
 /* Only track a certain number of alerts per session */
 #define MAX_FRAG_ALERTS 8
 
+/* ipv4 header length is at most 60 bytes */
+#define MAX_FRAG_IP_OPTIONS 40
+
 /* tracker for a fragmented packet set */
 struct FragTracker
 {
@@ -58,7 +61,7 @@ struct FragTracker
     uint8_t alert_count;                 /* count alerts seen in a frag list */
 
     uint8_t ip_options_len;  /* length of ip options for this set of frags */
-    uint8_t* ip_options_data; /* ip options from offset 0 packet */
+    uint8_t ip_options_data[MAX_FRAG_IP_OPTIONS]; /* ip options from offset 0 packet */
     uint8_t copied_ip_options_len;  /* length of 'copied' ip options */
 
     FragEngine* engine;
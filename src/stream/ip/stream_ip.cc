@@ -76,6 +76,9 @@ public:
     bool configure(SnortConfig*) override;
     void show(SnortConfig*) override;
 
+    void tinit() override;
+    void tterm() override;
+
     NORETURN_ASSERT void eval(Packet*) override;
 
 public:
@@ -107,6 +110,16 @@ void StreamIp::show(SnortConfig* sc)
     defrag->show(sc);
 }
 
+void StreamIp::tinit()
+{
+    defrag->tinit();
+}
+
+void StreamIp::tterm()
+{
+    defrag->tterm();
+}
+
 NORETURN_ASSERT void StreamIp::eval(Packet*)
 {
     // session::process() instead
@@ -135,6 +148,11 @@ static Module* mod_ctor()
 static void mod_dtor(Module* m)
 { delete m; }
 
+static void ip_pinit()
+{
+    Defrag::init();
+}
+
 static void ip_tinit()
 {
     IpHAManager::tinit();
@@ -179,7 +197,7 @@ static const InspectApi ip_api =
     (unsigned)PktType::IP,
     nullptr, // buffers
     nullptr, // service
-    nullptr, // pinit
+    ip_pinit, // pinit
     nullptr, // pterm
     ip_tinit, // tinit
     ip_tterm, // tterm
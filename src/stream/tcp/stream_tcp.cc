@@ -23,9 +23,11 @@
 #include "stream_tcp.h"
 
 #include "main/snort_config.h"
+#include "memory/memory_domain.h"
 
 #include "tcp_ha.h"
 #include "tcp_module.h"
+#include "tcp_reassembler.h"
 #include "tcp_session.h"
 
 //-------------------------------------------------------------------------
@@ -119,6 +121,11 @@ static Session* tcp_ssn(Flow* lws)
     return new TcpSession(lws);
 }
 
+static void tcp_pinit()
+{
+    memory::add_pruner(memory::Domain::REASSEMBLY, TcpReassembler::prune_flushed);
+}
+
 static void tcp_tinit()
 {
     TcpSession::sinit();
@@ -147,7 +154,7 @@ static const InspectApi tcp_api =
     (unsigned)PktType::TCP,
     nullptr,  // buffers
     nullptr,  // service
-    nullptr,  // init
+    tcp_pinit,
     nullptr,  // term
     tcp_tinit,
     tcp_tterm,
@@ -56,6 +56,105 @@ ReassemblyPolicy stream_reassembly_policy_map[] =
     ReassemblyPolicy::OS_DEFAULT
 };
 
+// reassemblers that have queued segments on this thread, least recently
+// used first, so the pruner needn't walk the flows
+static THREAD_LOCAL TcpReassembler* lru_head = nullptr;
+static THREAD_LOCAL TcpReassembler* lru_tail = nullptr;
+
+TcpReassembler::~TcpReassembler()
+{
+    unlink();
+}
+
+// called on the way in to anything that allocates segments, so whichever
+// reassembler is in use when the pruner runs is at the tail
+void TcpReassembler::touch()
+{
+    if ( lru_tail == this )
+        return;
+
+    unlink();
+
+    lru_prev = lru_tail;
+    lru_next = nullptr;
+
+    if ( lru_tail )
+        lru_tail->lru_next = this;
+    else
+        lru_head = this;
+
+    lru_tail = this;
+    lru_linked = true;
+}
+
+void TcpReassembler::unlink()
+{
+    if ( !lru_linked )
+        return;
+
+    if ( lru_prev )
+        lru_prev->lru_next = lru_next;
+    else
+        lru_head = lru_next;
+
+    if ( lru_next )
+        lru_next->lru_prev = lru_prev;
+    else
+        lru_tail = lru_prev;
+
+    lru_prev = lru_next = nullptr;
+    lru_linked = false;
+}
+
+// flushed segments are only kept until they are acked, so they can go
+// early; the tracker's sequence state is left alone and only the seglist
+// base moves, so none of it is flushed a second time
+bool TcpReassembler::release_flushed()
+{
+    uint32_t end = 0;
+    unsigned released = 0;
+
+    while ( seglist.head and seglist.head->buffered )
+    {
+        end = seglist.head->seq + seglist.head->payload_size;
+        delete_reassembly_segment(seglist.head);
+        released++;
+    }
+
+    if ( !released )
+        return false;
+
+    if ( SEQ_LT(seglist_base_seq, end) )
+        seglist_base_seq = end;
+
+    return true;
+}
+
+bool TcpReassembler::prune_flushed()
+{
+    // both sides of the session at the tail may be in use
+    const TcpSession* busy = lru_tail ? lru_tail->session : nullptr;
+    TcpReassembler* r = lru_head;
+
+    while ( r )
+    {
+        TcpReassembler* next = r->lru_next;
+
+        if ( !r->seg_count )
+            r->unlink();
+
+        else if ( r->session != busy and r->release_flushed() )
+        {
+            if ( !r->seg_count )
+                r->unlink();
+
+            return true;
+        }
+        r = next;
+    }
+    return false;
+}
+
 void TcpReassembler::set_tcp_reassembly_policy(StreamPolicy os_policy)
 {
     reassembly_policy = stream_reassembly_policy_map[ static_cast<int>( os_policy ) ];
@@ -136,15 +235,7 @@ int TcpReassembler::delete_reassembly_segment(TcpSegmentNode* tsn)
     DebugFormat(DEBUG_STREAM_STATE, "Dropping segment at seq %X, len %d\n", tsn->seq,
         tsn->payload_size);
 
-    if (tsn->prev)
-        tsn->prev->next = tsn->next;
-    else
-        seglist.head = tsn->next;
-
-    if (tsn->next)
-        tsn->next->prev = tsn->prev;
-    else
-        seglist.tail = tsn->prev;
+    seglist.remove(tsn);
 
     seg_bytes_logical -= tsn->payload_size;
     seg_bytes_total -= tsn->orig_dsize;
@@ -430,6 +521,7 @@ int TcpReassembler::flush_data_segments(Packet* p, uint32_t total, Packet* pdu)
 
     assert(seglist.next);
     Profile profile(s5TcpBuildPacketPerfStats);
+    touch();
 
     uint32_t to_seq = seglist.next->seq + total;
 
@@ -1167,6 +1259,7 @@ int TcpReassembler::flush_on_ack_policy(Packet* p)
 
 void TcpReassembler::purge_segment_list()
 {
+    unlink();
     seglist.clear( );
     seg_count = 0;
     flush_count = 0;
@@ -1205,78 +1298,10 @@ void TcpReassembler::insert_segment_in_empty_seglist(TcpSegmentDescriptor& tsd)
 
 void TcpReassembler::init_overlap_editor(TcpSegmentDescriptor& tsd)
 {
-    TcpSegmentNode* left = nullptr;
-    TcpSegmentNode* right = nullptr;
-    TcpSegmentNode* tsn = nullptr;
-    int32_t dist_head;
-    int32_t dist_tail;
-    DEBUG_WRAP(
-        TcpSegmentNode *lastptr = nullptr;
-        uint32_t base_seq = seglist_base_seq;
-        int last = 0;
-        );
-
-    if ( seglist.head && seglist.tail )
-    {
-        if ( SEQ_GT(tsd.get_seg_seq(), seglist.head->seq) )
-            dist_head = tsd.get_seg_seq() - seglist.head->seq;
-        else
-            dist_head = seglist.head->seq - tsd.get_seg_seq();
-
-        if ( SEQ_GT(tsd.get_seg_seq(), seglist.tail->seq) )
-            dist_tail = tsd.get_seg_seq() - seglist.tail->seq;
-        else
-            dist_tail = seglist.tail->seq - tsd.get_seg_seq();
-    }
-    else
-        dist_head = dist_tail = 0;
-
-    if ( SEQ_LEQ(dist_head, dist_tail) )
-    {
-        for ( tsn = seglist.head; tsn; tsn = tsn->next )
-        {
-            DEBUG_WRAP(
-                DebugFormat(DEBUG_STREAM_STATE, "tsn: %p  seq: 0x%X  size: %hu delta: %u\n",
-                (void*) tsn, tsn->seq, tsn->payload_size, ( tsn->seq - base_seq ) - last);
-                last = tsn->seq - base_seq;
-                lastptr = tsn;
-
-                DebugFormat(DEBUG_STREAM_STATE, "   lastptr: %p tsn->next: %p tsn->prev: %p\n",
-                (void*) lastptr, (void*) tsn->next, (void*) tsn->prev);
-                );
-
-            right = tsn;
-            if ( SEQ_GEQ(right->seq, tsd.get_seg_seq() ) )
-                break;
-            left = right;
-        }
-
-        if ( tsn == nullptr )
-            right = nullptr;
-    }
-    else
-    {
-        for ( tsn = seglist.tail; tsn; tsn = tsn->prev )
-        {
-            DEBUG_WRAP(
-                DebugFormat(DEBUG_STREAM_STATE, "tsn: %p  seq: 0x%X  size: %hu delta: %u\n",
-                (void*) tsn, tsn->seq, tsn->payload_size, ( tsn->seq - base_seq ) - last);
-                last = tsn->seq - base_seq;
-                lastptr = tsn;
-
-                DebugFormat(DEBUG_STREAM_STATE, "   lastptr: %p tsn->next: %p tsn->prev: %p\n",
-                (void*) lastptr, (void*) tsn->next, (void*) tsn->prev);
-                );
-
-            left = tsn;
-            if ( SEQ_LT(left->seq, tsd.get_seg_seq() ) )
-                break;
-            right = left;
-        }
-
-        if (tsn == nullptr)
-            left = nullptr;
-    }
+    // the new segment goes before the first queued segment that doesn't
+    // start before it
+    TcpSegmentNode* right = seglist.find_right(tsd.get_seg_seq());
+    TcpSegmentNode* left = right ? right->prev : seglist.tail;
 
     DebugMessage(DEBUG_STREAM_STATE, "!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+\n");
     DebugMessage(DEBUG_STREAM_STATE, "!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+!+\n");
@@ -1340,6 +1365,7 @@ int TcpReassembler::insert_segment_in_seglist(TcpSegmentDescriptor& tsd)
 int TcpReassembler::queue_packet_for_reassembly(TcpSegmentDescriptor& tsd)
 {
     Profile profile(s5TcpInsertPerfStats);
+    touch();
 
     int rc = STREAM_INSERT_OK;
 
@@ -31,6 +31,7 @@ class TcpStreamTracker;
 class TcpReassembler : public SegmentOverlapEditor
 {
 public:
+    ~TcpReassembler() override;
 
     virtual int queue_packet_for_reassembly(TcpSegmentDescriptor&);
     virtual void purge_segment_list();
@@ -98,6 +99,10 @@ public:
 
     void trace_segments();
 
+    // release the flushed but unacked segments of the least recently used
+    // reassembler on this thread; registered as the reassembly pruner
+    static bool prune_flushed();
+
 protected:
     TcpReassembler(TcpSession* session, TcpStreamTracker* tracker,
             StreamPolicy os_policy, bool server) : server_side(server), tracker(tracker)
@@ -116,9 +121,7 @@ protected:
             packet_dir = PKT_FROM_SERVER;
         }
 
-        seglist.head = nullptr;
-        seglist.tail = nullptr;
-        seglist.next = nullptr;
+        seglist.reset();
     }
 
     int add_reassembly_segment(TcpSegmentDescriptor&, int16_t len, uint32_t slide, uint32_t trunc,
@@ -155,6 +158,9 @@ protected:
     void fallback();
     int32_t flush_pdu_ackd(uint32_t* flags);
     int purge_to_seq(uint32_t flush_seq);
+    bool release_flushed();
+    void touch();
+    void unlink();
 
     bool server_side;
     TcpStreamTracker* tracker;
@@ -162,6 +168,10 @@ protected:
     uint8_t packet_dir;
     uint32_t flush_count = 0; /* number of flushed queued segments */
     uint32_t xtradata_mask = 0; /* extra data available to log */
+
+    TcpReassembler* lru_prev = nullptr;
+    TcpReassembler* lru_next = nullptr;
+    bool lru_linked = false;
 };
 
 #endif
@@ -25,15 +25,20 @@
 
 #include "tcp_segment_node.h"
 
+#include "memory/memory_domain.h"
 #include "utils/util.h"
 
 #include "tcp_module.h"
 
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
 // FIXIT-P this is going to set each member 2X; once here and once in init
 // separate ctors with default initializers would set them only once
 TcpSegmentNode::TcpSegmentNode() :
-    prev(nullptr), next(nullptr), data(nullptr),
-    tv({ 0, 0 }), ts(0), seq(0), offset(0), orig_dsize(0),
+    prev(nullptr), next(nullptr), lt(nullptr), gt(nullptr), up(nullptr), data(nullptr),
+    tv({ 0, 0 }), ts(0), seq(0), prio(0), offset(0), orig_dsize(0),
     payload_size(0), urg_offset(0), buffered(false)
 {
 }
@@ -53,6 +58,10 @@ TcpSegmentNode* TcpSegmentNode::init(TcpSegmentNode& tsn)
 
 TcpSegmentNode* TcpSegmentNode::init(const struct timeval& tv, const uint8_t* data, unsigned dsize)
 {
+    // only the segments are charged to reassembly, not whatever the
+    // splitter or inspectors allocate while they are being flushed
+    memory::DomainContext domain(memory::Domain::REASSEMBLY);
+
     TcpSegmentNode* ss = new TcpSegmentNode;
     ss->data = ( uint8_t* )snort_alloc(dsize);
     memcpy(ss->data, data, dsize);
@@ -96,3 +105,250 @@ bool TcpSegmentNode::is_retransmit(const uint8_t* rdata, uint16_t rsize, uint32_
 
     return false;
 }
+
+//-------------------------------------------------------------------------
+// TcpSegmentList sequence index
+//-------------------------------------------------------------------------
+
+// queued segments don't overlap so list order is seq order.  equal seqs
+// only occur briefly while a segment is split (dup_reassembly_segment()
+// queues the copy after the original) so ties go after existing nodes.
+
+static THREAD_LOCAL uint32_t prio_state = 2463534242;
+
+static inline uint32_t next_prio()
+{
+    // xorshift32
+    prio_state ^= prio_state << 13;
+    prio_state ^= prio_state >> 17;
+    prio_state ^= prio_state << 5;
+    return prio_state;
+}
+
+// a gets the nodes with seq <= the given seq, b the rest.  the up links of
+// the two roots are left for the caller.
+static void split(TcpSegmentNode* t, uint32_t seq, TcpSegmentNode*& a, TcpSegmentNode*& b)
+{
+    if ( !t )
+        a = b = nullptr;
+
+    else if ( SEQ_GT(t->seq, seq) )
+    {
+        split(t->lt, seq, a, t->lt);
+        if ( t->lt )
+            t->lt->up = t;
+        b = t;
+    }
+    else
+    {
+        split(t->gt, seq, t->gt, b);
+        if ( t->gt )
+            t->gt->up = t;
+        a = t;
+    }
+}
+
+// all of a precedes all of b
+static TcpSegmentNode* merge(TcpSegmentNode* a, TcpSegmentNode* b)
+{
+    if ( !a )
+        return b;
+
+    if ( !b )
+        return a;
+
+    if ( a->prio > b->prio )
+    {
+        a->gt = merge(a->gt, b);
+        a->gt->up = a;
+        return a;
+    }
+    b->lt = merge(a, b->lt);
+    b->lt->up = b;
+    return b;
+}
+
+TcpSegmentNode* TcpSegmentList::find_right(uint32_t seq) const
+{
+    TcpSegmentNode* t = root;
+    TcpSegmentNode* right = nullptr;
+
+    while ( t )
+    {
+        if ( SEQ_LT(t->seq, seq) )
+            t = t->gt;
+        else
+        {
+            right = t;
+            t = t->lt;
+        }
+    }
+    return right;
+}
+
+void TcpSegmentList::index_insert(TcpSegmentNode* tsn)
+{
+    TcpSegmentNode* a;
+    TcpSegmentNode* b;
+
+    tsn->lt = tsn->gt = nullptr;
+    tsn->prio = next_prio();
+
+    split(root, tsn->seq, a, b);
+    root = merge(merge(a, tsn), b);
+    root->up = nullptr;
+}
+
+// a node is unlinked through its up link rather than found by seq, so this
+// can't miss even if a seq was changed in place
+void TcpSegmentList::index_remove(TcpSegmentNode* tsn)
+{
+    TcpSegmentNode* t = merge(tsn->lt, tsn->gt);
+    TcpSegmentNode* up = tsn->up;
+
+    if ( t )
+        t->up = up;
+
+    if ( !up )
+        root = t;
+    else if ( up->lt == tsn )
+        up->lt = t;
+    else
+        up->gt = t;
+
+    tsn->lt = tsn->gt = tsn->up = nullptr;
+}
+
+#ifdef UNIT_TEST
+
+static TcpSegmentNode* make_seg(uint32_t seq, uint16_t size)
+{
+    TcpSegmentNode* tsn = new TcpSegmentNode;
+    tsn->seq = seq;
+    tsn->payload_size = size;
+    return tsn;
+}
+
+// the walk init_overlap_editor() used before the index
+static TcpSegmentNode* walk_right(TcpSegmentList& sl, uint32_t seq)
+{
+    for ( TcpSegmentNode* tsn = sl.head; tsn; tsn = tsn->next )
+        if ( SEQ_GEQ(tsn->seq, seq) )
+            return tsn;
+
+    return nullptr;
+}
+
+static void insert_seg(TcpSegmentList& sl, TcpSegmentNode* tsn)
+{
+    TcpSegmentNode* right = sl.find_right(tsn->seq);
+    sl.insert(right ? right->prev : sl.tail, tsn);
+}
+
+TEST_CASE("segment list index", "[stream_tcp]")
+{
+    TcpSegmentList sl;
+    const uint32_t base = 0xFFFFF000;  // queue wraps the sequence space
+    const unsigned num = 512;
+    unsigned slots[num];
+
+    for ( unsigned i = 0; i < num; ++i )
+        slots[i] = i;
+
+    // out of order arrival
+    srand(42);
+    for ( unsigned i = num - 1; i > 0; --i )
+        std::swap(slots[i], slots[rand() % (i + 1)]);
+
+    for ( unsigned i = 0; i < num; ++i )
+        insert_seg(sl, make_seg(base + slots[i] * 16, 8));
+
+    CHECK(sl.count == num);
+
+    SECTION("list is in sequence order")
+    {
+        uint32_t seq = base;
+
+        for ( TcpSegmentNode* tsn = sl.head; tsn; tsn = tsn->next, seq += 16 )
+            CHECK(tsn->seq == seq);
+    }
+
+    SECTION("lookup matches list walk")
+    {
+        for ( uint32_t seq = base - 16; seq != base + num * 16 + 16; seq += 4 )
+            CHECK(sl.find_right(seq) == walk_right(sl, seq));
+    }
+
+    SECTION("lookup after removal")
+    {
+        // flush from the head and drop some from the middle
+        for ( unsigned i = 0; i < num / 2; ++i )
+        {
+            TcpSegmentNode* tsn = sl.head;
+            sl.remove(tsn);
+            delete tsn;
+        }
+        for ( unsigned i = 0; i < 16; ++i )
+        {
+            TcpSegmentNode* tsn = sl.find_right(base + (num / 2 + i * 8) * 16);
+            sl.remove(tsn);
+            delete tsn;
+        }
+        for ( uint32_t seq = base; seq != base + num * 16; seq += 8 )
+            CHECK(sl.find_right(seq) == walk_right(sl, seq));
+
+        insert_seg(sl, make_seg(base, 8));
+        CHECK(sl.head->seq == base);
+        CHECK(sl.find_right(base) == sl.head);
+    }
+
+    while ( TcpSegmentNode* tsn = sl.head )
+    {
+        sl.remove(tsn);
+        delete tsn;
+    }
+    CHECK(!sl.find_right(base));
+}
+
+TEST_CASE("segment list split", "[stream_tcp]")
+{
+    TcpSegmentList sl;
+    TcpSegmentNode* left = make_seg(100, 16);
+    insert_seg(sl, make_seg(80, 16));
+    insert_seg(sl, left);
+    insert_seg(sl, make_seg(132, 16));
+
+    // the way dup_reassembly_segment() splits a segment around new data
+    TcpSegmentNode* right = make_seg(100, 16);
+    sl.insert(left, right);
+    left->payload_size = 4;
+    right->seq = 108;
+    right->payload_size = 8;
+
+    CHECK(left->next == right);
+    CHECK(sl.find_right(101) == right);
+    CHECK(sl.find_right(100) == left);
+
+    sl.remove(left);
+    delete left;
+
+    CHECK(sl.find_right(90) == right);
+    CHECK(sl.find_right(109)->seq == 132);
+
+    // removal doesn't search by seq so a stale seq can't strand a node
+    right->seq = 200;
+    sl.remove(right);
+    delete right;
+
+    CHECK(sl.find_right(90)->seq == 132);
+    CHECK(sl.find_right(0)->seq == 80);
+
+    while ( TcpSegmentNode* tsn = sl.head )
+    {
+        sl.remove(tsn);
+        delete tsn;
+    }
+    CHECK(!sl.find_right(0));
+}
+
+#endif
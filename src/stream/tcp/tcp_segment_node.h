@@ -49,11 +49,17 @@ struct TcpSegmentNode
     TcpSegmentNode* prev;
     TcpSegmentNode* next;
 
+    // sequence index links, see TcpSegmentList
+    TcpSegmentNode* lt;
+    TcpSegmentNode* gt;
+    TcpSegmentNode* up;
+
     uint8_t* data;
 
     struct timeval tv;
     uint32_t ts;
     uint32_t seq;
+    uint32_t prio;
 
     uint16_t offset;
     uint16_t orig_dsize;
@@ -67,7 +73,7 @@ class TcpSegmentList
 {
 public:
     TcpSegmentList() :
-        head(nullptr), tail(nullptr), next(nullptr), count(0)
+        head(nullptr), tail(nullptr), next(nullptr), count(0), root(nullptr)
     {
     }
 
@@ -100,12 +106,18 @@ public:
             dump_me->term( );
         }
 
-        head = tail = next = nullptr;
-        count = 0;
+        reset();
         DebugFormat(DEBUG_STREAM_STATE, "Dropped %d segments\n", i);
         return i;
     }
 
+    void reset()
+    {
+        head = tail = next = nullptr;
+        count = 0;
+        index_clear();
+    }
+
     void insert(TcpSegmentNode* prev, TcpSegmentNode* ss)
     {
         if ( prev )
@@ -128,6 +140,7 @@ public:
             head = ss;
         }
 
+        index_insert(ss);
         count++;
     }
 
@@ -143,8 +156,24 @@ public:
         else
             tail = ss->prev;
 
+        index_remove(ss);
         count--;
     }
+
+    // first queued segment with seq at or after the given seq
+    TcpSegmentNode* find_right(uint32_t seq) const;
+
+private:
+    // segments are also kept in a treap keyed by seq, linked through the
+    // nodes themselves, so the insertion point for a new segment is found
+    // in O(log n) without a walk of the list or an allocation
+    TcpSegmentNode* root;
+
+    void index_insert(TcpSegmentNode*);
+    void index_remove(TcpSegmentNode*);
+
+    void index_clear()
+    { root = nullptr; }
 };
 
 #endif
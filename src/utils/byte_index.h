@@ -0,0 +1,77 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifndef BYTE_INDEX_H
+#define BYTE_INDEX_H
+
+// ByteIndex replaces a 256 entry array of trie branches with a 256 bit map
+// of the bytes actually present.  the branches themselves are kept densely
+// by the caller in byte order after a slot 0 that holds whatever an absent
+// byte maps to (usually null).  the slot for a byte is 1 + the number of
+// present bytes below it, which is found with a mask and a popcount so the
+// lookup has no data dependent branches.
+//
+// like byte_scan.h, everything is inline so plugins don't need to link
+// against these symbols.
+
+#include <cstdint>
+
+class ByteIndex
+{
+public:
+    // slot of the branch for c or 0 if c is not present
+    unsigned find(uint8_t c) const
+    {
+        const unsigned w = c >> 6;
+        const uint64_t bit = 1ull << (c & 63);
+        const unsigned hit = -(unsigned)((bits[w] >> (c & 63)) & 1);
+        const unsigned slot = 1 + base[w] + __builtin_popcountll(bits[w] & (bit - 1));
+        return slot & hit;
+    }
+
+    // add c if not present and return its slot; the caller must insert a
+    // branch at that slot when c is new, ie when size() grows
+    unsigned add(uint8_t c)
+    {
+        const unsigned w = c >> 6;
+        const uint64_t bit = 1ull << (c & 63);
+
+        if ( !(bits[w] & bit) )
+        {
+            bits[w] |= bit;
+
+            for ( unsigned i = w + 1; i < 4; ++i )
+                ++base[i];
+        }
+        return find(c);
+    }
+
+    bool empty() const
+    { return !(bits[0] | bits[1] | bits[2] | bits[3]); }
+
+    // number of present bytes, not counting slot 0
+    unsigned size() const
+    { return base[3] + __builtin_popcountll(bits[3]); }
+
+private:
+    uint64_t bits[4] = { };
+    uint8_t base[4] = { };  // bytes present in the preceding words, at most 192
+};
+
+#endif
+
@@ -0,0 +1,94 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// byte_index_test.cc validates the sparse branch index against a full
+// 256 entry array
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdlib>
+#include <vector>
+
+#include "catch/snort_catch.h"
+
+#include "byte_index.h"
+
+SNORT_FORCED_INCLUSION_DEFINITION(byte_index_test);
+
+TEST_CASE("byte index empty", "[byte_index]")
+{
+    ByteIndex bi;
+
+    CHECK(bi.empty());
+    CHECK(bi.size() == 0);
+
+    for ( unsigned c = 0; c < 256; ++c )
+        CHECK(bi.find(c) == 0);
+}
+
+TEST_CASE("byte index edges", "[byte_index]")
+{
+    ByteIndex bi;
+
+    // first and last byte of each word
+    for ( unsigned c : { 255, 0, 63, 64, 127, 128, 191, 192 } )
+        bi.add(c);
+
+    CHECK(bi.size() == 8);
+    CHECK(bi.find(0) == 1);
+    CHECK(bi.find(63) == 2);
+    CHECK(bi.find(64) == 3);
+    CHECK(bi.find(191) == 6);
+    CHECK(bi.find(255) == 8);
+    CHECK(bi.find(1) == 0);
+    CHECK(bi.find(254) == 0);
+
+    // adding again doesn't change anything
+    CHECK(bi.add(128) == 5);
+    CHECK(bi.size() == 8);
+}
+
+TEST_CASE("byte index matches array", "[byte_index]")
+{
+    srand(1);
+
+    for ( unsigned n : { 1, 5, 40, 200, 256 } )
+    {
+        ByteIndex bi;
+        std::vector<int> branches(1, 0);
+        int array[256] = { };
+
+        // insert in random order the way a trie grows
+        for ( unsigned i = 0; i < n; ++i )
+        {
+            uint8_t c = rand();
+            unsigned size = bi.size();
+            unsigned slot = bi.add(c);
+
+            if ( bi.size() > size )
+                branches.insert(branches.begin() + slot, c + 1);
+
+            array[c] = c + 1;
+        }
+
+        for ( unsigned c = 0; c < 256; ++c )
+            CHECK(branches[bi.find(c)] == array[c]);
+    }
+}
+
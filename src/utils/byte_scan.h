@@ -0,0 +1,164 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifndef BYTE_SCAN_H
+#define BYTE_SCAN_H
+
+// find the first occurrence of any of a few byte values in a buffer.  these
+// are the delimiter searches done by stream splitters, eg CR or LF at the
+// end of a line.  each find returns end if none of the values is present.
+//
+// like checksum.h, everything is inline so plugins don't need to link
+// against these symbols.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// SSE2 is part of the x86_64 baseline; AVX2 is selected at runtime
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define BYTE_SCAN_SIMD
+#define BYTE_SCAN_AVX2_MIN_LEN 64
+#endif
+
+namespace byte_scan
+{
+inline const uint8_t* find(const uint8_t* p, const uint8_t* end, uint8_t a);
+inline const uint8_t* find(const uint8_t* p, const uint8_t* end, uint8_t a, uint8_t b);
+inline const uint8_t* find(
+    const uint8_t* p, const uint8_t* end, uint8_t a, uint8_t b, uint8_t c);
+
+// first CR or LF
+inline const uint8_t* find_eol(const uint8_t* p, const uint8_t* end)
+{ return find(p, end, '\r', '\n'); }
+
+namespace detail
+{
+inline const uint8_t* find_scalar(
+    const uint8_t* p, const uint8_t* end, uint8_t a, uint8_t b, uint8_t c)
+{
+    for ( ; p < end; ++p )
+    {
+        if ( *p == a || *p == b || *p == c )
+            break;
+    }
+    return p;
+}
+
+#ifdef BYTE_SCAN_SIMD
+inline const uint8_t* find_sse2(
+    const uint8_t* p, const uint8_t* end, uint8_t a, uint8_t b, uint8_t c)
+{
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    const __m128i vc = _mm_set1_epi8(c);
+
+    while ( end - p >= 16 )
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, vc));
+
+        if ( int bits = _mm_movemask_epi8(m) )
+            return p + __builtin_ctz(bits);
+
+        p += 16;
+    }
+    return find_scalar(p, end, a, b, c);
+}
+
+__attribute__((target("avx2")))
+inline const uint8_t* find_avx2(
+    const uint8_t* p, const uint8_t* end, uint8_t a, uint8_t b, uint8_t c)
+{
+    const __m256i va = _mm256_set1_epi8(a);
+    const __m256i vb = _mm256_set1_epi8(b);
+    const __m256i vc = _mm256_set1_epi8(c);
+
+    while ( end - p >= 32 )
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb));
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, vc));
+
+        if ( unsigned bits = _mm256_movemask_epi8(m) )
+            return p + __builtin_ctz(bits);
+
+        p += 32;
+    }
+    return find_sse2(p, end, a, b, c);
+}
+
+inline bool have_avx2()
+{
+    static const bool avx2 = []()
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return avx2;
+}
+#endif
+
+// lines are often shorter than an avx2 register is worth setting up for
+// so the wider kernel is only used for longer buffers
+inline const uint8_t* find_any(
+    const uint8_t* p, const uint8_t* end, uint8_t a, uint8_t b, uint8_t c)
+{
+#ifdef BYTE_SCAN_SIMD
+    if ( end - p >= BYTE_SCAN_AVX2_MIN_LEN && have_avx2() )
+        return find_avx2(p, end, a, b, c);
+
+    return find_sse2(p, end, a, b, c);
+#else
+    return find_scalar(p, end, a, b, c);
+#endif
+}
+} // namespace detail
+
+// libc memchr is already vectorized for a single value
+inline const uint8_t* find(const uint8_t* p, const uint8_t* end, uint8_t a)
+{
+    if ( p >= end )
+        return end;
+
+    const void* q = memchr(p, a, end - p);
+    return q ? (const uint8_t*)q : end;
+}
+
+inline const uint8_t* find(const uint8_t* p, const uint8_t* end, uint8_t a, uint8_t b)
+{
+    if ( p >= end )
+        return end;
+
+    return detail::find_any(p, end, a, b, b);
+}
+
+inline const uint8_t* find(
+    const uint8_t* p, const uint8_t* end, uint8_t a, uint8_t b, uint8_t c)
+{
+    if ( p >= end )
+        return end;
+
+    return detail::find_any(p, end, a, b, c);
+}
+} // namespace byte_scan
+
+#endif
+
@@ -0,0 +1,170 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// byte_scan_test.cc validates the vector delimiter searches against the
+// scalar loop and times them on header and body shaped data
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "catch/snort_catch.h"
+
+#include "byte_scan.h"
+
+SNORT_FORCED_INCLUSION_DEFINITION(byte_scan_test);
+
+using namespace byte_scan;
+
+static const uint8_t* scalar(const std::vector<uint8_t>& v, std::size_t from, uint8_t a, uint8_t b)
+{ return detail::find_scalar(v.data() + from, v.data() + v.size(), a, b, b); }
+
+TEST_CASE("find matches scalar", "[byte_scan]")
+{
+    std::vector<uint8_t> buf(300, 'x');
+
+    // a delimiter at every position and every start offset crosses each
+    // vector boundary and the scalar tail
+    for ( std::size_t at = 0; at < buf.size(); ++at )
+    {
+        for ( uint8_t d : { '\r', '\n' } )
+        {
+            buf[at] = d;
+
+            for ( std::size_t from = 0; from < 70; ++from )
+            {
+                const uint8_t* begin = buf.data() + from;
+                const uint8_t* end = buf.data() + buf.size();
+
+                CHECK(find_eol(begin, end) == scalar(buf, from, '\r', '\n'));
+                CHECK(find(begin, end, d) == scalar(buf, from, d, d));
+            }
+            buf[at] = 'x';
+        }
+    }
+}
+
+TEST_CASE("find edge cases", "[byte_scan]")
+{
+    std::vector<uint8_t> buf(100, 0xff);
+    const uint8_t* p = buf.data();
+    const uint8_t* end = p + buf.size();
+
+    CHECK(find_eol(p, end) == end);
+    CHECK(find(p, end, 0) == end);
+    CHECK(find(p, p, 0xff) == p);
+    CHECK(find_eol(end, end) == end);
+
+    // high bit values must not be confused by signed compares
+    buf[77] = 0x80;
+    CHECK(find(p, end, 0x80, 0x81, 0x82) == p + 77);
+    CHECK(find(p, end, 0xff, 0x80) == p);
+
+#ifdef BYTE_SCAN_SIMD
+    buf[99] = '\n';
+    CHECK(detail::find_sse2(p, end, '\r', '\n', '\n') == p + 99);
+
+    if ( detail::have_avx2() )
+        CHECK(detail::find_avx2(p, end, '\r', '\n', '\n') == p + 99);
+#endif
+}
+
+// header blocks are short lines; bodies are long runs without CR or LF
+static std::vector<uint8_t> make_headers(std::size_t len)
+{
+    static const char* lines[] =
+    {
+        "Host: www.example.com\r\n",
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:60.0) Gecko/20100101 Firefox/60.0\r\n",
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n",
+        "Accept-Language: en-US,en;q=0.5\r\n",
+        "Cookie: session=0123456789abcdef0123456789abcdef; theme=dark; lang=en\r\n",
+    };
+    std::string s;
+
+    for ( unsigned i = 0; s.size() < len; ++i )
+        s += lines[i % (sizeof(lines) / sizeof(lines[0]))];
+
+    return std::vector<uint8_t>(s.begin(), s.begin() + len);
+}
+
+static std::vector<uint8_t> make_body(std::size_t len)
+{
+    std::vector<uint8_t> v(len);
+    srand(1);
+
+    for ( auto& b : v )
+    {
+        b = rand();
+
+        if ( b == '\r' || b == '\n' )
+            b = ' ';
+    }
+    return v;
+}
+
+static unsigned count_eol(const uint8_t* p, const uint8_t* end, bool vector)
+{
+    unsigned n = 0;
+
+    while ( true )
+    {
+        p = vector ? find_eol(p, end) : detail::find_scalar(p, end, '\r', '\n', '\n');
+
+        if ( p == end )
+            return n;
+
+        ++n;
+        ++p;
+    }
+}
+
+TEST_CASE("byte_scan benchmarks", "[byte_scan][!benchmark]")
+{
+    std::vector<uint8_t> hdr = make_headers(65536);
+    std::vector<uint8_t> body = make_body(65536);
+    volatile unsigned sink = 0;
+
+    CHECK(count_eol(hdr.data(), hdr.data() + hdr.size(), true) ==
+        count_eol(hdr.data(), hdr.data() + hdr.size(), false));
+
+    BENCHMARK("scalar headers 64K")
+    {
+        for ( int i = 0; i < 100; ++i )
+            sink += count_eol(hdr.data(), hdr.data() + hdr.size(), false);
+    }
+    BENCHMARK("vector headers 64K")
+    {
+        for ( int i = 0; i < 100; ++i )
+            sink += count_eol(hdr.data(), hdr.data() + hdr.size(), true);
+    }
+    BENCHMARK("scalar body 64K")
+    {
+        for ( int i = 0; i < 100; ++i )
+            sink += count_eol(body.data(), body.data() + body.size(), false);
+    }
+    BENCHMARK("vector body 64K")
+    {
+        for ( int i = 0; i < 100; ++i )
+            sink += count_eol(body.data(), body.data() + body.size(), true);
+    }
+}
+
@@ -36,6 +36,11 @@ size_t segment_unusedmem()
     return unused_mem;
 }
 
+size_t segment_usedmem()
+{
+    return unused_ptr;
+}
+
 /***************************************************************************
  *  Initialize the segment memory
  * Return values:
@@ -33,6 +33,7 @@ MEM_OFFSET segment_snort_alloc(size_t size);
 void segment_free(MEM_OFFSET ptr);
 MEM_OFFSET segment_snort_calloc(size_t num, size_t size);
 size_t segment_unusedmem();
+size_t segment_usedmem();
 void* segment_basePtr();
 
 #endif
@@ -0,0 +1,370 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// perfbin.cc
+
+//  This program converts the binary records written by perf_monitor with
+//  format = bin into the same csv or json the other formatters produce, so
+//  high rate sampling can be stored cheaply and formatted later.
+
+#include <getopt.h>
+
+#include <cinttypes>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// must match src/network_inspectors/perf_monitor/bin_formatter.h
+#define PERF_BIN_MAGIC 0x50524642
+
+using namespace std;
+
+struct Field
+{
+    char type;
+    string section;
+    string name;
+};
+
+static string in_file;
+static bool json = false;
+static bool done = false;
+static FILE* file = nullptr;
+
+static void help()
+{
+    cout << "perf_monitor Binary Record Converter for Snort 3\n\n"
+         << "Usage: perfbin -i file [-j]\n"
+         << "-i: binary records file from Snort (required)\n"
+         << "-j: output json instead of csv\n";
+}
+
+static void error(const string& e)
+{
+    cerr << "perfbin: " << e << "\n";
+    if( file )
+        fclose(file);
+    exit(-1);
+}
+
+static void sigint_handler(int)
+{ done = true; }
+
+static bool handle_options(int argc, char* argv[])
+{
+    int opt;
+    while( (opt = getopt(argc, argv, "i:j")) != -1 )
+    {
+        switch(opt)
+        {
+            case 'i':
+                in_file = optarg;
+                break;
+
+            case 'j':
+                json = true;
+                break;
+
+            default:
+                help();
+                return false;
+        }
+    }
+    if( in_file.empty() )
+    {
+        help();
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+static bool get(const vector<uint8_t>& rec, size_t& pos, T& val)
+{
+    if( pos + sizeof(T) > rec.size() )
+        return false;
+
+    memcpy(&val, &rec[pos], sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+static vector<Field> load_schema()
+{
+    uint32_t magic, size;
+
+    if( fread(&magic, sizeof(magic), 1, file) != 1 )
+        error("unable to read file magic");
+
+    if( magic == __builtin_bswap32(PERF_BIN_MAGIC) )
+        error("file was written on a host with different byte order");
+
+    if( magic != PERF_BIN_MAGIC )
+        error("unknown file magic");
+
+    if( fread(&size, sizeof(size), 1, file) != 1 )
+        error("unable to read schema size");
+
+    string text(size, '\0');
+
+    if( size and fread(&text[0], size, 1, file) != 1 )
+        error("unable to read schema");
+
+    vector<Field> fields;
+    size_t pos = 0;
+
+    while( pos < text.size() )
+    {
+        size_t end = text.find('\n', pos);
+
+        if( end == string::npos )
+            end = text.size();
+
+        string line = text.substr(pos, end - pos);
+        size_t sp1 = line.find(' ');
+        size_t sp2 = (sp1 == string::npos) ? sp1 : line.find(' ', sp1 + 1);
+
+        if( sp1 != 1 or sp2 == string::npos or !strchr("psv", line[0]) )
+            error("bad schema line: " + line);
+
+        fields.push_back({ line[0], line.substr(2, sp2 - 2), line.substr(sp2 + 1) });
+        pos = end + 1;
+    }
+    return fields;
+}
+
+static void csv_header(const vector<Field>& fields)
+{
+    printf("#timestamp");
+
+    for( auto& f : fields )
+        printf(",%s.%s", f.section.c_str(), f.name.c_str());
+
+    printf("\n");
+}
+
+// same as CSVFormatter::write
+static bool csv_record(const vector<Field>& fields, const vector<uint8_t>& rec)
+{
+    size_t pos = 0;
+    uint64_t ts;
+
+    if( !get(rec, pos, ts) )
+        return false;
+
+    string out = to_string(ts);
+
+    for( auto& f : fields )
+    {
+        switch( f.type )
+        {
+            case 'p':
+            {
+                uint64_t pc;
+
+                if( !get(rec, pos, pc) )
+                    return false;
+
+                out += "," + to_string(pc);
+                break;
+            }
+            case 's':
+            {
+                uint16_t len;
+
+                if( !get(rec, pos, len) or pos + len > rec.size() )
+                    return false;
+
+                out += ",";
+                out.append((const char*)&rec[pos], len);
+                pos += len;
+                break;
+            }
+            case 'v':
+            {
+                uint32_t n;
+                string vals;
+                uint64_t size = 0;
+
+                if( !get(rec, pos, n) )
+                    return false;
+
+                for( uint32_t k = 0; k < n; k++ )
+                {
+                    uint64_t pc;
+
+                    if( !get(rec, pos, pc) )
+                        return false;
+
+                    if( pc )
+                    {
+                        vals += "," + to_string(pc);
+                        size++;
+                    }
+                }
+                out += "," + to_string(size) + vals;
+                break;
+            }
+        }
+    }
+    printf("%s\n", out.c_str());
+    return true;
+}
+
+// same as JSONFormatter::write; zero pegs and empty strings are left out
+static bool json_record(const vector<Field>& fields, const vector<uint8_t>& rec, bool first)
+{
+    size_t pos = 0;
+    uint64_t ts;
+
+    if( !get(rec, pos, ts) )
+        return false;
+
+    string out = first ? "" : ",";
+    out += "{\"timestamp\":" + to_string(ts);
+
+    const string* section = nullptr;
+    bool head = false;
+
+    for( auto& f : fields )
+    {
+        if( !section or *section != f.section )
+        {
+            if( head )
+                out += "}";
+
+            section = &f.section;
+            head = false;
+        }
+
+        string val;
+
+        switch( f.type )
+        {
+            case 'p':
+            {
+                uint64_t pc;
+
+                if( !get(rec, pos, pc) )
+                    return false;
+
+                if( pc )
+                    val = to_string(pc);
+                break;
+            }
+            case 's':
+            {
+                uint16_t len;
+
+                if( !get(rec, pos, len) or pos + len > rec.size() )
+                    return false;
+
+                if( len )
+                    val = "\"" + string((const char*)&rec[pos], len) + "\"";
+                pos += len;
+                break;
+            }
+            case 'v':
+            {
+                uint32_t n;
+
+                if( !get(rec, pos, n) )
+                    return false;
+
+                for( uint32_t k = 0; k < n; k++ )
+                {
+                    uint64_t pc;
+
+                    if( !get(rec, pos, pc) )
+                        return false;
+
+                    if( pc )
+                        val += (val.empty() ? "{\"" : ",\"") + to_string(k) + "\":" +
+                            to_string(pc);
+                }
+                if( !val.empty() )
+                    val += "}";
+                break;
+            }
+        }
+
+        if( val.empty() )
+            continue;
+
+        out += head ? "," : ",\"" + f.section + "\":{";
+        out += "\"" + f.name + "\":" + val;
+        head = true;
+    }
+    if( head )
+        out += "}";
+
+    printf("%s}", out.c_str());
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    signal(SIGINT, sigint_handler);
+
+    if( !handle_options(argc, argv) )
+        return 1;
+
+    file = fopen(in_file.c_str(), "rb");
+    if( !file )
+        error("unable to open " + in_file);
+
+    vector<Field> fields = load_schema();
+    vector<uint8_t> rec;
+    bool first = true;
+
+    if( json )
+        printf("[");
+    else
+        csv_header(fields);
+
+    while( !done )
+    {
+        uint32_t size;
+
+        // a partial record at the end is still being written
+        if( fread(&size, sizeof(size), 1, file) != 1 )
+            break;
+
+        rec.resize(size);
+
+        if( size and fread(&rec[0], size, 1, file) != 1 )
+            break;
+
+        bool ok = json ? json_record(fields, rec, first) : csv_record(fields, rec);
+
+        if( !ok )
+            error("record does not match schema");
+
+        first = false;
+    }
+
+    if( json )
+        printf("]\n");
+
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,189 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// rep_compiler.cc builds the reputation IP list table offline and writes
+// it as an image the reputation inspector can map with its image option.
+// The list parsing and table code is shared with the inspector so the
+// image is identical to what snort would build from the same lists.
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "log/messages.h"
+#include "network_inspectors/reputation/reputation_image.h"
+#include "network_inspectors/reputation/reputation_parse.h"
+#include "parser/config_file.h"
+#include "utils/util.h"
+
+#define SUCCESS 0
+#define FAILURE 1
+
+//--------------------------------------------------------------------------
+// the few snort services used by the shared list code
+//--------------------------------------------------------------------------
+
+static const char* conf_dir = ".";
+
+const char* get_snort_conf_dir()
+{ return conf_dir; }
+
+void LogMessage(const char* format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    vfprintf(stdout, format, ap);
+    va_end(ap);
+}
+
+void WarningMessage(const char* format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+}
+
+void ErrorMessage(const char* format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+}
+
+[[noreturn]] void FatalError(const char* format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+    exit(FAILURE);
+}
+
+char* snort_strdup(const char* str)
+{
+    size_t n = strlen(str) + 1;
+    char* p = (char*)snort_alloc(n);
+    memcpy(p, str, n);
+    return p;
+}
+
+const char* get_error(int errnum)
+{ return strerror(errnum); }
+
+//--------------------------------------------------------------------------
+// compiler
+//--------------------------------------------------------------------------
+
+static void usage()
+{
+    fprintf(stderr,
+        "Usage: rep_compiler [-b blacklist] [-w whitelist] [-m memcap] "
+        "[-a unblack|trust] [-d dir] <outfile>\n");
+}
+
+int main(int argc, char* argv[])
+{
+    ReputationConfig config;
+    int c;
+    opterr = 0;
+
+    while ((c = getopt (argc, argv, "a:b:d:m:w:")) != -1)
+    {
+        switch (c)
+        {
+        case 'a':
+            if (!strcmp(optarg, "unblack"))
+                config.whiteAction = UNBLACK;
+            else if (!strcmp(optarg, "trust"))
+                config.whiteAction = TRUST;
+            else
+            {
+                fprintf(stderr, "Invalid white action. Valid actions are: unblack, trust\n");
+                return FAILURE;
+            }
+            break;
+        case 'b':
+            config.blacklist_path = snort_strdup(optarg);
+            break;
+        case 'd':
+            conf_dir = optarg;
+            break;
+        case 'm':
+            config.memcap = strtoul(optarg, nullptr, 10);
+            if (config.memcap < 1 || config.memcap > 4095)
+            {
+                fprintf(stderr, "Invalid memcap. Valid range is 1:4095 MB\n");
+                return FAILURE;
+            }
+            break;
+        case 'w':
+            config.whitelist_path = snort_strdup(optarg);
+            break;
+        case '?':
+            if (isprint (optopt))
+                fprintf(stderr, "Unknown option or missing argument -%c.\n", optopt);
+            usage();
+            return FAILURE;
+        default:
+            abort();
+        }
+    }
+
+    if (optind != (argc - 1) || (!config.blacklist_path && !config.whitelist_path))
+    {
+        usage();
+        return FAILURE;
+    }
+
+    EstimateNumEntries(&config);
+
+    if (config.numEntries <= 0)
+    {
+        fprintf(stderr, "Error: can't find any whitelist/blacklist entries.\n");
+        return FAILURE;
+    }
+
+    IpListInit(config.numEntries + 1, &config);
+    LoadListFile(config.blacklist_path, config.local_black_ptr, &config);
+    LoadListFile(config.whitelist_path, config.local_white_ptr, &config);
+
+    if (config.memCapReached)
+    {
+        fprintf(stderr, "Error: memcap reached; image would be incomplete.\n");
+        return FAILURE;
+    }
+
+    if (!ReputationImage::save(argv[optind], &config))
+        return FAILURE;
+
+    printf("Wrote %u entries (%u bytes) to %s\n", sfrt_flat_num_entries(config.iplist),
+        sfrt_flat_usage(config.iplist), argv[optind]);
+
+    return SUCCESS;
+}
+